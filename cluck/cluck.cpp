@@ -512,6 +512,51 @@ bool cluck::remove_finally_callback(callback_manager_t::callback_id_t id)
 }
 
 
+/** \brief Add a callback function to call when the lock makes progress.
+ *
+ * This function adds a callback function to the callback manager used
+ * to call the lock progress functions. These get called each time a
+ * LOCK_PROGRESS message is received while waiting for the lock.
+ *
+ * Adding a progress callback also turns on the progress flag so the
+ * LOCK message asks the cluck daemon for LOCK_PROGRESS messages (see
+ * set_progress()).
+ *
+ * \param[in] func  The callback function to call.
+ * \param[in] priority  The priority of the callback.
+ *
+ * \return The callback identifier.
+ *
+ * \sa get_queue_position()
+ * \sa get_estimated_wait()
+ */
+cluck::callback_manager_t::callback_id_t cluck::add_lock_progress_callback(callback_t func, callback_manager_t::priority_t priority)
+{
+    f_progress = true;
+    return f_lock_progress_callbacks.add_callback(func, priority);
+}
+
+
+/** \brief Remove a callback function from the lock progress list.
+ *
+ * This function is the converse of the add_lock_progress_callback(). If
+ * you save the returned callback identifier, you can later call this
+ * function to remove the callback explicitly.
+ *
+ * \note
+ * The progress flag is not turned off by this function. Call
+ * set_progress() to stop receiving the LOCK_PROGRESS messages.
+ *
+ * \param[in] id  The identifier of the callback to remove.
+ *
+ * \return true if the callback was indeed removed.
+ */
+bool cluck::remove_lock_progress_callback(callback_manager_t::callback_id_t id)
+{
+    return f_lock_progress_callbacks.remove_callback(id);
+}
+
+
 /** \brief Retrieve the current lock obtention duration.
  *
  * This function returns the current timeout for the obtention of a lock.
@@ -766,6 +811,83 @@ void cluck::set_reason(reason_t reason)
 }
 
 
+/** \brief Check whether the LOCK asks for LOCK_PROGRESS messages.
+ *
+ * \return true if the cluck daemon is asked to send LOCK_PROGRESS messages.
+ *
+ * \sa set_progress()
+ */
+bool cluck::get_progress() const
+{
+    return f_progress;
+}
+
+
+/** \brief Ask the cluck daemon to send LOCK_PROGRESS messages.
+ *
+ * While waiting for a lock, the cluck daemon can send LOCK_PROGRESS
+ * messages with the position of this request in the queue of the lock,
+ * the number of locks held ahead of it, and an estimate of the wait.
+ * This lets you give up early (by calling unlock()) instead of waiting
+ * for the obtention timeout when the wait is obviously going to be
+ * too long.
+ *
+ * The flag is turned on automatically when you add a lock progress
+ * callback. If you instead override the lock_progress() function, call
+ * this function with true.
+ *
+ * The new value applies to the next call to lock().
+ *
+ * \param[in] progress  Whether to receive LOCK_PROGRESS messages.
+ *
+ * \sa add_lock_progress_callback()
+ */
+void cluck::set_progress(bool progress)
+{
+    f_progress = progress;
+}
+
+
+/** \brief Get the position of the lock request in the queue.
+ *
+ * This is the number of requests ahead of this one, including the ones
+ * currently holding the lock, as received in the last LOCK_PROGRESS
+ * message. A position of 0 means this request is next.
+ *
+ * \return The position in the queue or NO_POSITION if no LOCK_PROGRESS
+ * message was received since the last call to lock().
+ */
+std::size_t cluck::get_queue_position() const
+{
+    return f_queue_position;
+}
+
+
+/** \brief Get the number of locks held ahead of this request.
+ *
+ * \return The number of requests ahead of this one holding the lock as
+ * received in the last LOCK_PROGRESS message.
+ */
+std::size_t cluck::get_holders_ahead() const
+{
+    return f_holders_ahead;
+}
+
+
+/** \brief Get the estimated time before the lock is obtained.
+ *
+ * The cluck daemon estimates the wait using the recent hold times of
+ * the lock. The estimate is relative to the time the last LOCK_PROGRESS
+ * message was received.
+ *
+ * \return The estimated wait or a negative value if unknown.
+ */
+timeout_t cluck::get_estimated_wait() const
+{
+    return f_estimated_wait;
+}
+
+
 /** \brief Called whenever the HELP message is received or new messages are added.
  *
  * This function gets called whenever the dispatcher receives the HELP
@@ -782,6 +904,7 @@ bool cluck::help(advgetopt::string_set_t & commands)
 {
     commands.insert(g_name_cluck_cmd_locked);
     commands.insert(g_name_cluck_cmd_lock_failed);
+    commands.insert(g_name_cluck_cmd_lock_progress);
     commands.insert(g_name_cluck_cmd_unlocked);
     commands.insert(g_name_cluck_cmd_unlocking);
 
@@ -890,31 +1013,13 @@ bool cluck::lock()
     }
 
     f_serial = get_next_serial();
+    f_obtention_timeout_date = obtention_timeout_date;
+    f_retry_pending = false;
+    f_queue_position = NO_POSITION;
+    f_holders_ahead = 0;
+    f_estimated_wait = CLUCK_DEFAULT_TIMEOUT;
 
-    // send the LOCK message
-    //
-    ed::message lock_message;
-    lock_message.set_command(g_name_cluck_cmd_lock);
-    lock_message.set_service(g_name_cluck_service_name);
-    lock_message.add_parameter(g_name_cluck_param_object_name, f_object_name);
-    lock_message.add_parameter(g_name_cluck_param_tag, static_cast<int>(f_tag));
-    lock_message.add_parameter(g_name_cluck_param_pid, cppthread::gettid());
-    lock_message.add_parameter(ed::g_name_ed_param_serial, f_serial);
-    lock_message.add_parameter(g_name_cluck_param_timeout, obtention_timeout_date);
-    communicator::request_failure(lock_message);
-    if(f_lock_duration_timeout != CLUCK_DEFAULT_TIMEOUT)
-    {
-        lock_message.add_parameter(g_name_cluck_param_duration, f_lock_duration_timeout);
-    }
-    if(f_unlock_timeout != CLUCK_DEFAULT_TIMEOUT)
-    {
-        lock_message.add_parameter(g_name_cluck_param_unlock_duration, f_unlock_timeout);
-    }
-    if(f_type != type_t::CLUCK_TYPE_READ_WRITE)
-    {
-        lock_message.add_parameter(g_name_cluck_param_type, static_cast<int>(f_type));
-    }
-    if(!f_connection->send_message(lock_message))
+    if(!send_lock())
     {
         // LCOV_EXCL_START
         f_state = state_t::CLUCK_STATE_FAILED;
@@ -946,6 +1051,13 @@ bool cluck::lock()
             , ed::Tag(f_tag)));
     f_dispatcher->add_match(lock_failed);
 
+    ed::dispatcher_match lock_progress(ed::define_match(
+              ed::Expression(g_name_cluck_cmd_lock_progress)
+            , ed::Callback(std::bind(&cluck::msg_lock_progress, this, std::placeholders::_1))
+            , ed::MatchFunc(&match_command_and_tag)
+            , ed::Tag(f_tag)));
+    f_dispatcher->add_match(lock_progress);
+
     ed::dispatcher_match unlocked(ed::define_match(
               ed::Expression(g_name_cluck_cmd_unlocked)
             , ed::Callback(std::bind(&cluck::msg_unlocked, this, std::placeholders::_1))
@@ -978,6 +1090,47 @@ bool cluck::lock()
 }
 
 
+/** \brief Send the LOCK message.
+ *
+ * This function sends the LOCK message to the cluck daemon. It is called
+ * by lock() and again when the cluck daemon asked us to retry later
+ * (see the "retry_after" parameter of the LOCK_FAILED message).
+ *
+ * \return true if the message was sent.
+ */
+bool cluck::send_lock()
+{
+    // send the LOCK message
+    //
+    ed::message lock_message;
+    lock_message.set_command(g_name_cluck_cmd_lock);
+    lock_message.set_service(g_name_cluck_service_name);
+    lock_message.add_parameter(g_name_cluck_param_object_name, f_object_name);
+    lock_message.add_parameter(g_name_cluck_param_tag, static_cast<int>(f_tag));
+    lock_message.add_parameter(g_name_cluck_param_pid, cppthread::gettid());
+    lock_message.add_parameter(ed::g_name_ed_param_serial, f_serial);
+    lock_message.add_parameter(g_name_cluck_param_timeout, f_obtention_timeout_date);
+    communicator::request_failure(lock_message);
+    if(f_lock_duration_timeout != CLUCK_DEFAULT_TIMEOUT)
+    {
+        lock_message.add_parameter(g_name_cluck_param_duration, f_lock_duration_timeout);
+    }
+    if(f_unlock_timeout != CLUCK_DEFAULT_TIMEOUT)
+    {
+        lock_message.add_parameter(g_name_cluck_param_unlock_duration, f_unlock_timeout);
+    }
+    if(f_type != type_t::CLUCK_TYPE_READ_WRITE)
+    {
+        lock_message.add_parameter(g_name_cluck_param_type, static_cast<int>(f_type));
+    }
+    if(f_progress)
+    {
+        lock_message.add_parameter(g_name_cluck_param_progress, 1);
+    }
+    return f_connection->send_message(lock_message);
+}
+
+
 /** \brief Release the inter-process lock.
  *
  * This function releases this inter-process lock at the time it gets called.
@@ -1004,6 +1157,7 @@ void cluck::unlock()
     }
 
     f_lock_timeout_date = timeout_t();
+    f_retry_pending = false;
 
     // explicitly send the UNLOCK message and then make sure to unregister
     // from the communicator; note that we do not wait for a reply to the
@@ -1222,9 +1376,25 @@ void cluck::process_timeout()
     // LCOV_EXCL_STOP
 
     case state_t::CLUCK_STATE_LOCKING:
-        // lock never obtained
-        //
-        set_reason(reason_t::CLUCK_REASON_LOCAL_TIMEOUT);
+        if(f_retry_pending)
+        {
+            // the cluck daemon asked us to send our LOCK again later
+            //
+            f_retry_pending = false;
+            if(send_lock())
+            {
+                set_timeout_date(f_obtention_timeout_date);
+                set_enable(true);
+                break;
+            }
+            set_reason(reason_t::CLUCK_REASON_TRANSMISSION_ERROR);  // LCOV_EXCL_LINE
+        }
+        else
+        {
+            // lock never obtained
+            //
+            set_reason(reason_t::CLUCK_REASON_LOCAL_TIMEOUT);
+        }
         lock_failed();
         finally();
         break;
@@ -1327,6 +1497,27 @@ void cluck::lock_failed()
 }
 
 
+/** \brief The lock request made progress.
+ *
+ * This function gets called each time a LOCK_PROGRESS message is
+ * received while waiting for the lock. You are free to override the
+ * function. The position, holders, and estimated wait are available
+ * through get_queue_position(), get_holders_ahead(), and
+ * get_estimated_wait().
+ *
+ * By default, this function calls all the lock progress callbacks you
+ * added to this object. Make sure to call it if you use callbacks.
+ *
+ * To give up on the lock, call unlock() from your callback.
+ *
+ * \sa add_lock_progress_callback()
+ */
+void cluck::lock_progress()
+{
+    f_lock_progress_callbacks.call(this);
+}
+
+
 /** \brief The lock cycle is finally complete.
  *
  * This function is called once the lock process completes. This means
@@ -1393,6 +1584,12 @@ void cluck::msg_locked(ed::message & msg)
  * of this cluck object becomes FAILED which means it cannot be used to
  * obtain a lock again.
  *
+ * When the cluck daemon has too many entering tickets for this object or
+ * this client sends LOCK requests too quickly, the LOCK_FAILED message
+ * includes a "retry_after" delay. If that delay ends before the lock
+ * obtention timeout, the LOCK is sent again at that time instead of
+ * failing.
+ *
  * \param[in] msg  The LOCK_FAILED message.
  */
 void cluck::msg_lock_failed(ed::message & msg)
@@ -1404,10 +1601,33 @@ void cluck::msg_lock_failed(ed::message & msg)
     else
     {
         std::string const error(msg.get_parameter(g_name_cluck_param_error));
+        timeout_t retry_date(snapdev::timespec_ex::max());
+        if(msg.has_parameter(g_name_cluck_param_retry_after))
+        {
+            retry_date = snapdev::now() + msg.get_timespec_parameter(g_name_cluck_param_retry_after);
+        }
+
         if(error == g_name_cluck_value_timedout)
         {
             set_reason(reason_t::CLUCK_REASON_REMOTE_TIMEOUT);
         }
+        else if(f_state == state_t::CLUCK_STATE_LOCKING
+             && retry_date < f_obtention_timeout_date)
+        {
+            // the cluck daemon is too busy, try again once the delay
+            // it suggested is over
+            //
+            SNAP_LOG_DEBUG
+                << "cluck daemon too busy to lock \""
+                << f_object_name
+                << "\", will try again later."
+                << SNAP_LOG_SEND;
+
+            f_retry_pending = true;
+            set_timeout_date(retry_date);
+            set_enable(true);
+            return;
+        }
         else
         {
             // this may be a programmer error that need fixing
@@ -1427,6 +1647,41 @@ void cluck::msg_lock_failed(ed::message & msg)
 }
 
 
+/** \brief Process the LOCK_PROGRESS message.
+ *
+ * While this cluck object waits for its lock, the cluck daemon may send
+ * LOCK_PROGRESS messages (see set_progress()). This function saves the
+ * position, the number of holders ahead, and the estimated wait, then
+ * calls the lock_progress() function.
+ *
+ * Messages received in any other state than LOCKING are ignored since
+ * they arrived late.
+ *
+ * \param[in] msg  The LOCK_PROGRESS message.
+ */
+void cluck::msg_lock_progress(ed::message & msg)
+{
+    if(f_state != state_t::CLUCK_STATE_LOCKING
+    || !is_cluck_msg(msg))
+    {
+        return;
+    }
+
+    f_queue_position = msg.get_integer_parameter(g_name_cluck_param_position);
+    f_holders_ahead = msg.get_integer_parameter(g_name_cluck_param_holders);
+    if(msg.has_parameter(g_name_cluck_param_estimated_wait))
+    {
+        f_estimated_wait = msg.get_timespec_parameter(g_name_cluck_param_estimated_wait);
+    }
+    else
+    {
+        f_estimated_wait = CLUCK_DEFAULT_TIMEOUT;
+    }
+
+    lock_progress();
+}
+
+
 /** \brief Get a transmission report on errors.
  *
  * If the LOCK message cannot be sent, we receive a transmission error.
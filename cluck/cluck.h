@@ -105,11 +105,12 @@ void                        set_unlock_timeout(timeout_t timeout);
  *
  * This class is used to run code synchronously in a cluster of computers.
  *
- * The class accepts three callbacks:
+ * The class accepts four callbacks:
  *
  * * lock was obtained and is now in place
  * * lock was not obtained (timeout, network error)
  * * finally code (i.e. code to run after the lock was released)
+ * * lock request progress (position in the queue and estimated wait)
  *
  * The cluck class is itself an eventdispatcher connection so you must add
  * it to the communicator. Actually, you can add it and then forget about the
@@ -125,6 +126,8 @@ public:
     typedef snapdev::callback_manager<callback_t>   callback_manager_t;
     typedef std::uint64_t                           serial_t;
 
+    static constexpr std::size_t                    NO_POSITION = static_cast<std::size_t>(-1);
+
                         cluck(
                               std::string const & object_name
                             , ed::connection_with_send_message::pointer_t connection
@@ -150,6 +153,12 @@ public:
                             , callback_manager_t::priority_t priority = callback_manager_t::DEFAULT_PRIORITY);
     bool                remove_finally_callback(
                               callback_manager_t::callback_id_t id);
+    callback_manager_t::callback_id_t
+                        add_lock_progress_callback(
+                              callback_t func
+                            , callback_manager_t::priority_t priority = callback_manager_t::DEFAULT_PRIORITY);
+    bool                remove_lock_progress_callback(
+                              callback_manager_t::callback_id_t id);
 
     timeout_t           get_lock_obtention_timeout() const;
     void                set_lock_obtention_timeout(timeout_t timeout);
@@ -163,6 +172,11 @@ public:
     type_t              get_type() const;
     void                set_type(type_t type);
     reason_t            get_reason() const;
+    bool                get_progress() const;
+    void                set_progress(bool progress);
+    std::size_t         get_queue_position() const;
+    std::size_t         get_holders_ahead() const;
+    timeout_t           get_estimated_wait() const;
 
     bool                lock();
     void                unlock();
@@ -177,12 +191,15 @@ public:
 protected:
     virtual void        lock_obtained();
     virtual void        lock_failed();
+    virtual void        lock_progress();
     virtual void        finally();
 
 private:
     bool                is_cluck_msg(ed::message & msg) const;
     void                msg_locked(ed::message & msg);
     void                msg_lock_failed(ed::message & msg);
+    void                msg_lock_progress(ed::message & msg);
+    bool                send_lock();
     void                msg_transmission_report(ed::message & msg);
     void                msg_unlocked(ed::message & msg);
     void                msg_unlocking(ed::message & msg);
@@ -199,15 +216,22 @@ private:
     callback_manager_t          f_lock_obtained_callbacks = callback_manager_t();
     callback_manager_t          f_lock_failed_callbacks = callback_manager_t();
     callback_manager_t          f_finally_callbacks = callback_manager_t();
+    callback_manager_t          f_lock_progress_callbacks = callback_manager_t();
     timeout_t                   f_lock_obtention_timeout = CLUCK_DEFAULT_TIMEOUT;
     timeout_t                   f_lock_duration_timeout = CLUCK_DEFAULT_TIMEOUT;
     timeout_t                   f_unlock_timeout = CLUCK_DEFAULT_TIMEOUT;
+    timeout_t                   f_obtention_timeout_date = timeout_t();
     timeout_t                   f_lock_timeout_date = timeout_t();
     timeout_t                   f_unlocked_timeout_date = timeout_t();
     type_t                      f_type = type_t::CLUCK_TYPE_READ_WRITE;
     state_t                     f_state = state_t::CLUCK_STATE_IDLE;
     reason_t                    f_reason = reason_t::CLUCK_REASON_NONE;
     serial_t                    f_serial = serial_t();
+    bool                        f_retry_pending = false;
+    bool                        f_progress = false;
+    std::size_t                 f_queue_position = NO_POSITION;
+    std::size_t                 f_holders_ahead = 0;
+    timeout_t                   f_estimated_wait = CLUCK_DEFAULT_TIMEOUT;
 };
 
 
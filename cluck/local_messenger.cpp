@@ -0,0 +1,108 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// self
+//
+#include    "cluck/local_messenger.h"
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+/** \file
+ * \brief Implements a direct connection to the local cluck daemon.
+ *
+ * By default, the LOCK and UNLOCK messages of the cluck library go
+ * through the communicator daemon which forwards them to the cluck
+ * daemon. When the cluck daemon is started with the `local-listen`
+ * option, clients running on the same computer can instead connect
+ * directly to its Unix socket and save that extra hop.
+ *
+ * Usage:
+ *
+ * \code
+ *     cluck::local_messenger::pointer_t m(std::make_shared<cluck::local_messenger>());
+ *     ed::communicator::instance()->add_connection(m);
+ *     cluck::cluck::pointer_t lock(std::make_shared<cluck::cluck>(
+ *               "my-object"
+ *             , m
+ *             , m->get_dispatcher()));
+ * \endcode
+ *
+ * The cluck daemon accepts only the LOCK and UNLOCK messages on that
+ * socket. The other messages, such as LOCK_STATUS, still need to be
+ * sent through the communicator daemon.
+ */
+
+
+
+namespace cluck
+{
+
+
+
+/** \class local_messenger
+ * \brief A connection to the Unix socket of the local cluck daemon.
+ *
+ * This connection can be used in place of the messenger connected to
+ * the communicator daemon when creating a cluck object. It creates its
+ * own dispatcher to which the cluck objects add their matches.
+ */
+
+
+
+/** \brief Connect to the local cluck daemon.
+ *
+ * The constructor connects to the Unix socket of the cluck daemon. By
+ * default it uses CLUCK_DEFAULT_LOCAL_SOCKET which must match the
+ * `local_listen` parameter of the cluck daemon.
+ *
+ * \param[in] address  The path to the Unix socket of the cluck daemon.
+ */
+local_messenger::local_messenger(addr::addr_unix const & address)
+    : local_stream_client_message_connection(address)
+    , f_dispatcher(std::make_shared<ed::dispatcher>(this))
+{
+    set_name("cluck_local_messenger");
+    set_dispatcher(f_dispatcher);
+}
+
+
+local_messenger::~local_messenger()
+{
+}
+
+
+/** \brief Get the dispatcher of this connection.
+ *
+ * The cluck objects expect a dispatcher where they add their own
+ * matches to receive the LOCKED, LOCK_FAILED, UNLOCKING and UNLOCKED
+ * replies.
+ *
+ * \return The dispatcher attached to this connection.
+ */
+ed::dispatcher::pointer_t local_messenger::get_dispatcher() const
+{
+    return f_dispatcher;
+}
+
+
+
+} // namespace cluck
+// vim: ts=4 sw=4 et
@@ -0,0 +1,55 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+// eventdispatcher
+//
+#include    <eventdispatcher/dispatcher.h>
+#include    <eventdispatcher/local_stream_client_message_connection.h>
+
+
+
+namespace cluck
+{
+
+
+
+constexpr char const *      CLUCK_DEFAULT_LOCAL_SOCKET = "/run/cluck/cluckd.sock";
+
+
+
+class local_messenger
+    : public ed::local_stream_client_message_connection
+{
+public:
+    typedef std::shared_ptr<local_messenger>    pointer_t;
+
+                                local_messenger(
+                                    addr::addr_unix const & address = addr::addr_unix(CLUCK_DEFAULT_LOCAL_SOCKET));
+                                local_messenger(local_messenger const & rhs) = delete;
+    virtual                     ~local_messenger() override;
+
+    local_messenger &           operator = (local_messenger const & rhs) = delete;
+
+    ed::dispatcher::pointer_t   get_dispatcher() const;
+
+private:
+    ed::dispatcher::pointer_t   f_dispatcher = ed::dispatcher::pointer_t();
+};
+
+
+
+} // namespace cluck
+// vim: ts=4 sw=4 et
@@ -0,0 +1,451 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Implementation of the admission control of LOCK requests.
+ *
+ * A leader creates one entering ticket per LOCK request and keeps it until
+ * the ticket gets its number. If clients send LOCK requests faster than
+ * the tickets get their numbers, the number of entering tickets grows
+ * without bounds, so a limit is enforced per object.
+ *
+ * The limit is either fixed (see the `max-entering-locks` option) or
+ * adaptive. In the adaptive case, the rate at which the entering tickets
+ * of an object drain is measured and the limit is the number of tickets
+ * which drain in ADMISSION_WINDOW.
+ *
+ * When the limit is reached, the LOCK request can wait in a small backlog
+ * (see the `entering-backlog` option) instead of failing right away. When
+ * the backlog is full too, the LOCK fails with an "overflow" error and a
+ * "retry_after" hint computed from the drain rate.
+ *
+ * \warning
+ * The admission control is not protected by a mutex. The cluck daemon only
+ * uses it from its main thread.
+ */
+
+// self
+//
+#include    "admission_control.h"
+
+
+// C++
+//
+#include    <algorithm>
+#include    <cmath>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+namespace
+{
+
+
+
+/** \brief Duration of a drain rate measurement in microseconds.
+ *
+ * The drain rate of an object is updated with the tickets drained within
+ * this duration so a single quick ticket does not make the rate jump.
+ */
+constexpr std::int64_t      RATE_WINDOW = 100'000;
+
+
+/** \brief Time allowed to drain the entering tickets in microseconds.
+ *
+ * The adaptive limit is the number of entering tickets that drain within
+ * this duration at the current drain rate.
+ */
+constexpr std::int64_t      ADMISSION_WINDOW = 1'000'000;
+
+
+/** \brief Time after which the state of an idle object is removed.
+ *
+ * This is in microseconds.
+ */
+constexpr std::int64_t      IDLE_STATE = 60'000'000;
+
+
+/** \brief Limits of the retry_after hint in microseconds.
+ */
+constexpr std::int64_t      MINIMUM_RETRY_AFTER = 10'000;
+constexpr std::int64_t      MAXIMUM_RETRY_AFTER = 10'000'000;
+constexpr std::int64_t      DEFAULT_RETRY_AFTER = 1'000'000;
+
+
+
+} // no name namespace
+
+
+
+/** \class admission_control
+ * \brief Decide whether a LOCK request can create an entering ticket.
+ *
+ * The cluck daemon calls observe() with the current number of entering
+ * tickets of an object before it creates a new one and admitted() once
+ * the ticket was created. From the difference between the expected and
+ * the observed number of entering tickets, it computes how many tickets
+ * drained and from that a drain rate.
+ */
+
+
+
+/** \brief Set the maximum number of entering tickets per object.
+ *
+ * \param[in] limit  The maximum number of entering tickets or ADAPTIVE_LIMIT.
+ */
+void admission_control::set_limit(std::size_t limit)
+{
+    f_limit = limit;
+}
+
+
+/** \brief Get the maximum number of entering tickets per object.
+ *
+ * \return The limit or ADAPTIVE_LIMIT.
+ */
+std::size_t admission_control::get_limit() const
+{
+    return f_limit;
+}
+
+
+/** \brief Set the maximum number of LOCK requests waiting per object.
+ *
+ * When set to 0, a LOCK request which cannot be admitted fails
+ * immediately.
+ *
+ * \param[in] limit  The maximum size of the backlog of one object.
+ */
+void admission_control::set_backlog_limit(std::size_t limit)
+{
+    f_backlog_limit = limit;
+}
+
+
+/** \brief Get the maximum number of LOCK requests waiting per object.
+ *
+ * \return The maximum size of the backlog of one object.
+ */
+std::size_t admission_control::get_backlog_limit() const
+{
+    return f_backlog_limit;
+}
+
+
+/** \brief Record the current number of entering tickets of an object.
+ *
+ * The difference between the number of entering tickets last observed
+ * plus the tickets admitted since and \p entering is the number of
+ * tickets which drained. The drain rate is updated once per RATE_WINDOW.
+ *
+ * \param[in] object_name  The name of the object.
+ * \param[in] entering  The current number of entering tickets.
+ * \param[in] now  The current date.
+ */
+void admission_control::observe(
+      std::string const & object_name
+    , std::size_t entering
+    , cluck::timeout_t const & now)
+{
+    object_state & state(f_states[atom(object_name)]);
+
+    std::size_t const expected(state.f_entering + state.f_admitted);
+    if(expected > entering)
+    {
+        state.f_drained += expected - entering;
+    }
+    state.f_entering = entering;
+    state.f_admitted = 0;
+    state.f_last_seen = now;
+
+    if(state.f_window_start == cluck::timeout_t())
+    {
+        state.f_window_start = now;
+        return;
+    }
+
+    std::int64_t const elapsed((now - state.f_window_start).to_usec());
+    if(elapsed >= RATE_WINDOW)
+    {
+        double const sample(static_cast<double>(state.f_drained) * 1'000'000.0 / static_cast<double>(elapsed));
+        if(state.f_drain_rate == 0.0)
+        {
+            state.f_drain_rate = sample;
+        }
+        else
+        {
+            state.f_drain_rate = state.f_drain_rate * 0.7 + sample * 0.3;
+        }
+        state.f_drained = 0;
+        state.f_window_start = now;
+    }
+}
+
+
+/** \brief Record that an entering ticket was created for an object.
+ *
+ * \param[in] object_name  The name of the object.
+ */
+void admission_control::admitted(std::string const & object_name)
+{
+    object_state * state(find_state(object_name));
+    if(state != nullptr)
+    {
+        ++state->f_admitted;
+    }
+}
+
+
+/** \brief Get the rate at which the entering tickets of an object drain.
+ *
+ * \param[in] object_name  The name of the object.
+ *
+ * \return The number of tickets per second, 0.0 if not yet measured.
+ */
+double admission_control::get_drain_rate(std::string const & object_name) const
+{
+    object_state const * state(find_state(object_name));
+    if(state == nullptr)
+    {
+        return 0.0;
+    }
+    return state->f_drain_rate;
+}
+
+
+/** \brief Get the maximum number of entering tickets of an object.
+ *
+ * With a fixed limit, this is that limit. With the adaptive limit, this
+ * is the number of tickets which drain in ADMISSION_WINDOW, bounded by
+ * MINIMUM_ADAPTIVE_LIMIT and MAXIMUM_ADAPTIVE_LIMIT. Until the drain rate
+ * is known, the default CLUCK_MAXIMUM_ENTERING_LOCKS applies.
+ *
+ * \param[in] object_name  The name of the object.
+ *
+ * \return The maximum number of entering tickets.
+ */
+std::size_t admission_control::get_object_limit(std::string const & object_name) const
+{
+    if(f_limit != ADAPTIVE_LIMIT)
+    {
+        return f_limit;
+    }
+
+    double const rate(get_drain_rate(object_name));
+    if(rate == 0.0)
+    {
+        return cluck::CLUCK_MAXIMUM_ENTERING_LOCKS;
+    }
+
+    double const limit(std::ceil(rate * static_cast<double>(ADMISSION_WINDOW) / 1'000'000.0));
+    return std::clamp(
+              static_cast<std::size_t>(limit)
+            , MINIMUM_ADAPTIVE_LIMIT
+            , MAXIMUM_ADAPTIVE_LIMIT);
+}
+
+
+/** \brief Compute when a rejected client should try again.
+ *
+ * The hint is the time it takes for the entering tickets and the backlog
+ * above the limit to drain at the current rate.
+ *
+ * \param[in] object_name  The name of the object.
+ * \param[in] entering  The current number of entering tickets.
+ *
+ * \return The delay after which the client should send its LOCK again.
+ */
+cluck::timeout_t admission_control::get_retry_after(
+      std::string const & object_name
+    , std::size_t entering) const
+{
+    std::int64_t usec(DEFAULT_RETRY_AFTER);
+
+    object_state const * state(find_state(object_name));
+    if(state != nullptr
+    && state->f_drain_rate > 0.0)
+    {
+        std::size_t const waiting(entering + state->f_backlog.size());
+        std::size_t const limit(get_object_limit(object_name));
+        std::size_t const excess(waiting >= limit ? waiting - limit + 1 : 1);
+        usec = static_cast<std::int64_t>(static_cast<double>(excess) * 1'000'000.0 / state->f_drain_rate);
+    }
+
+    usec = std::clamp(usec, MINIMUM_RETRY_AFTER, MAXIMUM_RETRY_AFTER);
+    return cluck::timeout_t(usec / 1'000'000, usec % 1'000'000 * 1'000);
+}
+
+
+/** \brief Check whether LOCK requests are waiting for an object.
+ *
+ * \param[in] object_name  The name of the object.
+ *
+ * \return true if the backlog of that object is not empty.
+ */
+bool admission_control::has_backlog(std::string const & object_name) const
+{
+    object_state const * state(find_state(object_name));
+    return state != nullptr && !state->f_backlog.empty();
+}
+
+
+/** \brief Add a LOCK request to the backlog of its object.
+ *
+ * \param[in] r  The LOCK request.
+ *
+ * \return false if the backlog is full and the request was not added.
+ */
+bool admission_control::add_to_backlog(message_cache::request const & r)
+{
+    object_state & state(f_states[r.f_object_name]);
+    if(state.f_backlog.size() >= f_backlog_limit)
+    {
+        return false;
+    }
+
+    message_cache::request evicted;
+    state.f_backlog.add(r, evicted);
+    return true;
+}
+
+
+/** \brief Get the next LOCK request waiting for an object.
+ *
+ * The request with the earliest timeout is returned first.
+ *
+ * \param[in] object_name  The name of the object.
+ * \param[out] r  The LOCK request.
+ *
+ * \return true if \p r was set.
+ */
+bool admission_control::pop_backlog(std::string const & object_name, message_cache::request & r)
+{
+    object_state * state(find_state(object_name));
+    return state != nullptr && state->f_backlog.pop_next(r);
+}
+
+
+/** \brief Get a LOCK request which timed out in the backlog of an object.
+ *
+ * \param[in] object_name  The name of the object.
+ * \param[in] now  The current date.
+ * \param[out] r  The LOCK request.
+ *
+ * \return true if \p r was set.
+ */
+bool admission_control::pop_timed_out(
+      std::string const & object_name
+    , cluck::timeout_t const & now
+    , message_cache::request & r)
+{
+    object_state * state(find_state(object_name));
+    return state != nullptr && state->f_backlog.pop_timed_out(now, r);
+}
+
+
+/** \brief Get the earliest timeout of the LOCK requests in the backlogs.
+ *
+ * \return The earliest timeout or timespec_ex::max() if no request waits.
+ */
+cluck::timeout_t admission_control::get_next_timeout() const
+{
+    cluck::timeout_t result(snapdev::timespec_ex::max());
+    for(auto const & s : f_states)
+    {
+        result = std::min(result, s.second.f_backlog.get_next_timeout());
+    }
+    return result;
+}
+
+
+/** \brief Get the name of the objects with a non-empty backlog.
+ *
+ * \return The list of object names.
+ */
+std::vector<atom> admission_control::get_backlogged_objects() const
+{
+    std::vector<atom> result;
+    for(auto const & s : f_states)
+    {
+        if(!s.second.f_backlog.empty())
+        {
+            result.push_back(s.first);
+        }
+    }
+    return result;
+}
+
+
+/** \brief Forget the objects which were not locked in a while.
+ *
+ * The state of an object with an empty backlog which was not observed
+ * for IDLE_STATE microseconds is removed.
+ *
+ * \param[in] now  The current date.
+ */
+void admission_control::prune(cluck::timeout_t const & now)
+{
+    for(auto it(f_states.begin()); it != f_states.end(); )
+    {
+        if(it->second.f_backlog.empty()
+        && (now - it->second.f_last_seen).to_usec() >= IDLE_STATE)
+        {
+            it = f_states.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+
+admission_control::object_state const * admission_control::find_state(std::string const & object_name) const
+{
+    auto const it(f_states.find(atom::find(object_name)));
+    if(it == f_states.end())
+    {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+
+admission_control::object_state * admission_control::find_state(std::string const & object_name)
+{
+    auto const it(f_states.find(atom::find(object_name)));
+    if(it == f_states.end())
+    {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,102 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+// self
+//
+#include    "atom.h"
+#include    "message_cache.h"
+
+
+// cluck
+//
+#include    <cluck/cluck.h>
+
+
+// C++
+//
+#include    <unordered_map>
+#include    <vector>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+class admission_control
+{
+public:
+    static constexpr std::size_t ADAPTIVE_LIMIT = 0;
+    static constexpr std::size_t MINIMUM_ADAPTIVE_LIMIT = 10;
+    static constexpr std::size_t MAXIMUM_ADAPTIVE_LIMIT = 10'000;
+
+    void                        set_limit(std::size_t limit);
+    std::size_t                 get_limit() const;
+    void                        set_backlog_limit(std::size_t limit);
+    std::size_t                 get_backlog_limit() const;
+
+    void                        observe(
+                                      std::string const & object_name
+                                    , std::size_t entering
+                                    , cluck::timeout_t const & now);
+    void                        admitted(std::string const & object_name);
+    double                      get_drain_rate(std::string const & object_name) const;
+    std::size_t                 get_object_limit(std::string const & object_name) const;
+    cluck::timeout_t            get_retry_after(
+                                      std::string const & object_name
+                                    , std::size_t entering) const;
+
+    bool                        has_backlog(std::string const & object_name) const;
+    bool                        add_to_backlog(message_cache::request const & r);
+    bool                        pop_backlog(std::string const & object_name, message_cache::request & r);
+    bool                        pop_timed_out(
+                                      std::string const & object_name
+                                    , cluck::timeout_t const & now
+                                    , message_cache::request & r);
+    cluck::timeout_t            get_next_timeout() const;
+    std::vector<atom>           get_backlogged_objects() const;
+    void                        prune(cluck::timeout_t const & now);
+
+private:
+    struct object_state
+    {
+        std::size_t             f_entering = 0;
+        std::size_t             f_admitted = 0;
+        std::size_t             f_drained = 0;
+        cluck::timeout_t        f_window_start = cluck::timeout_t();
+        cluck::timeout_t        f_last_seen = cluck::timeout_t();
+        double                  f_drain_rate = 0.0;     // tickets per second
+        message_cache           f_backlog = message_cache();
+    };
+
+    typedef std::unordered_map<atom, object_state>  state_map_t;
+
+    object_state const *        find_state(std::string const & object_name) const;
+    object_state *              find_state(std::string const & object_name);
+
+    std::size_t                 f_limit = cluck::CLUCK_MAXIMUM_ENTERING_LOCKS;
+    std::size_t                 f_backlog_limit = 0;
+    state_map_t                 f_states = state_map_t();
+};
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,401 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Implementation of the interned strings.
+ *
+ * The cluck daemon keeps many copies of the same few strings: each ticket
+ * has the name of its object, the name of the server and service which
+ * requested the lock and the name of the leader owning it. With many
+ * tickets spread over a few objects and hosts, most of that memory is
+ * duplicates.
+ *
+ * An atom represents one such string. All the atoms of the same string
+ * share a single copy, which is reference counted and released when the
+ * last atom using it is destroyed. Comparing two atoms for equality is
+ * a pointer comparison.
+ *
+ * \warning
+ * The table of interned strings is not protected by a mutex. The cluck
+ * daemon only uses atoms from its main thread.
+ */
+
+// self
+//
+#include    "atom.h"
+
+
+// C++
+//
+#include    <memory>
+#include    <unordered_map>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+/** \class atom
+ * \brief A reference counted interned string.
+ *
+ * An atom holds a pointer to the only copy of its string. Creating an
+ * atom from a string searches the table of interned strings and adds the
+ * string if it is not yet defined. Copying an atom only increments the
+ * reference counter of its string.
+ *
+ * A default atom represents the empty string without using the table.
+ */
+
+
+
+struct atom::entry
+{
+    std::string                 f_string = std::string();
+    std::size_t                 f_references = 0;
+};
+
+
+namespace
+{
+
+
+
+typedef std::unordered_map<std::string_view, std::unique_ptr<atom::entry>>  interned_map_t;
+
+
+/** \brief The table of interned strings.
+ *
+ * The key is a view on the string of the entry, which is allocated on
+ * the heap so it does not move when the table grows.
+ *
+ * \return A reference to the table of interned strings.
+ */
+interned_map_t & get_interned()
+{
+    static interned_map_t g_interned = interned_map_t();
+    return g_interned;
+}
+
+
+std::string const g_empty_string = std::string();
+
+
+
+} // no name namespace
+
+
+
+/** \brief Initialize an empty atom.
+ *
+ * The empty string is not added to the table of interned strings.
+ */
+atom::atom()
+{
+}
+
+
+/** \brief Initialize an atom from a string.
+ *
+ * \param[in] name  The string to intern.
+ */
+atom::atom(std::string const & name)
+    : atom(std::string_view(name))
+{
+}
+
+
+/** \brief Initialize an atom from a string view.
+ *
+ * If \p name was already interned, the atom shares that string.
+ * Otherwise a new entry gets added to the table. Searching an existing
+ * string does not allocate memory.
+ *
+ * \param[in] name  The string to intern.
+ */
+atom::atom(std::string_view name)
+{
+    if(name.empty())
+    {
+        return;
+    }
+
+    interned_map_t & interned(get_interned());
+    auto it(interned.find(name));
+    if(it == interned.end())
+    {
+        std::unique_ptr<entry> e(std::make_unique<entry>());
+        e->f_string = name;
+        std::string_view const key(e->f_string);
+        it = interned.emplace(key, std::move(e)).first;
+    }
+    f_entry = it->second.get();
+    ++f_entry->f_references;
+}
+
+
+/** \brief Initialize an atom from a C string.
+ *
+ * \param[in] name  The string to intern.
+ */
+atom::atom(char const * name)
+    : atom(std::string_view(name == nullptr ? "" : name))
+{
+}
+
+
+/** \brief Copy an atom.
+ *
+ * The copy shares the string of \p rhs.
+ *
+ * \param[in] rhs  The atom to copy.
+ */
+atom::atom(atom const & rhs)
+    : f_entry(rhs.f_entry)
+{
+    if(f_entry != nullptr)
+    {
+        ++f_entry->f_references;
+    }
+}
+
+
+/** \brief Move an atom.
+ *
+ * The \p rhs atom becomes the empty atom.
+ *
+ * \param[in] rhs  The atom to move.
+ */
+atom::atom(atom && rhs)
+    : f_entry(rhs.f_entry)
+{
+    rhs.f_entry = nullptr;
+}
+
+
+/** \brief Release the string of this atom.
+ *
+ * When the last atom referencing a string is destroyed, the string gets
+ * removed from the table of interned strings.
+ */
+atom::~atom()
+{
+    if(f_entry != nullptr)
+    {
+        --f_entry->f_references;
+        if(f_entry->f_references == 0)
+        {
+            get_interned().erase(f_entry->f_string);
+        }
+    }
+}
+
+
+/** \brief Copy an atom.
+ *
+ * \param[in] rhs  The atom to copy.
+ *
+ * \return A reference to this atom.
+ */
+atom & atom::operator = (atom const & rhs)
+{
+    atom copy(rhs);
+    std::swap(f_entry, copy.f_entry);
+    return *this;
+}
+
+
+/** \brief Move an atom.
+ *
+ * \param[in] rhs  The atom to move.
+ *
+ * \return A reference to this atom.
+ */
+atom & atom::operator = (atom && rhs)
+{
+    std::swap(f_entry, rhs.f_entry);
+    return *this;
+}
+
+
+/** \brief Get the string of this atom.
+ *
+ * \return A reference to the interned string.
+ */
+std::string const & atom::str() const
+{
+    if(f_entry == nullptr)
+    {
+        return g_empty_string;
+    }
+    return f_entry->f_string;
+}
+
+
+/** \brief Get the string of this atom.
+ *
+ * This cast allows atoms to be used wherever a string is expected.
+ *
+ * \return A reference to the interned string.
+ */
+atom::operator std::string const & () const
+{
+    return str();
+}
+
+
+/** \brief Check whether this atom represents the empty string.
+ *
+ * \return true if the atom string is empty.
+ */
+bool atom::empty() const
+{
+    return f_entry == nullptr;
+}
+
+
+/** \brief Get the identifier of this atom.
+ *
+ * Two atoms of the same string have the same identifier. The empty
+ * string has identifier 0.
+ *
+ * \return The atom identifier.
+ */
+atom::id_t atom::id() const
+{
+    return reinterpret_cast<id_t>(f_entry);
+}
+
+
+/** \brief Compare two atoms.
+ *
+ * Since the strings are interned, this is a simple pointer comparison.
+ *
+ * \param[in] rhs  The other atom.
+ *
+ * \return true if both atoms represent the same string.
+ */
+bool atom::operator == (atom const & rhs) const
+{
+    return f_entry == rhs.f_entry;
+}
+
+
+/** \brief Compare an atom with a string.
+ *
+ * \param[in] rhs  The string to compare with.
+ *
+ * \return true if this atom represents \p rhs.
+ */
+bool atom::operator == (std::string const & rhs) const
+{
+    return str() == rhs;
+}
+
+
+/** \brief Compare an atom with a C string.
+ *
+ * \param[in] rhs  The string to compare with.
+ *
+ * \return true if this atom represents \p rhs.
+ */
+bool atom::operator == (char const * rhs) const
+{
+    return str() == rhs;
+}
+
+
+/** \brief Sort two atoms.
+ *
+ * Atoms sort like their strings. Equal atoms are detected without
+ * comparing the strings.
+ *
+ * \param[in] rhs  The other atom.
+ *
+ * \return true if this atom sorts before \p rhs.
+ */
+bool atom::operator < (atom const & rhs) const
+{
+    if(f_entry == rhs.f_entry)
+    {
+        return false;
+    }
+    return str() < rhs.str();
+}
+
+
+/** \brief Search for an interned string.
+ *
+ * This function returns the atom of \p name if that string is currently
+ * interned. Otherwise it returns the empty atom. Contrary to the
+ * constructor, it never adds a string to the table, which makes it
+ * useful to search containers keyed by atoms.
+ *
+ * \param[in] name  The string to search.
+ *
+ * \return The atom of \p name or the empty atom.
+ */
+atom atom::find(std::string_view name)
+{
+    atom result;
+    if(!name.empty())
+    {
+        interned_map_t & interned(get_interned());
+        auto it(interned.find(name));
+        if(it != interned.end())
+        {
+            result.f_entry = it->second.get();
+            ++result.f_entry->f_references;
+        }
+    }
+    return result;
+}
+
+
+/** \brief Get the number of strings currently interned.
+ *
+ * \return The size of the table of interned strings.
+ */
+std::size_t atom::interned_count()
+{
+    return get_interned().size();
+}
+
+
+/** \brief Output an atom to a stream.
+ *
+ * \param[in] out  The output stream.
+ * \param[in] a  The atom to print.
+ *
+ * \return A reference to \p out.
+ */
+std::ostream & operator << (std::ostream & out, atom const & a)
+{
+    return out << a.str();
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,119 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+// C++
+//
+#include    <cstdint>
+#include    <functional>
+#include    <iostream>
+#include    <string>
+#include    <string_view>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+class atom
+{
+public:
+    typedef std::uintptr_t      id_t;
+
+    struct entry;               // the interned string, private to atom.cpp
+
+                                atom();
+                                atom(std::string const & name);
+                                atom(std::string_view name);
+                                atom(char const * name);
+                                atom(atom const & rhs);
+                                atom(atom && rhs);
+                                ~atom();
+
+    atom &                      operator = (atom const & rhs);
+    atom &                      operator = (atom && rhs);
+
+    std::string const &         str() const;
+                                operator std::string const & () const;
+    bool                        empty() const;
+    id_t                        id() const;
+
+    bool                        operator == (atom const & rhs) const;
+    bool                        operator == (std::string const & rhs) const;
+    bool                        operator == (char const * rhs) const;
+    bool                        operator < (atom const & rhs) const;
+
+    static atom                 find(std::string_view name);
+    static std::size_t          interned_count();
+
+private:
+    entry *                     f_entry = nullptr;
+};
+
+
+std::ostream & operator << (std::ostream & out, atom const & a);
+
+
+/** \brief Compare atoms and strings in sorted containers.
+ *
+ * This comparator sorts atoms by their string so the order of a container
+ * does not depend on the address of the interned strings. It is
+ * transparent so a container keyed by atoms can be searched with a plain
+ * string without having to intern it first.
+ */
+struct atom_less
+{
+    typedef void is_transparent;
+
+    bool operator () (atom const & lhs, atom const & rhs) const
+    {
+        return lhs < rhs;
+    }
+
+    bool operator () (atom const & lhs, std::string const & rhs) const
+    {
+        return lhs.str() < rhs;
+    }
+
+    bool operator () (std::string const & lhs, atom const & rhs) const
+    {
+        return lhs < rhs.str();
+    }
+};
+
+
+
+} // namespace cluck_daemon
+
+
+namespace std
+{
+
+template<>
+struct hash<cluck_daemon::atom>
+{
+    std::size_t operator () (cluck_daemon::atom const & a) const
+    {
+        return std::hash<cluck_daemon::atom::id_t>()(a.id());
+    }
+};
+
+} // namespace std
+// vim: ts=4 sw=4 et
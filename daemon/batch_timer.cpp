@@ -0,0 +1,80 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// self
+//
+#include    "batch_timer.h"
+
+#include    "messenger.h"
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+/** \class batch_timer
+ * \brief Flush the batches of messages.
+ *
+ * When message batching is turned on (see the `batch-delay` option),
+ * the messenger collects the messages sent to the other leaders. This
+ * timer is armed when the first message gets added to a batch. Once it
+ * times out, the messenger sends the batches.
+ */
+
+
+
+/** \brief The batch timer initialization.
+ *
+ * The timer is off until a message is added to a batch.
+ *
+ * \param[in] m  The messenger which holds the batches.
+ */
+batch_timer::batch_timer(messenger * m)
+    : ed::timer(-1)
+    , f_messenger(m)
+{
+    set_name("batch_timer");
+}
+
+
+batch_timer::~batch_timer()
+{
+}
+
+
+/** \brief Send the batches.
+ *
+ * The delay is over, send all the pending batches.
+ */
+void batch_timer::process_timeout()
+{
+    f_messenger->flush_batches();
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,57 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+// eventdispatcher
+//
+#include    <eventdispatcher/timer.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+class messenger;
+
+
+
+class batch_timer
+    : public ed::timer
+{
+public:
+    typedef std::shared_ptr<batch_timer>    pointer_t;
+
+                                batch_timer(messenger * m);
+                                batch_timer(batch_timer const &) = delete;
+    virtual                     ~batch_timer() override;
+
+    batch_timer &               operator = (batch_timer const &) = delete;
+
+    // ed::connection implementation
+    virtual void                process_timeout() override;
+
+private:
+    messenger *                 f_messenger = nullptr;
+};
+
+
+
+} // namespace cluck_deamon
+// vim: ts=4 sw=4 et
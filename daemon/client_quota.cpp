@@ -0,0 +1,358 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Implementation of the quotas of the clients of a leader.
+ *
+ * A cluster is often shared by many services. Without quotas, one service
+ * sending LOCK requests in a loop fills the lists of tickets of the leaders
+ * and slows down the locks of all the other services.
+ *
+ * The quotas are applied per client, the client being the server and
+ * service which requested the lock (the lock_proxy_server_name and
+ * lock_proxy_service_name parameters when the LOCK was forwarded by
+ * another cluck daemon). Two limits are available:
+ *
+ * \li the number of tickets a client has on this leader (see the
+ * `client-max-tickets` option);
+ * \li the number of LOCK requests per second, implemented with a token
+ * bucket which allows bursts of up to one second worth of requests (see
+ * the `client-lock-rate` option).
+ *
+ * Each ticket holds a reservation which is released when the ticket gets
+ * destroyed, so the number of tickets of a client is maintained in O(1)
+ * whichever way the ticket goes away.
+ *
+ * \warning
+ * The quotas are not protected by a mutex. The cluck daemon only uses them
+ * from its main thread.
+ */
+
+// self
+//
+#include    "client_quota.h"
+
+
+// C++
+//
+#include    <algorithm>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+namespace
+{
+
+
+
+/** \brief Time after which an idle client is forgotten in microseconds.
+ *
+ * This is also how often the list of clients gets pruned.
+ */
+constexpr std::int64_t      IDLE_CLIENT = 60'000'000;
+
+
+
+} // no name namespace
+
+
+
+/** \class client_quota
+ * \brief Track the tickets and LOCK requests of each client.
+ *
+ * The cluck daemon calls check() when it receives a LOCK as a leader and
+ * reserve() once the ticket is created. The reservation is saved in the
+ * ticket.
+ */
+
+
+/** \class client_quota::reservation
+ * \brief One ticket counted against the quota of a client.
+ *
+ * The reservation increments the number of tickets of the client on
+ * creation and decrements it on destruction. It can be moved but not
+ * copied.
+ */
+
+
+
+/** \brief Reserve one ticket for a client.
+ *
+ * \param[in] u  The usage of the client.
+ */
+client_quota::reservation::reservation(std::shared_ptr<usage> u)
+    : f_usage(u)
+{
+    if(f_usage != nullptr)
+    {
+        ++f_usage->f_tickets;
+    }
+}
+
+
+/** \brief Move a reservation.
+ *
+ * \param[in] rhs  The reservation to move, it is empty on return.
+ */
+client_quota::reservation::reservation(reservation && rhs)
+    : f_usage(std::move(rhs.f_usage))
+{
+    rhs.f_usage.reset();
+}
+
+
+/** \brief Release the reservation.
+ */
+client_quota::reservation::~reservation()
+{
+    release();
+}
+
+
+/** \brief Move a reservation.
+ *
+ * The reservation held by this object, if any, is released first.
+ *
+ * \param[in] rhs  The reservation to move, it is empty on return.
+ *
+ * \return A reference to this object.
+ */
+client_quota::reservation & client_quota::reservation::operator = (reservation && rhs)
+{
+    if(this != &rhs)
+    {
+        release();
+        f_usage = std::move(rhs.f_usage);
+        rhs.f_usage.reset();
+    }
+    return *this;
+}
+
+
+void client_quota::reservation::release()
+{
+    if(f_usage != nullptr)
+    {
+        --f_usage->f_tickets;
+        f_usage.reset();
+    }
+}
+
+
+/** \brief Set the maximum number of tickets per client.
+ *
+ * \param[in] max_tickets  The maximum number of tickets or 0 for no limit.
+ */
+void client_quota::set_max_tickets(std::size_t max_tickets)
+{
+    f_max_tickets = max_tickets;
+}
+
+
+/** \brief Get the maximum number of tickets per client.
+ *
+ * \return The maximum number of tickets or 0 if there is no limit.
+ */
+std::size_t client_quota::get_max_tickets() const
+{
+    return f_max_tickets;
+}
+
+
+/** \brief Set the maximum number of LOCK requests per second per client.
+ *
+ * \param[in] rate  The number of requests per second or 0 for no limit.
+ */
+void client_quota::set_rate(std::size_t rate)
+{
+    f_rate = rate;
+}
+
+
+/** \brief Get the maximum number of LOCK requests per second per client.
+ *
+ * \return The number of requests per second or 0 if there is no limit.
+ */
+std::size_t client_quota::get_rate() const
+{
+    return f_rate;
+}
+
+
+/** \brief Check whether a client can get one more ticket.
+ *
+ * When \p count_request is true, the request is counted against the rate
+ * of the client. It is false for requests which were already counted
+ * once, such as a request waiting in a backlog.
+ *
+ * When the function returns QUOTA_RATE, \p retry_after is set to the
+ * time until the client gets a new token. Otherwise it is not modified.
+ *
+ * \param[in] server_name  The name of the server of the client.
+ * \param[in] service_name  The name of the service of the client.
+ * \param[in] now  The current date.
+ * \param[in] count_request  Whether to count this request.
+ * \param[out] retry_after  The time after which the client can try again.
+ *
+ * \return QUOTA_ACCEPTED if the client is within its quotas.
+ */
+client_quota::result_t client_quota::check(
+      std::string const & server_name
+    , std::string const & service_name
+    , cluck::timeout_t const & now
+    , bool count_request
+    , cluck::timeout_t & retry_after)
+{
+    std::shared_ptr<usage> & u(get_client(server_name, service_name));
+
+    if(count_request)
+    {
+        ++u->f_requests;
+        if(f_rate != 0)
+        {
+            double const burst(static_cast<double>(f_rate));
+            if(u->f_last_request != cluck::timeout_t())
+            {
+                double const elapsed(static_cast<double>((now - u->f_last_request).to_usec()) / 1'000'000.0);
+                u->f_tokens = std::min(burst, u->f_tokens + elapsed * burst);
+            }
+            else
+            {
+                u->f_tokens = burst;
+            }
+            u->f_last_request = now;
+
+            if(u->f_tokens < 1.0)
+            {
+                ++u->f_rejected;
+                std::int64_t const usec(static_cast<std::int64_t>((1.0 - u->f_tokens) * 1'000'000.0 / burst) + 1);
+                retry_after = cluck::timeout_t(usec / 1'000'000, usec % 1'000'000 * 1'000);
+                return result_t::QUOTA_RATE;
+            }
+            u->f_tokens -= 1.0;
+        }
+        else
+        {
+            u->f_last_request = now;
+        }
+    }
+
+    if(f_max_tickets != 0
+    && u->f_tickets >= f_max_tickets)
+    {
+        ++u->f_rejected;
+        return result_t::QUOTA_TICKETS;
+    }
+
+    return result_t::QUOTA_ACCEPTED;
+}
+
+
+/** \brief Count one more ticket for a client.
+ *
+ * The returned reservation has to be kept until the ticket is destroyed.
+ *
+ * \param[in] server_name  The name of the server of the client.
+ * \param[in] service_name  The name of the service of the client.
+ *
+ * \return The reservation of the ticket.
+ */
+client_quota::reservation client_quota::reserve(
+      std::string const & server_name
+    , std::string const & service_name)
+{
+    return reservation(get_client(server_name, service_name));
+}
+
+
+/** \brief Get the current usage of each client.
+ *
+ * \return A copy of the usage of each known client.
+ */
+std::vector<client_quota::usage> client_quota::get_usage() const
+{
+    std::vector<usage> result;
+    result.reserve(f_usage.size());
+    for(auto const & u : f_usage)
+    {
+        result.push_back(*u.second);
+    }
+    return result;
+}
+
+
+/** \brief Forget the clients which are idle.
+ *
+ * A client without tickets which did not send a LOCK request in
+ * IDLE_CLIENT microseconds is removed. The function only goes through
+ * the list once every IDLE_CLIENT microseconds.
+ *
+ * \param[in] now  The current date.
+ */
+void client_quota::prune(cluck::timeout_t const & now)
+{
+    if((now - f_last_prune).to_usec() < IDLE_CLIENT)
+    {
+        return;
+    }
+    f_last_prune = now;
+
+    for(auto it(f_usage.begin()); it != f_usage.end(); )
+    {
+        if(it->second->f_tickets == 0
+        && (now - it->second->f_last_request).to_usec() >= IDLE_CLIENT)
+        {
+            it = f_usage.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+
+std::shared_ptr<client_quota::usage> & client_quota::get_client(
+      std::string const & server_name
+    , std::string const & service_name)
+{
+    atom const server(server_name);
+    atom const service(service_name);
+    std::shared_ptr<usage> & u(f_usage[client_t(server.id(), service.id())]);
+    if(u == nullptr)
+    {
+        u = std::make_shared<usage>();
+        u->f_server_name = server;
+        u->f_service_name = service;
+    }
+    return u;
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
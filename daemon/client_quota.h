@@ -0,0 +1,126 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+// self
+//
+#include    "atom.h"
+
+
+// cluck
+//
+#include    <cluck/cluck.h>
+
+
+// C++
+//
+#include    <memory>
+#include    <unordered_map>
+#include    <vector>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+class client_quota
+{
+public:
+    enum class result_t
+    {
+        QUOTA_ACCEPTED,
+        QUOTA_TICKETS,          // too many outstanding tickets
+        QUOTA_RATE,             // too many LOCK requests per second
+    };
+
+    struct usage
+    {
+        atom                    f_server_name = atom();
+        atom                    f_service_name = atom();
+        std::size_t             f_tickets = 0;
+        std::uint64_t           f_requests = 0;
+        std::uint64_t           f_rejected = 0;
+        double                  f_tokens = 0.0;
+        cluck::timeout_t        f_last_request = cluck::timeout_t();
+    };
+
+    class reservation
+    {
+    public:
+                                reservation() = default;
+                                reservation(std::shared_ptr<usage> u);
+                                reservation(reservation const &) = delete;
+                                reservation(reservation && rhs);
+                                ~reservation();
+
+        reservation &           operator = (reservation const &) = delete;
+        reservation &           operator = (reservation && rhs);
+
+    private:
+        void                    release();
+
+        std::shared_ptr<usage>  f_usage = std::shared_ptr<usage>();
+    };
+
+    void                        set_max_tickets(std::size_t max_tickets);
+    std::size_t                 get_max_tickets() const;
+    void                        set_rate(std::size_t rate);
+    std::size_t                 get_rate() const;
+
+    result_t                    check(
+                                      std::string const & server_name
+                                    , std::string const & service_name
+                                    , cluck::timeout_t const & now
+                                    , bool count_request
+                                    , cluck::timeout_t & retry_after);
+    reservation                 reserve(
+                                      std::string const & server_name
+                                    , std::string const & service_name);
+    std::vector<usage>          get_usage() const;
+    void                        prune(cluck::timeout_t const & now);
+
+private:
+    typedef std::pair<atom::id_t, atom::id_t>   client_t;
+
+    struct client_hash
+    {
+        std::size_t operator () (client_t const & c) const
+        {
+            return std::hash<atom::id_t>()(c.first) * 31 + std::hash<atom::id_t>()(c.second);
+        }
+    };
+
+    typedef std::unordered_map<client_t, std::shared_ptr<usage>, client_hash>
+                                usage_map_t;
+
+    std::shared_ptr<usage> &    get_client(
+                                      std::string const & server_name
+                                    , std::string const & service_name);
+
+    std::size_t                 f_max_tickets = 0;
+    std::size_t                 f_rate = 0;
+    cluck::timeout_t            f_last_prune = cluck::timeout_t();
+    usage_map_t                 f_usage = usage_map_t();
+};
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -21,6 +21,7 @@
 //
 #include    "cluckd.h"
 
+#include    "daemon/message_structs.h"
 
 
 // cluck
@@ -66,6 +67,7 @@
 //
 #include    <advgetopt/advgetopt.h>
 #include    <advgetopt/exception.h>
+#include    <advgetopt/validator_integer.h>
 
 
 // C++
@@ -75,11 +77,6 @@
 #include    <sstream>
 
 
-// openssl
-//
-#include    <openssl/rand.h>
-
-
 // last include
 //
 #include    <snapdev/poison.h>
@@ -121,6 +118,11 @@
  * elections still require you to have a quorum of all the computers
  * (100 / 2 + 1 is at least 51 computers).
  *
+ * To scale beyond what three computers can handle, the `leader-groups`
+ * option can be used to elect several groups of three leaders. Each
+ * object name is assigned to one group using a consistent hash and only
+ * the leaders of that group handle the tickets of that object.
+ *
  * \note
  * The cluck implementation checks parameters and throws away
  * messages that are definitely not going to be understood. However,
@@ -145,8 +147,33 @@ constexpr std::string_view  g_default_candidate_priority =
     snapdev::integer_to_string_literal<computer::PRIORITY_DEFAULT>.data();
 
 
+/** \brief Delay between two slices of replayed LOCK requests.
+ *
+ * The LOCK requests cached before the cluck daemon is ready are replayed
+ * in slices, one slice every REPLAY_INTERVAL microseconds. The
+ * `lock-replay-rate` option defines the size of the slices.
+ */
+constexpr std::int64_t      REPLAY_INTERVAL = 10'000;
+
+
+/** \brief Number of objects listed by INFO in "hot" mode.
+ *
+ * The `cluck-status --hot` command lists the statistics of this many
+ * objects, the hottest first.
+ */
+constexpr std::size_t       HOT_OBJECTS = 10;
+
+
 advgetopt::option const g_options[] =
 {
+    advgetopt::define_option(
+          advgetopt::Name("batch-delay")
+        , advgetopt::Flags(advgetopt::all_flags<
+                      advgetopt::GETOPT_FLAG_REQUIRED
+                    , advgetopt::GETOPT_FLAG_GROUP_OPTIONS>())
+        , advgetopt::Help("Define the number of microseconds the messages to the other leaders are kept in a batch (-1 to 100000, -1 turns off batching).")
+        , advgetopt::DefaultValue("-1")
+    ),
     advgetopt::define_option(
           advgetopt::Name("candidate-priority")
         , advgetopt::ShortName('p')
@@ -156,6 +183,124 @@ advgetopt::option const g_options[] =
         , advgetopt::Help("Define the priority of this candidate (1 to 14) to gain a leader position or \"off\".")
         , advgetopt::DefaultValue(g_default_candidate_priority.data())
     ),
+    advgetopt::define_option(
+          advgetopt::Name("client-lock-rate")
+        , advgetopt::Flags(advgetopt::all_flags<
+                      advgetopt::GETOPT_FLAG_REQUIRED
+                    , advgetopt::GETOPT_FLAG_GROUP_OPTIONS>())
+        , advgetopt::Help("Define the maximum number of LOCK requests per second a leader accepts from one client service (0 to 1,000,000, 0 for no limit).")
+        , advgetopt::DefaultValue("0")
+    ),
+    advgetopt::define_option(
+          advgetopt::Name("client-max-tickets")
+        , advgetopt::Flags(advgetopt::all_flags<
+                      advgetopt::GETOPT_FLAG_REQUIRED
+                    , advgetopt::GETOPT_FLAG_GROUP_OPTIONS>())
+        , advgetopt::Help("Define the maximum number of tickets one client service can have on a leader (0 to 1,000,000, 0 for no limit).")
+        , advgetopt::DefaultValue("0")
+    ),
+    advgetopt::define_option(
+          advgetopt::Name("entering-backlog")
+        , advgetopt::Flags(advgetopt::all_flags<
+                      advgetopt::GETOPT_FLAG_REQUIRED
+                    , advgetopt::GETOPT_FLAG_GROUP_OPTIONS>())
+        , advgetopt::Help("Define the maximum number of LOCK requests waiting per object when its entering tickets are at their limit (0 to 10,000, 0 fails those requests immediately).")
+        , advgetopt::DefaultValue("0")
+    ),
+    advgetopt::define_option(
+          advgetopt::Name("leader-groups")
+        , advgetopt::Flags(advgetopt::all_flags<
+                      advgetopt::GETOPT_FLAG_REQUIRED
+                    , advgetopt::GETOPT_FLAG_GROUP_OPTIONS>())
+        , advgetopt::Help("Define the number of groups of three leaders used to share the lock objects (1 to 100).")
+        , advgetopt::DefaultValue("1")
+    ),
+    advgetopt::define_option(
+          advgetopt::Name("leader-mesh-certificate")
+        , advgetopt::Flags(advgetopt::all_flags<
+                      advgetopt::GETOPT_FLAG_REQUIRED
+                    , advgetopt::GETOPT_FLAG_GROUP_OPTIONS>())
+        , advgetopt::Help("Define the path to the TLS certificate used to encrypt the leader mesh connections.")
+    ),
+    advgetopt::define_option(
+          advgetopt::Name("leader-mesh-port")
+        , advgetopt::Flags(advgetopt::all_flags<
+                      advgetopt::GETOPT_FLAG_REQUIRED
+                    , advgetopt::GETOPT_FLAG_GROUP_OPTIONS>())
+        , advgetopt::Help("Define the TCP port used by the leaders to directly connect to each other (0 to 65535, 0 turns off the leader mesh).")
+        , advgetopt::DefaultValue("0")
+    ),
+    advgetopt::define_option(
+          advgetopt::Name("leader-mesh-private-key")
+        , advgetopt::Flags(advgetopt::all_flags<
+                      advgetopt::GETOPT_FLAG_REQUIRED
+                    , advgetopt::GETOPT_FLAG_GROUP_OPTIONS>())
+        , advgetopt::Help("Define the path to the TLS private key used to encrypt the leader mesh connections.")
+    ),
+    advgetopt::define_option(
+          advgetopt::Name("local-combining")
+        , advgetopt::Flags(advgetopt::all_flags<
+                      advgetopt::GETOPT_FLAG_REQUIRED
+                    , advgetopt::GETOPT_FLAG_GROUP_OPTIONS>())
+        , advgetopt::Help("Define the maximum number of local clients granted a lock in a row with one ticket (0 to 100, 0 turns off local combining; ignored when client-lock-rate or client-max-tickets is set since all the local clients would share one quota).")
+        , advgetopt::DefaultValue("0")
+    ),
+    advgetopt::define_option(
+          advgetopt::Name("local-listen")
+        , advgetopt::Flags(advgetopt::all_flags<
+                      advgetopt::GETOPT_FLAG_REQUIRED
+                    , advgetopt::GETOPT_FLAG_GROUP_OPTIONS>())
+        , advgetopt::Help("Define the path to a Unix socket used by local clients to directly connect to the cluck daemon (empty to turn off; ignored when client-lock-rate or client-max-tickets is set since all the local clients would share one quota).")
+        , advgetopt::DefaultValue("")
+    ),
+    advgetopt::define_option(
+          advgetopt::Name("lock-cache-limit")
+        , advgetopt::Flags(advgetopt::all_flags<
+                      advgetopt::GETOPT_FLAG_REQUIRED
+                    , advgetopt::GETOPT_FLAG_GROUP_OPTIONS>())
+        , advgetopt::Help("Define the maximum number of LOCK requests kept while the leaders are not yet known (1 to 1,000,000).")
+        , advgetopt::DefaultValue("100000")
+    ),
+    advgetopt::define_option(
+          advgetopt::Name("lock-progress-interval")
+        , advgetopt::Flags(advgetopt::all_flags<
+                      advgetopt::GETOPT_FLAG_REQUIRED
+                    , advgetopt::GETOPT_FLAG_GROUP_OPTIONS>())
+        , advgetopt::Help("Define the minimum number of milliseconds between two LOCK_PROGRESS messages sent to a client waiting for a lock (0 to 3,600,000, 0 to never send LOCK_PROGRESS messages).")
+        , advgetopt::DefaultValue("1000")
+    ),
+    advgetopt::define_option(
+          advgetopt::Name("lock-replay-rate")
+        , advgetopt::Flags(advgetopt::all_flags<
+                      advgetopt::GETOPT_FLAG_REQUIRED
+                    , advgetopt::GETOPT_FLAG_GROUP_OPTIONS>())
+        , advgetopt::Help("Define the maximum number of cached LOCK requests replayed per second once the cluck daemon is ready (0 to 1,000,000, 0 replays all the requests at once).")
+        , advgetopt::DefaultValue("1000")
+    ),
+    advgetopt::define_option(
+          advgetopt::Name("max-entering-locks")
+        , advgetopt::Flags(advgetopt::all_flags<
+                      advgetopt::GETOPT_FLAG_REQUIRED
+                    , advgetopt::GETOPT_FLAG_GROUP_OPTIONS>())
+        , advgetopt::Help("Define the maximum number of entering tickets per object (0 to 100,000, 0 adapts the limit to the rate at which the entering tickets drain).")
+        , advgetopt::DefaultValue("100")
+    ),
+    advgetopt::define_option(
+          advgetopt::Name("object-stats-limit")
+        , advgetopt::Flags(advgetopt::all_flags<
+                      advgetopt::GETOPT_FLAG_REQUIRED
+                    , advgetopt::GETOPT_FLAG_GROUP_OPTIONS>())
+        , advgetopt::Help("Define the maximum number of objects for which statistics are kept (0 to 1,000,000, 0 to not keep any statistics).")
+        , advgetopt::DefaultValue("1000")
+    ),
+    advgetopt::define_option(
+          advgetopt::Name("object-stats-prefix")
+        , advgetopt::Flags(advgetopt::all_flags<
+                      advgetopt::GETOPT_FLAG_REQUIRED
+                    , advgetopt::GETOPT_FLAG_GROUP_OPTIONS>())
+        , advgetopt::Help("Define the number of '/' separated components of the object names used to group their statistics (0 to 100, 0 to use the whole name).")
+        , advgetopt::DefaultValue("0")
+    ),
     advgetopt::define_option(
           advgetopt::Name("server-name")
         , advgetopt::ShortName('n')
@@ -192,6 +337,38 @@ constexpr char const * const g_configuration_files[] =
 };
 
 
+/** \brief Decode the parameters of a message.
+ *
+ * The parameter structures are generated from the message definitions
+ * (see message-definitions/GenerateMessageStructs.cmake). This function
+ * decodes all the parameters of \p msg in \p parameters at once so the
+ * message handlers can then use the typed fields directly.
+ *
+ * \param[in] msg  The message to decode.
+ * \param[out] parameters  The structure receiving the parameters.
+ *
+ * \return true if all the required parameters were found.
+ */
+template<typename T>
+bool decode_parameters(ed::message const & msg, T & parameters)
+{
+    if(parameters.decode(msg))
+    {
+        return true;
+    }
+
+    SNAP_LOG_ERROR
+        << "message "
+        << msg.get_command()
+        << " is missing required parameter \""
+        << parameters.f_missing
+        << "\"."
+        << SNAP_LOG_SEND;
+    return false;
+}
+
+
+
 advgetopt::options_environment const g_options_environment =
 {
     .f_project_name = "cluckd",
@@ -401,6 +578,76 @@ void cluckd::add_connections()
     // communicator daemon
     //
     f_messenger->finish_parsing();
+
+    // the LOCK requests received before the election are kept in a cache
+    // which needs to be bounded
+    //
+    f_message_cache.set_limit(f_opts.get_long("lock-cache-limit", 0, 1, 1'000'000));
+
+    // the cache gets replayed in slices, one every REPLAY_INTERVAL
+    //
+    std::size_t const replay_rate(f_opts.get_long("lock-replay-rate", 0, 0, 1'000'000));
+    f_replay_slice = replay_rate == 0
+                ? 0
+                : std::max(replay_rate * REPLAY_INTERVAL / 1'000'000, static_cast<std::size_t>(1));
+
+    // the number of entering tickets per object is limited
+    //
+    f_admission.set_limit(f_opts.get_long("max-entering-locks", 0, 0, 100'000));
+    f_admission.set_backlog_limit(f_opts.get_long("entering-backlog", 0, 0, 10'000));
+
+    // the quotas isolate the clients sharing this cluster
+    //
+    f_client_quota.set_max_tickets(f_opts.get_long("client-max-tickets", 0, 0, 1'000'000));
+    f_client_quota.set_rate(f_opts.get_long("client-lock-rate", 0, 0, 1'000'000));
+
+    // the combined LOCK requests reach the leaders as requests from this
+    // cluck daemon so all the local clients would share a single quota;
+    // combining is therefore turned off when quotas are in use
+    //
+    f_local_combining = f_opts.get_long("local-combining", 0, 0, 100);
+    if(f_local_combining > 0
+    && (f_client_quota.get_max_tickets() != 0
+        || f_client_quota.get_rate() != 0))
+    {
+        SNAP_LOG_WARNING
+            << "local-combining is ignored because client quotas are in use."
+            << SNAP_LOG_SEND;
+        f_local_combining = 0;
+    }
+
+    // local clients may connect directly to us through a Unix socket
+    // which avoids the extra hop through the communicator daemon; their
+    // requests also reach the other leaders as requests from this cluck
+    // daemon so the socket is not opened when quotas are in use
+    //
+    std::string const local_listen(f_opts.get_string("local-listen"));
+    if(!local_listen.empty())
+    {
+        if(f_client_quota.get_max_tickets() != 0
+        || f_client_quota.get_rate() != 0)
+        {
+            SNAP_LOG_WARNING
+                << "local-listen is ignored because client quotas are in use."
+                << SNAP_LOG_SEND;
+        }
+        else
+        {
+            addr::addr_unix const address(local_listen);
+            f_local_listener = std::make_shared<local_listener>(this, address);
+            f_communicator->add_connection(f_local_listener);
+        }
+    }
+
+    // clients waiting for a lock can be told about their progress
+    //
+    std::int64_t const progress_interval(f_opts.get_long("lock-progress-interval", 0, 0, 3'600'000));
+    f_lock_progress.set_interval(cluck::timeout_t(progress_interval / 1'000, progress_interval % 1'000 * 1'000'000));
+
+    // statistics about the objects being locked
+    //
+    f_object_stats.set_limit(f_opts.get_long("object-stats-limit", 0, 0, 1'000'000));
+    f_object_stats.set_prefix(f_opts.get_long("object-stats-prefix", 0, 0, 100));
 }
 
 
@@ -602,8 +849,34 @@ bool cluckd::is_daemon_ready() const
     }
 
     // we only need to have 2 leaders to have a functional system with
-    // 2 or 3 leaders total
+    // 2 or 3 leaders total; with multiple leader groups, that has to be
+    // true for each group
     //
+    if(f_leader_groups > 1)
+    {
+        for(std::size_t group(0); group < f_leader_groups; ++group)
+        {
+            computer::vector_t const leaders(get_group_leaders(group));
+            std::size_t const group_ready(std::count_if(
+                      leaders.begin()
+                    , leaders.end()
+                    , [](auto const & l)
+                    {
+                        return l->get_connected();
+                    }));
+            if(group_ready < 2
+            && (group_ready != leaders.size() || leaders.empty()))
+            {
+                SNAP_LOG_TRACE
+                    << "not considered ready: not enough leaders connected in group "
+                    << group
+                    << "."
+                    << SNAP_LOG_SEND;
+                return false;
+            }
+        }
+        return true;
+    }
     if(ready >= 2
     || ready == f_leaders.size())
     {
@@ -630,42 +903,30 @@ bool cluckd::is_daemon_ready() const
  *
  * When the function is called with an empty string as the computer
  * identifier, this computer is checked to see whether it is a leader.
+ * That case is the most common one and it returns the pointer cached
+ * by update_leader_cache() instead of searching the list of leaders.
  *
- * \warning
- * This function is considered slow since it goes through the list of leaders
- * on each call. On the other hand, it's only 1 to 3 leaders. Yet, you should
- * cache the result within your function if you need the result multiple
- * times, as in:
- *
- * \code
- *      computer::pointer_t leader(is_leader());
- *      if(leader != nullptr)
- *      {
- *          // ... use `leader` any number of times ...
- *      }
- * \endcode
- *
- * \par
- * This is done that way because the function may return a different result
- * over time (i.e. if a re-election happens). So you do not want to cache
- * the results between calls to your function.
+ * \note
+ * The function may return a different result over time (i.e. if a
+ * re-election happens). So you do not want to cache the results between
+ * calls to your function.
  *
  * \param[in] id  The identifier of the leader to search, if empty, default
  *                to f_my_id (i.e. whether this cluckd is a leader).
  *
  * \return The leader computer::pointer_t or a null pointer.
  */
-computer::pointer_t cluckd::is_leader(std::string id) const
+computer::pointer_t cluckd::is_leader(std::string const & id) const
 {
     if(id.empty())
     {
-        id = f_my_id;
+        return f_self_leader;
     }
 
     auto const l(std::find_if(
           f_leaders.begin()
         , f_leaders.end()
-        , [id](auto const & c){
+        , [&id](auto const & c){
               return c->get_id() == id;
           }));
     if(l != f_leaders.end())
@@ -695,32 +956,32 @@ computer::pointer_t cluckd::is_leader(std::string id) const
  * If the elections have not yet happened, this function always returns
  * a null pionter.
  *
+ * \note
+ * With multiple leader groups, the leader is searched in the group this
+ * cluck daemon is a member of. A leader only holds tickets for the
+ * objects assigned to its own group so this is the group the ticket
+ * messages have to be sent to.
+ *
  * \return A pointer to the leader A computer or nullptr if there is no
  *         such computer.
+ *
+ * \sa update_leader_cache()
  */
 computer::pointer_t cluckd::get_leader_a() const
 {
 #ifdef _DEBUG
-    if(is_leader() == nullptr)
+    if(f_self_leader == nullptr)
     {
         throw cluck::logic_error("cluckd::get_leader_a(): only a leader can call this function.");
     }
 #endif
 
-    switch(f_leaders.size())
+    if(f_leaders.empty())
     {
-    case 0: // LCOV_EXCL_LINE -- because of the debug above, this cannot happen here
-    default:
         throw cluck::logic_error("cluckd::get_leader_a(): call this function only when leaders were elected."); // LCOV_EXCL_LINE
-
-    case 1:
-        return computer::pointer_t();
-
-    case 2:
-    case 3:
-        return f_leaders[f_leaders[0]->is_self() ? 1 : 0];
-
     }
+
+    return f_leader_a;
 }
 
 
@@ -742,85 +1003,380 @@ computer::pointer_t cluckd::get_leader_a() const
  * If the elections have not yet happened, this function always returns
  * a null pionter.
  *
+ * \note
+ * With multiple leader groups, the leader is searched in the group this
+ * cluck daemon is a member of. A leader only holds tickets for the
+ * objects assigned to its own group so this is the group the ticket
+ * messages have to be sent to.
+ *
  * \return A pointer to the leader B computer or nullptr if there is no
  *         such computer.
+ *
+ * \sa update_leader_cache()
  */
 computer::pointer_t cluckd::get_leader_b() const
 {
 #ifdef _DEBUG
-    if(is_leader() == nullptr)
+    if(f_self_leader == nullptr)
     {
         throw cluck::logic_error("cluckd::get_leader_b(): only a leader can call this function.");
     }
 #endif
 
-    switch(f_leaders.size())
+    if(f_leaders.empty())
     {
-    case 0: // LCOV_EXCL_LINE -- because of the debug above, this cannot happen here
-    default:
         throw cluck::unexpected_case("cluckd::get_leader_b(): call this function only when leaders were elected."); // LCOV_EXCL_LINE
+    }
+
+    return f_leader_b;
+}
+
+
+/** \brief Compute the leader information used on each message.
+ *
+ * Whether this cluck daemon is a leader, which computers are its leader
+ * A and leader B and the prefix of the serial numbers it generates are
+ * needed by most of the messages we receive. That information only
+ * changes along the list of leaders so this function computes it once
+ * each time the list changes (election, LOCK_LEADERS, LOCK_STARTED,
+ * lost leader, cluster down).
+ *
+ * This function must be called each time f_leaders or f_my_id is
+ * modified.
+ *
+ * The ACTIVATE_LOCK messages sent to the previous leaders may never be
+ * answered so the function also clears the head activated flag of all
+ * the objects. This way the next call to activate_first_lock() sends
+ * a new ACTIVATE_LOCK to the new leaders.
+ */
+void cluckd::update_leader_cache()
+{
+    f_self_leader.reset();
+    f_leader_a.reset();
+    f_leader_b.reset();
+    f_serial_prefix = 0;
+
+    if(!f_my_id.empty())
+    {
+        auto const l(std::find_if(
+              f_leaders.begin()
+            , f_leaders.end()
+            , [this](auto const & c){
+                  return c->get_id() == f_my_id;
+              }));
+        if(l != f_leaders.end())
+        {
+            f_self_leader = *l;
+            f_serial_prefix = static_cast<ticket::serial_t>(f_self_leader->get_leader_index() % 3)
+                                    << ticket::SERIAL_LEADER_SHIFT;
+        }
+    }
 
+    computer::vector_t const leaders(f_self_leader == nullptr
+                                        ? f_leaders
+                                        : get_group_leaders(f_self_leader->get_leader_group()));
+    switch(leaders.size())
+    {
+    case 0:
     case 1:
-    case 2: // we have a leader A but no leader B when we have only 2 leaders
-        return computer::pointer_t();
+        break;
 
-    case 3:
-        return f_leaders[f_leaders[2]->is_self() ? 1 : 2];
+    case 2:
+        f_leader_a = leaders[leaders[0]->is_self() ? 1 : 0];
+        break;
+
+    default:
+        f_leader_a = leaders[leaders[0]->is_self() ? 1 : 0];
+        f_leader_b = leaders[leaders[2]->is_self() ? 1 : 2];
+        break;
 
     }
-}
 
+    for(auto & obj_ticket : f_tickets)
+    {
+        obj_ticket.second.set_head_activated(false);
+    }
+}
 
 
-/** \brief Return a JSON with the state of this cluckd object.
+/** \brief Determine the leader group handling the specified object.
  *
- * This function generates a JSON string of the current state of this
- * cluck daemon and replies with that message back to the caller.
+ * When the cluster is configured with more than one leader group (see
+ * the `leader-groups` option), each group of three leaders handles a
+ * subset of the lock objects. This function returns the group number
+ * handling \p object_name.
  *
- * This is primarily used to debug a cluckd instance and make sure that the
- * state is how you would otherwise expect it to be.
+ * The selection uses a consistent hash of the object name so all the
+ * cluck daemons agree on the group without any communication and
+ * changing the number of groups moves as few objects as possible.
  *
- * \todo
- * The list of tickets uses the internal serialization mechanism, which
- * creates a much small array of tickets. At some point, we should transform
- * that to output JSON instead.
+ * \param[in] object_name  The name of the object to lock.
  *
- * \param[in] msg  The INFO message.
+ * \return The leader group number, from 0 to the number of groups - 1.
  */
-void cluckd::msg_info(ed::message & msg)
+std::size_t cluckd::get_leader_group(std::string const & object_name) const
 {
-    std::stringstream ss;
+    return get_object_group(object_name, f_leader_groups);
+}
 
-    as2js::position p;
-    p.set_filename("cluckd.cpp");
-    p.set_function("msg_info");
 
-    as2js::json::json_value::object_t obj;
-    as2js::json::json_value::pointer_t result(std::make_shared<as2js::json::json_value>(p, obj));
+/** \brief Get the leaders of the specified group.
+ *
+ * This function returns the (up to) three leaders that are part of the
+ * specified \p group. The leaders are returned in the order they were
+ * elected.
+ *
+ * The vector may be empty if all the leaders of that group were lost
+ * and no new election happened yet.
+ *
+ * \param[in] group  The leader group number.
+ *
+ * \return The list of leaders in that group.
+ */
+computer::vector_t cluckd::get_group_leaders(std::size_t group) const
+{
+    return get_group_members(f_leaders, f_leader_groups, group);
+}
 
+
+/** \brief Check whether this cluck daemon handles \p object_name.
+ *
+ * A cluck daemon handles the tickets of an object only if it is a leader
+ * and it is a member of the leader group assigned to that object.
+ *
+ * \param[in] object_name  The name of the object to check.
+ *
+ * \return true if this daemon is a leader of the group of \p object_name.
+ */
+bool cluckd::is_object_leader(std::string const & object_name) const
+{
+    computer::pointer_t const self(is_leader());
+    if(self == nullptr)
     {
-        as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, is_daemon_ready()));
-        result->set_member("daemon_ready", value);
+        return false;
     }
 
-    if(!f_my_id.empty())
-    {
-        as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, f_my_id));
-        result->set_member("id", value);
+    return self->get_leader_group() == get_leader_group(object_name);
+}
+
+
+/** \brief Get the leader handling the specified object.
+ *
+ * Each object is assigned a preferred leader within its leader group.
+ * Sending all the requests about one object to the same leader means
+ * that this leader owns the whole queue of tickets for that object,
+ * which keeps its state in one process and avoids having all the
+ * leaders of the group become owners of some of the tickets.
+ *
+ * The preferred leader is determined using rendezvous hashing: each
+ * leader gets a weight computed from the object name and the leader
+ * name and the leader with the largest weight wins. If that leader is
+ * not currently connected, the connected leader with the next largest
+ * weight is used instead. When a leader is lost, only the objects it
+ * was handling move to another leader.
+ *
+ * The round trip time to each leader is also taken in account. If the
+ * preferred leader is much slower than the fastest connected leader
+ * (more than twice its round trip time plus one millisecond), then the
+ * fastest leader is used instead. This happens when a leader sits on a
+ * congested link or its event loop is overloaded.
+ *
+ * \param[in] object_name  The name of the object to lock.
+ *
+ * \return The leader handling \p object_name or a null pointer if the
+ * group of that object has no leaders.
+ */
+computer::pointer_t cluckd::get_object_leader(std::string const & object_name) const
+{
+    computer::vector_t const leaders(get_group_leaders(get_leader_group(object_name)));
+
+    std::uint64_t const object_hash(hash_object_name(object_name));
+    computer::pointer_t best;
+    computer::pointer_t best_connected;
+    std::uint64_t best_weight(0);
+    std::uint64_t best_connected_weight(0);
+    for(auto const & l : leaders)
+    {
+        std::uint64_t const weight(hash_object_name(l->get_name(), object_hash));
+        if(best == nullptr
+        || weight > best_weight)
+        {
+            best = l;
+            best_weight = weight;
+        }
+        if(l->get_connected()
+        && (best_connected == nullptr
+            || weight > best_connected_weight))
+        {
+            best_connected = l;
+            best_connected_weight = weight;
+        }
     }
 
+    if(best_connected == nullptr)
     {
-        addr::addr zero;
-        as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p,
-            f_my_ip_address == zero
-                ? "<not assigned>"
-                : f_my_ip_address.to_ipv4or6_string(addr::STRING_IP_ADDRESS | addr::STRING_IP_BRACKET_ADDRESS)));
-        result->set_member("ip", value);
+        return best;
     }
 
+    // check the latency of the leaders
+    //
+    snapdev::timespec_ex const now(snapdev::now());
+    std::int64_t const preferred_rtt(best_connected->get_rtt(now));
+    if(preferred_rtt == computer::RTT_UNKNOWN)
     {
-        as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, as2js::integer(f_neighbors_count)));
-        result->set_member("neighbors_count", value);
+        return best_connected;
+    }
+    computer::pointer_t fastest(best_connected);
+    std::int64_t fastest_rtt(preferred_rtt);
+    for(auto const & l : leaders)
+    {
+        if(l->get_connected())
+        {
+            std::int64_t const rtt(l->get_rtt(now));
+            if(rtt != computer::RTT_UNKNOWN
+            && rtt < fastest_rtt)
+            {
+                fastest = l;
+                fastest_rtt = rtt;
+            }
+        }
+    }
+    if(preferred_rtt > fastest_rtt * 2 + 1'000)
+    {
+        return fastest;
+    }
+
+    return best_connected;
+}
+
+
+/** \brief Send an RTT ping to the leaders of a group.
+ *
+ * This function sends an ALIVE message to the leaders of the specified
+ * group which were not pinged in a while. The ABSOLUTELY replies are
+ * used to compute the round trip time to each leader (see
+ * msg_absolutely()).
+ *
+ * The pings are sent lazily, only when we forward messages to that
+ * group, so a cluck daemon which never forwards anything does not
+ * generate any additional traffic.
+ *
+ * \param[in] group  The group of leaders to ping.
+ */
+void cluckd::ping_leaders(std::size_t group)
+{
+    snapdev::timespec_ex const now(snapdev::now());
+    for(auto const & l : get_group_leaders(group))
+    {
+        if(l->is_self()
+        || !l->get_connected()
+        || !l->rtt_ping(now))
+        {
+            continue;
+        }
+
+        ed::message alive_message;
+        alive_message.set_command(ed::g_name_ed_cmd_alive);
+        alive_message.set_server(l->get_name());
+        alive_message.set_service(cluck::g_name_cluck_service_name);
+        alive_message.add_parameter(
+                  ed::g_name_ed_param_serial
+                , "cluckd_rtt/" + l->get_name() + '/' + std::to_string(l->get_rtt_sequence()));
+        alive_message.add_parameter(ed::g_name_ed_param_timestamp, now);
+        f_messenger->send_message(alive_message);
+    }
+}
+
+
+
+/** \brief Return a JSON with the state of this cluckd object.
+ *
+ * This function generates a JSON string of the current state of this
+ * cluck daemon and replies with that message back to the caller.
+ *
+ * This is primarily used to debug a cluckd instance and make sure that the
+ * state is how you would otherwise expect it to be.
+ *
+ * Once locks were obtained, the "phases" object shows where the time
+ * of the LOCK requests goes: one histogram (in microseconds) per phase
+ * of the bakery algorithm (see lock_trace).
+ *
+ * \todo
+ * The list of tickets uses the internal serialization mechanism, which
+ * creates a much small array of tickets. At some point, we should transform
+ * that to output JSON instead.
+ *
+ * \param[in] msg  The INFO message.
+ */
+void cluckd::msg_info(ed::message & msg)
+{
+    std::stringstream ss;
+
+    as2js::position p;
+    p.set_filename("cluckd.cpp");
+    p.set_function("msg_info");
+
+    as2js::json::json_value::object_t obj;
+    as2js::json::json_value::pointer_t result(std::make_shared<as2js::json::json_value>(p, obj));
+
+    // the times are in microseconds
+    //
+    auto histogram_to_json = [&p](histogram const & h)
+    {
+        as2js::json::json_value::object_t times;
+        as2js::json::json_value::pointer_t item(std::make_shared<as2js::json::json_value>(p, times));
+
+        {
+            as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, as2js::integer(h.get_count())));
+            item->set_member("count", value);
+        }
+
+        {
+            as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, as2js::integer(h.get_average())));
+            item->set_member("average", value);
+        }
+
+        {
+            as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, as2js::integer(h.get_percentile(50))));
+            item->set_member("p50", value);
+        }
+
+        {
+            as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, as2js::integer(h.get_percentile(99))));
+            item->set_member("p99", value);
+        }
+
+        {
+            as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, as2js::integer(h.get_max())));
+            item->set_member("max", value);
+        }
+
+        return item;
+    };
+
+    {
+        as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, is_daemon_ready()));
+        result->set_member("daemon_ready", value);
+    }
+
+    if(!f_my_id.empty())
+    {
+        as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, f_my_id));
+        result->set_member("id", value);
+    }
+
+    {
+        addr::addr zero;
+        as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p,
+            f_my_ip_address == zero
+                ? "<not assigned>"
+                : f_my_ip_address.to_ipv4or6_string(addr::STRING_IP_ADDRESS | addr::STRING_IP_BRACKET_ADDRESS)));
+        result->set_member("ip", value);
+    }
+
+    {
+        as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, as2js::integer(f_neighbors_count)));
+        result->set_member("neighbors_count", value);
     }
 
     {
@@ -833,12 +1389,75 @@ void cluckd::msg_info(ed::message & msg)
         result->set_member("leaders_count", value);
     }
 
+    if(f_leader_groups > 1)
+    {
+        as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, as2js::integer(f_leader_groups)));
+        result->set_member("leader_groups", value);
+    }
+
     if(!f_message_cache.empty())
     {
         as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, as2js::integer(f_message_cache.size())));
         result->set_member("cache_size", value);
     }
 
+    {
+        std::vector<client_quota::usage> const clients(f_client_quota.get_usage());
+        if(!clients.empty())
+        {
+            as2js::json::json_value::array_t quotas;
+            as2js::json::json_value::pointer_t list(std::make_shared<as2js::json::json_value>(p, quotas));
+
+            for(auto const & c : clients)
+            {
+                as2js::json::json_value::object_t client;
+                as2js::json::json_value::pointer_t item(std::make_shared<as2js::json::json_value>(p, client));
+
+                {
+                    as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, c.f_server_name.str()));
+                    item->set_member("server", value);
+                }
+
+                {
+                    as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, c.f_service_name.str()));
+                    item->set_member("service", value);
+                }
+
+                {
+                    as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, as2js::integer(c.f_tickets)));
+                    item->set_member("tickets", value);
+                }
+
+                {
+                    as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, as2js::integer(c.f_requests)));
+                    item->set_member("requests", value);
+                }
+
+                {
+                    as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, as2js::integer(c.f_rejected)));
+                    item->set_member("rejected", value);
+                }
+
+                list->set_item(list->get_array().size(), item);
+            }
+            result->set_member("clients", list);
+        }
+    }
+
+    if(f_lock_phases.get_histogram(0).get_count() > 0)
+    {
+        as2js::json::json_value::object_t phases;
+        as2js::json::json_value::pointer_t item(std::make_shared<as2js::json::json_value>(p, phases));
+
+        for(std::size_t phase(0); phase < lock_trace::PHASE_COUNT; ++phase)
+        {
+            item->set_member(
+                      lock_trace::phase_name(phase)
+                    , histogram_to_json(f_lock_phases.get_histogram(phase)));
+        }
+        result->set_member("phases", item);
+    }
+
     {
         as2js::json::json_value::array_t computers;
         as2js::json::json_value::pointer_t list(std::make_shared<as2js::json::json_value>(p, computers));
@@ -879,8 +1498,23 @@ void cluckd::msg_info(ed::message & msg)
                 std::string leader;
                 if(it != f_leaders.end())
                 {
-                    as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, as2js::integer(it - f_leaders.begin())));
+                    as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, as2js::integer((*it)->get_leader_index())));
                     item->set_member("leader", value);
+
+                    if(f_leader_groups > 1)
+                    {
+                        as2js::json::json_value::pointer_t group(std::make_shared<as2js::json::json_value>(p, as2js::integer((*it)->get_leader_group())));
+                        item->set_member("leader_group", group);
+                    }
+                }
+            }
+
+            {
+                std::int64_t const rtt(c.second->get_smoothed_rtt());
+                if(rtt != computer::RTT_UNKNOWN)
+                {
+                    as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, as2js::integer(rtt)));
+                    item->set_member("rtt", value);
                 }
             }
 
@@ -889,6 +1523,61 @@ void cluckd::msg_info(ed::message & msg)
         result->set_member("computers", list);
     }
 
+    if(msg.has_parameter(cluck::g_name_cluck_param_mode)
+    && msg.get_parameter(cluck::g_name_cluck_param_mode) == cluck::g_name_cluck_value_hot)
+    {
+        snapdev::timespec_ex const now(snapdev::now());
+        as2js::json::json_value::array_t objects;
+        as2js::json::json_value::pointer_t list(std::make_shared<as2js::json::json_value>(p, objects));
+
+        for(auto const * s : f_object_stats.get_hot(HOT_OBJECTS, now))
+        {
+            as2js::json::json_value::object_t object;
+            as2js::json::json_value::pointer_t item(std::make_shared<as2js::json::json_value>(p, object));
+
+            {
+                as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, s->f_name));
+                item->set_member("name", value);
+            }
+
+            {
+                as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, as2js::floating(s->get_rate(now))));
+                item->set_member("rate", value);
+            }
+
+            {
+                as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, as2js::integer(s->f_requests)));
+                item->set_member("requests", value);
+            }
+
+            {
+                as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, as2js::integer(s->f_acquisitions)));
+                item->set_member("acquisitions", value);
+            }
+
+            {
+                as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, as2js::integer(s->f_timeouts)));
+                item->set_member("timeouts", value);
+            }
+
+            {
+                as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, as2js::integer(s->f_queue_depth)));
+                item->set_member("queue_depth", value);
+            }
+
+            {
+                as2js::json::json_value::pointer_t value(std::make_shared<as2js::json::json_value>(p, as2js::integer(s->f_max_queue_depth)));
+                item->set_member("max_queue_depth", value);
+            }
+
+            item->set_member("wait", histogram_to_json(s->f_wait));
+            item->set_member("hold", histogram_to_json(s->f_hold));
+
+            list->set_item(list->get_array().size(), item);
+        }
+        result->set_member("hot", list);
+    }
+
     if(msg.has_parameter(cluck::g_name_cluck_param_mode)
     && msg.get_parameter(cluck::g_name_cluck_param_mode) == cluck::g_name_cluck_value_debug)
     {
@@ -916,10 +1605,26 @@ void cluckd::msg_info(ed::message & msg)
  */
 std::string cluckd::ticket_list() const
 {
-    std::stringstream list;
+    // the store is not sorted, list the objects in alphabetical order
+    //
+    std::vector<ticket::object_map_t::value_type const *> objects;
+    objects.reserve(f_tickets.size());
     for(auto const & obj_ticket : f_tickets)
     {
-        for(auto const & key_ticket : obj_ticket.second)
+        objects.push_back(&obj_ticket);
+    }
+    std::sort(
+          objects.begin()
+        , objects.end()
+        , [](auto const * a, auto const * b)
+        {
+            return a->first < b->first;
+        });
+
+    std::stringstream list;
+    for(auto const * obj_ticket : objects)
+    {
+        for(auto const & key_ticket : obj_ticket->second)
         {
             list
                 << "ticket_id: "
@@ -978,7 +1683,7 @@ void cluckd::election_status()
         // the results may have been "tempered" with (i.e. one of
         // the leaders was lost)
         //
-        if(f_leaders.size() == 3
+        if(f_leaders.size() == 3 * f_leader_groups
         || (f_neighbors_count < 3 && f_leaders.size() == f_neighbors_count))
         {
             // status is fine
@@ -1147,24 +1852,33 @@ void cluckd::election_status()
 //std::cerr << "  " << s.second->get_name() << "    " << s.first << "\n";
 //}
 
-    // the first three are the new leaders
+    // the number of leader groups is limited by the number of candidates;
+    // we only create additional groups when we can have three leaders in
+    // each one of them
+    //
+    std::size_t groups(f_opts.get_long("leader-groups", 0, 1, 100));
+    groups = std::max(static_cast<std::size_t>(1), std::min(groups, sort_by_id.size() / 3));
+
+    // the first three (per group) are the new leaders
     //
     ed::message lock_leaders_message;
     lock_leaders_message.set_command(cluck::g_name_cluck_cmd_lock_leaders);
     lock_leaders_message.set_service(communicator::g_name_communicator_server_any);
     f_leaders.clear();
+    f_leader_groups = groups;
     f_election_date = snapdev::now();
     lock_leaders_message.add_parameter(cluck::g_name_cluck_param_election_date, f_election_date);
     auto leader(sort_by_id.begin());
-    std::size_t const max(std::min(static_cast<computer::map_t::size_type>(3), sort_by_id.size()));
+    std::size_t const max(std::min(3 * groups, sort_by_id.size()));
     for(std::size_t idx(0); idx < max; ++idx, ++leader)
     {
-        lock_leaders_message.add_parameter(
-              cluck::g_name_cluck_param_leader + std::to_string(idx)
-            , leader->second->get_id());
+        leader->second->set_leader_index(idx);
         f_leaders.push_back(leader->second);
     }
+    update_leader_cache();
+    add_leaders_parameters(lock_leaders_message);
     f_messenger->send_message(lock_leaders_message);
+    update_leader_mesh();
 
 #if 1
 SNAP_LOG_WARNING
@@ -1206,19 +1920,68 @@ void cluckd::check_lock_status()
     {
         // we still have a cache of locks that can now be processed
         //
-        // note:
-        // although msg_lock() could re-add some of those messages
-        // in the f_message_cache vector, it should not since it
-        // calls the same is_daemon_ready() function which we know returns
-        // true and therefore no cache is required
-        //
-        message_cache::list_t cache;
-        cache.swap(f_message_cache);
-        for(auto & mc : cache)
+        replay_cached_locks();
+    }
+}
+
+
+/** \brief Replay the next slice of cached LOCK requests.
+ *
+ * The LOCK requests received before the cluck daemon is ready are cached.
+ * After a restart of the cluster, the cache may include thousands of
+ * requests. Replaying all of them at once would start as many bakery
+ * negotiations on the new leaders and many of them would time out.
+ *
+ * Instead, this function replays at most one slice of requests, as
+ * defined by the `lock-replay-rate` option, and sets up the replay timer
+ * to come back for the next slice. The requests with the earliest
+ * timeout are replayed first.
+ *
+ * While the replay is in progress, new LOCK requests are added to the
+ * cache so they do not get ahead of the requests which were waiting.
+ *
+ * If the daemon stops being ready, the replay stops. It restarts once
+ * check_lock_status() finds that the daemon is ready again.
+ */
+void cluckd::replay_cached_locks()
+{
+    if(!is_daemon_ready())
+    {
+        return;
+    }
+
+    std::size_t count(f_replay_slice == 0
+                ? f_message_cache.size()
+                : f_replay_slice);
+
+    f_replaying = true;
+    message_cache::request r;
+    while(count > 0
+       && is_daemon_ready()
+       && f_message_cache.pop_next(r))
+    {
+        ed::message lock_message(r.to_message());
+        msg_lock(lock_message);
+        --count;
+    }
+    f_replaying = false;
+
+    if(f_message_cache.empty()
+    || !is_daemon_ready())
+    {
+        if(f_replay_timer != nullptr)
         {
-            msg_lock(mc.f_message);
+            f_replay_timer->set_timeout_date(-1);
         }
+        return;
+    }
+
+    if(f_replay_timer == nullptr)
+    {
+        f_replay_timer = std::make_shared<replay_timer>(this);
+        f_communicator->add_connection(f_replay_timer);
     }
+    f_replay_timer->set_timeout_date(snapdev::now() + snapdev::timespec_ex(0, REPLAY_INTERVAL * 1'000));
 }
 
 
@@ -1257,89 +2020,244 @@ void cluckd::send_lock_started(ed::message const * msg)
     if(!f_leaders.empty())
     {
         lock_started_message.add_parameter(cluck::g_name_cluck_param_election_date, f_election_date);
-        for(size_t idx(0); idx < f_leaders.size(); ++idx)
-        {
-            lock_started_message.add_parameter(
-                  cluck::g_name_cluck_param_leader + std::to_string(idx)
-                , f_leaders[idx]->get_id());
-        }
+        add_leaders_parameters(lock_started_message);
     }
 
     f_messenger->send_message(lock_started_message);
 }
 
 
-/** \brief Called whenever we receive the STOP command or equivalent.
+/** \brief Add the list of leaders to a message.
  *
- * This function makes sure the cluck daemon exits as quickly as
- * possible. This means unregistering all the daemon's connections
- * from the communicator.
+ * The leaders are sent as "leader<n>" parameters. The leaders of group
+ * zero use parameters "leader0" to "leader2", the leaders of group one
+ * use "leader3" to "leader5", etc. This way older versions of cluckd
+ * which only know about one group still see the first group of leaders.
  *
- * If possible, the function sends an UNREGISTER message to the
- * communicator daemon.
+ * When more than one group exists, the "leader_groups" parameter is also
+ * added to the message.
  *
- * \param[in] quitting  Set to true if we received a QUITTING message (false
- * usually means we received a STOP message).
+ * \param[in,out] msg  The message where the parameters get added.
+ *
+ * \sa load_leaders()
  */
-void cluckd::stop(bool quitting)
+void cluckd::add_leaders_parameters(ed::message & msg) const
 {
-    if(f_messenger != nullptr)
+    if(f_leader_groups > 1)
     {
-        f_messenger->unregister_fluid_settings(quitting);
-        f_communicator->remove_connection(f_messenger);
-        f_messenger.reset();
+        msg.add_parameter(cluck::g_name_cluck_param_leader_groups, f_leader_groups);
     }
 
-    if(f_communicator != nullptr)
+    for(std::size_t group(0); group < f_leader_groups; ++group)
     {
-        f_communicator->remove_connection(f_interrupt);
-        f_interrupt.reset();
-
-        f_communicator->remove_connection(f_timer);
-        f_timer.reset();
+        computer::vector_t const leaders(get_group_leaders(group));
+        for(std::size_t idx(0); idx < leaders.size(); ++idx)
+        {
+            msg.add_parameter(
+                  cluck::g_name_cluck_param_leader + std::to_string(group * 3 + idx)
+                , leaders[idx]->get_id());
+        }
     }
 }
 
 
-/** \brief Make sure the very first ticket is marked as LOCKED.
- *
- * This function is called whenever the f_tickets map changes
- * (more specifically, one of its children) to make sure
- * that the first ticket is clearly marked as being locked.
- * Most of the time this happens when we add and when we remove
- * tickets.
+/** \brief Load the list of leaders from a message.
  *
- * Note that the function may be called many times even though the
- * first ticket does not actually change. Generally this is fine 
- * although each time it sends an ACTIVATE_LOCK message so we want
- * to limit the number of calls to make sure we do not send too
- * many possibly confusing messages.
+ * This function reads the "leader<n>" parameters and saves the
+ * corresponding computers in the f_leaders vector. If one of the
+ * leaders is not yet known, it gets added to the list of computers
+ * marked as not connected.
  *
- * \note
- * We need the ACTIVATE_LOCK and LOCK_ACTIVATED messages to make sure
- * that we only activate the very first lock which we cannot be sure
- * of on our own because all the previous messages are using the
- * QUORUM as expected and thus our table of locks may not be complete
- * at any one time.
+ * \param[in] msg  The LOCK_LEADERS or LOCK_STARTED message.
  *
- * \param[in] object_name  The name of the object which very
- *                         first ticket may have changed.
+ * \sa add_leaders_parameters()
  */
-void cluckd::activate_first_lock(std::string const & object_name)
+void cluckd::load_leaders(ed::message const & msg)
 {
-    auto ticket(find_first_lock(object_name));
-
-    if(ticket != nullptr)
+    f_leaders.clear();
+    f_leader_groups = 1;
+    if(msg.has_parameter(cluck::g_name_cluck_param_leader_groups))
     {
-        // there is what we think is the first ticket
-        // that should be actived now; we need to share
-        // with the other 2 leaders to make sure of that
-        //
-        ticket->activate_lock();
+        f_leader_groups = std::clamp(
+                  msg.get_integer_parameter(cluck::g_name_cluck_param_leader_groups)
+                , static_cast<std::int64_t>(1)
+                , static_cast<std::int64_t>(100));
+    }
+
+    std::size_t const max(f_leader_groups * 3);
+    for(std::size_t idx(0); idx < max; ++idx)
+    {
+        std::string const param_name(cluck::g_name_cluck_param_leader + std::to_string(idx));
+        if(msg.has_parameter(param_name))
+        {
+            computer::pointer_t leader(std::make_shared<computer>());
+            std::string const lockid(msg.get_parameter(param_name));
+            if(leader->set_id(lockid))
+            {
+                computer::map_t::iterator exists(f_computers.find(leader->get_name()));
+                if(exists != f_computers.end())
+                {
+                    // it already exists, use our existing instance
+                    //
+                    leader = exists->second;
+                }
+                else
+                {
+                    // we do not yet know of that computer, even though
+                    // it is a leader! (i.e. we are not yet aware that
+                    // somehow we are connected to it)
+                    //
+                    leader->set_connected(false);
+                    f_computers[leader->get_name()] = leader;
+                }
+                leader->set_leader_index(idx);
+                f_leaders.push_back(leader);
+            }
+        }
+    }
+
+    update_leader_cache();
+    update_leader_mesh();
+}
+
+
+/** \brief Called whenever we receive the STOP command or equivalent.
+ *
+ * This function makes sure the cluck daemon exits as quickly as
+ * possible. This means unregistering all the daemon's connections
+ * from the communicator.
+ *
+ * If possible, the function sends an UNREGISTER message to the
+ * communicator daemon.
+ *
+ * \param[in] quitting  Set to true if we received a QUITTING message (false
+ * usually means we received a STOP message).
+ */
+void cluckd::stop(bool quitting)
+{
+    if(f_messenger != nullptr)
+    {
+        f_messenger->stop_batching();
+        f_messenger->unregister_fluid_settings(quitting);
+        f_communicator->remove_connection(f_messenger);
+        f_messenger.reset();
+    }
+
+    if(f_communicator != nullptr)
+    {
+        f_communicator->remove_connection(f_interrupt);
+        f_interrupt.reset();
+
+        f_communicator->remove_connection(f_timer);
+        f_timer.reset();
+
+        if(f_replay_timer != nullptr)
+        {
+            f_communicator->remove_connection(f_replay_timer);
+            f_replay_timer.reset();
+        }
+
+        if(f_local_listener != nullptr)
+        {
+            f_communicator->remove_connection(f_local_listener);
+            f_local_listener.reset();
+        }
+
+        for(auto const & c : f_local_clients)
+        {
+            local_client::pointer_t client(c.second.lock());
+            if(client != nullptr)
+            {
+                f_communicator->remove_connection(client);
+            }
+        }
+        f_local_clients.clear();
+        f_local_forwards.clear();
+
+        if(f_leader_listener != nullptr)
+        {
+            f_communicator->remove_connection(f_leader_listener);
+            f_leader_listener.reset();
+        }
+
+        for(auto const & c : f_leader_connections)
+        {
+            f_communicator->remove_connection(c.second);
+        }
+        f_leader_connections.clear();
+
+        for(auto const & c : f_leader_clients)
+        {
+            leader_client::pointer_t client(c.lock());
+            if(client != nullptr)
+            {
+                f_communicator->remove_connection(client);
+            }
+        }
+        f_leader_clients.clear();
+    }
+}
+
+
+/** \brief Make sure the very first ticket is marked as LOCKED.
+ *
+ * This function is called whenever the f_tickets map changes
+ * (more specifically, one of its children) to make sure
+ * that the first ticket is clearly marked as being locked.
+ * Most of the time this happens when we add and when we remove
+ * tickets.
+ *
+ * The function may be called many times even though the first ticket
+ * does not actually change. Each activation sends an ACTIVATE_LOCK
+ * message so the ticket map of the object remembers whether its head
+ * was already activated. That flag is cleared whenever the head changes
+ * and the function returns immediately when it is still set.
+ *
+ * \note
+ * We need the ACTIVATE_LOCK and LOCK_ACTIVATED messages to make sure
+ * that we only activate the very first lock which we cannot be sure
+ * of on our own because all the previous messages are using the
+ * QUORUM as expected and thus our table of locks may not be complete
+ * at any one time.
+ *
+ * \param[in] object_name  The name of the object which very
+ *                         first ticket may have changed.
+ */
+void cluckd::activate_first_lock(std::string const & object_name)
+{
+    auto ticket(find_first_lock(object_name));
+
+    if(ticket != nullptr)
+    {
+        // find_first_lock() does not remove the object when it returns
+        // a ticket
+        //
+        ticket::key_map_t & tickets(f_tickets.find(object_name)->second);
+        if(tickets.is_head_activated())
+        {
+            return;
+        }
+
+        // there is what we think is the first ticket
+        // that should be actived now; we need to share
+        // with the other 2 leaders to make sure of that
+        //
+        tickets.set_head_activated(ticket->activate_lock());
     }
 }
 
 
+/** \brief Search the first ticket of an object.
+ *
+ * The tickets are sorted so the first ticket is the head of the queue.
+ * If that ticket timed out, it is removed and the next one becomes the
+ * head. The other tickets are not checked here; cleanup() takes care
+ * of them once their time comes.
+ *
+ * \param[in] object_name  The name of the object.
+ *
+ * \return The first ticket or nullptr if there is none.
+ */
 ticket::pointer_t cluckd::find_first_lock(std::string const & object_name)
 {
     ticket::pointer_t first_ticket;
@@ -1347,42 +2265,38 @@ ticket::pointer_t cluckd::find_first_lock(std::string const & object_name)
 
     if(obj_ticket != f_tickets.end())
     {
-        // loop through making sure that we activate a ticket only
-        // if the obtention date was not already reached; if that
-        // date was reached before we had the time to activate the
-        // lock, then the client should have abandonned the lock
-        // request anyway...
+        // make sure that we activate a ticket only if the obtention date
+        // was not already reached; if that date was reached before we
+        // had the time to activate the lock, then the client should
+        // have abandonned the lock request anyway...
         //
         // (this is already done in the cleanup(), but a couple of
         // other functions may call the activate_first_lock()
         // function!)
         //
-        for(auto key_ticket(obj_ticket->second.begin()); key_ticket != obj_ticket->second.end(); )
+        ticket::key_map_t & tickets(obj_ticket->second);
+        while(!tickets.empty())
         {
-            if(key_ticket->second->timed_out())
+            auto head(tickets.begin());
+            if(head->second->timed_out())
             {
                 // that ticket timed out, send an UNLOCKING, UNLOCKED,
                 // or LOCK_FAILED message and get rid of it
                 //
-                key_ticket->second->lock_failed("timed out while searching for first lock");
-                if(key_ticket->second->timed_out())
+                head->second->lock_failed("timed out while searching for first lock");
+                if(head->second->timed_out())
                 {
                     // still timed out, remove it
                     //
-                    key_ticket = obj_ticket->second.erase(key_ticket);
+                    tickets.erase(head);
+                    continue;
                 }
             }
-            else
-            {
-                if(first_ticket == nullptr)
-                {
-                    first_ticket = key_ticket->second;
-                }
-                ++key_ticket;
-            }
+            first_ticket = head->second;
+            break;
         }
 
-        if(obj_ticket->second.empty())
+        if(tickets.empty())
         {
             // it is empty now, get rid of that set of tickets
             //
@@ -1435,8 +2349,16 @@ void cluckd::synchronize_leaders()
         return;
     }
 
-    // determine whether we are leader #0 or not, if zero, then we
-    // call msg_lock() directly, otherwise we do a f_messenger->send_message()
+    // with multiple leader groups, the synchronization happens per group:
+    // the tickets of an object are handled by the leaders of the group
+    // the object is assigned to (see get_leader_group()); after an election
+    // the number of groups may have changed so a ticket we hold may now
+    // have to be handled by another group
+    //
+    // the first leader of the group (leader #0 when there is a single group)
+    // receives the LOCK messages of tickets that need to be restarted; if
+    // that is us, then we call msg_lock() directly, otherwise we do a
+    // f_messenger->send_message()
     //
     // TODO: review the logic here, I do not think that leader0 has anything
     //       to do with lock requests and tickets; instead, I think that the
@@ -1445,7 +2367,21 @@ void cluckd::synchronize_leaders()
     //       as a new leader to compensate, that new leader needs to get
     //       all the info which is what the LOCK_TICKETS message is about)
     //
-    bool const leader0(f_leaders[0]->get_id() == f_my_id);
+    std::vector<computer::vector_t> group_leaders(f_leader_groups);
+    for(std::size_t group(0); group < f_leader_groups; ++group)
+    {
+        group_leaders[group] = get_group_leaders(group);
+    }
+    auto const owner_is_leader = [](computer::vector_t const & leaders, atom const & owner_name)
+        {
+            return std::find_if(
+                      leaders.begin()
+                    , leaders.end()
+                    , [&owner_name](auto const & l)
+                    {
+                        return l->get_name_atom() == owner_name;
+                    }) != leaders.end();
+        };
 
     // a vector of messages for which we have to call msg_lock()
     //
@@ -1462,23 +2398,25 @@ void cluckd::synchronize_leaders()
     //
     for(auto obj_entering(f_entering_tickets.begin()); obj_entering != f_entering_tickets.end(); ++obj_entering)
     {
+        computer::vector_t const & leaders(group_leaders[get_leader_group(obj_entering->first)]);
+        if(leaders.empty())
+        {
+            // all the leaders of that group are gone, wait for the next
+            // election
+            //
+            continue;
+        }
+        bool const leader0(leaders[0] == f_self_leader);
+
         for(auto key_entering(obj_entering->second.begin()); key_entering != obj_entering->second.end(); )
         {
-            std::string const owner_name(key_entering->second->get_owner());
-            auto key_leader(std::find_if(
-                      f_leaders.begin()
-                    , f_leaders.end()
-                    , [&owner_name](auto const & l)
-                    {
-                        return l->get_name() == owner_name;
-                    }));
-            if(key_leader == f_leaders.end())
+            if(!owner_is_leader(leaders, key_entering->second->get_owner()))
             {
                 // give new ownership to leader[0]
                 //
                 ed::message lock_message;
                 lock_message.set_command(cluck::g_name_cluck_cmd_lock);
-                lock_message.set_server(f_leaders[0]->get_name());
+                lock_message.set_server(leaders[0]->get_name());
                 lock_message.set_service(cluck::g_name_cluck_service_name);
                 lock_message.set_sent_from_server(key_entering->second->get_server_name());
                 lock_message.set_sent_from_service(key_entering->second->get_service_name());
@@ -1488,6 +2426,7 @@ void cluckd::synchronize_leaders()
                 lock_message.add_parameter(cluck::g_name_cluck_param_timeout, key_entering->second->get_obtention_timeout());
                 lock_message.add_parameter(cluck::g_name_cluck_param_duration, key_entering->second->get_lock_duration());
                 lock_message.add_parameter(cluck::g_name_cluck_param_unlock_duration, key_entering->second->get_unlock_duration());
+                lock_message.add_parameter(cluck::g_name_cluck_param_relock, 1);
                 if(leader0)
                 {
                     // we are leader #0 so directly call msg_lock()
@@ -1502,9 +2441,9 @@ void cluckd::synchronize_leaders()
                 {
                     // we are not leader #0, so send the message to it
                     //
-                    ++key_entering;
                     lock_message.add_parameter(cluck::g_name_cluck_param_serial, key_entering->second->get_serial());
                     f_messenger->send_message(lock_message);
+                    ++key_entering;
                 }
             }
             else
@@ -1520,34 +2459,35 @@ void cluckd::synchronize_leaders()
     // if locked, a ticket is assigned leader0 as its new owner so
     // further work on that ticket works as expected
     //
-    std::string serialized;
+    std::vector<std::string> serialized(f_leader_groups);
     for(auto obj_ticket(f_tickets.begin()); obj_ticket != f_tickets.end(); ++obj_ticket)
     {
+        std::size_t const group(get_leader_group(obj_ticket->first));
+        computer::vector_t const & leaders(group_leaders[group]);
+        if(leaders.empty())
+        {
+            continue;
+        }
+        bool const leader0(leaders[0] == f_self_leader);
+
         for(auto key_ticket(obj_ticket->second.begin()); key_ticket != obj_ticket->second.end(); )
         {
-            std::string const owner_name(key_ticket->second->get_owner());
-            auto key_leader(std::find_if(
-                      f_leaders.begin()
-                    , f_leaders.end()
-                    , [&owner_name](auto const & l)
-                    {
-                        return l->get_name() == owner_name;
-                    }));
+            bool const owner_found(owner_is_leader(leaders, key_ticket->second->get_owner()));
             if(key_ticket->second->is_locked())
             {
                 // if ticket was locked by the leader that disappeared, we
                 // transfer ownership to leader #0
                 //
-                if(key_leader == f_leaders.end())
+                if(!owner_found)
                 {
-                    key_ticket->second->set_owner(f_leaders[0]->get_name());
+                    key_ticket->second->set_owner(leaders[0]->get_name());
                 }
 
                 // and send that ticket to the other leaders to make sure
                 // they all agree on its current state
                 //
-                serialized += key_ticket->second->serialize();
-                serialized += '\n';
+                serialized[group] += key_ticket->second->serialize();
+                serialized[group] += '\n';
 
                 ++key_ticket;
             }
@@ -1556,13 +2496,13 @@ void cluckd::synchronize_leaders()
                 // it was not locked yet, restart the LOCK process from
                 // the very beginning
                 //
-                if(key_leader == f_leaders.end())
+                if(!owner_found)
                 {
                     // give new ownership to leader[0]
                     //
                     ed::message lock_message;
                     lock_message.set_command(cluck::g_name_cluck_cmd_lock);
-                    lock_message.set_server(f_leaders[0]->get_name());
+                    lock_message.set_server(leaders[0]->get_name());
                     lock_message.set_service(cluck::g_name_cluck_service_name);
                     lock_message.set_sent_from_server(key_ticket->second->get_server_name());
                     lock_message.set_sent_from_service(key_ticket->second->get_service_name());
@@ -1572,6 +2512,11 @@ void cluckd::synchronize_leaders()
                     lock_message.add_parameter(cluck::g_name_cluck_param_timeout, key_ticket->second->get_obtention_timeout());
                     lock_message.add_parameter(cluck::g_name_cluck_param_duration, key_ticket->second->get_lock_duration());
                     lock_message.add_parameter(cluck::g_name_cluck_param_unlock_duration, key_ticket->second->get_unlock_duration());
+                    if(key_ticket->second->get_progress())
+                    {
+                        lock_message.add_parameter(cluck::g_name_cluck_param_progress, 1);
+                    }
+                    lock_message.add_parameter(cluck::g_name_cluck_param_relock, 1);
                     if(leader0)
                     {
                         // we are leader #0 so directly call msg_lock()
@@ -1583,9 +2528,9 @@ void cluckd::synchronize_leaders()
                     {
                         // we are not leader #0, so send the message to it
                         //
-                        ++key_ticket;
                         lock_message.add_parameter(cluck::g_name_cluck_param_serial, key_ticket->second->get_serial());
                         f_messenger->send_message(lock_message);
+                        ++key_ticket;
                     }
                 }
                 else
@@ -1606,25 +2551,27 @@ void cluckd::synchronize_leaders()
         msg_lock(lm);
     }
 
-    // send LOCK_TICkETS if there is serialized ticket data
+    // send LOCK_TICKETS if there is serialized ticket data; in our own
+    // group, this goes to leader A and B, in other groups (i.e. the
+    // number of groups changed) it goes to all the leaders of that group
     //
-    if(!serialized.empty())
+    for(std::size_t group(0); group < f_leader_groups; ++group)
     {
+        if(serialized[group].empty())
+        {
+            continue;
+        }
+
         ed::message lock_tickets_message;
         lock_tickets_message.set_command(cluck::g_name_cluck_cmd_lock_tickets);
         lock_tickets_message.set_service(cluck::g_name_cluck_service_name);
-        lock_tickets_message.add_parameter(cluck::g_name_cluck_param_tickets, serialized);
+        lock_tickets_message.add_parameter(cluck::g_name_cluck_param_tickets, serialized[group]);
 
-        auto const la(get_leader_a());
-        if(la != nullptr)
+        for(auto const & l : group_leaders[group])
         {
-            lock_tickets_message.set_server(la->get_name());
-            f_messenger->send_message(lock_tickets_message);
-
-            auto const lb(get_leader_b());
-            if(lb != nullptr)
+            if(!l->is_self())
             {
-                lock_tickets_message.set_server(lb->get_name());
+                lock_tickets_message.set_server(l->get_name());
                 f_messenger->send_message(lock_tickets_message);
             }
         }
@@ -1639,6 +2586,17 @@ void cluckd::synchronize_leaders()
  * If we are not a leader, then we need to call this function to
  * forward the message (this daemon acts as a proxy).
  *
+ * The message is sent to the leader handling the object named in the
+ * message (see get_object_leader()) so all the forwarded requests about
+ * one object end up on the same leader. A leader which receives a message
+ * for an object handled by another leader group also uses this function
+ * to forward the message to that group.
+ *
+ * When this daemon is itself a leader, the message gets marked with the
+ * "forwarded" parameter. The leaders of the other group process it or
+ * fail it but never forward it again, so a message cannot bounce between
+ * groups while the leaders do not agree on the groups.
+ *
  * Note that we do not make a copy of the message because we do not expect
  * it to be used any further after this call so we may as well update that
  * message. It should not be destructive at all anyway.
@@ -1655,6 +2613,21 @@ void cluckd::forward_message_to_leader(ed::message & msg)
         return; // LCOV_EXCL_LINE
     }
 
+    std::string const object_name(msg.get_parameter(cluck::g_name_cluck_param_object_name));
+    ping_leaders(get_leader_group(object_name));
+    computer::pointer_t const leader(get_object_leader(object_name));
+    if(leader == nullptr)
+    {
+        SNAP_LOG_ERROR
+            << "no leader available to handle a "
+            << msg.get_command()
+            << " for object \""
+            << object_name
+            << "\"."
+            << SNAP_LOG_SEND;
+        return;
+    }
+
     // we are not a leader, we work as a proxy by forwarding the
     // message to a leader, we add our trail so the LOCKED and
     // other messages can be proxied back
@@ -1663,12 +2636,39 @@ void cluckd::forward_message_to_leader(ed::message & msg)
     //       even see the returned message, it may be proxied to another
     //       server directly or through another route
     //
+    // Note: a message forwarded by a leader of another group already
+    //       includes the trail of the original client
+    //
+    // Note: a client connected directly to us (see local_client) is not
+    //       known by the communicator daemon so the replies come back to
+    //       us and we relay them to that client
+    //
     msg.set_service(cluck::g_name_cluck_service_name);
-    msg.add_parameter(cluck::g_name_cluck_param_lock_proxy_server_name, msg.get_sent_from_server());
-    msg.add_parameter(cluck::g_name_cluck_param_lock_proxy_service_name, msg.get_sent_from_service());
+    if(!msg.has_parameter(cluck::g_name_cluck_param_lock_proxy_server_name))
+    {
+        std::string service_name(msg.get_sent_from_service());
+        if(f_local_clients.contains(service_name))
+        {
+            f_local_forwards.add(
+                      service_name
+                    , msg.get_integer_parameter(cluck::g_name_cluck_param_pid)
+                    , object_name
+                    , msg.get_integer_parameter(cluck::g_name_cluck_param_tag));
+            service_name = cluck::g_name_cluck_service_name;
+        }
+        msg.add_parameter(cluck::g_name_cluck_param_lock_proxy_server_name, msg.get_sent_from_server());
+        msg.add_parameter(cluck::g_name_cluck_param_lock_proxy_service_name, service_name);
+    }
+
+    // a leader forwards the messages about objects handled by another
+    // group; the leaders of that group must not forward them again
+    //
+    if(is_leader() != nullptr)
+    {
+        msg.add_parameter(cluck::g_name_cluck_param_forwarded, 1);
+    }
 
-    f_next_leader = (f_next_leader + 1) % f_leaders.size();
-    msg.set_server(f_leaders[f_next_leader]->get_name());
+    msg.set_server(leader->get_name());
 
     f_messenger->send_message(msg);
 }
@@ -1687,69 +2687,38 @@ void cluckd::forward_message_to_leader(ed::message & msg)
  */
 void cluckd::cleanup()
 {
-    cluck::timeout_t next_timeout(snapdev::timespec_ex::max());
+    cluck::timeout_t const now(snapdev::now());
+
+    // the deadlines pushed while this pass runs (i.e. by the LOCK requests
+    // admitted from the backlogs or the tickets activated below) are kept
+    // and merged with the deadlines found by this pass
+    //
+    f_next_deadline = snapdev::timespec_ex::max();
+    f_in_cleanup = true;
+    admit_backlog(now);
 
     // when we receive LOCK requests before we have leaders elected, they
     // get added to our cache, so do some cache clean up when not empty
     //
-    cluck::timeout_t const now(snapdev::now());
-    for(auto c(f_message_cache.begin()); c != f_message_cache.end(); )
+    message_cache::request r;
+    while(f_message_cache.pop_timed_out(now, r))
     {
-        if(c->f_timeout <= now)
-        {
-            std::string object_name;
-            ed::dispatcher_match::tag_t tag(ed::dispatcher_match::DISPATCHER_MATCH_NO_TAG);
-            pid_t client_pid(0);
-            cluck::timeout_t timeout;
-            if(!get_parameters(c->f_message, &object_name, &tag, &client_pid, &timeout, nullptr, nullptr))
-            {
-                // we should never cache messages that are invalid
-                //
-                throw cluck::logic_error("cluck::cleanup() of LOCK message failed get_parameters()."); // LCOV_EXCL_LINE
-            }
-
-            SNAP_LOG_WARNING
-                << "Lock on \""
-                << object_name
-                << "\" / \""
-                << client_pid
-                << "\" / \""
-                << tag
-                << "\" timed out before leaders were known."
-                << SNAP_LOG_SEND;
-
-            std::string const server_name(c->f_message.has_parameter("lock_proxy_server_name")
-                                        ? c->f_message.get_parameter("lock_proxy_server_name")
-                                        : c->f_message.get_sent_from_server());
-            std::string const service_name(c->f_message.has_parameter("lock_proxy_service_name")
-                                         ? c->f_message.get_parameter("lock_proxy_service_name")
-                                         : c->f_message.get_sent_from_service());
-            std::string const entering_key(server_name + '/' + std::to_string(client_pid));
-
-            ed::message lock_failed_message;
-            lock_failed_message.set_command(cluck::g_name_cluck_cmd_lock_failed);
-            lock_failed_message.set_service(service_name);
-            lock_failed_message.set_server(server_name);
-            lock_failed_message.add_parameter(cluck::g_name_cluck_param_object_name, object_name);
-            lock_failed_message.add_parameter(cluck::g_name_cluck_param_tag, tag);
-            lock_failed_message.add_parameter(cluck::g_name_cluck_param_key, entering_key);
-            lock_failed_message.add_parameter(cluck::g_name_cluck_param_error, cluck::g_name_cluck_value_timedout);
-#ifndef CLUCKD_OPTIMIZATIONS
-            lock_failed_message.add_parameter(cluck::g_name_cluck_param_description, "cleanup() found a timed out lock");
-#endif
-            f_messenger->send_message(lock_failed_message);
+        SNAP_LOG_WARNING
+            << "Lock on \""
+            << r.f_object_name
+            << "\" / \""
+            << r.f_pid
+            << "\" / \""
+            << r.f_tag
+            << "\" timed out before leaders were known."
+            << SNAP_LOG_SEND;
 
-            c = f_message_cache.erase(c);
-        }
-        else
-        {
-            if(c->f_timeout < next_timeout)
-            {
-                next_timeout = c->f_timeout;
-            }
-            ++c;
-        }
+        send_cached_lock_failed(
+                  r
+                , cluck::g_name_cluck_value_timedout
+                , "cleanup() found a timed out lock");
     }
+    cluck::timeout_t next_timeout(f_message_cache.get_next_timeout());
 
     // remove any f_ticket that timed out
     //
@@ -1766,6 +2735,7 @@ void cluckd::cleanup()
                 {
                     // still timed out, remove it
                     //
+                    record_hold(key_ticket->second, now);
                     key_ticket = obj_ticket->second.erase(key_ticket);
                     try_activate = true;
                     move_next = false;
@@ -1794,6 +2764,10 @@ void cluckd::cleanup()
                 activate_first_lock(obj_ticket->first);
             }
 
+            // let the clients waiting on this object know how far they are
+            //
+            next_timeout = std::min(next_timeout, send_lock_progress(obj_ticket->first, now));
+
             ++obj_ticket;
         }
     }
@@ -1834,65 +2808,346 @@ void cluckd::cleanup()
         }
     }
 
+    // time out the local lock requests and remove idle local locks
+    //
+    for(auto local(f_local_locks.begin()); local != f_local_locks.end(); )
+    {
+        next_timeout = std::min(next_timeout, local->second->cleanup(now));
+        if(local->second->is_idle())
+        {
+            local = f_local_locks.erase(local);
+        }
+        else
+        {
+            ++local;
+        }
+    }
+
+    // the LOCK requests waiting in a backlog may time out too
+    //
+    next_timeout = std::min(next_timeout, f_admission.get_next_timeout());
+
+    f_in_cleanup = false;
+
     // got a new timeout?
     //
-    if(next_timeout != snapdev::timespec_ex::max())
+    f_next_deadline = std::min(f_next_deadline, next_timeout);
+    if(f_next_deadline != snapdev::timespec_ex::max())
     {
         // we add one second to avoid looping like crazy
         // if we timeout just around the "wrong" time
         //
-        f_timer->set_timeout_date(next_timeout + cluck::timeout_t(1, 0));
+        arm_timer((f_next_deadline + cluck::timeout_t(1, 0)).to_usec());
     }
     else
     {
-        f_timer->set_timeout_date(-1);
+        arm_timer(-1);
     }
 }
 
 
-/** \brief Determine the last ticket defined in this cluck daemon.
- *
- * This function loops through the existing tickets and returns the
- * largest ticket number it finds.
- *
- * Note that the number returned is the last ticket. At some point,
- * the caller needs to add one to this number before assigning the
- * result to a new ticket.
- *
- * If no ticket were defined for \p object_name or we are dealing with
- * that object very first ticket, then the function returns NO_TICKET
- * (which is 0).
+/** \brief Admit the LOCK requests waiting in the backlogs.
  *
- * \param[in] object_name  The name of the object for which the last ticket
- *                         number is being sought.
+ * When an object has too many entering tickets, new LOCK requests wait
+ * in the backlog of that object (see the `entering-backlog` option).
+ * This function fails the requests which timed out and replays the
+ * others, earliest timeout first, as long as the object remains under
+ * its limit of entering tickets.
  *
- * \return The last ticket number or NO_TICKET.
+ * \param[in] now  The current date.
  */
-ticket::ticket_id_t cluckd::get_last_ticket(std::string const & object_name)
+void cluckd::admit_backlog(cluck::timeout_t const & now)
 {
-    ticket::ticket_id_t last_ticket(ticket::NO_TICKET);
-
-    // Note: There is no need to check the f_entering_tickets list
-    //       since that one does not yet have any ticket number assigned
-    //       and thus the maximum there would return 0 every time
-    //
-    auto obj_ticket(f_tickets.find(object_name));
-    if(obj_ticket != f_tickets.end())
+    for(auto const & object_name : f_admission.get_backlogged_objects())
     {
-        // note:
-        // the std::max_element() algorithm would require many more
-        // get_ticket_number() when our loop uses one per ticket
-        //
-        for(auto key_ticket : obj_ticket->second)
+        message_cache::request r;
+        while(f_admission.pop_timed_out(object_name, now, r))
         {
-            ticket::ticket_id_t const ticket_number(key_ticket.second->get_ticket_number());
-            if(ticket_number > last_ticket)
-            {
-                last_ticket = ticket_number;
+            send_cached_lock_failed(
+                      r
+                    , cluck::g_name_cluck_value_timedout
+                    , "LOCK timed out while waiting in the backlog");
+        }
+
+        for(;;)
+        {
+            auto const entering_ticket(f_entering_tickets.find(object_name));
+            std::size_t const entering_count(entering_ticket == f_entering_tickets.end()
+                                            ? 0
+                                            : entering_ticket->second.size());
+            f_admission.observe(object_name, entering_count, now);
+            if(entering_count >= f_admission.get_object_limit(object_name)
+            || !f_admission.pop_backlog(object_name, r))
+            {
+                break;
+            }
+
+            ed::message lock_message(r.to_message());
+            f_admitting_backlog = true;
+            msg_lock(lock_message);
+            f_admitting_backlog = false;
+        }
+    }
+
+    f_admission.prune(now);
+    f_client_quota.prune(now);
+    f_lock_progress.prune(now);
+}
+
+
+/** \brief Fail a LOCK request found in the cache.
+ *
+ * The LOCK requests received before the leaders are known are kept in
+ * the message cache. When one of them times out or gets evicted because
+ * the cache is full, the client is sent a LOCK_FAILED message.
+ *
+ * \param[in] r  The cached LOCK request.
+ * \param[in] error  The error to send back to the client.
+ * \param[in] description  A description of the error.
+ */
+void cluckd::send_cached_lock_failed(
+      message_cache::request const & r
+    , std::string const & error
+    , char const * description)
+{
+    std::string const server_name(r.get_server_name());
+    ticket_key const entering_key(atom(server_name), r.f_pid);
+
+    ed::message lock_failed_message;
+    lock_failed_message.set_command(cluck::g_name_cluck_cmd_lock_failed);
+    lock_failed_message.set_service(r.get_service_name());
+    lock_failed_message.set_server(server_name);
+    lock_failed_message.add_parameter(cluck::g_name_cluck_param_object_name, r.f_object_name.str());
+    lock_failed_message.add_parameter(cluck::g_name_cluck_param_tag, r.f_tag);
+    lock_failed_message.add_parameter(cluck::g_name_cluck_param_key, entering_key.to_string());
+    lock_failed_message.add_parameter(cluck::g_name_cluck_param_error, error);
+#ifndef CLUCKD_OPTIMIZATIONS
+    lock_failed_message.add_parameter(cluck::g_name_cluck_param_description, description);
+#else
+    snapdev::NOT_USED(description);
+#endif
+    f_messenger->send_message(lock_failed_message);
+}
+
+
+/** \brief Remember how long a ticket held its lock.
+ *
+ * When a ticket which obtained its lock gets removed, the time it held
+ * the lock is added to the hold times of its object. These are used to
+ * estimate the wait sent in the LOCK_PROGRESS messages.
+ *
+ * Tickets which never obtained their lock are ignored.
+ *
+ * \param[in] t  The ticket being removed.
+ * \param[in] now  The current date.
+ */
+void cluckd::record_hold(ticket::pointer_t const & t, cluck::timeout_t const & now)
+{
+    if(t->is_locked())
+    {
+        f_lock_progress.record_hold(
+                  t->get_object_name()
+                , now - (t->get_lock_timeout_date() - t->get_lock_duration())
+                , now);
+    }
+}
+
+
+/** \brief Send the LOCK_PROGRESS messages of an object.
+ *
+ * This function goes through the tickets of \p object_name in order
+ * and gives each waiting ticket its position in the queue, the number
+ * of tickets holding the lock ahead of it, and an estimate of its wait.
+ * The ticket decides whether a LOCK_PROGRESS message gets sent (see
+ * ticket::progress()).
+ *
+ * \param[in] object_name  The name of the object.
+ * \param[in] now  The current date.
+ *
+ * \return The earliest date at which a postponed LOCK_PROGRESS message
+ * can be sent or timespec_ex::max() if none are pending.
+ */
+cluck::timeout_t cluckd::send_lock_progress(
+      std::string const & object_name
+    , cluck::timeout_t const & now)
+{
+    cluck::timeout_t next_date(snapdev::timespec_ex::max());
+    cluck::timeout_t const & interval(f_lock_progress.get_interval());
+    if(interval == cluck::timeout_t())
+    {
+        return next_date;
+    }
+
+    auto const obj_ticket(f_tickets.find(object_name));
+    if(obj_ticket == f_tickets.end())
+    {
+        return next_date;
+    }
+
+    std::size_t position(0);
+    std::size_t holders(0);
+    cluck::timeout_t held_for;
+    for(auto key_ticket(obj_ticket->second.begin()); key_ticket != obj_ticket->second.end(); ++key_ticket, ++position)
+    {
+        ticket::pointer_t const & t(key_ticket->second);
+        if(t->is_locked())
+        {
+            if(holders == 0)
+            {
+                held_for = now - (t->get_lock_timeout_date() - t->get_lock_duration());
             }
+            ++holders;
+        }
+        else if(t->get_progress())
+        {
+            cluck::timeout_t estimated_wait(-1, 0);
+            f_lock_progress.estimate_wait(object_name, position, held_for, estimated_wait);
+            next_date = std::min(next_date, t->progress(position, holders, estimated_wait, now, interval));
+        }
+    }
+
+    return next_date;
+}
+
+
+/** \brief Request a cleanup pass if a deadline is due.
+ *
+ * The message handlers call this function each time they change the
+ * list of tickets. Going through all the tickets on each message would
+ * be wasteful. Instead, the handlers push the deadline of what they
+ * changed (see push_deadline()) and the full pass only runs once the
+ * earliest deadline is reached, either right here or when the timer
+ * fires.
+ *
+ * Without a \p deadline, the function only makes sure that the handler
+ * does not work with tickets that already timed out.
+ *
+ * \param[in] deadline  The new deadline or timespec_ex::max() if none.
+ */
+void cluckd::schedule_cleanup(cluck::timeout_t const & deadline)
+{
+    push_deadline(deadline);
+
+    if(!f_in_cleanup
+    && snapdev::now() >= f_next_deadline)
+    {
+        cleanup();
+    }
+}
+
+
+/** \brief Push a new deadline.
+ *
+ * If \p deadline is earlier than the earliest deadline known so far,
+ * it becomes the new earliest deadline and the timer gets set to wake
+ * us up at that time. This function never runs the cleanup pass itself
+ * so it can be called from anywhere, including the ticket functions
+ * called by cleanup().
+ *
+ * \param[in] deadline  The new deadline.
+ */
+void cluckd::push_deadline(cluck::timeout_t const & deadline)
+{
+    if(deadline >= f_next_deadline)
+    {
+        return;
+    }
+
+    f_next_deadline = deadline;
+    if(!f_in_cleanup)
+    {
+        // like cleanup(), add one second to avoid looping like crazy
+        //
+        arm_timer((deadline + cluck::timeout_t(1, 0)).to_usec());
+    }
+}
+
+
+/** \brief Update the deadlines after the tickets of an object changed.
+ *
+ * When tickets get removed or activated, the position of the other
+ * tickets of the object changes. This function sends the LOCK_PROGRESS
+ * messages immediately (or pushes the date when they can be sent).
+ *
+ * When entering tickets were removed and that object has LOCK requests
+ * waiting in its backlog, some of them can now be admitted. That
+ * happens in cleanup() so it is made due now.
+ *
+ * \param[in] object_name  The name of the object that changed.
+ * \param[in] deadline  The new deadline or timespec_ex::max() if none.
+ */
+void cluckd::tickets_changed(
+      std::string const & object_name
+    , cluck::timeout_t const & deadline)
+{
+    cluck::timeout_t const now(snapdev::now());
+    cluck::timeout_t next_deadline(std::min(deadline, send_lock_progress(object_name, now)));
+
+    if(f_admission.has_backlog(object_name))
+    {
+        auto const entering_ticket(f_entering_tickets.find(object_name));
+        std::size_t const entering_count(entering_ticket == f_entering_tickets.end()
+                                        ? 0
+                                        : entering_ticket->second.size());
+        if(entering_count < f_admission.get_object_limit(object_name))
+        {
+            next_deadline = now;
         }
     }
 
+    schedule_cleanup(next_deadline);
+}
+
+
+/** \brief Set the date of the timer if it changes.
+ *
+ * \param[in] date  The date in microseconds or -1 to turn the timer off.
+ */
+void cluckd::arm_timer(std::int64_t date)
+{
+    if(f_timer != nullptr
+    && f_timer->get_timeout_date() != date)
+    {
+        f_timer->set_timeout_date(date);
+    }
+}
+
+
+/** \brief Determine the last ticket defined in this cluck daemon.
+ *
+ * This function loops through the existing tickets and returns the
+ * largest ticket number it finds.
+ *
+ * Note that the number returned is the last ticket. At some point,
+ * the caller needs to add one to this number before assigning the
+ * result to a new ticket.
+ *
+ * If no ticket were defined for \p object_name or we are dealing with
+ * that object very first ticket, then the function returns NO_TICKET
+ * (which is 0).
+ *
+ * \param[in] object_name  The name of the object for which the last ticket
+ *                         number is being sought.
+ *
+ * \return The last ticket number or NO_TICKET.
+ */
+ticket::ticket_id_t cluckd::get_last_ticket(std::string const & object_name)
+{
+    ticket::ticket_id_t last_ticket(ticket::NO_TICKET);
+
+    // Note: There is no need to check the f_entering_tickets list
+    //       since that one does not yet have any ticket number assigned
+    //       and thus the maximum there would return 0 every time
+    //
+    auto obj_ticket(f_tickets.find(object_name));
+    if(obj_ticket != f_tickets.end())
+    {
+        // the keys include the ticket number and are sorted by number
+        // so there is no need to look at the tickets themselves
+        //
+        last_ticket = obj_ticket->second.get_last_ticket_number();
+    }
+
     return last_ticket;
 }
 
@@ -1909,10 +3164,15 @@ ticket::ticket_id_t cluckd::get_last_ticket(std::string const & object_name)
  */
 void cluckd::set_ticket(
       std::string const & object_name
-    , std::string const & key
+    , ticket_key const & key
     , ticket::pointer_t ticket)
 {
     f_tickets[object_name][key] = ticket;
+
+    // the clients waiting on that object which asked for it learn about
+    // their position right away instead of on the next cleanup
+    //
+    push_deadline(send_lock_progress(object_name, snapdev::now()));
 }
 
 
@@ -2119,6 +3379,27 @@ void cluckd::msg_absolutely(ed::message & msg)
     std::string const serial(msg.get_parameter(ed::g_name_ed_param_serial));
     std::vector<std::string> segments;
     snapdev::tokenize_string(segments, serial, "/");
+    if(segments.empty())
+    {
+        return;
+    }
+
+    if(segments[0] == "cluckd_rtt")
+    {
+        // reply to one of our RTT pings (see ping_leaders())
+        //
+        std::int64_t sequence(0);
+        if(segments.size() == 3
+        && advgetopt::validator_integer::convert_string(segments[2], sequence))
+        {
+            auto it(f_computers.find(segments[1]));
+            if(it != f_computers.end())
+            {
+                it->second->rtt_pong(static_cast<std::uint32_t>(sequence), snapdev::now());
+            }
+        }
+        return;
+    }
 
     if(segments[0] == "cluckd")
     {
@@ -2157,7 +3438,7 @@ void cluckd::msg_absolutely(ed::message & msg)
         auto entering_ticket(f_entering_tickets.find(object_name));
         if(entering_ticket != f_entering_tickets.end())
         {
-            std::string const entering_key(server_name + '/' + client_pid);
+            ticket_key const entering_key(server_name + '/' + client_pid);
             auto key_ticket(entering_ticket->second.find(entering_key));
             if(key_ticket != entering_ticket->second.end())
             {
@@ -2192,13 +3473,14 @@ void cluckd::msg_absolutely(ed::message & msg)
  */
 void cluckd::msg_activate_lock(ed::message & msg)
 {
-    std::string object_name;
-    ed::dispatcher_match::tag_t tag(ed::dispatcher_match::DISPATCHER_MATCH_NO_TAG);
-    std::string key;
-    if(!get_parameters(msg, &object_name, &tag, nullptr, nullptr, &key, nullptr))
+    params::activate_lock parameters;
+    if(!decode_parameters(msg, parameters))
     {
         return; // LCOV_EXCL_LINE
     }
+    std::string const & object_name(parameters.f_object_name);
+    ed::dispatcher_match::tag_t const tag(parameters.f_tag);
+    std::string const & key(parameters.f_key);
 
     std::string first_key("no-key");
 
@@ -2207,9 +3489,9 @@ void cluckd::msg_activate_lock(ed::message & msg)
     {
         // found a lock
         //
-        first_key = ticket->get_ticket_key();
+        first_key = ticket->get_ticket_key().to_string();
 
-        if(key == first_key)
+        if(ticket->get_ticket_key() == ticket_key(key))
         {
             // we can mark this ticket as activated
             //
@@ -2229,10 +3511,10 @@ void cluckd::msg_activate_lock(ed::message & msg)
     lock_activated_message.add_parameter(cluck::g_name_cluck_param_other_key, first_key);
     f_messenger->send_message(lock_activated_message);
 
-    // the list of tickets is not unlikely changed so we need to make
-    // a call to cleanup to make sure the timer is reset appropriately
+    // the activated ticket pushed its new deadline, the other tickets
+    // of that object may have moved
     //
-    cleanup();
+    tickets_changed(object_name);
 }
 
 
@@ -2253,21 +3535,22 @@ void cluckd::msg_activate_lock(ed::message & msg)
  */
 void cluckd::msg_add_ticket(ed::message & msg)
 {
-    std::string object_name;
-    ed::dispatcher_match::tag_t tag(ed::dispatcher_match::DISPATCHER_MATCH_NO_TAG);
-    std::string key;
-    cluck::timeout_t timeout;
-    if(!get_parameters(msg, &object_name, &tag, nullptr, &timeout, &key, nullptr))
+    params::add_ticket parameters;
+    if(!decode_parameters(msg, parameters))
     {
         return; // LCOV_EXCL_LINE
     }
+    std::string const & object_name(parameters.f_object_name);
+    ed::dispatcher_match::tag_t const tag(parameters.f_tag);
+    std::string const & key(parameters.f_key);
+    ticket_key const parsed_key(key);
 
     // make sure the ticket is unique
     //
     auto const obj_ticket(f_tickets.find(object_name));
     if(obj_ticket != f_tickets.end())
     {
-        auto const key_ticket(obj_ticket->second.find(key));
+        auto const key_ticket(obj_ticket->second.find(parsed_key));
         if(key_ticket != obj_ticket->second.end())
         {
             SNAP_LOG_ERROR
@@ -2312,9 +3595,7 @@ void cluckd::msg_add_ticket(ed::message & msg)
 
     // the client_pid parameter is part of the key (3rd segment)
     //
-    std::vector<std::string> segments;
-    snapdev::tokenize_string(segments, key, "/");
-    if(segments.size() != 3)
+    if(std::count(key.begin(), key.end(), '/') != 2)
     {
         SNAP_LOG_ERROR
             << "Expected exactly 3 segments in \""
@@ -2337,28 +3618,16 @@ void cluckd::msg_add_ticket(ed::message & msg)
         return;
     }
 
-    // TODO: we probably want to look at using a function which returns false
-    //       instead of having to do a try/catch
+    // older versions of cluckd use 8 digits, newer versions may use 16
     //
-    bool ok(true);
-    std::uint32_t number(0);
-    try
-    {
-        number = snapdev::hex_to_int<std::uint32_t>(segments[0]);
-    }
-    catch(snapdev::hexadecimal_string_exception const &)
-    {
-        ok = false;
-    }
-    catch(snapdev::hexadecimal_string_out_of_range const &)
-    {
-        ok = false;
-    }
+    std::string_view const number_segment(std::string_view(key).substr(0, key.find('/')));
+    ticket::ticket_id_t number(ticket::NO_TICKET);
+    bool const ok(ticket_key::parse_ticket_number(number_segment, number));
     if(!ok)
     {
         SNAP_LOG_ERROR
             << "somehow ticket number \""
-            << segments[0]
+            << number_segment
             << "\" is not a valid hexadecimal number."
             << SNAP_LOG_SEND;
 
@@ -2405,10 +3674,9 @@ void cluckd::msg_add_ticket(ed::message & msg)
     }
 
     // the key we need to search is not the new ticket key but the
-    // entering key, build it from the segments
+    // entering key
     //
-    std::string const entering_key(segments[1] + '/' + segments[2]);
-    auto const key_entering_ticket(obj_entering_ticket->second.find(entering_key));
+    auto const key_entering_ticket(obj_entering_ticket->second.find(parsed_key.get_entering_key()));
     if(key_entering_ticket == obj_entering_ticket->second.end())
     {
         SNAP_LOG_ERROR
@@ -2437,13 +3705,13 @@ void cluckd::msg_add_ticket(ed::message & msg)
     // this should happen on all cluck daemon other than the one that
     // first received the LOCK message
     //
-    set_ticket(object_name, key, key_entering_ticket->second);
+    set_ticket(object_name, parsed_key, key_entering_ticket->second);
 
     // WARNING: the set_ticket_number() function has the same side
     //          effects as the add_ticket() function without the
     //          f_messenger->send_message() call
     //
-    f_tickets[object_name][key]->set_ticket_number(number);
+    f_tickets[object_name][parsed_key]->set_ticket_number(number);
 
     ed::message ticket_added_message;
     ticket_added_message.set_command(cluck::g_name_cluck_cmd_ticket_added);
@@ -2455,6 +3723,87 @@ void cluckd::msg_add_ticket(ed::message & msg)
 }
 
 
+/** \brief Process a batch of messages.
+ *
+ * When batching is turned on (see the `batch-delay` option), the other
+ * leaders send their messages in a BATCH. This function processes each
+ * message in the order they were added to the batch, as if each one had
+ * been received separately.
+ *
+ * A BATCH is only accepted from one of the other leaders of our group
+ * and only the messages of the inter-leader protocol found in it get
+ * dispatched (see leader_client::get_commands()). Any other message,
+ * such as a STOP or a nested BATCH, is ignored.
+ *
+ * \param[in,out] msg  The BATCH message.
+ */
+void cluckd::msg_batch(ed::message & msg)
+{
+    std::string const & server_name(msg.get_sent_from_server());
+    computer::pointer_t const self(is_leader());
+    bool found(false);
+    if(self != nullptr)
+    {
+        for(auto const & l : get_group_leaders(self->get_leader_group()))
+        {
+            if(!l->is_self()
+            && l->get_name() == server_name)
+            {
+                found = true;
+                break;
+            }
+        }
+    }
+    if(!found)
+    {
+        SNAP_LOG_WARNING
+            << "ignoring BATCH received from \""
+            << server_name
+            << "\" which is not one of our leaders."
+            << SNAP_LOG_SEND;
+        return;
+    }
+
+    std::string const messages(msg.get_parameter(cluck::g_name_cluck_param_messages));
+    std::list<std::string> lines;
+    snapdev::tokenize_string(lines, messages, "\n", true);
+    for(auto const & l : lines)
+    {
+        ed::message m;
+        if(!m.from_message(l))
+        {
+            SNAP_LOG_WARNING
+                << "could not parse message \""
+                << l
+                << "\" found in a BATCH from \""
+                << msg.get_sent_from_server()
+                << "\"."
+                << SNAP_LOG_SEND;
+            continue;
+        }
+
+        if(m.get_command() == cluck::g_name_cluck_cmd_batch
+        || !leader_client::get_commands().contains(m.get_command()))
+        {
+            SNAP_LOG_WARNING
+                << "ignoring message \""
+                << m.get_command()
+                << "\" found in a BATCH from \""
+                << server_name
+                << "\"; it is not part of the inter-leader protocol."
+                << SNAP_LOG_SEND;
+            continue;
+        }
+
+        // the messages of a batch are all sent by the same cluck daemon
+        //
+        m.set_sent_from_server(msg.get_sent_from_server());
+        m.set_sent_from_service(msg.get_sent_from_service());
+        f_messenger->get_dispatcher()->dispatch(m);
+    }
+}
+
+
 /** \brief Message telling us whether the clock is stable.
  *
  * When rebooting, the NTP system takes a little time to get started. The
@@ -2501,6 +3850,8 @@ void cluckd::msg_cluster_down(ed::message & msg)
     // in this case, we cannot safely keep the leaders
     //
     f_leaders.clear();
+    update_leader_cache();
+    update_leader_mesh();
 
     // in case services listen to the NO_LOCK, let them know it's gone
     //
@@ -2548,6 +3899,7 @@ void cluckd::msg_cluster_up(ed::message & msg)
     f_computers[f_server_name]->set_start_time(f_start_time);
     f_computers[f_server_name]->set_connected(true);
     f_my_id = f_computers[f_server_name]->get_id();
+    update_leader_cache();
 
     SNAP_LOG_INFO
         << "cluster is up with "
@@ -2580,24 +3932,20 @@ void cluckd::msg_cluster_up(ed::message & msg)
  */
 void cluckd::msg_drop_ticket(ed::message & msg)
 {
-    std::string object_name;
-    ed::dispatcher_match::tag_t tag(ed::dispatcher_match::DISPATCHER_MATCH_NO_TAG);
-    std::string key;
-    if(!get_parameters(msg, &object_name, &tag, nullptr, nullptr, &key, nullptr))
+    params::drop_ticket parameters;
+    if(!decode_parameters(msg, parameters))
     {
         return; // LCOV_EXCL_LINE
     }
-
-    std::vector<std::string> segments;
-    snapdev::tokenize_string(segments, key, "/");
+    std::string const & object_name(parameters.f_object_name);
+    ticket_key const key(parameters.f_key);
 
     // drop the regular ticket
     //
-    // if we have only 2 segments, then there is no corresponding ticket
+    // if we received an entering key, then there is no corresponding ticket
     // since tickets are added only once we have a ticket_id
     //
-    std::string entering_key;
-    if(segments.size() == 3)
+    if(!key.is_entering_key())
     {
         auto obj_ticket(f_tickets.find(object_name));
         if(obj_ticket != f_tickets.end())
@@ -2605,6 +3953,7 @@ void cluckd::msg_drop_ticket(ed::message & msg)
             auto key_ticket(obj_ticket->second.find(key));
             if(key_ticket != obj_ticket->second.end())
             {
+                record_hold(key_ticket->second, snapdev::now());
                 obj_ticket->second.erase(key_ticket);
             }
 
@@ -2617,20 +3966,12 @@ void cluckd::msg_drop_ticket(ed::message & msg)
             //
             activate_first_lock(object_name);
         }
-
-        // we received the ticket_id in the message, so
-        // we have to regenerate the entering_key without
-        // the ticket_id (which is the first element)
-        //
-        entering_key = segments[1] + '/' + segments[2];
-    }
-    else
-    {
-        // we received the entering_key in the message, use as is
-        //
-        entering_key = key;
     }
 
+    // the entering key is the ticket key without the ticket_id
+    //
+    ticket_key const entering_key(key.get_entering_key());
+
     // drop the entering ticket
     //
     auto obj_entering_ticket(f_entering_tickets.find(object_name));
@@ -2648,10 +3989,10 @@ void cluckd::msg_drop_ticket(ed::message & msg)
         }
     }
 
-    // the list of tickets is not unlikely changed so we need to make
-    // a call to cleanup to make sure the timer is reset appropriately
+    // tickets may have been removed, update the other tickets of that
+    // object (the removal itself does not bring any deadline closer)
     //
-    cleanup();
+    tickets_changed(object_name);
 }
 
 
@@ -2670,18 +4011,19 @@ void cluckd::msg_drop_ticket(ed::message & msg)
  */
 void cluckd::msg_get_max_ticket(ed::message & msg)
 {
-    std::string object_name;
-    ed::dispatcher_match::tag_t tag(ed::dispatcher_match::DISPATCHER_MATCH_NO_TAG);
-    std::string key;
-    if(!get_parameters(msg, &object_name, &tag, nullptr, nullptr, &key, nullptr))
+    params::get_max_ticket parameters;
+    if(!decode_parameters(msg, parameters))
     {
         return; // LCOV_EXCL_LINE
     }
+    std::string const & object_name(parameters.f_object_name);
+    ed::dispatcher_match::tag_t const tag(parameters.f_tag);
+    std::string const & key(parameters.f_key);
 
     // remove any f_tickets that timed out by now because these should
     // not be taken in account in the max. computation
     //
-    cleanup();
+    schedule_cleanup();
 
     ticket::ticket_id_t const last_ticket(get_last_ticket(object_name));
 
@@ -2763,7 +4105,7 @@ void cluckd::msg_lock(ed::message & msg)
 
     // do some cleanup as well
     //
-    cleanup();
+    schedule_cleanup();
 
     // if we are a leader, create an entering key
     //
@@ -2775,7 +4117,7 @@ void cluckd::msg_lock(ed::message & msg)
                                 ? msg.get_parameter(cluck::g_name_cluck_param_lock_proxy_service_name)
                                 : msg.get_sent_from_service());
 
-    std::string const entering_key(server_name + '/' + std::to_string(client_pid));
+    ticket_key const entering_key(atom(server_name), client_pid);
 
     if(timeout <= snapdev::now())
     {
@@ -2794,7 +4136,7 @@ void cluckd::msg_lock(ed::message & msg)
         lock_failed_message.reply_to(msg);
         lock_failed_message.add_parameter(cluck::g_name_cluck_param_object_name, object_name);
         lock_failed_message.add_parameter(cluck::g_name_cluck_param_tag, tag);
-        lock_failed_message.add_parameter(cluck::g_name_cluck_param_key, entering_key);
+        lock_failed_message.add_parameter(cluck::g_name_cluck_param_key, entering_key.to_string());
         lock_failed_message.add_parameter(cluck::g_name_cluck_param_error, cluck::g_name_cluck_value_timedout);
 #ifndef CLUCKD_OPTIMIZATIONS
         lock_failed_message.add_parameter(cluck::g_name_cluck_param_description, "LOCK timeout date is already in the past");
@@ -2821,7 +4163,7 @@ void cluckd::msg_lock(ed::message & msg)
         lock_failed_message.reply_to(msg);
         lock_failed_message.add_parameter(cluck::g_name_cluck_param_object_name, object_name);
         lock_failed_message.add_parameter(cluck::g_name_cluck_param_tag, tag);
-        lock_failed_message.add_parameter(cluck::g_name_cluck_param_key, entering_key);
+        lock_failed_message.add_parameter(cluck::g_name_cluck_param_key, entering_key.to_string());
         lock_failed_message.add_parameter(cluck::g_name_cluck_param_error, cluck::g_name_cluck_value_invalid);
 #ifndef CLUCKD_OPTIMIZATIONS
         lock_failed_message.add_parameter(cluck::g_name_cluck_param_description, "LOCK called with a duration that is too small");
@@ -2851,7 +4193,7 @@ void cluckd::msg_lock(ed::message & msg)
             lock_failed_message.reply_to(msg);
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_object_name, object_name);
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_tag, tag);
-            lock_failed_message.add_parameter(cluck::g_name_cluck_param_key, entering_key);
+            lock_failed_message.add_parameter(cluck::g_name_cluck_param_key, entering_key.to_string());
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_error, cluck::g_name_cluck_value_invalid);
 #ifndef CLUCKD_OPTIMIZATIONS
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_description, "LOCK called with an unlock duration that is too small");
@@ -2862,63 +4204,135 @@ void cluckd::msg_lock(ed::message & msg)
         }
     }
 
-    if(!is_daemon_ready())
+    // while the cached requests are being replayed, new requests wait
+    // in the cache as well so they do not get ahead of the older ones
+    //
+    if(!is_daemon_ready()
+    || (!f_replaying && !f_message_cache.empty()))
     {
         SNAP_LOG_TRACE
             << "caching LOCK message for \""
             << object_name
             << "\" ("
             << tag
-            << ") as the cluck system is not yet considered ready."
+            << ") as the cluck system is not yet considered ready or is still replaying its cache."
             << SNAP_LOG_SEND;
 
-        f_message_cache.emplace_back(timeout, msg);
+        message_cache::request const r(message_cache::request::from_message(msg, timeout));
 
-        // make sure the cache gets cleaned up if the message times out
-        //
-        std::int64_t const timeout_date(f_timer->get_timeout_date());
-        if(timeout_date == -1
-        || cluck::timeout_t(timeout_date / 1'000'000, timeout_date % 1'000'000) > timeout)
+        message_cache::request evicted;
+        if(f_message_cache.add(r, evicted))
         {
-            f_timer->set_timeout_date(timeout);
+            SNAP_LOG_WARNING
+                << "LOCK cache is full ("
+                << f_message_cache.get_limit()
+                << " requests); dropping the oldest request on \""
+                << evicted.f_object_name
+                << "\" ("
+                << evicted.f_tag
+                << ")."
+                << SNAP_LOG_SEND;
+
+            send_cached_lock_failed(
+                      evicted
+                    , cluck::g_name_cluck_value_overflow
+                    , "LOCK cache is full, oldest request dropped");
         }
-        return;
-    }
 
-    if(is_leader() == nullptr)
-    {
-        // we are not a leader, we need to forward the message to one
-        // of the leaders instead
+        // make sure the cache gets cleaned up if the message times out
         //
-        forward_message_to_leader(msg);
+        push_deadline(timeout);
         return;
     }
 
-    // make sure this is a new ticket
-    //
-    auto entering_ticket(f_entering_tickets.find(object_name));
-    if(entering_ticket != f_entering_tickets.end())
+    if(!is_object_leader(object_name))
     {
-        auto key_ticket(entering_ticket->second.find(entering_key));
-        if(key_ticket != entering_ticket->second.end())
+        // a leader already forwarded this LOCK from another group; the
+        // leaders do not agree on the groups (i.e. an election is in
+        // progress) so instead of bouncing the LOCK between the groups,
+        // we let the client try again
+        //
+        if(msg.has_parameter(cluck::g_name_cluck_param_forwarded))
         {
-            // if this is a re-LOCK, then it may be a legitimate duplicate
-            // in which case we do not want to generate a LOCK_FAILED error
-            //
-            if(msg.has_parameter(cluck::g_name_cluck_param_serial))
-            {
-                ticket::serial_t const serial(msg.get_integer_parameter(cluck::g_name_cluck_param_serial));
-                if(key_ticket->second->get_serial() == serial)
-                {
-                    // legitimate double request from leaders
-                    // (this happens when a leader dies and we have to restart
-                    // a lock negotiation)
-                    //
-                    return;
-                }
-            }
-
-            // the object already exists... do not allow duplicates
+            SNAP_LOG_WARNING
+                << "LOCK on \""
+                << object_name
+                << "\" ("
+                << tag
+                << ") was already forwarded by a leader of another group; not forwarding it again."
+                << SNAP_LOG_SEND;
+
+            ed::message lock_failed_message;
+            lock_failed_message.set_command(cluck::g_name_cluck_cmd_lock_failed);
+            lock_failed_message.set_server(server_name);
+            lock_failed_message.set_service(service_name);
+            lock_failed_message.add_parameter(cluck::g_name_cluck_param_object_name, object_name);
+            lock_failed_message.add_parameter(cluck::g_name_cluck_param_tag, tag);
+            lock_failed_message.add_parameter(cluck::g_name_cluck_param_key, entering_key.to_string());
+            lock_failed_message.add_parameter(cluck::g_name_cluck_param_error, cluck::g_name_cluck_value_failed);
+#ifndef CLUCKD_OPTIMIZATIONS
+            lock_failed_message.add_parameter(cluck::g_name_cluck_param_description, "LOCK forwarded between leader groups more than once");
+#endif
+            f_messenger->send_message(lock_failed_message);
+
+            return;
+        }
+
+        // a LOCK from a local client can be combined with the other local
+        // requests on the same object so only one ticket is requested
+        // from the leaders for this computer (see local_lock)
+        //
+        if(!msg.has_parameter(cluck::g_name_cluck_param_lock_proxy_server_name))
+        {
+            if(f_local_combining > 0)
+            {
+                local_lock::pointer_t & local(f_local_locks[object_name]);
+                if(local == nullptr)
+                {
+                    local = std::make_shared<local_lock>(this, f_messenger, object_name, f_local_combining);
+                }
+                local->lock(msg, tag, client_pid, timeout, duration, unlock_duration);
+                schedule_cleanup(local->get_next_timeout());
+                return;
+            }
+        }
+
+        // we are not a leader (of the group handling this object), we
+        // need to forward the message to one of the leaders instead
+        //
+        // Note: a leader of the correct group processes the LOCK even if
+        //       it is not the preferred leader of that object; this
+        //       avoids an extra hop for the clients running on leaders
+        //
+        forward_message_to_leader(msg);
+        return;
+    }
+
+    // make sure this is a new ticket
+    //
+    auto entering_ticket(f_entering_tickets.find(object_name));
+    if(entering_ticket != f_entering_tickets.end())
+    {
+        auto key_ticket(entering_ticket->second.find(entering_key));
+        if(key_ticket != entering_ticket->second.end())
+        {
+            // if this is a re-LOCK, then it may be a legitimate duplicate
+            // in which case we do not want to generate a LOCK_FAILED error
+            //
+            if(msg.has_parameter(cluck::g_name_cluck_param_serial))
+            {
+                ticket::serial_t const serial(msg.get_integer_parameter(cluck::g_name_cluck_param_serial));
+                if(key_ticket->second->get_serial() == serial)
+                {
+                    // legitimate double request from leaders
+                    // (this happens when a leader dies and we have to restart
+                    // a lock negotiation)
+                    //
+                    return;
+                }
+            }
+
+            // the object already exists... do not allow duplicates
             //
             SNAP_LOG_ERROR
                 << "an entering ticket has the same object name \""
@@ -2935,7 +4349,7 @@ void cluckd::msg_lock(ed::message & msg)
             lock_failed_message.reply_to(msg);
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_object_name, object_name);
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_tag, tag);
-            lock_failed_message.add_parameter(cluck::g_name_cluck_param_key, entering_key);
+            lock_failed_message.add_parameter(cluck::g_name_cluck_param_key, entering_key.to_string());
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_error, cluck::g_name_cluck_value_duplicate);
 #ifndef CLUCKD_OPTIMIZATIONS
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_description, "LOCK called with the same entering ticket object_name and entering_key");
@@ -2944,17 +4358,35 @@ void cluckd::msg_lock(ed::message & msg)
 
             return;
         }
-        if(entering_ticket->second.size() >= cluck::CLUCK_MAXIMUM_ENTERING_LOCKS)
+    }
+
+    // make sure the client is within its quotas; the requests sent again
+    // by the leaders (marked with "relock") were already accepted once
+    //
+    // Note: the "serial" parameter cannot be used for that purpose since
+    //       the cluck library always adds a serial number to its LOCK
+    //
+    if(!msg.has_parameter(cluck::g_name_cluck_param_relock))
+    {
+        cluck::timeout_t retry_after;
+        client_quota::result_t const quota(f_client_quota.check(
+                  server_name
+                , service_name
+                , snapdev::now()
+                , !f_admitting_backlog
+                , retry_after));
+        if(quota != client_quota::result_t::QUOTA_ACCEPTED)
         {
-            // this is a failure in the algorithm (unfortunately), if you
-            // send LOCK commands without much pause, the number of entering
-            // ticket can grow forever; the following is a way to avoid
-            // that situation by preventing such inconsiderate growth.
-            //
-            SNAP_LOG_ERROR
-                << "too many entering tickets for object name \""
+            SNAP_LOG_WARNING
+                << "client \""
+                << server_name
+                << '/'
+                << service_name
+                << "\" is over its "
+                << (quota == client_quota::result_t::QUOTA_RATE ? "LOCK rate" : "tickets")
+                << " quota, LOCK on \""
                 << object_name
-                << "\"."
+                << "\" refused."
                 << SNAP_LOG_SEND;
 
             ed::message lock_failed_message;
@@ -2962,10 +4394,14 @@ void cluckd::msg_lock(ed::message & msg)
             lock_failed_message.reply_to(msg);
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_object_name, object_name);
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_tag, tag);
-            lock_failed_message.add_parameter(cluck::g_name_cluck_param_key, entering_key);
-            lock_failed_message.add_parameter(cluck::g_name_cluck_param_error, cluck::g_name_cluck_value_overflow);
+            lock_failed_message.add_parameter(cluck::g_name_cluck_param_key, entering_key.to_string());
+            lock_failed_message.add_parameter(cluck::g_name_cluck_param_error, cluck::g_name_cluck_value_quota);
+            if(quota == client_quota::result_t::QUOTA_RATE)
+            {
+                lock_failed_message.add_parameter(cluck::g_name_cluck_param_retry_after, retry_after);
+            }
 #ifndef CLUCKD_OPTIMIZATIONS
-            lock_failed_message.add_parameter(cluck::g_name_cluck_param_description, "LOCK called too quickly that the number of entering tickets overflowed");
+            lock_failed_message.add_parameter(cluck::g_name_cluck_param_description, "LOCK refused, the client is over its quota");
 #endif
             f_messenger->send_message(lock_failed_message);
 
@@ -2973,6 +4409,58 @@ void cluckd::msg_lock(ed::message & msg)
         }
     }
 
+    // limit the number of entering tickets per object; when the limit is
+    // reached, the request waits in the backlog if there is room, otherwise
+    // it fails with a hint about when to try again
+    //
+    // this prevents the number of entering tickets from growing forever
+    // when LOCK commands are sent without much pause
+    //
+    std::size_t const entering_count(entering_ticket == f_entering_tickets.end()
+                                    ? 0
+                                    : entering_ticket->second.size());
+    f_admission.observe(object_name, entering_count, snapdev::now());
+    if(entering_count >= f_admission.get_object_limit(object_name)
+    || (!f_admitting_backlog && f_admission.has_backlog(object_name)))
+    {
+        if(f_admission.add_to_backlog(message_cache::request::from_message(msg, timeout)))
+        {
+            SNAP_LOG_TRACE
+                << "LOCK on \""
+                << object_name
+                << "\" ("
+                << tag
+                << ") waits in the backlog, too many entering tickets."
+                << SNAP_LOG_SEND;
+
+            // make sure the backlog gets cleaned up if the request times out
+            //
+            push_deadline(timeout);
+            return;
+        }
+
+        SNAP_LOG_ERROR
+            << "too many entering tickets for object name \""
+            << object_name
+            << "\"."
+            << SNAP_LOG_SEND;
+
+        ed::message lock_failed_message;
+        lock_failed_message.set_command(cluck::g_name_cluck_cmd_lock_failed);
+        lock_failed_message.reply_to(msg);
+        lock_failed_message.add_parameter(cluck::g_name_cluck_param_object_name, object_name);
+        lock_failed_message.add_parameter(cluck::g_name_cluck_param_tag, tag);
+        lock_failed_message.add_parameter(cluck::g_name_cluck_param_key, entering_key.to_string());
+        lock_failed_message.add_parameter(cluck::g_name_cluck_param_error, cluck::g_name_cluck_value_overflow);
+        lock_failed_message.add_parameter(cluck::g_name_cluck_param_retry_after, f_admission.get_retry_after(object_name, entering_count));
+#ifndef CLUCKD_OPTIMIZATIONS
+        lock_failed_message.add_parameter(cluck::g_name_cluck_param_description, "LOCK called too quickly that the number of entering tickets overflowed");
+#endif
+        f_messenger->send_message(lock_failed_message);
+
+        return;
+    }
+
     // make sure there is not a ticket with the same name already defined
     //
     // (this is is really important so we can actually properly UNLOCK an
@@ -3009,7 +4497,7 @@ void cluckd::msg_lock(ed::message & msg)
             lock_failed_message.reply_to(msg);
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_object_name, object_name);
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_tag, tag);
-            lock_failed_message.add_parameter(cluck::g_name_cluck_param_key, entering_key);
+            lock_failed_message.add_parameter(cluck::g_name_cluck_param_key, entering_key.to_string());
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_error, cluck::g_name_cluck_value_duplicate);
 #ifndef CLUCKD_OPTIMIZATIONS
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_description, "LOCK called with the same ticket object_name and entering_key");
@@ -3020,8 +4508,9 @@ void cluckd::msg_lock(ed::message & msg)
         }
     }
 
-    ticket::pointer_t ticket(std::make_shared<ticket>(
-                                  this
+    ticket::pointer_t ticket(std::allocate_shared<ticket>(
+                                  ticket_allocator<ticket>(f_ticket_pool)
+                                , this
                                 , f_messenger
                                 , object_name
                                 , tag
@@ -3032,6 +4521,14 @@ void cluckd::msg_lock(ed::message & msg)
                                 , service_name));
 
     f_entering_tickets[object_name][entering_key] = ticket;
+    f_admission.admitted(object_name);
+    ticket->set_quota_reservation(f_client_quota.reserve(server_name, service_name));
+    ticket->set_progress(msg.has_parameter(cluck::g_name_cluck_param_progress)
+                      && msg.get_integer_parameter(cluck::g_name_cluck_param_progress) != 0);
+    f_object_stats.queued(
+              object_name
+            , entering_count + 1
+                + (obj_ticket == f_tickets.end() ? 0 : obj_ticket->second.size()));
 
     // finish up ticket initialization
     //
@@ -3039,21 +4536,12 @@ void cluckd::msg_lock(ed::message & msg)
 
     // generate a serial number for that ticket
     //
-    f_ticket_serial = (f_ticket_serial + 1) & 0x00FFFFFF;   // 0 is a valid serial number (-1 is not)
-    if(f_leaders[0]->get_id() != f_my_id)
-    {
-        if(f_leaders.size() >= 2
-        && f_leaders[1]->get_id() != f_my_id)
-        {
-            f_ticket_serial |= 1 << 24;
-        }
-        else if(f_leaders.size() >= 3
-             && f_leaders[2]->get_id() != f_my_id)
-        {
-            f_ticket_serial |= 2 << 24;
-        }
-    }
-    ticket->set_serial(f_ticket_serial);
+    // the counter uses 56 bits and the top bits are the index of this
+    // leader within its group so two leaders never generate the same
+    // serial number
+    //
+    f_ticket_serial = (f_ticket_serial + 1) & ticket::SERIAL_COUNTER_MASK;   // 0 is a valid serial number (-1 is not)
+    ticket->set_serial(f_ticket_serial | f_serial_prefix);
 
     if(msg.has_parameter(cluck::g_name_cluck_param_serial))
     {
@@ -3070,7 +4558,7 @@ void cluckd::msg_lock(ed::message & msg)
         alive_message.set_command(ed::g_name_ed_cmd_alive);
         alive_message.set_server(server_name);
         alive_message.set_service(service_name);
-        alive_message.add_parameter(ed::g_name_ed_param_serial, "cluckd/" + object_name + '/' + entering_key);
+        alive_message.add_parameter(ed::g_name_ed_param_serial, "cluckd/" + object_name + '/' + entering_key.to_string());
         alive_message.add_parameter(ed::g_name_ed_param_timestamp, snapdev::now());
         f_messenger->send_message(alive_message);
     }
@@ -3083,7 +4571,7 @@ void cluckd::msg_lock(ed::message & msg)
 
     // the list of tickets changed, make sure we update the timeout timer
     //
-    cleanup();
+    schedule_cleanup(ticket->get_current_timeout_date());
 }
 
 
@@ -3097,21 +4585,21 @@ void cluckd::msg_lock(ed::message & msg)
  */
 void cluckd::msg_lock_activated(ed::message & msg)
 {
-    std::string object_name;
-    ed::dispatcher_match::tag_t tag(ed::dispatcher_match::DISPATCHER_MATCH_NO_TAG);
-    std::string key;
-    if(!get_parameters(msg, &object_name, &tag, nullptr, nullptr, &key, nullptr))
+    params::lock_activated parameters;
+    if(!decode_parameters(msg, parameters))
     {
         return; // LCOV_EXCL_LINE
     }
+    std::string const & object_name(parameters.f_object_name);
+    std::string const & key(parameters.f_key);
 
-    std::string const & other_key(msg.get_parameter(cluck::g_name_cluck_param_other_key));
-    if(other_key == key)
+    std::string const & other_key(parameters.f_other_key);
+    auto obj_ticket(f_tickets.find(object_name));
+    if(obj_ticket != f_tickets.end())
     {
-        auto obj_ticket(f_tickets.find(object_name));
-        if(obj_ticket != f_tickets.end())
+        if(other_key == key)
         {
-            auto key_ticket(obj_ticket->second.find(key));
+            auto key_ticket(obj_ticket->second.find(ticket_key(key)));
             if(key_ticket != obj_ticket->second.end())
             {
                 // that key is still here!
@@ -3120,6 +4608,13 @@ void cluckd::msg_lock_activated(ed::message & msg)
                 key_ticket->second->lock_activated();
             }
         }
+        else
+        {
+            // the other leader sees a different first ticket, the
+            // activation has to be attempted again on the next change
+            //
+            obj_ticket->second.set_head_activated(false);
+        }
     }
 }
 
@@ -3134,13 +4629,13 @@ void cluckd::msg_lock_activated(ed::message & msg)
  */
 void cluckd::msg_lock_entered(ed::message & msg)
 {
-    std::string object_name;
-    ed::dispatcher_match::tag_t tag(ed::dispatcher_match::DISPATCHER_MATCH_NO_TAG);
-    std::string key;
-    if(!get_parameters(msg, &object_name, &tag, nullptr, nullptr, &key, nullptr))
+    params::lock_entered parameters;
+    if(!decode_parameters(msg, parameters))
     {
         return; // LCOV_EXCL_LINE
     }
+    std::string const & object_name(parameters.f_object_name);
+    ticket_key const key(parameters.f_key);
 
     auto const obj_entering_ticket(f_entering_tickets.find(object_name));
     if(obj_entering_ticket != f_entering_tickets.end())
@@ -3175,15 +4670,19 @@ void cluckd::msg_lock_entered(ed::message & msg)
  */
 void cluckd::msg_lock_entering(ed::message & msg)
 {
-    std::string object_name;
-    ed::dispatcher_match::tag_t tag(ed::dispatcher_match::DISPATCHER_MATCH_NO_TAG);
-    cluck::timeout_t timeout;
-    std::string key;
-    std::string source;
-    if(!get_parameters(msg, &object_name, &tag, nullptr, &timeout, &key, &source))
+    params::lock_entering parameters;
+    if(!decode_parameters(msg, parameters))
     {
         return; // LCOV_EXCL_LINE
     }
+    std::string const & object_name(parameters.f_object_name);
+    ed::dispatcher_match::tag_t const tag(parameters.f_tag);
+    std::string const & key(parameters.f_key);
+    ticket_key const entering_key(key);
+    std::string const & source(parameters.f_source);
+    cluck::timeout_t const timeout(parameters.f_has_timeout
+                                    ? parameters.f_timeout
+                                    : snapdev::now() + cluck::get_lock_obtention_timeout());
 
     // lock still in the future?
     //
@@ -3215,7 +4714,7 @@ void cluckd::msg_lock_entering(ed::message & msg)
     auto const obj_ticket(f_entering_tickets.find(object_name));
     if(obj_ticket != f_entering_tickets.end())
     {
-        auto const key_ticket(obj_ticket->second.find(key));
+        auto const key_ticket(obj_ticket->second.find(entering_key));
         allocate = key_ticket == obj_ticket->second.end();
     }
     if(allocate)
@@ -3223,7 +4722,7 @@ void cluckd::msg_lock_entering(ed::message & msg)
         // ticket does not exist, so create it now
         // (note: ticket should only exist on originator)
         //
-        cluck::timeout_t const duration(msg.get_timespec_parameter(cluck::g_name_cluck_param_duration));
+        cluck::timeout_t const & duration(parameters.f_duration);
         if(duration < cluck::CLUCK_MINIMUM_TIMEOUT)
         {
             // invalid duration
@@ -3251,9 +4750,9 @@ void cluckd::msg_lock_entering(ed::message & msg)
         }
 
         cluck::timeout_t unlock_duration(cluck::CLUCK_DEFAULT_TIMEOUT);
-        if(msg.has_parameter(cluck::g_name_cluck_param_unlock_duration))
+        if(parameters.f_has_unlock_duration)
         {
-            unlock_duration = msg.get_timespec_parameter(cluck::g_name_cluck_param_unlock_duration);
+            unlock_duration = parameters.f_unlock_duration;
             if(unlock_duration != cluck::CLUCK_DEFAULT_TIMEOUT
             && unlock_duration < cluck::CLUCK_UNLOCK_MINIMUM_TIMEOUT)
             {
@@ -3310,24 +4809,25 @@ void cluckd::msg_lock_entering(ed::message & msg)
             return;
         }
 
-        ticket::pointer_t ticket(std::make_shared<ticket>(
-                                  this
+        ticket::pointer_t ticket(std::allocate_shared<ticket>(
+                                  ticket_allocator<ticket>(f_ticket_pool)
+                                , this
                                 , f_messenger
                                 , object_name
                                 , tag
-                                , key
+                                , entering_key
                                 , timeout
                                 , duration
                                 , source_segments[0]
                                 , source_segments[1]));
 
-        f_entering_tickets[object_name][key] = ticket;
+        f_entering_tickets[object_name][entering_key] = ticket;
 
         // finish up on ticket initialization
         //
         ticket->set_owner(msg.get_sent_from_server());
         ticket->set_unlock_duration(unlock_duration);
-        ticket->set_serial(msg.get_integer_parameter(cluck::g_name_cluck_param_serial));
+        ticket->set_serial(parameters.f_serial);
     }
 
     ed::message reply;
@@ -3338,7 +4838,7 @@ void cluckd::msg_lock_entering(ed::message & msg)
     reply.add_parameter(cluck::g_name_cluck_param_key, key);
     f_messenger->send_message(reply);
 
-    cleanup();
+    schedule_cleanup(timeout);
 }
 
 
@@ -3352,13 +4852,13 @@ void cluckd::msg_lock_entering(ed::message & msg)
  */
 void cluckd::msg_lock_exiting(ed::message & msg)
 {
-    std::string object_name;
-    ed::dispatcher_match::tag_t tag(ed::dispatcher_match::DISPATCHER_MATCH_NO_TAG);
-    std::string key;
-    if(!get_parameters(msg, &object_name, &tag, nullptr, nullptr, &key, nullptr))
+    params::lock_exiting parameters;
+    if(!decode_parameters(msg, parameters))
     {
         return; // LCOV_EXCL_LINE
     }
+    std::string const & object_name(parameters.f_object_name);
+    ticket_key const key(parameters.f_key);
 
     // when exiting we just remove the entry with that key
     //
@@ -3433,10 +4933,10 @@ void cluckd::msg_lock_exiting(ed::message & msg)
             << SNAP_LOG_SEND;
     }
 
-    // the list of tickets is not unlikely changed so we need to make
-    // a call to cleanup to make sure the timer is reset appropriately
+    // tickets may have been removed, update the other tickets of that
+    // object (the removal itself does not bring any deadline closer)
     //
-    cleanup();
+    tickets_changed(object_name);
 }
 
 
@@ -3474,6 +4974,23 @@ void cluckd::msg_lock_failed(ed::message & msg)
     {
         return; // LCOV_EXCL_LINE
     }
+    ticket_key const parsed_key(key);
+
+    // the failure may be about the ticket of one of our local locks
+    //
+    local_lock::pointer_t local(find_local_lock(object_name, tag));
+    if(local != nullptr
+    && parsed_key.get_entering_key() == local->get_entering_key())
+    {
+        local->node_lock_failed(msg);
+        schedule_cleanup(local->get_next_timeout());
+        return;
+    }
+
+    if(relay_to_local_client(msg, object_name, tag, true))
+    {
+        return;
+    }
 
     std::string errmsg("get LOCK_FAILED: ");
     errmsg += msg.get_parameter("error");
@@ -3486,7 +5003,7 @@ void cluckd::msg_lock_failed(ed::message & msg)
     auto obj_entering(f_entering_tickets.find(object_name));
     if(obj_entering != f_entering_tickets.end())
     {
-        auto key_entering(obj_entering->second.find(key));
+        auto key_entering(obj_entering->second.find(parsed_key));
         if(key_entering != obj_entering->second.end())
         {
             forward_server = key_entering->second->get_server_name();
@@ -3509,15 +5026,15 @@ void cluckd::msg_lock_failed(ed::message & msg)
     if(obj_ticket != f_tickets.end())
     {
         bool try_activate(false);
-        auto key_ticket(obj_ticket->second.find(key));
+        auto key_ticket(obj_ticket->second.find(parsed_key));
         if(key_ticket == obj_ticket->second.end())
         {
             key_ticket = std::find_if(
                       obj_ticket->second.begin()
                     , obj_ticket->second.end()
-                    , [&key](auto const & t)
+                    , [&parsed_key](auto const & t)
                     {
-                        return t.second->get_entering_key() == key;
+                        return t.second->get_entering_key() == parsed_key;
                     });
         }
         if(key_ticket != obj_ticket->second.end())
@@ -3568,10 +5085,10 @@ void cluckd::msg_lock_failed(ed::message & msg)
         << '.'
         << SNAP_LOG_SEND;
 
-    // the list of tickets is not unlikely changed so we need to make
-    // a call to cleanup to make sure the timer is reset appropriately
+    // tickets may have been removed, update the other tickets of that
+    // object (the removal itself does not bring any deadline closer)
     //
-    cleanup();
+    tickets_changed(object_name);
 }
 
 
@@ -3587,52 +5104,11 @@ void cluckd::msg_lock_leaders(ed::message & msg)
 
     // save the new leaders in our own list
     //
-    f_leaders.clear();
-    for(int idx(0); idx < 3; ++idx)
-    {
-        std::string const param_name(cluck::g_name_cluck_param_leader + std::to_string(idx));
-        if(msg.has_parameter(param_name))
-        {
-            computer::pointer_t leader(std::make_shared<computer>());
-            std::string const lockid(msg.get_parameter(param_name));
-            if(leader->set_id(lockid))
-            {
-                computer::map_t::iterator exists(f_computers.find(leader->get_name()));
-                if(exists != f_computers.end())
-                {
-                    // it already exists, use our existing instance
-                    //
-                    f_leaders.push_back(exists->second);
-                }
-                else
-                {
-                    // we do not yet know of that computer, even though
-                    // it is a leader! (i.e. we are not yet aware that
-                    // somehow we are connected to it)
-                    //
-                    leader->set_connected(false);
-                    f_computers[leader->get_name()] = leader;
-
-                    f_leaders.push_back(leader);
-                }
-            }
-        }
-    }
+    load_leaders(msg);
 
     if(!f_leaders.empty())
     {
         synchronize_leaders();
-
-        // set the round-robin position to a random value
-        //
-        // note: I know the result is likely skewed, c will be set to
-        // a number between 0 and 255 and modulo 3 means that you get
-        // one extra zero (255 % 3 == 0); however, there are 85 times
-        // 3 in 255 so it probably won't be noticeable.
-        //
-        std::uint8_t c;
-        RAND_bytes(reinterpret_cast<unsigned char *>(&c), sizeof(c));
-        f_next_leader = c % f_leaders.size();
     }
 
     // the is_daemon_ready() function depends on having f_leaders defined
@@ -3642,6 +5118,40 @@ void cluckd::msg_lock_leaders(ed::message & msg)
 }
 
 
+/** \brief Relay the progress of a lock request to a local client.
+ *
+ * The leader owning a ticket sends the LOCK_PROGRESS messages to the
+ * server and service which sent the LOCK. When a local client connected
+ * through our Unix socket requested the lock, that service is us and
+ * the message gets relayed to that client.
+ *
+ * Other LOCK_PROGRESS messages arrive late (i.e. after the LOCKED or
+ * LOCK_FAILED replies) and are ignored.
+ *
+ * \param[in] msg  The LOCK_PROGRESS message.
+ */
+void cluckd::msg_lock_progress(ed::message & msg)
+{
+    std::string object_name;
+    ed::dispatcher_match::tag_t tag(ed::dispatcher_match::DISPATCHER_MATCH_NO_TAG);
+    if(!get_parameters(msg, &object_name, &tag, nullptr, nullptr, nullptr, nullptr))
+    {
+        return; // LCOV_EXCL_LINE
+    }
+
+    if(!relay_to_local_client(msg, object_name, tag, false))
+    {
+        SNAP_LOG_TRACE
+            << "received a LOCK_PROGRESS for \""
+            << object_name
+            << "\" ("
+            << tag
+            << ") which is not a request of a local client."
+            << SNAP_LOG_SEND;
+    }
+}
+
+
 /** \brief Called whenever a cluck computer is acknowledging itself.
  *
  * This function gets called on a LOCK_STARTED event which is sent whenever
@@ -3738,36 +5248,7 @@ void cluckd::msg_lock_started(ed::message & msg)
 
     if(f_leaders.empty())
     {
-        for(int idx(0); idx < 3; ++idx)
-        {
-            std::string const param_name(cluck::g_name_cluck_param_leader + std::to_string(idx));
-            if(msg.has_parameter(param_name))
-            {
-                computer::pointer_t leader(std::make_shared<computer>());
-                std::string const lockid(msg.get_parameter(param_name));
-                if(leader->set_id(lockid))
-                {
-                    computer::map_t::iterator exists(f_computers.find(leader->get_name()));
-                    if(exists != f_computers.end())
-                    {
-                        // it already exists, use our existing instance
-                        //
-                        f_leaders.push_back(exists->second);
-                    }
-                    else
-                    {
-                        // we do not yet know of that computer, even though
-                        // it is a leader! (i.e. we are not yet aware that
-                        // somehow we are connected to it)
-                        //
-                        leader->set_connected(false);
-                        f_computers[leader->get_name()] = leader;
-
-                        f_leaders.push_back(leader);
-                    }
-                }
-            }
-        }
+        load_leaders(msg);
     }
 
     election_status();
@@ -3836,6 +5317,7 @@ void cluckd::msg_lock_tickets(ed::message & msg)
     // work on lines one at a time
     //
     bool added_tickets(false);
+    cluck::timeout_t deadline(snapdev::timespec_ex::max());
     std::list<std::string> lines;
     snapdev::tokenize_string(lines, tickets, "\n", true);
     for(auto const & l : lines)
@@ -3864,7 +5346,7 @@ void cluckd::msg_lock_tickets(ed::message & msg)
                 // extract the values which start after the '=' sign
                 //
                 std::string const object_name(object_name_value->substr(12));
-                std::string const entering_key(entering_key_value->substr(13));
+                ticket_key const entering_key(std::string_view(*entering_key_value).substr(13));
 
                 auto entering_ticket(f_entering_tickets.find(object_name));
                 if(entering_ticket != f_entering_tickets.end())
@@ -3903,8 +5385,9 @@ void cluckd::msg_lock_tickets(ed::message & msg)
                     // because they are required; they will be replaced by the
                     // unserialize call below...
                     //
-                    t = std::make_shared<ticket>(
-                                  this
+                    t = std::allocate_shared<ticket>(
+                                  ticket_allocator<ticket>(f_ticket_pool)
+                                , this
                                 , f_messenger
                                 , object_name
                                 , ed::dispatcher_match::DISPATCHER_MATCH_NO_TAG
@@ -3917,6 +5400,7 @@ void cluckd::msg_lock_tickets(ed::message & msg)
 
                 t->unserialize(l);
                 added_tickets = true;
+                deadline = std::min(deadline, t->get_current_timeout_date());
 
                 // do a couple of additional sanity tests to
                 // make sure that we want to keep new tickets
@@ -3936,7 +5420,7 @@ void cluckd::msg_lock_tickets(ed::message & msg)
                             , f_leaders.end()
                             , [&t](auto const & c)
                             {
-                                return t->get_owner() == c->get_name();
+                                return t->get_owner() == c->get_name_atom();
                             }));
                     if(li != f_leaders.end())
                     {
@@ -3952,8 +5436,49 @@ void cluckd::msg_lock_tickets(ed::message & msg)
     //
     if(added_tickets)
     {
-        cleanup();
+        schedule_cleanup(deadline);
+    }
+}
+
+
+/** \brief The ticket of a local lock was obtained.
+ *
+ * When local combining is turned on (see the `local-combining` option),
+ * this cluck daemon requests tickets from the leaders on behalf of its
+ * local clients. The leaders reply with a LOCKED message which is
+ * handled here by the corresponding local lock.
+ *
+ * \param[in] msg  The LOCKED message.
+ */
+void cluckd::msg_locked(ed::message & msg)
+{
+    std::string object_name;
+    ed::dispatcher_match::tag_t tag(ed::dispatcher_match::DISPATCHER_MATCH_NO_TAG);
+    if(!get_parameters(msg, &object_name, &tag, nullptr, nullptr, nullptr, nullptr))
+    {
+        return; // LCOV_EXCL_LINE
+    }
+
+    local_lock::pointer_t local(find_local_lock(object_name, tag));
+    if(local == nullptr)
+    {
+        if(relay_to_local_client(msg, object_name, tag, false))
+        {
+            return;
+        }
+
+        SNAP_LOG_WARNING
+            << "received a LOCKED for \""
+            << object_name
+            << "\" ("
+            << tag
+            << ") which does not match any local lock."
+            << SNAP_LOG_SEND;
+        return;
     }
+
+    local->node_locked(msg);
+    schedule_cleanup(local->get_next_timeout());
 }
 
 
@@ -3977,13 +5502,13 @@ void cluckd::msg_lock_tickets(ed::message & msg)
  */
 void cluckd::msg_max_ticket(ed::message & msg)
 {
-    std::string object_name;
-    ed::dispatcher_match::tag_t tag(ed::dispatcher_match::DISPATCHER_MATCH_NO_TAG);
-    std::string key;
-    if(!get_parameters(msg, &object_name, &tag, nullptr, nullptr, &key, nullptr))
+    params::max_ticket parameters;
+    if(!decode_parameters(msg, parameters))
     {
         return; // LCOV_EXCL_LINE
     }
+    std::string const & object_name(parameters.f_object_name);
+    ticket_key const key(parameters.f_key);
 
     // the MAX_TICKET is an answer that has to go in a still un-added ticket
     //
@@ -3993,7 +5518,7 @@ void cluckd::msg_max_ticket(ed::message & msg)
         auto const key_entering_ticket(obj_entering_ticket->second.find(key));
         if(key_entering_ticket != obj_entering_ticket->second.end())
         {
-            key_entering_ticket->second->max_ticket(msg.get_integer_parameter(cluck::g_name_cluck_param_ticket_id));
+            key_entering_ticket->second->max_ticket(parameters.f_ticket_id);
         }
     }
 }
@@ -4064,6 +5589,7 @@ SNAP_LOG_WARNING << "removed \"" << server_name << "\"" << SNAP_LOG_SEND;
     if(li != f_leaders.end())
     {
         f_leaders.erase(li);
+        update_leader_cache();
 
         if(f_messenger != nullptr)
         {
@@ -4133,13 +5659,13 @@ void cluckd::msg_status(ed::message & msg)
  */
 void cluckd::msg_ticket_added(ed::message & msg)
 {
-    std::string object_name;
-    ed::dispatcher_match::tag_t tag(ed::dispatcher_match::DISPATCHER_MATCH_NO_TAG);
-    std::string key;
-    if(!get_parameters(msg, &object_name, &tag, nullptr, nullptr, &key, nullptr))
+    params::ticket_added parameters;
+    if(!decode_parameters(msg, parameters))
     {
         return; // LCOV_EXCL_LINE
     }
+    std::string const & object_name(parameters.f_object_name);
+    ticket_key const key(parameters.f_key);
 
     auto const obj_ticket(f_tickets.find(object_name));
     if(obj_ticket != f_tickets.end())
@@ -4209,7 +5735,7 @@ void cluckd::msg_ticket_ready(ed::message & msg)
     auto obj_ticket(f_tickets.find(object_name));
     if(obj_ticket != f_tickets.end())
     {
-        auto key_ticket(obj_ticket->second.find(key));
+        auto key_ticket(obj_ticket->second.find(ticket_key(key)));
         if(key_ticket != obj_ticket->second.end())
         {
             // we can mark this ticket as activated
@@ -4238,15 +5764,6 @@ void cluckd::msg_unlock(ed::message & msg)
         return;
     }
 
-    if(is_leader() == nullptr)
-    {
-        // we are not a leader, we need to forward to a leader to handle
-        // the message properly
-        //
-        forward_message_to_leader(msg);
-        return;
-    }
-
     std::string object_name;
     ed::dispatcher_match::tag_t tag(ed::dispatcher_match::DISPATCHER_MATCH_NO_TAG);
     pid_t client_pid(0);
@@ -4255,20 +5772,57 @@ void cluckd::msg_unlock(ed::message & msg)
         return;
     }
 
-    // if the ticket still exists, send the UNLOCKED and then erase it
+    // the lock may have been granted by our local lock
     //
-    auto obj_ticket(f_tickets.find(object_name));
-    if(obj_ticket != f_tickets.end())
+    if(!msg.has_parameter(cluck::g_name_cluck_param_lock_proxy_server_name))
     {
-        std::string const server_name(msg.has_parameter("lock_proxy_server_name")
-                                    ? msg.get_parameter("lock_proxy_server_name")
-                                    : msg.get_sent_from_server());
-
+        auto local(f_local_locks.find(object_name));
+        if(local != f_local_locks.end()
+        && local->second->unlock(msg.get_sent_from_server(), client_pid))
+        {
+            schedule_cleanup(local->second->get_next_timeout());
+            return;
+        }
+    }
+
+    if(!is_object_leader(object_name))
+    {
+        // see msg_lock() about the forwarded parameter; the ticket, if
+        // any, times out in this case
+        //
+        if(msg.has_parameter(cluck::g_name_cluck_param_forwarded))
+        {
+            SNAP_LOG_WARNING
+                << "UNLOCK on \""
+                << object_name
+                << "\" ("
+                << tag
+                << ") was already forwarded by a leader of another group; not forwarding it again."
+                << SNAP_LOG_SEND;
+            return;
+        }
+
+        // we are not a leader (of the group handling this object), we
+        // need to forward to a leader to handle the message properly
+        //
+        forward_message_to_leader(msg);
+        return;
+    }
+
+    // if the ticket still exists, send the UNLOCKED and then erase it
+    //
+    auto obj_ticket(f_tickets.find(object_name));
+    if(obj_ticket != f_tickets.end())
+    {
+        std::string const server_name(msg.has_parameter("lock_proxy_server_name")
+                                    ? msg.get_parameter("lock_proxy_server_name")
+                                    : msg.get_sent_from_server());
+
         //std::string const service_name(msg.has_parameter("lock_proxy_service_name")
         //                            ? msg.get_parameter("lock_proxy_service_name")
         //                            : msg.get_sent_from_service());
 
-        std::string const entering_key(server_name + '/' + std::to_string(client_pid));
+        ticket_key const entering_key(atom(server_name), client_pid);
         auto key_ticket(std::find_if(
                   obj_ticket->second.begin()
                 , obj_ticket->second.end()
@@ -4283,6 +5837,7 @@ void cluckd::msg_unlock(ed::message & msg)
             // UNLOCKED which gets sent at most once.)
             //
             key_ticket->second->drop_ticket();
+            record_hold(key_ticket->second, snapdev::now());
 
             obj_ticket->second.erase(key_ticket);
             if(obj_ticket->second.empty())
@@ -4319,9 +5874,588 @@ void cluckd::msg_unlock(ed::message & msg)
             << SNAP_LOG_SEND;
     }
 
-    // reset the timeout with the other locks
+    // the ticket was removed, update the other tickets of that object
     //
-    cleanup();
+    tickets_changed(object_name);
+}
+
+
+/** \brief The ticket of a local lock was released.
+ *
+ * This message is the reply to the UNLOCK of a local lock ticket or
+ * the leaders letting us know that the ticket timed out.
+ *
+ * \param[in] msg  The UNLOCKED message.
+ */
+void cluckd::msg_unlocked(ed::message & msg)
+{
+    std::string object_name;
+    ed::dispatcher_match::tag_t tag(ed::dispatcher_match::DISPATCHER_MATCH_NO_TAG);
+    if(!get_parameters(msg, &object_name, &tag, nullptr, nullptr, nullptr, nullptr))
+    {
+        return; // LCOV_EXCL_LINE
+    }
+
+    local_lock::pointer_t local(find_local_lock(object_name, tag));
+    if(local == nullptr)
+    {
+        if(relay_to_local_client(msg, object_name, tag, true))
+        {
+            return;
+        }
+
+        SNAP_LOG_WARNING
+            << "received an UNLOCKED for \""
+            << object_name
+            << "\" ("
+            << tag
+            << ") which does not match any local lock."
+            << SNAP_LOG_SEND;
+        return;
+    }
+
+    local->node_unlocked(msg);
+    schedule_cleanup(local->get_next_timeout());
+}
+
+
+/** \brief The ticket of a local lock is timing out.
+ *
+ * The leaders send this message when the duration of a local lock
+ * ticket elapsed. The local client currently holding the lock is asked
+ * to release it.
+ *
+ * \param[in] msg  The UNLOCKING message.
+ */
+void cluckd::msg_unlocking(ed::message & msg)
+{
+    std::string object_name;
+    ed::dispatcher_match::tag_t tag(ed::dispatcher_match::DISPATCHER_MATCH_NO_TAG);
+    if(!get_parameters(msg, &object_name, &tag, nullptr, nullptr, nullptr, nullptr))
+    {
+        return; // LCOV_EXCL_LINE
+    }
+
+    local_lock::pointer_t local(find_local_lock(object_name, tag));
+    if(local != nullptr)
+    {
+        local->node_unlocking(msg);
+        return;
+    }
+
+    relay_to_local_client(msg, object_name, tag, false);
+}
+
+
+/** \brief Search for a local lock.
+ *
+ * This function searches the local lock handling \p object_name. The
+ * \p tag must also match the tag of the current ticket of that local
+ * lock, otherwise the message is considered out of date.
+ *
+ * \param[in] object_name  The name of the object of the local lock.
+ * \param[in] tag  The tag found in the message.
+ *
+ * \return The local lock or nullptr if not found.
+ */
+local_lock::pointer_t cluckd::find_local_lock(
+      std::string const & object_name
+    , ed::dispatcher_match::tag_t tag) const
+{
+    auto it(f_local_locks.find(object_name));
+    if(it == f_local_locks.end()
+    || it->second->get_tag() != tag)
+    {
+        return local_lock::pointer_t();
+    }
+    return it->second;
+}
+
+
+/** \brief Register a client connected to our Unix socket.
+ *
+ * The local listener calls this function each time a new client
+ * connects. The client gets added to the communicator and is
+ * remembered by service name so replies can be sent to it.
+ *
+ * \param[in] client  The new local client.
+ */
+void cluckd::add_local_client(local_client::pointer_t client)
+{
+    f_local_clients[client->get_service_name()] = client;
+    f_communicator->add_connection(client);
+}
+
+
+/** \brief Forget about a local client.
+ *
+ * This function is called when a local client disconnects. The
+ * connection is removed from the communicator and the replies of the
+ * requests that were forwarded on its behalf will be dropped.
+ *
+ * \note
+ * The tickets of that client are not released here. Just like with a
+ * client connected through the communicator daemon, they time out.
+ *
+ * \param[in] service_name  The service name of the local client.
+ */
+void cluckd::remove_local_client(std::string const & service_name)
+{
+    auto it(f_local_clients.find(service_name));
+    if(it == f_local_clients.end())
+    {
+        return;
+    }
+    local_client::pointer_t client(it->second.lock());
+    f_local_clients.erase(it);
+    if(client != nullptr
+    && f_communicator != nullptr)
+    {
+        f_communicator->remove_connection(client);
+    }
+
+    f_local_forwards.remove_service(service_name);
+}
+
+
+/** \brief Send a message to a local client.
+ *
+ * The messenger calls this function before sending a message to the
+ * communicator daemon. If the message is addressed to one of the clients
+ * connected to our Unix socket, it gets sent directly to that client.
+ *
+ * If the client is gone, the message is dropped.
+ *
+ * \param[in] msg  The message to send.
+ *
+ * \return true if the message was addressed to a local client.
+ */
+bool cluckd::send_local_message(ed::message & msg)
+{
+    if(f_local_clients.empty())
+    {
+        return false;
+    }
+
+    std::string const & server_name(msg.get_server());
+    if(!server_name.empty()
+    && server_name != f_server_name)
+    {
+        return false;
+    }
+
+    auto it(f_local_clients.find(msg.get_service()));
+    if(it == f_local_clients.end())
+    {
+        return false;
+    }
+
+    local_client::pointer_t client(it->second.lock());
+    if(client != nullptr)
+    {
+        client->send_message(msg);
+    }
+
+    return true;
+}
+
+
+/** \brief Relay a reply to a local client.
+ *
+ * When we forward a request from a local client to a leader, the
+ * leader replies to us (see forward_message_to_leader()). This function
+ * sends that reply to the local client which made the request.
+ *
+ * Several local clients may use the same tag on the same object so the
+ * request is searched using the process identifier found in the reply
+ * as well (see local_forwards::get_reply_pid()).
+ *
+ * \param[in] msg  The reply received from a leader.
+ * \param[in] object_name  The name of the object concerned.
+ * \param[in] tag  The tag of the request.
+ * \param[in] done  Whether this reply ends the request.
+ *
+ * \return true if the message was relayed.
+ */
+bool cluckd::relay_to_local_client(
+      ed::message & msg
+    , std::string const & object_name
+    , ed::dispatcher_match::tag_t tag
+    , bool done)
+{
+    pid_t const pid(local_forwards::get_reply_pid(msg));
+    std::string const service_name(f_local_forwards.find(pid, object_name, tag));
+    if(service_name.empty())
+    {
+        return false;
+    }
+
+    msg.set_server(f_server_name);
+    msg.set_service(service_name);
+    f_messenger->send_message(msg);
+
+    if(done)
+    {
+        f_local_forwards.remove(pid, object_name, tag);
+    }
+
+    return true;
+}
+
+
+/** \brief Update the direct connections between leaders.
+ *
+ * When the `leader-mesh-port` option is set, the leaders of a group
+ * connect to each other directly. This function is called each time
+ * the list of leaders changes. It creates the connections to the new
+ * leaders of our group and removes the connections to the computers
+ * which are not leaders of our group anymore. This includes the
+ * connections those computers opened to our listener (see
+ * close_demoted_leader_clients()). If we are not a leader, all the
+ * connections get removed.
+ *
+ * The listener is created the first time we become a leader and kept
+ * until the daemon stops.
+ *
+ * When the `leader-mesh-certificate` and `leader-mesh-private-key`
+ * options are both defined, the connections use TLS.
+ */
+void cluckd::update_leader_mesh()
+{
+    std::int64_t const port(f_opts.get_long("leader-mesh-port", 0, 0, 65535));
+    if(port == 0
+    || f_communicator == nullptr)
+    {
+        return;
+    }
+
+    std::string const certificate(f_opts.get_string("leader-mesh-certificate"));
+    std::string const private_key(f_opts.get_string("leader-mesh-private-key"));
+    bool const secure(!certificate.empty() && !private_key.empty());
+
+    computer::vector_t peers;
+    computer::pointer_t const self(is_leader());
+    if(self != nullptr)
+    {
+        peers = get_group_leaders(self->get_leader_group());
+
+        if(f_leader_listener == nullptr
+        && !f_my_ip_address.is_default())
+        {
+            addr::addr address(f_my_ip_address);
+            address.set_port(port);
+            f_leader_listener = std::make_shared<leader_listener>(this, address, certificate, private_key);
+            f_communicator->add_connection(f_leader_listener);
+        }
+    }
+
+    leader_connection::map_t connections;
+    for(auto const & p : peers)
+    {
+        if(p->is_self()
+        || p->get_ip_address().is_default())
+        {
+            continue;
+        }
+
+        addr::addr address(p->get_ip_address());
+        address.set_port(port);
+
+        auto it(f_leader_connections.find(p->get_name()));
+        if(it != f_leader_connections.end()
+        && it->second->get_address() == address)
+        {
+            connections[it->first] = it->second;
+            f_leader_connections.erase(it);
+            continue;
+        }
+
+        leader_connection::pointer_t c(std::make_shared<leader_connection>(p->get_name(), address, secure));
+        f_communicator->add_connection(c);
+        connections[p->get_name()] = c;
+    }
+
+    // whatever is left is not a leader of our group anymore
+    //
+    for(auto const & c : f_leader_connections)
+    {
+        f_communicator->remove_connection(c.second);
+    }
+    f_leader_connections.swap(connections);
+
+    close_demoted_leader_clients();
+}
+
+
+/** \brief Register a connection from another leader.
+ *
+ * The leader listener calls this function each time another leader
+ * connects to us. The client gets added to the communicator and is
+ * remembered so it can be closed if that computer stops being one of
+ * the leaders of our group.
+ *
+ * \param[in] client  The new leader client.
+ */
+void cluckd::add_leader_client(leader_client::pointer_t client)
+{
+    f_leader_clients.push_back(client);
+    f_communicator->add_connection(client);
+}
+
+
+/** \brief Close the connections from computers which are not our leaders.
+ *
+ * The listener verifies the address of a new connection only when it
+ * accepts it. After an election, a computer which was one of the leaders
+ * of our group may not be a leader anymore (or be a leader of another
+ * group). Its connection is closed here. The connections already closed
+ * by the other side are forgotten.
+ */
+void cluckd::close_demoted_leader_clients()
+{
+    auto it(f_leader_clients.begin());
+    while(it != f_leader_clients.end())
+    {
+        leader_client::pointer_t client(it->lock());
+        if(client == nullptr)
+        {
+            it = f_leader_clients.erase(it);
+            continue;
+        }
+
+        if(!is_leader_address(client->get_peer()))
+        {
+            SNAP_LOG_INFO
+                << "closing leader mesh connection from \""
+                << client->get_peer().to_ipv4or6_string(addr::STRING_IP_ADDRESS | addr::STRING_IP_BRACKET_ADDRESS)
+                << "\" which is not one of our leaders anymore."
+                << SNAP_LOG_SEND;
+            it = f_leader_clients.erase(it);
+            if(f_communicator != nullptr)
+            {
+                f_communicator->remove_connection(client);
+            }
+            continue;
+        }
+
+        ++it;
+    }
+}
+
+
+/** \brief Get the delay used to batch messages to the other leaders.
+ *
+ * This function is called for each message sent so the value of the
+ * option is read only once.
+ *
+ * \return The delay in microseconds or -1 if batching is turned off.
+ *
+ * \sa messenger::batch_message()
+ */
+std::int64_t cluckd::get_batch_delay()
+{
+    if(f_batch_delay < -1)
+    {
+        f_batch_delay = f_opts.get_long("batch-delay", 0, -1, 100'000);
+    }
+    return f_batch_delay;
+}
+
+
+/** \brief Get the statistics of the objects being locked.
+ *
+ * The tickets update these statistics as they go through the bakery
+ * algorithm (see ticket::lock_activated(), ticket::drop_ticket() and
+ * ticket::lock_failed()). The INFO message reports the hottest objects
+ * when its mode is "hot".
+ *
+ * \return A reference to the object statistics.
+ */
+object_stats & cluckd::get_object_stats()
+{
+    return f_object_stats;
+}
+
+
+/** \brief Get the statistics of the phases of the locks.
+ *
+ * Each ticket records the date of its transitions through the bakery
+ * algorithm (see lock_trace). When a ticket obtains its lock, the
+ * duration of each phase is added to these statistics. The INFO message
+ * reports them.
+ *
+ * \return A reference to the lock phases statistics.
+ */
+lock_phases & cluckd::get_lock_phases()
+{
+    return f_lock_phases;
+}
+
+
+/** \brief Send a message directly to another leader.
+ *
+ * The messenger calls this function before sending a message to the
+ * communicator daemon. If the message is part of the inter-leader
+ * protocol and we have a live connection to the destination leader,
+ * the message is sent over that connection.
+ *
+ * \param[in] msg  The message to send.
+ *
+ * \return true if the message was sent to the other leader.
+ */
+bool cluckd::send_leader_message(ed::message & msg)
+{
+    advgetopt::string_list_t servers{ msg.get_server() };
+    return multicast_leader_message(msg, servers) > 0;
+}
+
+
+/** \brief Send one message directly to several leaders.
+ *
+ * This function sends \p msg to each leader found in \p servers which
+ * is reachable through the leader mesh. Those servers are removed from
+ * the \p servers list so the caller can send the message to the
+ * remaining ones through the communicator daemon.
+ *
+ * A connection is used only once it has been up for a little while
+ * (see leader_connection::is_ready()) so the switch from the
+ * communicator daemon to the mesh does not reorder the messages.
+ *
+ * The mesh connections are point to point so the message does not
+ * need to name its destination. The server name gets cleared once
+ * before the first send. The message then remains unchanged between
+ * sends and its serialized form, which the message caches, is reused
+ * for each leader.
+ *
+ * \param[in,out] msg  The message to send.
+ * \param[in,out] servers  The names of the destination leaders.
+ *
+ * \return The number of leaders the message was sent to.
+ */
+std::size_t cluckd::multicast_leader_message(
+      ed::message & msg
+    , advgetopt::string_list_t & servers)
+{
+    if(f_leader_connections.empty()
+    || msg.get_service() != cluck::g_name_cluck_service_name
+    || !leader_client::get_commands().contains(msg.get_command()))
+    {
+        return 0;
+    }
+
+    snapdev::timespec_ex const now(snapdev::now());
+    std::size_t count(0);
+    bool prepared(false);
+    for(auto s(servers.begin()); s != servers.end(); )
+    {
+        auto it(f_leader_connections.find(*s));
+        if(it != f_leader_connections.end()
+        && it->second->is_ready(now))
+        {
+            if(!prepared)
+            {
+                msg.set_server(std::string());
+                msg.set_sent_from_server(f_server_name);
+                msg.set_sent_from_service(cluck::g_name_cluck_service_name);
+                prepared = true;
+            }
+            if(it->second->send_message(msg))
+            {
+                ++count;
+                s = servers.erase(s);
+                continue;
+            }
+        }
+        ++s;
+    }
+
+    return count;
+}
+
+
+/** \brief Check whether an address is the address of another leader.
+ *
+ * The leader mesh only accepts connections from the other leaders of
+ * our group. This function compares the IP address of the peer (the
+ * port is ignored) against the IP addresses of those leaders.
+ *
+ * \param[in] address  The address of the peer.
+ *
+ * \return true if \p address is the IP address of one of the other
+ * leaders of our group.
+ */
+bool cluckd::is_leader_address(addr::addr const & address) const
+{
+    computer::pointer_t const self(is_leader());
+    if(self == nullptr)
+    {
+        return false;
+    }
+
+    return find_leader_by_address(get_group_leaders(self->get_leader_group()), address) != nullptr;
+}
+
+
+/** \brief Process a message received from another leader.
+ *
+ * The messages received over the leader mesh are processed as if they
+ * were received from the communicator daemon. Only the messages sent
+ * by one of the other leaders of our group are accepted.
+ *
+ * The leaders change with each election so the address of the
+ * connection (\p peer) is checked again against the current leaders
+ * of our group with is_leader_address(). If it is not one of them
+ * anymore, the message is ignored and the connections of the computers
+ * which are not leaders of our group anymore get closed.
+ *
+ * The name of the sender is defined by the sender itself so it cannot
+ * be trusted by itself. The message is accepted only if the IP address
+ * of that leader is the IP address of the connection it was received
+ * on.
+ *
+ * \param[in] msg  The message received from another leader.
+ * \param[in] peer  The address of the connection.
+ */
+void cluckd::process_leader_message(ed::message & msg, addr::addr const & peer)
+{
+    if(!is_leader_address(peer))
+    {
+        SNAP_LOG_WARNING
+            << "ignoring "
+            << msg.get_command()
+            << " received from \""
+            << peer.to_ipv4or6_string(addr::STRING_IP_ADDRESS | addr::STRING_IP_BRACKET_ADDRESS)
+            << "\" which is not one of our leaders anymore."
+            << SNAP_LOG_SEND;
+        close_demoted_leader_clients();
+        return;
+    }
+
+    computer::vector_t const leaders(get_group_leaders(is_leader()->get_leader_group()));
+    std::string const & server_name(msg.get_sent_from_server());
+    auto const it(std::find_if(
+          leaders.begin()
+        , leaders.end()
+        , [&server_name, &peer](auto const & l)
+        {
+            return l->get_name() == server_name
+                && find_leader_by_address({ l }, peer) != nullptr;
+        }));
+    if(it == leaders.end())
+    {
+        SNAP_LOG_WARNING
+            << "ignoring "
+            << msg.get_command()
+            << " received from \""
+            << server_name
+            << "\" which is not the leader at address "
+            << peer.to_ipv4or6_string(addr::STRING_IP_ADDRESS | addr::STRING_IP_BRACKET_ADDRESS)
+            << "."
+            << SNAP_LOG_SEND;
+        return;
+    }
+
+    f_messenger->get_dispatcher()->dispatch(msg);
 }
 
 
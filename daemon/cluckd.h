@@ -19,10 +19,24 @@
 
 // self
 //
+#include    "admission_control.h"
+#include    "client_quota.h"
 #include    "computer.h"
 #include    "interrupt.h"
+#include    "leader_client.h"
+#include    "leader_connection.h"
+#include    "leader_groups.h"
+#include    "leader_listener.h"
+#include    "local_client.h"
+#include    "local_forwards.h"
+#include    "local_listener.h"
+#include    "local_lock.h"
+#include    "lock_progress.h"
 #include    "message_cache.h"
+#include    "object_stats.h"
+#include    "replay_timer.h"
 #include    "ticket.h"
+#include    "ticket_pool.h"
 #include    "timer.h"
 
 
@@ -62,12 +76,17 @@ public:
     int                         get_computer_count() const;
     std::string const &         get_server_name() const;
     bool                        is_daemon_ready() const;
-    computer::pointer_t         is_leader(std::string id = std::string()) const;
+    computer::pointer_t         is_leader(std::string const & id = std::string()) const;
     computer::pointer_t         get_leader_a() const;
     computer::pointer_t         get_leader_b() const;
+    std::size_t                 get_leader_group(std::string const & object_name) const;
+    computer::vector_t          get_group_leaders(std::size_t group) const;
     void                        cleanup();
+    void                        schedule_cleanup(cluck::timeout_t const & deadline = snapdev::timespec_ex::max());
+    void                        push_deadline(cluck::timeout_t const & deadline);
+    void                        replay_cached_locks();
     ticket::ticket_id_t         get_last_ticket(std::string const & lock_name);
-    void                        set_ticket(std::string const & object_name, std::string const & key, ticket::pointer_t ticket);
+    void                        set_ticket(std::string const & object_name, ticket_key const & key, ticket::pointer_t ticket);
     void                        lock_exiting(ed::message & msg);
     ticket::key_map_t const     get_entering_tickets(std::string const & lock_name);
     std::string                 serialized_tickets();
@@ -76,6 +95,20 @@ public:
     std::string                 ticket_list() const;
     void                        send_lock_started(ed::message const * msg);
     void                        election_status();
+    void                        forward_message_to_leader(ed::message & message);
+    void                        add_local_client(local_client::pointer_t client);
+    void                        remove_local_client(std::string const & service_name);
+    bool                        send_local_message(ed::message & msg);
+    bool                        send_leader_message(ed::message & msg);
+    std::int64_t                get_batch_delay();
+    object_stats &              get_object_stats();
+    lock_phases &               get_lock_phases();
+    std::size_t                 multicast_leader_message(
+                                      ed::message & msg
+                                    , advgetopt::string_list_t & servers);
+    bool                        is_leader_address(addr::addr const & address) const;
+    void                        process_leader_message(ed::message & msg, addr::addr const & peer);
+    void                        add_leader_client(leader_client::pointer_t client);
 
     // messages received by the messenger which then calls the cluckd functions
     // however, the messenger accesses all of them to setup the dispatcher
@@ -83,6 +116,7 @@ public:
     void                        msg_absolutely(ed::message & msg);
     void                        msg_activate_lock(ed::message & msg);
     void                        msg_add_ticket(ed::message & msg);
+    void                        msg_batch(ed::message & msg);
     void                        msg_clock_stable(ed::message & msg);
     void                        msg_cluster_down(ed::message & msg);
     void                        msg_cluster_up(ed::message & msg);
@@ -97,15 +131,19 @@ public:
     void                        msg_lock_exiting(ed::message & msg);
     void                        msg_lock_failed(ed::message & msg);
     void                        msg_lock_leaders(ed::message & msg);
+    void                        msg_lock_progress(ed::message & msg);
     void                        msg_lock_started(ed::message & msg);
     void                        msg_lock_status(ed::message & msg);
     void                        msg_lock_tickets(ed::message & msg);
+    void                        msg_locked(ed::message & msg);
     void                        msg_max_ticket(ed::message & msg);
     void                        msg_server_gone(ed::message & msg);
     void                        msg_status(ed::message & msg);
     void                        msg_ticket_added(ed::message & msg);
     void                        msg_ticket_ready(ed::message & msg);
     void                        msg_unlock(ed::message & msg);
+    void                        msg_unlocked(ed::message & msg);
+    void                        msg_unlocking(ed::message & msg);
 
 private:
     bool                        get_parameters(
@@ -117,9 +155,39 @@ private:
                                     , std::string * key
                                     , std::string * source);
     void                        activate_first_lock(std::string const & object_name);
+    void                        admit_backlog(cluck::timeout_t const & now);
+    void                        arm_timer(std::int64_t date);
     void                        check_lock_status();
+    void                        record_hold(
+                                      ticket::pointer_t const & t
+                                    , cluck::timeout_t const & now);
+    cluck::timeout_t            send_lock_progress(
+                                      std::string const & object_name
+                                    , cluck::timeout_t const & now);
+    void                        tickets_changed(
+                                      std::string const & object_name
+                                    , cluck::timeout_t const & deadline = snapdev::timespec_ex::max());
+    void                        send_cached_lock_failed(
+                                      message_cache::request const & r
+                                    , std::string const & error
+                                    , char const * description);
     void                        synchronize_leaders();
-    void                        forward_message_to_leader(ed::message & message);
+    bool                        is_object_leader(std::string const & object_name) const;
+    computer::pointer_t         get_object_leader(std::string const & object_name) const;
+    void                        ping_leaders(std::size_t group);
+    void                        update_leader_mesh();
+    void                        close_demoted_leader_clients();
+    void                        update_leader_cache();
+    void                        load_leaders(ed::message const & msg);
+    void                        add_leaders_parameters(ed::message & msg) const;
+    local_lock::pointer_t       find_local_lock(
+                                      std::string const & object_name
+                                    , ed::dispatcher_match::tag_t tag) const;
+    bool                        relay_to_local_client(
+                                      ed::message & msg
+                                    , std::string const & object_name
+                                    , ed::dispatcher_match::tag_t tag
+                                    , bool done);
 
     advgetopt::getopt                   f_opts;
 
@@ -129,6 +197,8 @@ private:
     messenger::pointer_t                f_messenger = messenger::pointer_t();
     interrupt::pointer_t                f_interrupt = interrupt::pointer_t();
     timer::pointer_t                    f_timer = timer::pointer_t();
+    cluck::timeout_t                    f_next_deadline = snapdev::timespec_ex::max();  // earliest known deadline, the timer fires then
+    bool                                f_in_cleanup = false;
     std::size_t                         f_neighbors_count = 0;
     std::size_t                         f_neighbors_quorum = 0;
     std::string                         f_my_id = std::string();
@@ -137,12 +207,35 @@ private:
     bool                                f_stable_clock = false;
     computer::map_t                     f_computers = computer::map_t();        // key is the computer name
     computer::vector_t                  f_leaders = computer::vector_t();
-    int                                 f_next_leader = 0;
-    message_cache::list_t               f_message_cache = message_cache::list_t();
+    std::size_t                         f_leader_groups = 1;
+    computer::pointer_t                 f_self_leader = computer::pointer_t();  // cached by update_leader_cache()
+    computer::pointer_t                 f_leader_a = computer::pointer_t();
+    computer::pointer_t                 f_leader_b = computer::pointer_t();
+    ticket::serial_t                    f_serial_prefix = 0;
+    message_cache                       f_message_cache = message_cache();
+    replay_timer::pointer_t             f_replay_timer = replay_timer::pointer_t();
+    std::size_t                         f_replay_slice = 0;     // 0 means replay everything at once
+    bool                                f_replaying = false;
+    admission_control                   f_admission = admission_control();
+    bool                                f_admitting_backlog = false;
+    client_quota                        f_client_quota = client_quota();
+    std::size_t                         f_local_combining = 0;
+    lock_progress                       f_lock_progress = lock_progress();
+    object_stats                        f_object_stats = object_stats();
+    lock_phases                         f_lock_phases = lock_phases();
+    ticket_pool::pointer_t              f_ticket_pool = std::make_shared<ticket_pool>();
     ticket::object_map_t                f_entering_tickets = ticket::object_map_t();
     ticket::object_map_t                f_tickets = ticket::object_map_t();
+    local_lock::map_t                   f_local_locks = local_lock::map_t();
+    local_listener::pointer_t           f_local_listener = local_listener::pointer_t();
+    local_client::map_t                 f_local_clients = local_client::map_t();
+    leader_listener::pointer_t          f_leader_listener = leader_listener::pointer_t();
+    leader_connection::map_t            f_leader_connections = leader_connection::map_t();
+    leader_client::vector_t             f_leader_clients = leader_client::vector_t();
+    local_forwards                      f_local_forwards = local_forwards();
     snapdev::timespec_ex                f_election_date = snapdev::timespec_ex();
     ticket::serial_t                    f_ticket_serial = 0;
+    std::int64_t                        f_batch_delay = -2;                     // not yet read
     mutable time_t                      f_pace_lockstarted = 0;
 };
 
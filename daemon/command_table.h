@@ -0,0 +1,210 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+/** \file
+ * \brief Compile time table of the cluck protocol commands.
+ *
+ * The cluck daemon receives many messages from the other cluck daemons
+ * and from its clients. Searching the corresponding callback in the
+ * dispatcher means comparing the command against each match, one after
+ * the other. This table is a perfect hash of the cluck commands so the
+ * messenger can find the command in a single lookup (see
+ * find_cluck_command()).
+ *
+ * The hash is an FNV-1a with a seed selected so that each command ends
+ * up in a different slot of the table. The static_assert() below verify
+ * that property at compile time, so adding a command to the table which
+ * creates a collision requires a new seed.
+ */
+
+// C++
+//
+#include    <array>
+#include    <cstdint>
+#include    <string_view>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+enum class cluck_command_t : std::uint8_t
+{
+    CLUCK_COMMAND_UNKNOWN,
+
+    CLUCK_COMMAND_ACTIVATE_LOCK,
+    CLUCK_COMMAND_ADD_TICKET,
+    CLUCK_COMMAND_BATCH,
+    CLUCK_COMMAND_DROP_TICKET,
+    CLUCK_COMMAND_GET_MAX_TICKET,
+    CLUCK_COMMAND_INFO,
+    CLUCK_COMMAND_LIST_TICKETS,
+    CLUCK_COMMAND_LOCK,
+    CLUCK_COMMAND_LOCK_ACTIVATED,
+    CLUCK_COMMAND_LOCK_ENTERED,
+    CLUCK_COMMAND_LOCK_ENTERING,
+    CLUCK_COMMAND_LOCK_EXITING,
+    CLUCK_COMMAND_LOCK_FAILED,
+    CLUCK_COMMAND_LOCK_LEADERS,
+    CLUCK_COMMAND_LOCK_PROGRESS,
+    CLUCK_COMMAND_LOCK_STARTED,
+    CLUCK_COMMAND_LOCK_STATUS,
+    CLUCK_COMMAND_LOCK_TICKETS,
+    CLUCK_COMMAND_LOCKED,
+    CLUCK_COMMAND_MAX_TICKET,
+    CLUCK_COMMAND_TICKET_ADDED,
+    CLUCK_COMMAND_TICKET_READY,
+    CLUCK_COMMAND_UNLOCK,
+    CLUCK_COMMAND_UNLOCKED,
+    CLUCK_COMMAND_UNLOCKING,
+
+    CLUCK_COMMAND_max
+};
+
+
+struct cluck_command_name
+{
+    std::string_view            f_name = std::string_view();
+    cluck_command_t             f_command = cluck_command_t::CLUCK_COMMAND_UNKNOWN;
+};
+
+
+// the names must match the ones defined in cluck/names.an
+//
+constexpr cluck_command_name const g_cluck_command_names[] =
+{
+    { "ACTIVATE_LOCK",  cluck_command_t::CLUCK_COMMAND_ACTIVATE_LOCK },
+    { "ADD_TICKET",     cluck_command_t::CLUCK_COMMAND_ADD_TICKET },
+    { "BATCH",          cluck_command_t::CLUCK_COMMAND_BATCH },
+    { "DROP_TICKET",    cluck_command_t::CLUCK_COMMAND_DROP_TICKET },
+    { "GET_MAX_TICKET", cluck_command_t::CLUCK_COMMAND_GET_MAX_TICKET },
+    { "INFO",           cluck_command_t::CLUCK_COMMAND_INFO },
+    { "LIST_TICKETS",   cluck_command_t::CLUCK_COMMAND_LIST_TICKETS },
+    { "LOCK",           cluck_command_t::CLUCK_COMMAND_LOCK },
+    { "LOCK_ACTIVATED", cluck_command_t::CLUCK_COMMAND_LOCK_ACTIVATED },
+    { "LOCK_ENTERED",   cluck_command_t::CLUCK_COMMAND_LOCK_ENTERED },
+    { "LOCK_ENTERING",  cluck_command_t::CLUCK_COMMAND_LOCK_ENTERING },
+    { "LOCK_EXITING",   cluck_command_t::CLUCK_COMMAND_LOCK_EXITING },
+    { "LOCK_FAILED",    cluck_command_t::CLUCK_COMMAND_LOCK_FAILED },
+    { "LOCK_LEADERS",   cluck_command_t::CLUCK_COMMAND_LOCK_LEADERS },
+    { "LOCK_PROGRESS",  cluck_command_t::CLUCK_COMMAND_LOCK_PROGRESS },
+    { "LOCK_STARTED",   cluck_command_t::CLUCK_COMMAND_LOCK_STARTED },
+    { "LOCK_STATUS",    cluck_command_t::CLUCK_COMMAND_LOCK_STATUS },
+    { "LOCK_TICKETS",   cluck_command_t::CLUCK_COMMAND_LOCK_TICKETS },
+    { "LOCKED",         cluck_command_t::CLUCK_COMMAND_LOCKED },
+    { "MAX_TICKET",     cluck_command_t::CLUCK_COMMAND_MAX_TICKET },
+    { "TICKET_ADDED",   cluck_command_t::CLUCK_COMMAND_TICKET_ADDED },
+    { "TICKET_READY",   cluck_command_t::CLUCK_COMMAND_TICKET_READY },
+    { "UNLOCK",         cluck_command_t::CLUCK_COMMAND_UNLOCK },
+    { "UNLOCKED",       cluck_command_t::CLUCK_COMMAND_UNLOCKED },
+    { "UNLOCKING",      cluck_command_t::CLUCK_COMMAND_UNLOCKING },
+};
+
+
+constexpr std::size_t const     CLUCK_COMMAND_HASH_BITS = 6;
+constexpr std::uint32_t const   CLUCK_COMMAND_HASH_SEED = 92;
+
+
+/** \brief Compute the perfect hash of a command.
+ *
+ * This function computes the FNV-1a hash of \p command, starting with
+ * our seed instead of the usual offset basis, and returns its top bits.
+ * The low bits of an FNV hash only depend on the low bits of the input
+ * characters, which is why we keep the top bits instead.
+ *
+ * \param[in] command  The command to hash.
+ *
+ * \return The slot of \p command in the perfect hash table.
+ */
+constexpr std::size_t cluck_command_hash(std::string_view command)
+{
+    std::uint32_t h(CLUCK_COMMAND_HASH_SEED);
+    for(char const c : command)
+    {
+        h ^= static_cast<std::uint8_t>(c);
+        h *= 16777619U;
+    }
+    return h >> (32 - CLUCK_COMMAND_HASH_BITS);
+}
+
+
+typedef std::array<cluck_command_name, 1 << CLUCK_COMMAND_HASH_BITS>   cluck_command_table_t;
+
+
+constexpr cluck_command_table_t build_cluck_command_table()
+{
+    cluck_command_table_t table{};
+    for(auto const & c : g_cluck_command_names)
+    {
+        table[cluck_command_hash(c.f_name)] = c;
+    }
+    return table;
+}
+
+
+constexpr cluck_command_table_t const g_cluck_command_table = build_cluck_command_table();
+
+
+constexpr bool cluck_command_table_is_perfect()
+{
+    for(auto const & c : g_cluck_command_names)
+    {
+        if(g_cluck_command_table[cluck_command_hash(c.f_name)].f_command != c.f_command)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+static_assert(std::size(g_cluck_command_names) + 1 == static_cast<std::size_t>(cluck_command_t::CLUCK_COMMAND_max)
+            , "each cluck command must be defined in g_cluck_command_names");
+static_assert(cluck_command_table_is_perfect()
+            , "the cluck command hash has collisions, select another CLUCK_COMMAND_HASH_SEED");
+
+
+/** \brief Search a cluck command.
+ *
+ * This function searches \p command in the perfect hash table of the
+ * cluck commands. Since there are no collisions, a single comparison
+ * is required to know whether \p command is a cluck command.
+ *
+ * \param[in] command  The command to search.
+ *
+ * \return The cluck command or CLUCK_COMMAND_UNKNOWN if \p command is not
+ * one of the cluck commands.
+ */
+constexpr cluck_command_t find_cluck_command(std::string_view command)
+{
+    cluck_command_name const & c(g_cluck_command_table[cluck_command_hash(command)]);
+    if(c.f_command != cluck_command_t::CLUCK_COMMAND_UNKNOWN
+    && c.f_name == command)
+    {
+        return c.f_command;
+    }
+    return cluck_command_t::CLUCK_COMMAND_UNKNOWN;
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -96,7 +96,7 @@ computer::computer(std::string const & name, priority_t priority, addr::addr ip_
     }
     std::string invalid_name_characters("|");
     invalid_name_characters += '\0';
-    if(f_name.find_first_of(invalid_name_characters) != std::string::npos)
+    if(f_name.str().find_first_of(invalid_name_characters) != std::string::npos)
     {
         throw cluck::invalid_parameter("a computer name cannot include the '|' or null characters.");
     }
@@ -286,7 +286,187 @@ snapdev::timespec_ex const & computer::get_start_time() const
 }
 
 
+/** \brief Set the position of this computer in the list of leaders.
+ *
+ * When elected, a leader is given an index. The leaders are organized
+ * in groups of three (see the `leader-groups` option) so the index
+ * divided by three is the leader group and the remainder is the
+ * position of the leader within that group.
+ *
+ * The index is only meaningful while the computer is a leader.
+ *
+ * \param[in] index  The index of this leader.
+ */
+void computer::set_leader_index(std::size_t index)
+{
+    f_leader_index = index;
+}
+
+
+/** \brief Get the index of this computer in the list of leaders.
+ *
+ * \return The index as defined by set_leader_index().
+ */
+std::size_t computer::get_leader_index() const
+{
+    return f_leader_index;
+}
+
+
+/** \brief Get the leader group this computer is a member of.
+ *
+ * \return The leader index divided by three.
+ */
+std::size_t computer::get_leader_group() const
+{
+    return f_leader_index / 3;
+}
+
+
+/** \brief Check whether a new RTT ping should be sent.
+ *
+ * The cluck daemon measures the round trip time to the leaders it forwards
+ * requests to by sending them an ALIVE message and waiting for the
+ * ABSOLUTELY reply. This function paces those pings to at most one every
+ * five seconds per computer.
+ *
+ * If the function returns true, the caller is expected to send the ALIVE
+ * message right away with the sequence number returned by
+ * get_rtt_sequence() in its serial. The time is saved and used by
+ * rtt_pong() to compute the round trip time.
+ *
+ * Each ping gets a new sequence number so a late reply to an earlier
+ * ping (or a ping which never got a reply) does not get measured
+ * against the date of the latest ping.
+ *
+ * \param[in] now  The current time.
+ *
+ * \return true if a new ping has to be sent.
+ */
+bool computer::rtt_ping(snapdev::timespec_ex const & now)
+{
+    if(f_rtt_ping_date != snapdev::timespec_ex()
+    && now - f_rtt_ping_date < snapdev::timespec_ex(5, 0))
+    {
+        return false;
+    }
+
+    f_rtt_ping_date = now;
+    ++f_rtt_sequence;
+    if(f_rtt_pending_date == snapdev::timespec_ex())
+    {
+        f_rtt_pending_date = now;
+    }
+    return true;
+}
+
+
+/** \brief Get the sequence number of the latest RTT ping.
+ *
+ * The sequence number is sent in the serial of the ALIVE message and
+ * returned in the ABSOLUTELY reply. It is then passed to rtt_pong().
+ *
+ * \return The sequence number of the latest ping.
+ */
+std::uint32_t computer::get_rtt_sequence() const
+{
+    return f_rtt_sequence;
+}
+
+
+/** \brief Register the reply to an RTT ping.
+ *
+ * When the ABSOLUTELY reply to our ALIVE message is received, this
+ * function computes the round trip time and adds it to an exponentially
+ * weighted moving average (EWMA) using a weight of 1/8 for the new
+ * sample, as TCP does for its smoothed RTT.
+ *
+ * Only the reply to the latest ping is measured. A reply to an older
+ * ping, a duplicate, or a reply without a ping is ignored.
+ *
+ * \param[in] sequence  The sequence number found in the reply.
+ * \param[in] now  The current time.
+ */
+void computer::rtt_pong(std::uint32_t sequence, snapdev::timespec_ex const & now)
+{
+    if(f_rtt_pending_date == snapdev::timespec_ex()
+    || sequence != f_rtt_sequence)
+    {
+        return;
+    }
+
+    std::int64_t const sample((now - f_rtt_ping_date).to_usec());
+    f_rtt_pending_date = snapdev::timespec_ex();
+    if(sample < 0)
+    {
+        return; // LCOV_EXCL_LINE
+    }
+
+    if(f_rtt == RTT_UNKNOWN)
+    {
+        f_rtt = sample;
+    }
+    else
+    {
+        f_rtt += (sample - f_rtt) / 8;
+    }
+}
+
+
+/** \brief Get the current round trip time to this computer.
+ *
+ * This function returns the smoothed round trip time in microseconds.
+ * If a ping is pending and has been for longer than the average, then
+ * the time since the ping was sent is returned instead. This way a
+ * computer which stops answering (i.e. its event loop is overloaded)
+ * quickly looks slower than the others.
+ *
+ * \param[in] now  The current time.
+ *
+ * \return The round trip time in microseconds or RTT_UNKNOWN.
+ */
+std::int64_t computer::get_rtt(snapdev::timespec_ex const & now) const
+{
+    if(f_rtt_pending_date != snapdev::timespec_ex())
+    {
+        std::int64_t const pending((now - f_rtt_pending_date).to_usec());
+        if(pending > f_rtt)
+        {
+            return pending;
+        }
+    }
+
+    return f_rtt;
+}
+
+
+/** \brief Get the smoothed round trip time to this computer.
+ *
+ * This function returns the average of the round trip times measured
+ * so far, ignoring any pending ping.
+ *
+ * \return The round trip time in microseconds or RTT_UNKNOWN.
+ */
+std::int64_t computer::get_smoothed_rtt() const
+{
+    return f_rtt;
+}
+
+
 std::string const & computer::get_name() const
+{
+    return f_name.str();
+}
+
+
+/** \brief Get the name of this computer as an atom.
+ *
+ * Comparing two atoms is faster than comparing two strings. This is
+ * used to search the owner of a ticket among the leaders.
+ *
+ * \return The computer name atom.
+ */
+atom const & computer::get_name_atom() const
 {
     return f_name;
 }
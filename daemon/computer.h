@@ -17,6 +17,11 @@
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #pragma once
 
+// self
+//
+#include    "atom.h"
+
+
 // libaddr
 //
 #include    <libaddr/addr.h>
@@ -58,6 +63,8 @@ public:
     static priority_t const PRIORITY_OFF = 15;
     static priority_t const PRIORITY_MAX = 15;
 
+    static std::int64_t const RTT_UNKNOWN = -1;
+
                             computer();
                             computer(
                                   std::string const & name
@@ -72,8 +79,17 @@ public:
     void                    set_start_time(snapdev::timespec_ex const & start_time);
     snapdev::timespec_ex const &
                             get_start_time() const;
+    void                    set_leader_index(std::size_t index);
+    std::size_t             get_leader_index() const;
+    std::size_t             get_leader_group() const;
+    bool                    rtt_ping(snapdev::timespec_ex const & now);
+    std::uint32_t           get_rtt_sequence() const;
+    void                    rtt_pong(std::uint32_t sequence, snapdev::timespec_ex const & now);
+    std::int64_t            get_rtt(snapdev::timespec_ex const & now) const;
+    std::int64_t            get_smoothed_rtt() const;
 
     std::string const &     get_name() const;
+    atom const &            get_name_atom() const;
     std::string const &     get_id() const;
     addr::addr const &      get_ip_address() const;
 
@@ -87,9 +103,14 @@ private:
     random_t                f_random_id = 0;
     addr::addr              f_ip_address = addr::addr();
     pid_t                   f_pid = 0;
-    std::string             f_name = std::string();
+    atom                    f_name = atom();
 
     snapdev::timespec_ex    f_start_time = snapdev::timespec_ex();
+    std::size_t             f_leader_index = 0;
+    std::int64_t            f_rtt = RTT_UNKNOWN;
+    snapdev::timespec_ex    f_rtt_ping_date = snapdev::timespec_ex();
+    snapdev::timespec_ex    f_rtt_pending_date = snapdev::timespec_ex();
+    std::uint32_t           f_rtt_sequence = 0;
 };
 
 
@@ -0,0 +1,210 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Implementation of a fixed size histogram.
+ *
+ * The statistics of the cluck daemon are updated each time a ticket
+ * changes state. Keeping all the samples would use an unbounded amount
+ * of memory and sorting them to find percentiles would be slow. Instead,
+ * the samples are counted in log2 buckets: bucket 0 counts the samples
+ * equal to 0, bucket 1 the samples equal to 1, bucket 2 the samples from
+ * 2 to 3, bucket 3 the samples from 4 to 7, and so on. The last bucket
+ * counts all the larger samples.
+ *
+ * Adding a sample is O(1) and the percentiles are precise within a
+ * factor of 2, which is plenty to find out where the time goes.
+ */
+
+// self
+//
+#include    "histogram.h"
+
+
+// C++
+//
+#include    <algorithm>
+#include    <bit>
+#include    <limits>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+/** \class histogram
+ * \brief Count samples in log2 buckets.
+ *
+ * The samples are expected to be durations in microseconds. With 32
+ * buckets, the last bucket starts at about 18 minutes. Negative samples
+ * (which happen when the clock gets adjusted) are counted as 0.
+ */
+
+
+
+/** \brief Add a sample to the histogram.
+ *
+ * \param[in] value  The sample to add.
+ */
+void histogram::add(std::int64_t value)
+{
+    value = std::max(value, static_cast<std::int64_t>(0));
+    ++f_buckets[bucket_of(value)];
+    ++f_count;
+    f_sum += value;
+    f_max = std::max(f_max, value);
+}
+
+
+/** \brief Remove all the samples.
+ */
+void histogram::clear()
+{
+    f_buckets.fill(0);
+    f_count = 0;
+    f_sum = 0;
+    f_max = 0;
+}
+
+
+/** \brief Get the number of samples.
+ *
+ * \return The number of samples added since creation or the last clear().
+ */
+std::uint64_t histogram::get_count() const
+{
+    return f_count;
+}
+
+
+/** \brief Get the number of samples in one bucket.
+ *
+ * \param[in] idx  The index of the bucket, from 0 to BUCKETS - 1.
+ *
+ * \return The number of samples in that bucket.
+ */
+std::uint64_t histogram::get_bucket(std::size_t idx) const
+{
+    return f_buckets[idx];
+}
+
+
+/** \brief Get the average of the samples.
+ *
+ * \return The average or 0 if there are no samples.
+ */
+std::int64_t histogram::get_average() const
+{
+    if(f_count == 0)
+    {
+        return 0;
+    }
+    return f_sum / static_cast<std::int64_t>(f_count);
+}
+
+
+/** \brief Get the largest sample.
+ *
+ * \return The largest sample or 0 if there are no samples.
+ */
+std::int64_t histogram::get_max() const
+{
+    return f_max;
+}
+
+
+/** \brief Get a percentile of the samples.
+ *
+ * The function returns the upper limit of the bucket where the
+ * percentile falls, or the largest sample if smaller.
+ *
+ * \param[in] percent  The percentile, from 0 to 100.
+ *
+ * \return The percentile or 0 if there are no samples.
+ */
+std::int64_t histogram::get_percentile(int percent) const
+{
+    if(f_count == 0)
+    {
+        return 0;
+    }
+
+    std::uint64_t const rank(std::max(
+              (f_count * static_cast<std::uint64_t>(std::clamp(percent, 0, 100)) + 99) / 100
+            , static_cast<std::uint64_t>(1)));
+    std::uint64_t total(0);
+    for(std::size_t idx(0); idx < BUCKETS; ++idx)
+    {
+        total += f_buckets[idx];
+        if(total >= rank)
+        {
+            return std::min(bucket_limit(idx), f_max);
+        }
+    }
+
+    return f_max; // LCOV_EXCL_LINE
+}
+
+
+/** \brief Get the bucket of a sample.
+ *
+ * \param[in] value  The sample, expected to be positive or zero.
+ *
+ * \return The index of the bucket counting \p value.
+ */
+std::size_t histogram::bucket_of(std::int64_t value)
+{
+    if(value <= 0)
+    {
+        return 0;
+    }
+    return std::min(
+              static_cast<std::size_t>(std::bit_width(static_cast<std::uint64_t>(value)))
+            , BUCKETS - 1);
+}
+
+
+/** \brief Get the largest sample counted in a bucket.
+ *
+ * The last bucket has no limit, the function returns the largest
+ * possible sample in that case.
+ *
+ * \param[in] idx  The index of the bucket.
+ *
+ * \return The largest sample which goes in bucket \p idx.
+ */
+std::int64_t histogram::bucket_limit(std::size_t idx)
+{
+    if(idx >= BUCKETS - 1)
+    {
+        return std::numeric_limits<std::int64_t>::max();
+    }
+    return (static_cast<std::int64_t>(1) << idx) - 1;
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,59 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+// C++
+//
+#include    <array>
+#include    <cstdint>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+class histogram
+{
+public:
+    static constexpr std::size_t    BUCKETS = 32;
+
+    void                        add(std::int64_t value);
+    void                        clear();
+    std::uint64_t               get_count() const;
+    std::uint64_t               get_bucket(std::size_t idx) const;
+    std::int64_t                get_average() const;
+    std::int64_t                get_max() const;
+    std::int64_t                get_percentile(int percent) const;
+
+    static std::size_t          bucket_of(std::int64_t value);
+    static std::int64_t         bucket_limit(std::size_t idx);
+
+private:
+    std::array<std::uint64_t, BUCKETS>
+                                f_buckets = std::array<std::uint64_t, BUCKETS>();
+    std::uint64_t               f_count = 0;
+    std::int64_t                f_sum = 0;
+    std::int64_t                f_max = 0;
+};
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
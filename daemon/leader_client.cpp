@@ -0,0 +1,143 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// self
+//
+#include    "leader_client.h"
+
+#include    "cluckd.h"
+
+
+// cluck
+//
+#include    <cluck/names.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+/** \class leader_client
+ * \brief A connection from another leader.
+ *
+ * This connection is created when another leader connects to our
+ * leader mesh listener (see leader_listener). It receives the
+ * inter-leader protocol messages sent by that leader and passes them
+ * to the cluck daemon, which verifies that they come from one of its
+ * current leaders and that the name of the sender matches the IP
+ * address of the connection before processing them. The connection
+ * gets closed once that computer is not a leader of our group anymore
+ * (see cluckd::close_demoted_leader_clients()).
+ */
+
+
+
+/** \brief Initialize a connection from another leader.
+ *
+ * \param[in] c  The cluck daemon.
+ * \param[in] client  The socket returned by accept().
+ * \param[in] peer  The address of the other leader.
+ */
+leader_client::leader_client(
+          cluckd * c
+        , ed::tcp_bio_client::pointer_t client
+        , addr::addr const & peer)
+    : tcp_server_client_message_connection(client)
+    , f_cluckd(c)
+    , f_peer(peer)
+    , f_dispatcher(std::make_shared<ed::dispatcher>(this))
+{
+    set_name("leader_client");
+    set_dispatcher(f_dispatcher);
+
+    ed::dispatcher_match::vector_t matches;
+    for(auto const & command : get_commands())
+    {
+        matches.push_back(ed::define_match(
+                  ed::Expression(command)
+                , ed::Callback(std::bind(&leader_client::msg_leader, this, std::placeholders::_1))
+            ));
+    }
+    f_dispatcher->add_matches(matches);
+}
+
+
+leader_client::~leader_client()
+{
+}
+
+
+/** \brief Get the address of the other leader.
+ *
+ * The cluck daemon uses this address to close the connection when that
+ * computer is not one of the leaders of our group anymore.
+ *
+ * \return The address of the other side of this connection.
+ */
+addr::addr const & leader_client::get_peer() const
+{
+    return f_peer;
+}
+
+
+/** \brief The commands sent over the leader mesh.
+ *
+ * Only the messages of the inter-leader protocol go through the direct
+ * connections between leaders. The other messages, such as the
+ * LOCK_LEADERS and LOCK_STARTED, are broadcast and continue to go
+ * through the communicator daemon.
+ *
+ * \return The set of commands accepted on the leader mesh.
+ */
+std::set<std::string> const & leader_client::get_commands()
+{
+    static std::set<std::string> const commands = {
+        cluck::g_name_cluck_cmd_activate_lock,
+        cluck::g_name_cluck_cmd_add_ticket,
+        cluck::g_name_cluck_cmd_batch,
+        cluck::g_name_cluck_cmd_drop_ticket,
+        cluck::g_name_cluck_cmd_get_max_ticket,
+        cluck::g_name_cluck_cmd_lock_activated,
+        cluck::g_name_cluck_cmd_lock_entered,
+        cluck::g_name_cluck_cmd_lock_entering,
+        cluck::g_name_cluck_cmd_lock_exiting,
+        cluck::g_name_cluck_cmd_max_ticket,
+        cluck::g_name_cluck_cmd_ticket_added,
+        cluck::g_name_cluck_cmd_ticket_ready,
+    };
+    return commands;
+}
+
+
+void leader_client::msg_leader(ed::message & msg)
+{
+    f_cluckd->process_leader_message(msg, f_peer);
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,80 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+// eventdispatcher
+//
+#include    <eventdispatcher/dispatcher.h>
+#include    <eventdispatcher/tcp_server_client_message_connection.h>
+
+
+// libaddr
+//
+#include    <libaddr/addr.h>
+
+
+// C++
+//
+#include    <set>
+#include    <vector>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+class cluckd;
+
+
+
+class leader_client
+    : public ed::tcp_server_client_message_connection
+{
+public:
+    typedef std::shared_ptr<leader_client>      pointer_t;
+    typedef std::weak_ptr<leader_client>        weak_pointer_t;
+    typedef std::vector<weak_pointer_t>         vector_t;
+
+                                leader_client(
+                                          cluckd * c
+                                        , ed::tcp_bio_client::pointer_t client
+                                        , addr::addr const & peer);
+                                leader_client(leader_client const & rhs) = delete;
+    virtual                     ~leader_client() override;
+
+    leader_client &             operator = (leader_client const & rhs) = delete;
+
+    addr::addr const &          get_peer() const;
+
+    static std::set<std::string> const &
+                                get_commands();
+
+private:
+    void                        msg_leader(ed::message & msg);
+
+    cluckd *                    f_cluckd = nullptr;
+    addr::addr                  f_peer = addr::addr();
+    ed::dispatcher::pointer_t   f_dispatcher = ed::dispatcher::pointer_t();
+};
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
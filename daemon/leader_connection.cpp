@@ -0,0 +1,184 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// self
+//
+#include    "leader_connection.h"
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+/** \class leader_connection
+ * \brief Direct connection to another leader.
+ *
+ * When the `leader-mesh-port` option is set, each leader connects
+ * directly to the other leaders of its group. The messages of the
+ * inter-leader protocol (LOCK_ENTERING, GET_MAX_TICKET, ADD_TICKET, etc.)
+ * are then sent over this connection instead of being relayed by the
+ * communicator daemons of both computers.
+ *
+ * This connection is only used to send messages. The other leader sends
+ * its own messages through its own connection to us (see leader_client).
+ * This way no negotiation is necessary to decide which side connects.
+ *
+ * The connection is permanent: if the other leader is not yet listening
+ * or the connection is lost, it tries to reconnect after a small pause.
+ * In the meantime, the messages go through the communicator daemon.
+ *
+ * \warning
+ * Switching between the communicator daemon and this connection can
+ * reorder the messages sent to that leader: a message sent directly
+ * could arrive before a message sent a moment earlier through the
+ * communicator daemons. To limit this, a new connection is only used
+ * once it has been up for MESH_SWITCH_DELAY (see is_ready()), which
+ * gives the messages already sent through the communicator daemons
+ * time to arrive. When the connection goes down, the messages still
+ * in its buffers are lost, not reordered; the bakery algorithm
+ * recovers from lost messages through its timeouts.
+ */
+
+
+
+namespace
+{
+
+
+
+/** \brief Time a new connection must be up before it gets used.
+ *
+ * This is much larger than the time a message takes to go through the
+ * communicator daemons of two computers.
+ */
+snapdev::timespec_ex const MESH_SWITCH_DELAY = snapdev::timespec_ex(1, 0);
+
+
+
+} // no name namespace
+
+
+
+/** \brief Initialize a connection to another leader.
+ *
+ * \param[in] leader_name  The name of the other leader.
+ * \param[in] address  The address and port of the other leader mesh listener.
+ * \param[in] secure  Whether the connection uses TLS.
+ */
+leader_connection::leader_connection(
+          std::string const & leader_name
+        , addr::addr const & address
+        , bool secure)
+    : tcp_client_permanent_message_connection(
+              address
+            , secure ? ed::mode_t::MODE_ALWAYS_SECURE : ed::mode_t::MODE_PLAIN
+            , ed::DEFAULT_PAUSE_BEFORE_RECONNECTING
+            , true)
+    , f_leader_name(leader_name)
+    , f_address(address)
+    , f_secure(secure)
+{
+    set_name("leader_connection_" + leader_name);
+}
+
+
+leader_connection::~leader_connection()
+{
+}
+
+
+std::string const & leader_connection::get_leader_name() const
+{
+    return f_leader_name;
+}
+
+
+addr::addr const & leader_connection::get_address() const
+{
+    return f_address;
+}
+
+
+bool leader_connection::is_secure() const
+{
+    return f_secure;
+}
+
+
+/** \brief Check whether the messages can be sent over this connection.
+ *
+ * The connection must be connected and have been connected for at
+ * least MESH_SWITCH_DELAY so the messages sent through the communicator
+ * daemons before the connection was established had time to arrive.
+ *
+ * \param[in] now  The current date.
+ *
+ * \return true if messages can be sent over this connection.
+ *
+ * \sa is_switch_delay_over()
+ */
+bool leader_connection::is_ready(snapdev::timespec_ex const & now) const
+{
+    return is_connected()
+        && is_switch_delay_over(f_connected_date, now);
+}
+
+
+/** \brief Check whether a connection was up long enough to be used.
+ *
+ * A connection which was never connected (\p connected_date is zero)
+ * is never ready. Otherwise it becomes ready MESH_SWITCH_DELAY after
+ * \p connected_date. A date in the future (i.e. the clock moved back)
+ * is not ready either.
+ *
+ * \param[in] connected_date  The date when the connection was established.
+ * \param[in] now  The current date.
+ *
+ * \return true if the messages can be switched to that connection.
+ */
+bool leader_connection::is_switch_delay_over(
+      snapdev::timespec_ex const & connected_date
+    , snapdev::timespec_ex const & now)
+{
+    return connected_date != snapdev::timespec_ex()
+        && now - connected_date >= MESH_SWITCH_DELAY;
+}
+
+
+/** \brief The connection to the other leader was established.
+ *
+ * The date is saved so is_ready() can delay the use of the connection.
+ */
+void leader_connection::process_connected()
+{
+    tcp_client_permanent_message_connection::process_connected();
+    f_connected_date = snapdev::now();
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,74 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+// eventdispatcher
+//
+#include    <eventdispatcher/tcp_client_permanent_message_connection.h>
+
+
+// snapdev
+//
+#include    <snapdev/timespec_ex.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+class leader_connection
+    : public ed::tcp_client_permanent_message_connection
+{
+public:
+    typedef std::shared_ptr<leader_connection>  pointer_t;
+    typedef std::map<std::string, pointer_t>    map_t;          // key is the leader name
+
+                                leader_connection(
+                                          std::string const & leader_name
+                                        , addr::addr const & address
+                                        , bool secure);
+                                leader_connection(leader_connection const & rhs) = delete;
+    virtual                     ~leader_connection() override;
+
+    leader_connection &         operator = (leader_connection const & rhs) = delete;
+
+    std::string const &         get_leader_name() const;
+    addr::addr const &          get_address() const;
+    bool                        is_secure() const;
+    bool                        is_ready(snapdev::timespec_ex const & now) const;
+
+    static bool                 is_switch_delay_over(
+                                      snapdev::timespec_ex const & connected_date
+                                    , snapdev::timespec_ex const & now);
+
+    // ed::tcp_client_permanent_message_connection implementation
+    virtual void                process_connected() override;
+
+private:
+    std::string                 f_leader_name = std::string();
+    addr::addr                  f_address = addr::addr();
+    bool                        f_secure = false;
+    snapdev::timespec_ex        f_connected_date = snapdev::timespec_ex();
+};
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
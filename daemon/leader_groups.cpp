@@ -0,0 +1,193 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Implementation of the assignment of the objects to leader groups.
+ *
+ * When the cluster is configured with more than one leader group (see
+ * the `leader-groups` option), each group of three leaders handles a
+ * subset of the lock objects. All the cluck daemons have to agree on the
+ * group of an object without any communication so the functions found
+ * here only depend on their parameters.
+ *
+ * The leaders of a group can also connect to each other directly (see
+ * the `leader-mesh-port` option). The functions used to verify the peer
+ * of those connections are found here too.
+ */
+
+// self
+//
+#include    "leader_groups.h"
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+/** \brief Compute a stable hash of an object name.
+ *
+ * The leader group and the leader handling an object are selected using
+ * this hash so it has to give the exact same result on all the computers
+ * of the cluster. The std::hash<> functions do not offer such a guarantee
+ * so we use the 64 bit FNV-1a algorithm instead.
+ *
+ * The \p hash parameter can be used to chain multiple strings in one hash.
+ *
+ * \param[in] object_name  The name of the object to hash.
+ * \param[in] hash  The starting value of the hash.
+ *
+ * \return The 64 bit hash of \p object_name.
+ */
+std::uint64_t hash_object_name(
+      std::string const & object_name
+    , std::uint64_t hash)
+{
+    for(char const c : object_name)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+
+/** \brief Map a hash to a bucket using consistent hashing.
+ *
+ * This function implements the jump consistent hash by John Lamping and
+ * Eric Veach. When the number of buckets changes from N to N + 1, only
+ * 1 / (N + 1) of the keys move to the new bucket; all the other keys
+ * stay where they were. This limits the number of objects which change
+ * leader group when the number of groups changes after an election.
+ *
+ * \param[in] key  The hash of the object name.
+ * \param[in] buckets  The number of buckets (leader groups), at least 1.
+ *
+ * \return A number from 0 to \p buckets - 1.
+ */
+std::size_t jump_consistent_hash(std::uint64_t key, std::size_t buckets)
+{
+    std::int64_t b(-1);
+    std::int64_t j(0);
+    while(j < static_cast<std::int64_t>(buckets))
+    {
+        b = j;
+        key = key * 2862933555777941757ULL + 1;
+        j = static_cast<std::int64_t>(
+                  static_cast<double>(b + 1)
+                * (static_cast<double>(1LL << 31) / static_cast<double>((key >> 33) + 1)));
+    }
+    return static_cast<std::size_t>(b);
+}
+
+
+/** \brief Determine the leader group handling the specified object.
+ *
+ * \param[in] object_name  The name of the object to lock.
+ * \param[in] groups  The number of leader groups.
+ *
+ * \return The leader group number, from 0 to \p groups - 1.
+ */
+std::size_t get_object_group(std::string const & object_name, std::size_t groups)
+{
+    if(groups <= 1)
+    {
+        return 0;
+    }
+
+    return jump_consistent_hash(hash_object_name(object_name), groups);
+}
+
+
+/** \brief Get the leaders of the specified group.
+ *
+ * The leaders of group \p group are the leaders with an index from
+ * `group * 3` to `group * 3 + 2` (see computer::get_leader_group()).
+ * They are returned in the order found in \p leaders.
+ *
+ * \param[in] leaders  All the leaders.
+ * \param[in] groups  The number of leader groups.
+ * \param[in] group  The leader group number.
+ *
+ * \return The list of leaders in that group.
+ */
+computer::vector_t get_group_members(
+      computer::vector_t const & leaders
+    , std::size_t groups
+    , std::size_t group)
+{
+    if(groups <= 1)
+    {
+        return leaders;
+    }
+
+    computer::vector_t members;
+    for(auto const & l : leaders)
+    {
+        if(l->get_leader_group() == group)
+        {
+            members.push_back(l);
+        }
+    }
+    return members;
+}
+
+
+/** \brief Search the leader with the specified IP address.
+ *
+ * The leader mesh accepts connections and messages only from the other
+ * leaders of our group. This function searches \p leaders for a leader,
+ * other than ourselves, with the IP address of \p address. The port is
+ * ignored since the port of a client connection is ephemeral.
+ *
+ * \param[in] leaders  The leaders of our group.
+ * \param[in] address  The address of the peer.
+ *
+ * \return The matching leader or nullptr.
+ */
+computer::pointer_t find_leader_by_address(
+      computer::vector_t const & leaders
+    , addr::addr const & address)
+{
+    for(auto const & l : leaders)
+    {
+        if(l->is_self())
+        {
+            continue;
+        }
+        addr::addr ip(address);
+        ip.set_port(l->get_ip_address().get_port());
+        if(ip == l->get_ip_address())
+        {
+            return l;
+        }
+    }
+
+    return computer::pointer_t();
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,57 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+// self
+//
+#include    "computer.h"
+
+
+// C++
+//
+#include    <cstdint>
+#include    <string>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+constexpr std::uint64_t         FNV_OFFSET_BASIS = 14695981039346656037ULL;
+
+std::uint64_t                   hash_object_name(
+                                      std::string const & object_name
+                                    , std::uint64_t hash = FNV_OFFSET_BASIS);
+std::size_t                     jump_consistent_hash(std::uint64_t key, std::size_t buckets);
+std::size_t                     get_object_group(
+                                      std::string const & object_name
+                                    , std::size_t groups);
+computer::vector_t              get_group_members(
+                                      computer::vector_t const & leaders
+                                    , std::size_t groups
+                                    , std::size_t group);
+computer::pointer_t             find_leader_by_address(
+                                      computer::vector_t const & leaders
+                                    , addr::addr const & address);
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,136 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// self
+//
+#include    "leader_listener.h"
+
+#include    "cluckd.h"
+#include    "leader_client.h"
+
+
+// snaplogger
+//
+#include    <snaplogger/message.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+/** \class leader_listener
+ * \brief Listen for direct connections from the other leaders.
+ *
+ * When the `leader-mesh-port` option is set, the cluck daemon listens
+ * on that port for connections from the other leaders of its group.
+ * Each accepted connection is handled by a leader_client object.
+ *
+ * The connection is refused unless it comes from the IP address of one
+ * of the other leaders of our group. When a certificate and a private
+ * key are defined, the connections are encrypted with TLS.
+ */
+
+
+
+/** \brief Initialize the leader listener.
+ *
+ * \param[in] c  The cluck daemon.
+ * \param[in] address  The address and port to listen on.
+ * \param[in] certificate  The TLS certificate or an empty string.
+ * \param[in] private_key  The TLS private key or an empty string.
+ */
+leader_listener::leader_listener(
+          cluckd * c
+        , addr::addr const & address
+        , std::string const & certificate
+        , std::string const & private_key)
+    : tcp_server_connection(
+              address
+            , certificate
+            , private_key
+            , certificate.empty() || private_key.empty()
+                ? ed::mode_t::MODE_PLAIN
+                : ed::mode_t::MODE_ALWAYS_SECURE
+            , 10
+            , true)
+    , f_cluckd(c)
+{
+    set_name("leader_listener");
+}
+
+
+leader_listener::~leader_listener()
+{
+}
+
+
+/** \brief Accept a connection from another leader.
+ *
+ * This function accepts the new connection and creates a leader_client
+ * to handle it. The cluck daemon adds it to the communicator. The
+ * connection gets removed from the communicator automatically once the
+ * other side closes it or by the cluck daemon once that computer is not
+ * one of our leaders anymore.
+ *
+ * A connection from an IP address which is not the address of one of
+ * the other leaders of our group gets closed immediately.
+ */
+void leader_listener::process_accept()
+{
+    ed::tcp_bio_client::pointer_t const new_client(accept());
+    if(new_client == nullptr)
+    {
+        // an error occurred, report in the logs
+        //
+        int const e(errno);
+        SNAP_LOG_ERROR
+            << "somehow accept() of a leader connection failed with errno: "
+            << e
+            << " -- "
+            << strerror(e)
+            << SNAP_LOG_SEND;
+        return;
+    }
+
+    addr::addr const peer(new_client->get_client_address());
+    if(!f_cluckd->is_leader_address(peer))
+    {
+        SNAP_LOG_WARNING
+            << "refusing leader mesh connection from \""
+            << peer.to_ipv4or6_string(addr::STRING_IP_ADDRESS | addr::STRING_IP_BRACKET_ADDRESS)
+            << "\" which is not one of our leaders."
+            << SNAP_LOG_SEND;
+        return;
+    }
+
+    leader_client::pointer_t client(std::make_shared<leader_client>(f_cluckd, new_client, peer));
+    f_cluckd->add_leader_client(client);
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,61 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+// eventdispatcher
+//
+#include    <eventdispatcher/tcp_server_connection.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+class cluckd;
+
+
+
+class leader_listener
+    : public ed::tcp_server_connection
+{
+public:
+    typedef std::shared_ptr<leader_listener>    pointer_t;
+
+                                leader_listener(
+                                          cluckd * c
+                                        , addr::addr const & address
+                                        , std::string const & certificate
+                                        , std::string const & private_key);
+                                leader_listener(leader_listener const & rhs) = delete;
+    virtual                     ~leader_listener() override;
+
+    leader_listener &           operator = (leader_listener const & rhs) = delete;
+
+    // ed::connection implementation
+    virtual void                process_accept() override;
+
+private:
+    cluckd *                    f_cluckd = nullptr;
+};
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
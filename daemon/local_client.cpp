@@ -0,0 +1,246 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// self
+//
+#include    "local_client.h"
+
+#include    "cluckd.h"
+
+
+// cluck
+//
+#include    <cluck/names.h>
+
+
+// communicator
+//
+#include    <communicator/names.h>
+
+
+// snapdev
+//
+#include    <snapdev/not_used.h>
+
+
+// snaplogger
+//
+#include    <snaplogger/message.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+/** \class local_client
+ * \brief A client connected directly to the cluck daemon.
+ *
+ * This connection represents one local client connected to the Unix
+ * socket of the cluck daemon (see local_listener). It accepts the LOCK
+ * and UNLOCK messages and passes them to the cluck daemon as if they
+ * had been received through the communicator daemon.
+ *
+ * The replies are sent to the service name of this client. The
+ * messenger recognizes those names and sends the replies through this
+ * connection instead of the communicator daemon (see
+ * cluckd::send_local_message()).
+ */
+
+
+
+/** \brief Initialize a local client connection.
+ *
+ * The constructor retrieves the credentials of the peer using
+ * SO_PEERCRED. The process identifier is used when the client does not
+ * include a "pid" parameter in its messages.
+ *
+ * \param[in] c  The cluck daemon.
+ * \param[in] client  The socket returned by accept().
+ * \param[in] service_name  The name used to route replies to this client.
+ */
+local_client::local_client(
+          cluckd * c
+        , snapdev::raii_fd_t client
+        , std::string const & service_name)
+    : local_stream_server_client_message_connection(std::move(client))
+    , f_cluckd(c)
+    , f_service_name(service_name)
+    , f_peer(get_socket())
+    , f_dispatcher(std::make_shared<ed::dispatcher>(this))
+{
+    set_name(service_name);
+
+    if(f_peer.get_pid() <= 0)
+    {
+        int const e(f_peer.get_error());    // LCOV_EXCL_LINE
+        SNAP_LOG_WARNING                    // LCOV_EXCL_LINE
+            << "could not retrieve the credentials of local client \""
+            << service_name
+            << "\" (errno: "
+            << e
+            << " -- "
+            << strerror(e)
+            << ")."
+            << SNAP_LOG_SEND;
+    }
+
+    set_dispatcher(f_dispatcher);
+    f_dispatcher->add_matches({
+        ed::define_match(
+              ed::Expression(cluck::g_name_cluck_cmd_lock)
+            , ed::Callback(std::bind(&local_client::msg_lock, this, std::placeholders::_1))
+        ),
+        ed::define_match(
+              ed::Expression(cluck::g_name_cluck_cmd_unlock)
+            , ed::Callback(std::bind(&local_client::msg_unlock, this, std::placeholders::_1))
+        ),
+
+        // the cluck library sends its list of commands the same way it
+        // does with the communicator daemon, we do not need it
+        //
+        ed::define_match(
+              ed::Expression(::communicator::g_name_communicator_cmd_commands)
+            , ed::Callback(std::bind(&local_client::msg_ignore, this, std::placeholders::_1))
+        ),
+    });
+}
+
+
+local_client::~local_client()
+{
+}
+
+
+std::string const & local_client::get_service_name() const
+{
+    return f_service_name;
+}
+
+
+pid_t local_client::get_peer_pid() const
+{
+    return f_peer.get_pid();
+}
+
+
+void local_client::process_hup()
+{
+    local_stream_server_client_message_connection::process_hup();
+    disconnected();
+}
+
+
+void local_client::process_error()
+{
+    local_stream_server_client_message_connection::process_error();
+    disconnected();
+}
+
+
+void local_client::process_invalid()
+{
+    local_stream_server_client_message_connection::process_invalid();
+    disconnected();
+}
+
+
+void local_client::msg_ignore(ed::message & msg)
+{
+    snapdev::NOT_USED(msg);
+}
+
+
+void local_client::msg_lock(ed::message & msg)
+{
+    prepare_message(msg);
+    f_cluckd->msg_lock(msg);
+}
+
+
+void local_client::msg_unlock(ed::message & msg)
+{
+    prepare_message(msg);
+    f_cluckd->msg_unlock(msg);
+}
+
+
+/** \brief Make the message look like it came from the communicator daemon.
+ *
+ * The messages received through the communicator daemon have their
+ * "sent from" server and service defined. The cluck daemon uses those to
+ * send the replies so here we set them to this computer name and the
+ * service name of this client.
+ *
+ * If the message does not include a "pid" parameter, the process
+ * identifier found in the peer credentials is used instead. If it does,
+ * it must be the process itself or one of its threads (the cluck library
+ * sends its thread identifier).
+ *
+ * The verification itself is done by the local_peer object.
+ *
+ * \param[in,out] msg  The message to update.
+ */
+void local_client::prepare_message(ed::message & msg)
+{
+    msg.set_sent_from_server(f_cluckd->get_server_name());
+    msg.set_sent_from_service(f_service_name);
+
+    if(f_peer.get_pid() <= 0)
+    {
+        return; // LCOV_EXCL_LINE
+    }
+
+    if(msg.has_parameter(cluck::g_name_cluck_param_pid))
+    {
+        pid_t const pid(msg.get_integer_parameter(cluck::g_name_cluck_param_pid));
+        if(f_peer.is_peer_thread(pid))
+        {
+            return;
+        }
+
+        SNAP_LOG_WARNING
+            << "local client \""
+            << f_service_name
+            << "\" sent pid "
+            << pid
+            << " which is not one of its threads; using "
+            << f_peer.get_pid()
+            << " instead."
+            << SNAP_LOG_SEND;
+    }
+
+    msg.add_parameter(cluck::g_name_cluck_param_pid, f_peer.get_pid());
+}
+
+
+void local_client::disconnected()
+{
+    f_cluckd->remove_local_client(f_service_name);
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,83 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+// self
+//
+#include    "local_peer.h"
+
+
+// eventdispatcher
+//
+#include    <eventdispatcher/dispatcher.h>
+#include    <eventdispatcher/local_stream_server_client_message_connection.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+class cluckd;
+
+
+
+class local_client
+    : public ed::local_stream_server_client_message_connection
+{
+public:
+    typedef std::shared_ptr<local_client>       pointer_t;
+    typedef std::weak_ptr<local_client>         weak_pointer_t;
+    typedef std::map<std::string, weak_pointer_t>
+                                                map_t;      // key is the service name
+
+                                local_client(
+                                          cluckd * c
+                                        , snapdev::raii_fd_t client
+                                        , std::string const & service_name);
+                                local_client(local_client const & rhs) = delete;
+    virtual                     ~local_client() override;
+
+    local_client &              operator = (local_client const & rhs) = delete;
+
+    std::string const &         get_service_name() const;
+    pid_t                       get_peer_pid() const;
+
+    // ed::connection implementation
+    virtual void                process_hup() override;
+    virtual void                process_error() override;
+    virtual void                process_invalid() override;
+
+private:
+    void                        msg_ignore(ed::message & msg);
+    void                        msg_lock(ed::message & msg);
+    void                        msg_unlock(ed::message & msg);
+    void                        prepare_message(ed::message & msg);
+    void                        disconnected();
+
+    cluckd *                    f_cluckd = nullptr;
+    std::string                 f_service_name = std::string();
+    local_peer                  f_peer;
+    ed::dispatcher::pointer_t   f_dispatcher = ed::dispatcher::pointer_t();
+};
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,201 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Implementation of the requests forwarded for local clients.
+ *
+ * When the cluck daemon is not a leader, the LOCK and UNLOCK messages of
+ * the clients connected to its Unix socket (see local_client) get
+ * forwarded to a leader. The communicator daemon does not know about
+ * those clients so the leader replies to this cluck daemon, which relays
+ * the reply to the client which made the request.
+ *
+ * The leaders only know the object name, the tag, and the process
+ * identifier of the request. The tags are chosen by each client so two
+ * clients may well use the same tag on the same object. The process
+ * identifier is what distinguishes them: it was verified against the
+ * peer credentials of the client (see local_peer) and a process or
+ * thread identifier is unique on a computer.
+ */
+
+// self
+//
+#include    "local_forwards.h"
+
+#include    "ticket_key.h"
+
+
+// cluck
+//
+#include    <cluck/names.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+/** \class local_forwards
+ * \brief Map the replies of the leaders back to the local clients.
+ *
+ * Each request is saved with the process identifier, the object name,
+ * and the tag of the request as the key and the service name of the
+ * local client as the value.
+ */
+
+
+
+/** \brief Remember which local client sent a request.
+ *
+ * \param[in] service_name  The service name of the local client.
+ * \param[in] pid  The process identifier of the request.
+ * \param[in] object_name  The name of the object to lock.
+ * \param[in] tag  The tag of the request.
+ */
+void local_forwards::add(
+      std::string const & service_name
+    , pid_t pid
+    , std::string const & object_name
+    , ed::dispatcher_match::tag_t tag)
+{
+    f_forwards[make_key(pid, object_name, tag)] = service_name;
+}
+
+
+/** \brief Search the local client which sent a request.
+ *
+ * \param[in] pid  The process identifier of the request.
+ * \param[in] object_name  The name of the object to lock.
+ * \param[in] tag  The tag of the request.
+ *
+ * \return The service name of the local client or an empty string.
+ */
+std::string local_forwards::find(
+      pid_t pid
+    , std::string const & object_name
+    , ed::dispatcher_match::tag_t tag) const
+{
+    auto const it(f_forwards.find(make_key(pid, object_name, tag)));
+    if(it == f_forwards.end())
+    {
+        return std::string();
+    }
+    return it->second;
+}
+
+
+/** \brief Forget a request.
+ *
+ * \param[in] pid  The process identifier of the request.
+ * \param[in] object_name  The name of the object to lock.
+ * \param[in] tag  The tag of the request.
+ *
+ * \return true if the request was found.
+ */
+bool local_forwards::remove(
+      pid_t pid
+    , std::string const & object_name
+    , ed::dispatcher_match::tag_t tag)
+{
+    return f_forwards.erase(make_key(pid, object_name, tag)) != 0;
+}
+
+
+/** \brief Forget all the requests of a local client.
+ *
+ * This function is called when the local client disconnects.
+ *
+ * \param[in] service_name  The service name of the local client.
+ */
+void local_forwards::remove_service(std::string const & service_name)
+{
+    for(auto it(f_forwards.begin()); it != f_forwards.end(); )
+    {
+        if(it->second == service_name)
+        {
+            it = f_forwards.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+
+/** \brief Forget all the requests.
+ */
+void local_forwards::clear()
+{
+    f_forwards.clear();
+}
+
+
+/** \brief Get the number of requests currently remembered.
+ *
+ * \return The number of requests.
+ */
+std::size_t local_forwards::size() const
+{
+    return f_forwards.size();
+}
+
+
+/** \brief Retrieve the process identifier of a reply.
+ *
+ * The LOCKED, LOCK_PROGRESS, UNLOCKING, and UNLOCKED replies include the
+ * "pid" parameter. The LOCK_FAILED replies include the "key" parameter
+ * instead, which ends with the process identifier whether it is an
+ * entering key or a ticket key.
+ *
+ * \param[in] msg  The reply received from a leader.
+ *
+ * \return The process identifier or 0 if the reply does not include one.
+ */
+pid_t local_forwards::get_reply_pid(ed::message const & msg)
+{
+    if(msg.has_parameter(cluck::g_name_cluck_param_pid))
+    {
+        return msg.get_integer_parameter(cluck::g_name_cluck_param_pid);
+    }
+    if(msg.has_parameter(cluck::g_name_cluck_param_key))
+    {
+        return ticket_key(msg.get_parameter(cluck::g_name_cluck_param_key)).get_pid();
+    }
+    return 0;
+}
+
+
+std::string local_forwards::make_key(
+      pid_t pid
+    , std::string const & object_name
+    , ed::dispatcher_match::tag_t tag)
+{
+    return std::to_string(pid) + '/' + object_name + '/' + std::to_string(tag);
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
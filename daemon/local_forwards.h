@@ -0,0 +1,78 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+// eventdispatcher
+//
+#include    <eventdispatcher/dispatcher_match.h>
+#include    <eventdispatcher/message.h>
+
+
+// C++
+//
+#include    <map>
+#include    <string>
+
+
+// C
+//
+#include    <sys/types.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+class local_forwards
+{
+public:
+    void                        add(
+                                      std::string const & service_name
+                                    , pid_t pid
+                                    , std::string const & object_name
+                                    , ed::dispatcher_match::tag_t tag);
+    std::string                 find(
+                                      pid_t pid
+                                    , std::string const & object_name
+                                    , ed::dispatcher_match::tag_t tag) const;
+    bool                        remove(
+                                      pid_t pid
+                                    , std::string const & object_name
+                                    , ed::dispatcher_match::tag_t tag);
+    void                        remove_service(std::string const & service_name);
+    void                        clear();
+    std::size_t                 size() const;
+
+    static pid_t                get_reply_pid(ed::message const & msg);
+
+private:
+    static std::string          make_key(
+                                      pid_t pid
+                                    , std::string const & object_name
+                                    , ed::dispatcher_match::tag_t tag);
+
+    std::map<std::string, std::string>
+                                f_forwards = std::map<std::string, std::string>();   // "<pid>/<object>/<tag>" -> local service name
+};
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
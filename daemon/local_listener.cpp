@@ -0,0 +1,122 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// self
+//
+#include    "local_listener.h"
+
+#include    "cluckd.h"
+#include    "local_client.h"
+
+
+// eventdispatcher
+//
+#include    <eventdispatcher/communicator.h>
+
+
+// snaplogger
+//
+#include    <snaplogger/message.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+/** \class local_listener
+ * \brief Listen for direct connections from local clients.
+ *
+ * The cluck library normally sends its LOCK and UNLOCK messages through
+ * the communicator daemon. This means each message gets parsed and
+ * serialized twice in each direction before it reaches cluckd.
+ *
+ * When the `local-listen` option is set, the cluck daemon also listens
+ * on a Unix stream socket. Local clients can connect to that socket
+ * (see cluck::local_messenger) and exchange their lock messages directly
+ * with the cluck daemon. Messages between computers still go through the
+ * communicator daemon.
+ */
+
+
+
+/** \brief Initialize the local listener.
+ *
+ * This function creates the Unix socket and starts listening for
+ * connections from local clients.
+ *
+ * \param[in] c  The cluck daemon which owns this listener.
+ * \param[in] address  The path to the Unix socket.
+ */
+local_listener::local_listener(
+          cluckd * c
+        , addr::addr_unix const & address)
+    : local_stream_server_connection(address, 50, true, true)
+    , f_cluckd(c)
+{
+    set_name("cluck_local_listener");
+}
+
+
+local_listener::~local_listener()
+{
+}
+
+
+/** \brief Accept a new local client.
+ *
+ * This function accepts the new connection and creates a local_client
+ * object to handle it. Each client receives a unique service name which
+ * is used to route the replies back to it.
+ */
+void local_listener::process_accept()
+{
+    snapdev::raii_fd_t new_client(accept());
+    if(new_client == nullptr)
+    {
+        // an error occurred, report in the logs
+        //
+        int const e(errno);
+        SNAP_LOG_ERROR
+            << "somehow accept() of a local client failed with errno: "
+            << e
+            << " -- "
+            << strerror(e)
+            << SNAP_LOG_SEND;
+        return;
+    }
+
+    ++f_next_client;
+    local_client::pointer_t client(std::make_shared<local_client>(
+              f_cluckd
+            , std::move(new_client)
+            , "cluck_local_" + std::to_string(f_next_client)));
+    f_cluckd->add_local_client(client);
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,791 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// self
+//
+#include    "local_lock.h"
+
+#include    "cluckd.h"
+
+
+// cluck
+//
+#include    <cluck/names.h>
+
+
+// snapdev
+//
+#include    <snapdev/not_used.h>
+
+
+// snaplogger
+//
+#include    <snaplogger/message.h>
+
+
+// C++
+//
+#include    <algorithm>
+
+
+// C
+//
+#include    <unistd.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+namespace
+{
+
+
+
+/** \brief Extra time given to the leaders to reply about the node ticket.
+ *
+ * If neither a LOCKED nor a LOCK_FAILED is received by the time the
+ * node ticket obtention timeout plus this amount of time is reached,
+ * the LOCK message is considered lost.
+ *
+ * Similarly, once the node ticket was obtained, the leaders are expected
+ * to send the UNLOCKED message by the end of the node ticket. If it is
+ * not received by that date plus this amount of time, the message is
+ * considered lost.
+ */
+cluck::timeout_t const g_node_lock_grace = cluck::timeout_t(5, 0);
+
+
+/** \brief Delay before requesting a new node ticket after a failure.
+ *
+ * When the leaders refuse the node ticket without saying when to try
+ * again (i.e. no "retry_after" parameter), the local lock waits this
+ * long before sending a new LOCK for the clients still waiting.
+ */
+cluck::timeout_t const g_node_lock_retry = cluck::timeout_t(1, 0);
+
+
+
+} // no name namespace
+
+
+
+/** \class local_lock
+ * \brief Combine the LOCK requests of local clients.
+ *
+ * When many processes running on the same computer ask for a lock on
+ * the same object, each LOCK would otherwise be forwarded to a leader
+ * and go through the whole bakery algorithm (several messages between
+ * the three leaders for each lock). For hot objects, this represents a
+ * lot of network traffic for requests which end up being serialized
+ * anyway.
+ *
+ * A cluck daemon which is not a leader of the object can instead queue
+ * the local requests in a local_lock object. That object requests one
+ * ticket from the leaders on behalf of the whole computer (the node
+ * ticket) and, while that ticket is held, it grants the lock to each
+ * local waiter in turn. Each local client still receives its own
+ * LOCKED, UNLOCKED, UNLOCKING, and LOCK_FAILED messages so the client
+ * library does not see any difference.
+ *
+ * To remain fair with the other computers, the node ticket is released
+ * once \em limit local clients were granted the lock or when the node
+ * ticket does not have enough time left for the next client. If more
+ * local clients are waiting at that point, a new node ticket is
+ * requested and placed at the end of the cluster queue.
+ *
+ * The entering key of the node ticket is built from the name of this
+ * computer and the process identifier of the cluck daemon so the leaders
+ * send their replies back to this daemon.
+ *
+ * \note
+ * The local clients do not receive LOCK_PROGRESS messages while their
+ * requests are combined. Their position in the cluster queue is the one
+ * of the node ticket, which the leaders do not know about. The
+ * "progress" parameter of their LOCK is ignored.
+ *
+ * \note
+ * The leaders see the node ticket as a request from the cluck daemon
+ * itself so all the local clients would share a single client quota.
+ * For that reason, the cluck daemon does not combine requests when the
+ * `client-lock-rate` or `client-max-tickets` options are set.
+ */
+
+
+
+/** \brief Initialize a local lock.
+ *
+ * The local lock starts idle. The first call to lock() sends the LOCK
+ * message for the node ticket.
+ *
+ * \param[in] c  The cluck daemon object.
+ * \param[in] messenger  The messenger used to send messages.
+ * \param[in] object_name  The name of the object being locked.
+ * \param[in] limit  The maximum number of local clients granted the lock
+ * per node ticket.
+ */
+local_lock::local_lock(
+          cluckd * c
+        , messenger::pointer_t messenger
+        , std::string const & object_name
+        , std::size_t limit)
+    : f_cluckd(c)
+    , f_messenger(messenger)
+    , f_object_name(object_name)
+    , f_limit(std::max(static_cast<std::size_t>(1), limit))
+    , f_entering_key(atom(f_cluckd->get_server_name()), getpid())
+{
+}
+
+
+/** \brief Add a request from a local client.
+ *
+ * This function adds the LOCK request of a local client to the queue
+ * of waiting clients. If the node ticket is not yet requested, the
+ * LOCK gets sent to a leader. If the node ticket is held and no client
+ * currently owns the lock, the lock is immediately granted.
+ *
+ * A client with the same server name and process identifier as one
+ * already in the queue is refused with a LOCK_FAILED message.
+ *
+ * \param[in] msg  The LOCK message sent by the client.
+ * \param[in] tag  The tag of the client lock.
+ * \param[in] client_pid  The process identifier of the client.
+ * \param[in] obtention_timeout  The date when the LOCK times out.
+ * \param[in] duration  The duration of the lock once obtained.
+ * \param[in] unlock_duration  The amount of time to wait for the UNLOCK.
+ */
+void local_lock::lock(
+          ed::message const & msg
+        , ed::dispatcher_match::tag_t tag
+        , pid_t client_pid
+        , cluck::timeout_t obtention_timeout
+        , cluck::timeout_t duration
+        , cluck::timeout_t unlock_duration)
+{
+    request r;
+    r.f_server_name = msg.get_sent_from_server();
+    r.f_service_name = msg.get_sent_from_service();
+    r.f_tag = tag;
+    r.f_client_pid = client_pid;
+    r.f_obtention_timeout = obtention_timeout;
+    r.f_duration = duration;
+    r.f_unlock_duration = unlock_duration == cluck::CLUCK_DEFAULT_TIMEOUT
+                            ? duration
+                            : unlock_duration;
+
+    auto const same([&r](request const & o)
+        {
+            return o.f_server_name == r.f_server_name
+                && o.f_client_pid == r.f_client_pid;
+        });
+    if((f_granted && same(f_owner))
+    || std::find_if(f_waiting.begin(), f_waiting.end(), same) != f_waiting.end())
+    {
+        SNAP_LOG_ERROR
+            << "a local lock request has the same object name \""
+            << f_object_name
+            << "\" ("
+            << tag
+            << ") and client \""
+            << r.f_server_name
+            << '/'
+            << client_pid
+            << "\"."
+            << SNAP_LOG_SEND;
+
+        send_reply(r, cluck::g_name_cluck_cmd_lock_failed, cluck::g_name_cluck_value_duplicate);
+        return;
+    }
+
+    f_waiting.push_back(r);
+
+    switch(f_state)
+    {
+    case state_t::LOCAL_LOCK_STATE_IDLE:
+        if(f_retry_date == cluck::timeout_t())
+        {
+            send_node_lock();
+        }
+        // else -- cleanup() sends the LOCK once the retry date is reached
+        break;
+
+    case state_t::LOCAL_LOCK_STATE_LOCKED:
+        if(!f_granted)
+        {
+            grant_next(); // LCOV_EXCL_LINE
+        }
+        break;
+
+    case state_t::LOCAL_LOCK_STATE_LOCKING:
+    case state_t::LOCAL_LOCK_STATE_UNLOCKING:
+        // wait for the leaders
+        //
+        break;
+
+    }
+}
+
+
+/** \brief Release a local lock.
+ *
+ * This function is called when a local client sends an UNLOCK. If that
+ * client currently owns the lock, it gets the UNLOCKED reply and the
+ * lock is granted to the next local client, if any. If the client is
+ * still waiting, it is removed from the queue.
+ *
+ * \param[in] server_name  The name of the server sending the UNLOCK.
+ * \param[in] client_pid  The process identifier of the client.
+ *
+ * \return true if the client was found in this local lock.
+ */
+bool local_lock::unlock(std::string const & server_name, pid_t client_pid)
+{
+    if(f_granted
+    && f_owner.f_server_name == server_name
+    && f_owner.f_client_pid == client_pid)
+    {
+        send_reply(f_owner, cluck::g_name_cluck_cmd_unlocked, std::string());
+        f_granted = false;
+        if(f_state == state_t::LOCAL_LOCK_STATE_LOCKED)
+        {
+            grant_next();
+        }
+        return true;
+    }
+
+    auto it(std::find_if(
+              f_waiting.begin()
+            , f_waiting.end()
+            , [&server_name, client_pid](request const & r)
+            {
+                return r.f_server_name == server_name
+                    && r.f_client_pid == client_pid;
+            }));
+    if(it != f_waiting.end())
+    {
+        send_reply(*it, cluck::g_name_cluck_cmd_unlocked, std::string());
+        f_waiting.erase(it);
+        return true;
+    }
+
+    return false;
+}
+
+
+/** \brief The node ticket was obtained.
+ *
+ * The leaders sent us a LOCKED message for our node ticket. We can
+ * now grant the lock to the local clients, one at a time.
+ *
+ * \param[in] msg  The LOCKED message.
+ */
+void local_lock::node_locked(ed::message const & msg)
+{
+    if(f_state != state_t::LOCAL_LOCK_STATE_LOCKING)
+    {
+        return;
+    }
+
+    f_state = state_t::LOCAL_LOCK_STATE_LOCKED;
+    f_lock_timeout_date = msg.get_timespec_parameter(cluck::g_name_cluck_param_timeout_date);
+    f_unlocked_date = msg.get_timespec_parameter(cluck::g_name_cluck_param_unlocked_date);
+    f_node_deadline = f_unlocked_date + g_node_lock_grace;
+    f_grants = 0;
+
+    grant_next();
+}
+
+
+/** \brief The node ticket is timing out.
+ *
+ * The leaders let us know that the node ticket duration elapsed. The
+ * current owner, if any, is told to unlock. No other local client gets
+ * the lock with this node ticket.
+ *
+ * \param[in] msg  The UNLOCKING message.
+ */
+void local_lock::node_unlocking(ed::message const & msg)
+{
+    snapdev::NOT_USED(msg);
+
+    if(f_granted
+    && !f_owner.f_unlocking)
+    {
+        f_owner.f_unlocking = true;
+        send_reply(f_owner, cluck::g_name_cluck_cmd_unlocking, cluck::g_name_cluck_value_timedout);
+    }
+}
+
+
+/** \brief The node ticket was released.
+ *
+ * This is the reply to our UNLOCK or the leaders letting us know that
+ * the node ticket timed out. If a local client still owns the lock, it
+ * gets an UNLOCKED message. If more local clients are waiting, a new
+ * node ticket is requested.
+ *
+ * \param[in] msg  The UNLOCKED message.
+ */
+void local_lock::node_unlocked(ed::message const & msg)
+{
+    snapdev::NOT_USED(msg);
+
+    if(f_granted)
+    {
+        send_reply(f_owner, cluck::g_name_cluck_cmd_unlocked, cluck::g_name_cluck_value_timedout);
+        f_granted = false;
+    }
+
+    f_state = state_t::LOCAL_LOCK_STATE_IDLE;
+    if(!f_waiting.empty())
+    {
+        send_node_lock();
+    }
+}
+
+
+/** \brief The node ticket could not be obtained.
+ *
+ * The leaders could not give us the node ticket. The local clients
+ * which reached their own obtention timeout receive a LOCK_FAILED with
+ * the same error. The other clients keep waiting and a new node ticket
+ * is requested on their behalf.
+ *
+ * When the node ticket timed out, the new LOCK is sent immediately.
+ * Otherwise (i.e. the leaders are overloaded or the computer is over
+ * its quota), it is sent after the delay specified in the "retry_after"
+ * parameter, or one second if not specified, so the local lock does
+ * not flood the leaders with LOCK messages.
+ *
+ * \param[in] msg  The LOCK_FAILED message.
+ */
+void local_lock::node_lock_failed(ed::message const & msg)
+{
+    cluck::timeout_t const now(snapdev::now());
+    std::string const error(msg.get_parameter(cluck::g_name_cluck_param_error));
+    for(auto it(f_waiting.begin()); it != f_waiting.end(); )
+    {
+        if(it->f_obtention_timeout <= now)
+        {
+            send_reply(*it, cluck::g_name_cluck_cmd_lock_failed, error);
+            it = f_waiting.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if(f_granted)
+    {
+        send_reply(f_owner, cluck::g_name_cluck_cmd_unlocked, error);
+        f_granted = false;
+    }
+
+    f_state = state_t::LOCAL_LOCK_STATE_IDLE;
+    if(!f_waiting.empty())
+    {
+        if(error == cluck::g_name_cluck_value_timedout)
+        {
+            send_node_lock();
+        }
+        else
+        {
+            cluck::timeout_t retry_after(g_node_lock_retry);
+            if(msg.has_parameter(cluck::g_name_cluck_param_retry_after))
+            {
+                retry_after = std::max(
+                          msg.get_timespec_parameter(cluck::g_name_cluck_param_retry_after)
+                        , cluck::timeout_t(0, 1'000'000));
+            }
+            f_retry_date = now + retry_after;
+        }
+    }
+}
+
+
+std::string const & local_lock::get_object_name() const
+{
+    return f_object_name;
+}
+
+
+ticket_key const & local_lock::get_entering_key() const
+{
+    return f_entering_key;
+}
+
+
+ed::dispatcher_match::tag_t local_lock::get_tag() const
+{
+    return f_tag;
+}
+
+
+std::size_t local_lock::get_waiting_count() const
+{
+    return f_waiting.size();
+}
+
+
+/** \brief Check whether this local lock can be deleted.
+ *
+ * A local lock which has no node ticket, no owner, and no waiting
+ * clients is not useful anymore and can be removed.
+ *
+ * \return true if the local lock is idle.
+ */
+bool local_lock::is_idle() const
+{
+    return f_state == state_t::LOCAL_LOCK_STATE_IDLE
+        && !f_granted
+        && f_waiting.empty();
+}
+
+
+/** \brief Get the date when cleanup() needs to be called.
+ *
+ * This function returns the earliest date at which one of the requests
+ * of this local lock times out. The message handlers use it to push
+ * their deadline instead of running a full cleanup pass.
+ *
+ * \return The earliest timeout of this local lock or
+ * snapdev::timespec_ex::max() if there is no such date.
+ */
+cluck::timeout_t local_lock::get_next_timeout() const
+{
+    cluck::timeout_t next_timeout(snapdev::timespec_ex::max());
+
+    for(auto const & r : f_waiting)
+    {
+        next_timeout = std::min(next_timeout, r.f_obtention_timeout);
+    }
+
+    if(f_state == state_t::LOCAL_LOCK_STATE_IDLE)
+    {
+        if(f_retry_date != cluck::timeout_t())
+        {
+            next_timeout = std::min(next_timeout, f_retry_date);
+        }
+    }
+    else
+    {
+        next_timeout = std::min(next_timeout, f_node_deadline);
+    }
+
+    if(f_granted)
+    {
+        next_timeout = std::min(
+                  next_timeout
+                , f_owner.f_unlocking
+                    ? f_owner.f_unlocked_date
+                    : f_owner.f_lock_timeout_date);
+    }
+
+    return next_timeout;
+}
+
+
+/** \brief Time out local requests.
+ *
+ * This function sends a LOCK_FAILED to the waiting clients which timed
+ * out and an UNLOCKING or UNLOCKED to the owner when its lock times out.
+ * In the latter case, the lock is granted to the next client.
+ *
+ * If a new node ticket has to be requested after a failure (see
+ * node_lock_failed()), the LOCK is sent once the retry date is reached.
+ *
+ * If the leaders do not reply about the node ticket in time (i.e. the
+ * LOCK, LOCKED, or UNLOCK message was lost with a leader), the node
+ * ticket is forgotten and a new one is requested if clients are still
+ * waiting. The new ticket uses a new tag so late replies about the
+ * previous one get ignored.
+ *
+ * \param[in] now  The current date.
+ *
+ * \return The date when this function needs to be called again or
+ * snapdev::timespec_ex::max() if there is no such date.
+ */
+cluck::timeout_t local_lock::cleanup(cluck::timeout_t const & now)
+{
+    cluck::timeout_t next_timeout(snapdev::timespec_ex::max());
+
+    for(auto it(f_waiting.begin()); it != f_waiting.end(); )
+    {
+        if(it->f_obtention_timeout <= now)
+        {
+            send_reply(*it, cluck::g_name_cluck_cmd_lock_failed, cluck::g_name_cluck_value_timedout);
+            it = f_waiting.erase(it);
+        }
+        else
+        {
+            next_timeout = std::min(next_timeout, it->f_obtention_timeout);
+            ++it;
+        }
+    }
+
+    if(f_state == state_t::LOCAL_LOCK_STATE_IDLE
+    && f_retry_date != cluck::timeout_t())
+    {
+        if(f_waiting.empty())
+        {
+            f_retry_date = cluck::timeout_t();
+        }
+        else if(f_retry_date <= now)
+        {
+            send_node_lock();
+        }
+        else
+        {
+            next_timeout = std::min(next_timeout, f_retry_date);
+        }
+    }
+
+    if(f_state != state_t::LOCAL_LOCK_STATE_IDLE
+    && f_node_deadline <= now)
+    {
+        if(f_state == state_t::LOCAL_LOCK_STATE_LOCKING)
+        {
+            SNAP_LOG_WARNING
+                << "the ticket of local lock \""
+                << f_object_name
+                << "\" timed out without a reply from the leaders."
+                << SNAP_LOG_SEND;
+        }
+        else
+        {
+            // the node ticket ended a while ago and the leaders still
+            // did not send the UNLOCKED; consider that message lost
+            //
+            SNAP_LOG_WARNING
+                << "the ticket of local lock \""
+                << f_object_name
+                << "\" ended without an UNLOCKED from the leaders."
+                << SNAP_LOG_SEND;
+        }
+
+        if(f_granted)
+        {
+            send_reply(f_owner, cluck::g_name_cluck_cmd_unlocked, cluck::g_name_cluck_value_timedout);
+            f_granted = false;
+        }
+        f_state = state_t::LOCAL_LOCK_STATE_IDLE;
+        if(!f_waiting.empty())
+        {
+            send_node_lock();
+        }
+    }
+    if(f_state != state_t::LOCAL_LOCK_STATE_IDLE)
+    {
+        next_timeout = std::min(next_timeout, f_node_deadline);
+    }
+
+    if(f_granted)
+    {
+        if(f_owner.f_unlocked_date <= now)
+        {
+            send_reply(f_owner, cluck::g_name_cluck_cmd_unlocked, cluck::g_name_cluck_value_timedout);
+            f_granted = false;
+            if(f_state == state_t::LOCAL_LOCK_STATE_LOCKED)
+            {
+                grant_next();
+                if(f_granted)
+                {
+                    next_timeout = std::min(next_timeout, f_owner.f_lock_timeout_date);
+                }
+            }
+        }
+        else if(f_owner.f_lock_timeout_date <= now)
+        {
+            if(!f_owner.f_unlocking)
+            {
+                f_owner.f_unlocking = true;
+                send_reply(f_owner, cluck::g_name_cluck_cmd_unlocking, cluck::g_name_cluck_value_timedout);
+            }
+            next_timeout = std::min(next_timeout, f_owner.f_unlocked_date);
+        }
+        else
+        {
+            next_timeout = std::min(next_timeout, f_owner.f_lock_timeout_date);
+        }
+    }
+
+    return next_timeout;
+}
+
+
+/** \brief Request the node ticket.
+ *
+ * This function sends a LOCK to the leader handling this object on
+ * behalf of all the local clients. The obtention timeout is the largest
+ * timeout of the waiting clients and the duration is large enough to
+ * grant the lock to \em limit clients in a row.
+ *
+ * A new tag is used for each node ticket so late replies about a
+ * previous node ticket can be ignored.
+ */
+void local_lock::send_node_lock()
+{
+    cluck::timeout_t obtention_timeout;
+    cluck::timeout_t duration;
+    cluck::timeout_t unlock_duration;
+    for(auto const & r : f_waiting)
+    {
+        obtention_timeout = std::max(obtention_timeout, r.f_obtention_timeout);
+        duration = std::max(duration, r.f_duration);
+        unlock_duration = std::max(unlock_duration, r.f_unlock_duration);
+    }
+    cluck::timeout_t total_duration;
+    for(std::size_t idx(0); idx < f_limit && total_duration < cluck::CLUCK_MAXIMUM_TIMEOUT; ++idx)
+    {
+        total_duration += duration;
+    }
+    total_duration = std::min(total_duration, cluck::CLUCK_MAXIMUM_TIMEOUT);
+
+    f_tag = ed::dispatcher_match::get_next_tag();
+    f_state = state_t::LOCAL_LOCK_STATE_LOCKING;
+    f_retry_date = cluck::timeout_t();
+    f_node_deadline = obtention_timeout + g_node_lock_grace;
+
+    ed::message lock_message;
+    lock_message.set_command(cluck::g_name_cluck_cmd_lock);
+    lock_message.add_parameter(cluck::g_name_cluck_param_object_name, f_object_name);
+    lock_message.add_parameter(cluck::g_name_cluck_param_tag, f_tag);
+    lock_message.add_parameter(cluck::g_name_cluck_param_pid, getpid());
+    lock_message.add_parameter(cluck::g_name_cluck_param_timeout, obtention_timeout);
+    lock_message.add_parameter(cluck::g_name_cluck_param_duration, total_duration);
+    lock_message.add_parameter(cluck::g_name_cluck_param_unlock_duration, unlock_duration);
+    lock_message.add_parameter(cluck::g_name_cluck_param_lock_proxy_server_name, f_cluckd->get_server_name());
+    lock_message.add_parameter(cluck::g_name_cluck_param_lock_proxy_service_name, cluck::g_name_cluck_service_name);
+    f_cluckd->forward_message_to_leader(lock_message);
+}
+
+
+/** \brief Release the node ticket.
+ *
+ * This function sends the UNLOCK of the node ticket to a leader. The
+ * local lock then waits for the UNLOCKED reply before requesting a new
+ * node ticket for the clients still waiting.
+ */
+void local_lock::send_node_unlock()
+{
+    f_state = state_t::LOCAL_LOCK_STATE_UNLOCKING;
+
+    ed::message unlock_message;
+    unlock_message.set_command(cluck::g_name_cluck_cmd_unlock);
+    unlock_message.add_parameter(cluck::g_name_cluck_param_object_name, f_object_name);
+    unlock_message.add_parameter(cluck::g_name_cluck_param_tag, f_tag);
+    unlock_message.add_parameter(cluck::g_name_cluck_param_pid, getpid());
+    unlock_message.add_parameter(cluck::g_name_cluck_param_lock_proxy_server_name, f_cluckd->get_server_name());
+    unlock_message.add_parameter(cluck::g_name_cluck_param_lock_proxy_service_name, cluck::g_name_cluck_service_name);
+    f_cluckd->forward_message_to_leader(unlock_message);
+}
+
+
+/** \brief Grant the lock to the next local client.
+ *
+ * This function is called while the node ticket is held and no local
+ * client owns the lock. The next client which did not yet time out
+ * receives a LOCKED message.
+ *
+ * The node ticket is released instead when no client is waiting, when
+ * the fairness limit is reached, or when the node ticket does not have
+ * enough time left for the next client's lock duration.
+ */
+void local_lock::grant_next()
+{
+    cluck::timeout_t const now(snapdev::now());
+    while(!f_waiting.empty()
+       && f_waiting.front().f_obtention_timeout <= now)
+    {
+        send_reply(f_waiting.front(), cluck::g_name_cluck_cmd_lock_failed, cluck::g_name_cluck_value_timedout);
+        f_waiting.pop_front();
+    }
+
+    if(f_waiting.empty()
+    || f_grants >= f_limit
+    || now + f_waiting.front().f_duration > f_lock_timeout_date)
+    {
+        send_node_unlock();
+        return;
+    }
+
+    f_owner = f_waiting.front();
+    f_waiting.pop_front();
+    f_granted = true;
+    ++f_grants;
+
+    f_owner.f_lock_timeout_date = now + f_owner.f_duration;
+    f_owner.f_unlocked_date = std::min(f_owner.f_lock_timeout_date + f_owner.f_unlock_duration, f_unlocked_date);
+    send_reply(f_owner, cluck::g_name_cluck_cmd_locked, std::string());
+}
+
+
+/** \brief Send a reply to a local client.
+ *
+ * This function sends one of the LOCKED, LOCK_FAILED, UNLOCKING, or
+ * UNLOCKED messages to a local client with the same parameters as the
+ * leaders would use.
+ *
+ * \param[in] r  The request of the client to reply to.
+ * \param[in] command  The command of the reply.
+ * \param[in] error  The error to include in the reply, if not empty.
+ */
+void local_lock::send_reply(
+      request const & r
+    , std::string const & command
+    , std::string const & error)
+{
+    ed::message reply_message;
+    reply_message.set_command(command);
+    reply_message.set_server(r.f_server_name);
+    reply_message.set_service(r.f_service_name);
+    reply_message.add_parameter(cluck::g_name_cluck_param_object_name, f_object_name);
+    reply_message.add_parameter(cluck::g_name_cluck_param_tag, r.f_tag);
+    if(command == cluck::g_name_cluck_cmd_locked)
+    {
+        reply_message.add_parameter(cluck::g_name_cluck_param_timeout_date, r.f_lock_timeout_date);
+        reply_message.add_parameter(cluck::g_name_cluck_param_unlocked_date, r.f_unlocked_date);
+    }
+    else if(command == cluck::g_name_cluck_cmd_lock_failed)
+    {
+        reply_message.add_parameter(cluck::g_name_cluck_param_key, r.f_server_name + '/' + std::to_string(r.f_client_pid));
+    }
+    else if(command == cluck::g_name_cluck_cmd_unlocked)
+    {
+        reply_message.add_parameter(cluck::g_name_cluck_param_unlocked_date, snapdev::now());
+    }
+    if(!error.empty())
+    {
+        reply_message.add_parameter(cluck::g_name_cluck_param_error, error);
+    }
+    f_messenger->send_message(reply_message);
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,138 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+// self
+//
+#include    "messenger.h"
+#include    "ticket_key.h"
+
+
+// cluck
+//
+#include    <cluck/cluck.h>
+
+
+// C++
+//
+#include    <deque>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+class local_lock
+{
+public:
+    typedef std::shared_ptr<local_lock>         pointer_t;
+    typedef std::map<std::string, pointer_t>    map_t;          // sorted by object_name
+
+                                local_lock(
+                                          cluckd * c
+                                        , messenger::pointer_t messenger
+                                        , std::string const & object_name
+                                        , std::size_t limit);
+                                local_lock(local_lock const &) = delete;
+    local_lock &                operator = (local_lock const &) = delete;
+
+    // messages from local clients
+    //
+    void                        lock(
+                                          ed::message const & msg
+                                        , ed::dispatcher_match::tag_t tag
+                                        , pid_t client_pid
+                                        , cluck::timeout_t obtention_timeout
+                                        , cluck::timeout_t duration
+                                        , cluck::timeout_t unlock_duration);
+    bool                        unlock(std::string const & server_name, pid_t client_pid);
+
+    // messages from the leaders about the node ticket
+    //
+    void                        node_locked(ed::message const & msg);
+    void                        node_unlocking(ed::message const & msg);
+    void                        node_unlocked(ed::message const & msg);
+    void                        node_lock_failed(ed::message const & msg);
+
+    std::string const &         get_object_name() const;
+    ticket_key const &          get_entering_key() const;
+    ed::dispatcher_match::tag_t get_tag() const;
+    std::size_t                 get_waiting_count() const;
+    bool                        is_idle() const;
+    cluck::timeout_t            get_next_timeout() const;
+    cluck::timeout_t            cleanup(cluck::timeout_t const & now);
+
+private:
+    enum class state_t
+    {
+        LOCAL_LOCK_STATE_IDLE,          // no node ticket
+        LOCAL_LOCK_STATE_LOCKING,       // LOCK sent to a leader
+        LOCAL_LOCK_STATE_LOCKED,        // node ticket held, grant locally
+        LOCAL_LOCK_STATE_UNLOCKING,     // UNLOCK sent to a leader
+    };
+
+    struct request
+    {
+        typedef std::deque<request>     queue_t;
+
+        std::string                     f_server_name = std::string();
+        std::string                     f_service_name = std::string();
+        ed::dispatcher_match::tag_t     f_tag = ed::dispatcher_match::DISPATCHER_MATCH_NO_TAG;
+        pid_t                           f_client_pid = 0;
+        cluck::timeout_t                f_obtention_timeout = cluck::timeout_t();
+        cluck::timeout_t                f_duration = cluck::timeout_t();
+        cluck::timeout_t                f_unlock_duration = cluck::timeout_t();
+        cluck::timeout_t                f_lock_timeout_date = cluck::timeout_t();
+        cluck::timeout_t                f_unlocked_date = cluck::timeout_t();
+        bool                            f_unlocking = false;
+    };
+
+    void                        send_node_lock();
+    void                        send_node_unlock();
+    void                        grant_next();
+    void                        send_reply(
+                                          request const & r
+                                        , std::string const & command
+                                        , std::string const & error);
+
+    // this is owned by a cluckd object so no need for a smart pointer
+    //
+    cluckd *                        f_cluckd = nullptr;
+
+    messenger::pointer_t            f_messenger = messenger::pointer_t();
+    std::string                     f_object_name = std::string();
+    std::size_t                     f_limit = 1;
+    ticket_key                      f_entering_key = ticket_key();
+    state_t                         f_state = state_t::LOCAL_LOCK_STATE_IDLE;
+    ed::dispatcher_match::tag_t     f_tag = ed::dispatcher_match::DISPATCHER_MATCH_NO_TAG;
+    cluck::timeout_t                f_lock_timeout_date = cluck::timeout_t();
+    cluck::timeout_t                f_unlocked_date = cluck::timeout_t();
+    cluck::timeout_t                f_node_deadline = cluck::timeout_t();
+    cluck::timeout_t                f_retry_date = cluck::timeout_t();
+    std::size_t                     f_grants = 0;
+    request::queue_t                f_waiting = request::queue_t();
+    request                         f_owner = request();
+    bool                            f_granted = false;
+};
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,180 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Implementation of the credentials of a local client.
+ *
+ * A client connected to the Unix socket of the cluck daemon (see
+ * local_client) is identified by the process identifier found in its
+ * peer credentials (SO_PEERCRED). The kernel gives us that identifier so
+ * it cannot be faked by the client.
+ *
+ * The cluck library sends its thread identifier in the "pid" parameter
+ * of the LOCK and UNLOCK messages. This class verifies that such an
+ * identifier is the peer process itself or one of its threads.
+ */
+
+// self
+//
+#include    "local_peer.h"
+
+
+// C++
+//
+#include    <string>
+
+
+// C
+//
+#include    <sys/socket.h>
+#include    <unistd.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+namespace
+{
+
+
+
+/** \brief Maximum number of threads remembered per local client.
+ *
+ * A client with more threads than this sending LOCK messages gets its
+ * threads checked again once the cache gets cleared.
+ */
+constexpr std::size_t       MAX_PEER_THREADS = 1'000;
+
+
+
+} // no name namespace
+
+
+
+/** \class local_peer
+ * \brief The process at the other end of a local client socket.
+ *
+ * Checking a thread requires a system call so the threads found valid
+ * are remembered for the lifetime of the object. The number of threads
+ * remembered is bounded; when the limit is reached, the cache is cleared
+ * and the threads get checked again.
+ */
+
+
+
+/** \brief Retrieve the credentials of the peer of a Unix socket.
+ *
+ * On failure, get_pid() returns -1 and get_error() returns the errno
+ * of the getsockopt() call.
+ *
+ * \param[in] socket  The socket returned by accept().
+ */
+local_peer::local_peer(int socket)
+{
+    ucred credentials = {};
+    socklen_t length(sizeof(credentials));
+    if(getsockopt(socket, SOL_SOCKET, SO_PEERCRED, &credentials, &length) == 0)
+    {
+        f_pid = credentials.pid;
+    }
+    else
+    {
+        f_error = errno;
+    }
+}
+
+
+/** \brief Get the process identifier of the peer.
+ *
+ * \return The process identifier or -1 if the credentials are not known.
+ */
+pid_t local_peer::get_pid() const
+{
+    return f_pid;
+}
+
+
+/** \brief Get the error which occurred while reading the credentials.
+ *
+ * \return The errno of the getsockopt() call or 0.
+ */
+int local_peer::get_error() const
+{
+    return f_error;
+}
+
+
+/** \brief Check whether \p pid is the peer process or one of its threads.
+ *
+ * A thread is found valid when /proc/<peer>/task/<pid> exists.
+ *
+ * \param[in] pid  The process or thread identifier sent by the client.
+ *
+ * \return true if \p pid belongs to the peer.
+ */
+bool local_peer::is_peer_thread(pid_t pid)
+{
+    if(f_pid <= 0
+    || pid <= 0)
+    {
+        return false;
+    }
+
+    if(pid == f_pid
+    || f_threads.contains(pid))
+    {
+        return true;
+    }
+
+    std::string const task("/proc/" + std::to_string(f_pid) + "/task/" + std::to_string(pid));
+    if(access(task.c_str(), F_OK) != 0)
+    {
+        return false;
+    }
+
+    if(f_threads.size() >= MAX_PEER_THREADS)
+    {
+        f_threads.clear();
+    }
+    f_threads.insert(pid);
+
+    return true;
+}
+
+
+/** \brief Get the number of threads currently remembered.
+ *
+ * \return The number of threads found valid since the cache was cleared.
+ */
+std::size_t local_peer::get_thread_count() const
+{
+    return f_threads.size();
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,56 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+// C++
+//
+#include    <cstdint>
+#include    <unordered_set>
+
+
+// C
+//
+#include    <sys/types.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+class local_peer
+{
+public:
+                                local_peer(int socket);
+
+    pid_t                       get_pid() const;
+    int                         get_error() const;
+    bool                        is_peer_thread(pid_t pid);
+    std::size_t                 get_thread_count() const;
+
+private:
+    pid_t                       f_pid = -1;
+    int                         f_error = 0;
+    std::unordered_set<pid_t>   f_threads = std::unordered_set<pid_t>();
+};
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,269 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Implementation of the lock progress estimates.
+ *
+ * A client waiting for a lock has no idea how long it will have to wait.
+ * When it requests it, the leader owning its ticket sends LOCK_PROGRESS
+ * messages with its position in the queue of the object, the number of
+ * tickets holding the lock ahead of it, and an estimate of the wait. That
+ * way the client can give up early instead of waiting for its obtention
+ * timeout.
+ *
+ * The estimate uses the average time the locks of that object were held
+ * recently. The average is an exponentially weighted moving average so
+ * it adapts quickly when the usage of a lock changes.
+ *
+ * \warning
+ * The estimates are not protected by a mutex. The cluck daemon only uses
+ * them from its main thread.
+ */
+
+// self
+//
+#include    "lock_progress.h"
+
+
+// C++
+//
+#include    <algorithm>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+namespace
+{
+
+
+
+/** \brief Time after which the hold time of an object is forgotten.
+ *
+ * This is in microseconds. This is also how often the list of objects
+ * gets pruned.
+ */
+constexpr std::int64_t      IDLE_OBJECT = 600'000'000;
+
+
+/** \brief The weight of a new sample in the average hold time.
+ *
+ * Each new sample counts for 1/HOLD_WEIGHT of the average.
+ */
+constexpr std::int64_t      HOLD_WEIGHT = 8;
+
+
+
+} // no name namespace
+
+
+
+/** \class lock_progress
+ * \brief Estimate how long a ticket waits before obtaining its lock.
+ *
+ * The cluck daemon calls record_hold() each time a lock gets released
+ * and estimate_wait() when it sends a LOCK_PROGRESS message. The interval
+ * is the minimum amount of time between two LOCK_PROGRESS messages sent
+ * for the same ticket (see the `lock-progress-interval` option).
+ */
+
+
+
+/** \brief Set the minimum interval between two progress messages.
+ *
+ * \param[in] interval  The interval, zero to not send any progress message.
+ */
+void lock_progress::set_interval(cluck::timeout_t const & interval)
+{
+    f_interval = interval;
+}
+
+
+/** \brief Get the minimum interval between two progress messages.
+ *
+ * \return The interval, zero if progress messages are not sent.
+ */
+cluck::timeout_t const & lock_progress::get_interval() const
+{
+    return f_interval;
+}
+
+
+/** \brief Record how long a lock was held.
+ *
+ * \param[in] object_name  The name of the object that was locked.
+ * \param[in] hold  How long the lock was held.
+ * \param[in] now  The current date.
+ */
+void lock_progress::record_hold(
+      std::string const & object_name
+    , cluck::timeout_t const & hold
+    , cluck::timeout_t const & now)
+{
+    std::int64_t const usec(std::max(hold.to_usec(), static_cast<std::int64_t>(0)));
+    atom const object(object_name);
+    hold_t & h(f_holds[object.id()]);
+    if(h.f_samples == 0)
+    {
+        h.f_object_name = object;
+        h.f_average = usec;
+    }
+    else
+    {
+        h.f_average += (usec - h.f_average) / HOLD_WEIGHT;
+    }
+    ++h.f_samples;
+    h.f_last_sample = now;
+}
+
+
+/** \brief Get the average amount of time the object was locked.
+ *
+ * \param[in] object_name  The name of the object.
+ *
+ * \return The average hold time, zero if unknown.
+ */
+cluck::timeout_t lock_progress::get_average_hold(std::string const & object_name) const
+{
+    hold_t const * h(find_hold(object_name));
+    if(h == nullptr)
+    {
+        return cluck::timeout_t();
+    }
+    return cluck::timeout_t(
+                  h->f_average / 1'000'000
+                , h->f_average % 1'000'000 * 1'000);
+}
+
+
+/** \brief Estimate how long a ticket has to wait for its lock.
+ *
+ * Each ticket ahead is expected to hold the lock for the average hold
+ * time of the object. The first ticket ahead may already be holding the
+ * lock, in which case the time it already held the lock gets removed
+ * from the estimate (up to the average hold time).
+ *
+ * \param[in] object_name  The name of the object.
+ * \param[in] ahead  The number of tickets ahead of this one.
+ * \param[in] held_for  How long the first ticket ahead held the lock so
+ * far, zero if it does not hold the lock yet.
+ * \param[out] wait  The estimated wait.
+ *
+ * \return false if the object has no hold time history yet, in which
+ * case \p wait is not modified.
+ */
+bool lock_progress::estimate_wait(
+      std::string const & object_name
+    , std::size_t ahead
+    , cluck::timeout_t const & held_for
+    , cluck::timeout_t & wait) const
+{
+    hold_t const * h(find_hold(object_name));
+    if(h == nullptr)
+    {
+        return false;
+    }
+
+    std::int64_t const average(h->f_average);
+    std::int64_t usec(static_cast<std::int64_t>(ahead) * average);
+    if(ahead > 0)
+    {
+        usec -= std::clamp(held_for.to_usec(), static_cast<std::int64_t>(0), average);
+    }
+    wait = cluck::timeout_t(usec / 1'000'000, usec % 1'000'000 * 1'000);
+
+    return true;
+}
+
+
+/** \brief Get the number of objects with a hold time history.
+ *
+ * \return The number of objects.
+ */
+std::size_t lock_progress::size() const
+{
+    return f_holds.size();
+}
+
+
+/** \brief Forget the objects which were not locked in a while.
+ *
+ * An object which was not released in IDLE_OBJECT microseconds is
+ * removed. The function only goes through the list once every
+ * IDLE_OBJECT microseconds.
+ *
+ * \param[in] now  The current date.
+ */
+void lock_progress::prune(cluck::timeout_t const & now)
+{
+    if((now - f_last_prune).to_usec() < IDLE_OBJECT)
+    {
+        return;
+    }
+    f_last_prune = now;
+
+    for(auto it(f_holds.begin()); it != f_holds.end(); )
+    {
+        if((now - it->second.f_last_sample).to_usec() >= IDLE_OBJECT)
+        {
+            it = f_holds.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+
+
+/** \brief Search the hold times of an object.
+ *
+ * The search does not intern \p object_name (see atom::find()).
+ *
+ * \param[in] object_name  The name of the object.
+ *
+ * \return The hold times of the object or nullptr if unknown.
+ */
+lock_progress::hold_t const * lock_progress::find_hold(std::string const & object_name) const
+{
+    atom const object(atom::find(object_name));
+    if(object.empty())
+    {
+        return nullptr;
+    }
+    auto const it(f_holds.find(object.id()));
+    if(it == f_holds.end())
+    {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
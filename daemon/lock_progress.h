@@ -0,0 +1,83 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+// self
+//
+#include    "atom.h"
+
+
+// cluck
+//
+#include    <cluck/cluck.h>
+
+
+// C++
+//
+#include    <unordered_map>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+class lock_progress
+{
+public:
+    static constexpr std::int64_t   DEFAULT_INTERVAL = 1'000'000;   // in microseconds
+
+    void                        set_interval(cluck::timeout_t const & interval);
+    cluck::timeout_t const &    get_interval() const;
+
+    void                        record_hold(
+                                      std::string const & object_name
+                                    , cluck::timeout_t const & hold
+                                    , cluck::timeout_t const & now);
+    cluck::timeout_t            get_average_hold(std::string const & object_name) const;
+    bool                        estimate_wait(
+                                      std::string const & object_name
+                                    , std::size_t ahead
+                                    , cluck::timeout_t const & held_for
+                                    , cluck::timeout_t & wait) const;
+    std::size_t                 size() const;
+    void                        prune(cluck::timeout_t const & now);
+
+private:
+    struct hold_t
+    {
+        atom                    f_object_name = atom();     // keeps the key interned
+        std::int64_t            f_average = 0;      // in microseconds
+        std::uint64_t           f_samples = 0;
+        cluck::timeout_t        f_last_sample = cluck::timeout_t();
+    };
+
+    typedef std::unordered_map<atom::id_t, hold_t>  hold_map_t;
+
+    hold_t const *              find_hold(std::string const & object_name) const;
+
+    cluck::timeout_t            f_interval = cluck::timeout_t(DEFAULT_INTERVAL / 1'000'000, DEFAULT_INTERVAL % 1'000'000 * 1'000);
+    cluck::timeout_t            f_last_prune = cluck::timeout_t();
+    hold_map_t                  f_holds = hold_map_t();
+};
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,261 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Implementation of the tracing of the phases of a lock.
+ *
+ * A LOCK goes through several phases of the bakery algorithm before the
+ * LOCKED reply gets sent back. When a lock is slow, the time could be
+ * spent waiting for the LOCK_ENTERED, the MAX_TICKET, or the TICKET_ADDED
+ * quorum, waiting for other tickets to be done entering, or waiting for
+ * the ACTIVATE_LOCK. Without a timestamp on each transition, there is
+ * no way to tell which.
+ *
+ * The lock_trace records the date of each transition of one ticket and
+ * the lock_phases aggregates the duration of each phase of all the
+ * tickets in histograms which the INFO message reports.
+ */
+
+// self
+//
+#include    "lock_trace.h"
+
+
+// C++
+//
+#include    <sstream>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+namespace
+{
+
+
+
+/** \brief The name of each phase.
+ *
+ * A phase is named after what the ticket waits on during that phase.
+ */
+constexpr char const * const g_phase_names[lock_trace::PHASE_COUNT] =
+{
+    "admission",            // CREATED -> ENTERING
+    "entering",             // ENTERING -> ENTERED
+    "max_ticket",           // ENTERED -> MAX_TICKET
+    "add_ticket",           // MAX_TICKET -> ADD_TICKET
+    "ticket_added",         // ADD_TICKET -> TICKET_ADDED
+    "still_entering",       // TICKET_ADDED -> READY
+    "activation",           // READY -> LOCKED
+};
+
+
+
+} // no name namespace
+
+
+
+/** \class lock_trace
+ * \brief Record the date of each transition of a ticket.
+ *
+ * The owner of a ticket marks each transition as the ticket goes through
+ * the bakery algorithm. Only the first call to mark() for a given
+ * transition is kept since some of the messages are received once per
+ * leader.
+ *
+ * A date of zero means that the transition did not happen yet.
+ */
+
+
+/** \brief Record the date of a transition.
+ *
+ * The date is saved only the first time the transition is marked.
+ *
+ * \param[in] transition  The transition which just happened.
+ * \param[in] now  The current date.
+ */
+void lock_trace::mark(transition_t transition, cluck::timeout_t const & now)
+{
+    if(f_dates[transition] == cluck::timeout_t())
+    {
+        f_dates[transition] = now;
+    }
+}
+
+
+/** \brief Get the date of a transition.
+ *
+ * \param[in] transition  The transition to retrieve.
+ *
+ * \return The date of the transition or zero if it did not happen yet.
+ */
+cluck::timeout_t const & lock_trace::get_date(transition_t transition) const
+{
+    return f_dates[transition];
+}
+
+
+/** \brief Check whether all the transitions were marked.
+ *
+ * A ticket which was re-sent by the leaders after an election or
+ * a ticket which is not owned by this leader does not go through all
+ * the transitions. Such traces are not added to the statistics.
+ *
+ * \return true if all the transitions happened.
+ */
+bool lock_trace::is_complete() const
+{
+    for(auto const & d : f_dates)
+    {
+        if(d == cluck::timeout_t())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/** \brief Get the duration of one phase.
+ *
+ * \param[in] phase  The phase, from 0 to PHASE_COUNT - 1.
+ *
+ * \return The duration of the phase or -1 if it did not end yet.
+ */
+cluck::timeout_t lock_trace::get_phase(std::size_t phase) const
+{
+    if(phase >= PHASE_COUNT
+    || f_dates[phase] == cluck::timeout_t()
+    || f_dates[phase + 1] == cluck::timeout_t())
+    {
+        return cluck::timeout_t(-1, 0);
+    }
+    return f_dates[phase + 1] - f_dates[phase];
+}
+
+
+/** \brief Describe the phases of this trace.
+ *
+ * The string lists each phase with its duration in microseconds,
+ * followed by the total. The phases which did not end are shown
+ * with a question mark.
+ *
+ * \return A string such as "admission: 5us, entering: 250us, ...".
+ */
+std::string lock_trace::to_string() const
+{
+    std::stringstream ss;
+    for(std::size_t phase(0); phase < PHASE_COUNT; ++phase)
+    {
+        cluck::timeout_t const duration(get_phase(phase));
+        ss << g_phase_names[phase] << ": ";
+        if(duration < cluck::timeout_t())
+        {
+            ss << '?';
+        }
+        else
+        {
+            ss << duration.to_usec() << "us";
+        }
+        ss << ", ";
+    }
+    ss << "total: ";
+    if(f_dates[TRANSITION_CREATED] == cluck::timeout_t()
+    || f_dates[TRANSITION_LOCKED] == cluck::timeout_t())
+    {
+        ss << '?';
+    }
+    else
+    {
+        ss << (f_dates[TRANSITION_LOCKED] - f_dates[TRANSITION_CREATED]).to_usec() << "us";
+    }
+    return ss.str();
+}
+
+
+/** \brief Get the name of a phase.
+ *
+ * \param[in] phase  The phase, from 0 to PHASE_COUNT - 1.
+ *
+ * \return The name of the phase or "unknown".
+ */
+char const * lock_trace::phase_name(std::size_t phase)
+{
+    if(phase >= PHASE_COUNT)
+    {
+        return "unknown";
+    }
+    return g_phase_names[phase];
+}
+
+
+
+/** \class lock_phases
+ * \brief Aggregate the phases of all the locks.
+ *
+ * Each time a lock is obtained, its trace is added here. The durations
+ * of each phase are counted in a histogram (in microseconds).
+ */
+
+
+/** \brief Add the phases of a lock to the statistics.
+ *
+ * Incomplete traces are ignored.
+ *
+ * \param[in] trace  The trace of a ticket which just obtained its lock.
+ */
+void lock_phases::add(lock_trace const & trace)
+{
+    if(!trace.is_complete())
+    {
+        return;
+    }
+
+    for(std::size_t phase(0); phase < lock_trace::PHASE_COUNT; ++phase)
+    {
+        f_phases[phase].add(trace.get_phase(phase).to_usec());
+    }
+}
+
+
+/** \brief Get the histogram of one phase.
+ *
+ * \exception std::out_of_range
+ * The \p phase must be smaller than lock_trace::PHASE_COUNT.
+ *
+ * \param[in] phase  The phase, from 0 to PHASE_COUNT - 1.
+ *
+ * \return The histogram of the durations of that phase in microseconds.
+ */
+histogram const & lock_phases::get_histogram(std::size_t phase) const
+{
+    return f_phases.at(phase);
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,91 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+// self
+//
+#include    "histogram.h"
+
+
+// cluck
+//
+#include    <cluck/cluck.h>
+
+
+// C++
+//
+#include    <array>
+#include    <string>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+class lock_trace
+{
+public:
+    enum transition_t : std::size_t
+    {
+        TRANSITION_CREATED,         // LOCK received
+        TRANSITION_ENTERING,        // LOCK_ENTERING sent
+        TRANSITION_ENTERED,         // LOCK_ENTERED quorum, GET_MAX_TICKET sent
+        TRANSITION_MAX_TICKET,      // MAX_TICKET quorum
+        TRANSITION_ADD_TICKET,      // ADD_TICKET sent
+        TRANSITION_TICKET_ADDED,    // TICKET_ADDED quorum, LOCK_EXITING sent
+        TRANSITION_READY,           // no more tickets entering ahead of us
+        TRANSITION_LOCKED,          // ACTIVATE_LOCK quorum, LOCKED sent
+
+        TRANSITION_COUNT
+    };
+
+    // a phase is the time between a transition and the next
+    //
+    static constexpr std::size_t    PHASE_COUNT = TRANSITION_COUNT - 1;
+
+    void                        mark(transition_t transition, cluck::timeout_t const & now);
+    cluck::timeout_t const &    get_date(transition_t transition) const;
+    bool                        is_complete() const;
+    cluck::timeout_t            get_phase(std::size_t phase) const;
+    std::string                 to_string() const;
+
+    static char const *         phase_name(std::size_t phase);
+
+private:
+    std::array<cluck::timeout_t, TRANSITION_COUNT>
+                                f_dates = std::array<cluck::timeout_t, TRANSITION_COUNT>();
+};
+
+
+class lock_phases
+{
+public:
+    void                        add(lock_trace const & trace);
+    histogram const &           get_histogram(std::size_t phase) const;
+
+private:
+    std::array<histogram, lock_trace::PHASE_COUNT>
+                                f_phases = std::array<histogram, lock_trace::PHASE_COUNT>();
+};
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
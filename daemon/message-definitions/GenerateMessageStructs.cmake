@@ -0,0 +1,210 @@
+# Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+#
+# https://snapwebsites.org/project/cluck
+# contact@m2osw.com
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+# Generate C++ structures from the message definitions
+#
+# Usage:
+#
+#     cmake -D INPUT_DIR=<dir> -D OUTPUT=<file> [-D STAMP=<file>] -P GenerateMessageStructs.cmake
+#
+# Each <COMMAND>.conf file found in INPUT_DIR is transformed into a
+# structure named after the command (in lowercase) in the
+# cluck_daemon::params namespace. The structure has one field per
+# parameter, typed as defined by the `type = ...` entry of that parameter
+# (string by default). The optional parameters also get an f_has_<name>
+# flag. The decode() function reads all the parameters of a message at
+# once and returns false if a required parameter is missing, in which
+# case the f_missing field is set to the name of that parameter. Each
+# parameter is searched once in the message, the timespec parameters are
+# then converted by ed::message::get_timespec_parameter() so an invalid
+# value raises an ed::invalid_message exception like the other types.
+#
+# The OUTPUT file is only written when its content changes so the files
+# including it do not get recompiled for nothing. When a STAMP file is
+# defined, it gets touched each time, which gives the build system an
+# output that is always newer than the inputs.
+
+if(NOT INPUT_DIR OR NOT OUTPUT)
+    message(FATAL_ERROR "INPUT_DIR and OUTPUT must be defined.")
+endif()
+
+file(GLOB DEFINITIONS "${INPUT_DIR}/*.conf")
+list(SORT DEFINITIONS)
+
+set(CODE "// DO NOT EDIT -- generated by GenerateMessageStructs.cmake from the
+// daemon/message-definitions/*.conf files
+#pragma once
+
+// eventdispatcher
+//
+#include    <eventdispatcher/exception.h>
+#include    <eventdispatcher/message.h>
+
+
+// advgetopt
+//
+#include    <advgetopt/validator_integer.h>
+
+
+// snapdev
+//
+#include    <snapdev/timespec_ex.h>
+
+
+// C++
+//
+#include    <cstdint>
+#include    <string>
+
+
+
+namespace cluck_daemon
+{
+namespace params
+{
+
+
+")
+
+foreach(DEFINITION ${DEFINITIONS})
+    get_filename_component(COMMAND ${DEFINITION} NAME_WE)
+    string(TOLOWER ${COMMAND} STRUCT_NAME)
+
+    set(NAMES)
+    set(NAME)
+    file(STRINGS ${DEFINITION} LINES)
+    foreach(LINE ${LINES})
+        if(LINE MATCHES "^\\[([a-z_0-9]+)\\]")
+            set(NAME ${CMAKE_MATCH_1})
+            list(APPEND NAMES ${NAME})
+            set(TYPE_${NAME} "string")
+            set(REQUIRED_${NAME} FALSE)
+        elseif(NAME AND LINE MATCHES "^type *= *([a-z]+)")
+            set(TYPE_${NAME} ${CMAKE_MATCH_1})
+        elseif(NAME AND LINE MATCHES "^flags *= *(.*)$")
+            if(CMAKE_MATCH_1 MATCHES "required")
+                set(REQUIRED_${NAME} TRUE)
+            endif()
+        endif()
+    endforeach()
+
+    set(FIELDS)
+    set(DECODE)
+    foreach(NAME ${NAMES})
+        # the conversion of optional parameters is within an if() block
+        #
+        if(REQUIRED_${NAME})
+            set(I "        ")
+        else()
+            set(I "            ")
+        endif()
+
+        if(TYPE_${NAME} STREQUAL "integer")
+            set(CPP_TYPE "std::int64_t")
+            set(DEFAULT "0")
+            string(CONCAT CONVERT
+                "${I}if(!advgetopt::validator_integer::convert_string(it->second, f_${NAME}))\n"
+                "${I}{\n"
+                "${I}    throw ed::invalid_message(\"${COMMAND} parameter \\\"${NAME}\\\" must be a valid integer.\");\n"
+                "${I}}\n")
+        elseif(TYPE_${NAME} STREQUAL "timespec")
+            set(CPP_TYPE "snapdev::timespec_ex")
+            set(DEFAULT "snapdev::timespec_ex()")
+            # use the ed::message conversion so an invalid value raises
+            # the same ed::invalid_message as before
+            #
+            set(CONVERT "${I}f_${NAME} = msg.get_timespec_parameter(\"${NAME}\");\n")
+        else()
+            set(CPP_TYPE "std::string")
+            set(DEFAULT "std::string()")
+            set(CONVERT "${I}f_${NAME} = it->second;\n")
+        endif()
+
+        string(APPEND FIELDS "    ${CPP_TYPE} f_${NAME} = ${DEFAULT};\n")
+        string(APPEND DECODE
+            "        it = parameters.find(\"${NAME}\");\n")
+        if(REQUIRED_${NAME})
+            string(APPEND DECODE
+                "        if(it == parameters.end())\n"
+                "        {\n"
+                "            f_missing = \"${NAME}\";\n"
+                "            return false;\n"
+                "        }\n"
+                "${CONVERT}")
+        else()
+            string(APPEND FIELDS "    bool f_has_${NAME} = false;\n")
+            string(APPEND DECODE
+                "        f_has_${NAME} = it != parameters.end();\n"
+                "        if(f_has_${NAME})\n"
+                "        {\n"
+                "${CONVERT}"
+                "        }\n")
+        endif()
+    endforeach()
+
+    if(NAMES)
+        string(CONCAT DECODE
+            "        ed::message::parameters_t const & parameters(msg.get_all_parameters());\n"
+            "        ed::message::parameters_t::const_iterator it;\n"
+            "${DECODE}")
+    endif()
+
+    string(APPEND CODE
+        "struct ${STRUCT_NAME}\n"
+        "{\n"
+        "    static constexpr char const * COMMAND = \"${COMMAND}\";\n"
+        "\n"
+        "${FIELDS}"
+        "    std::string f_missing = std::string();\n"
+        "\n"
+        "    bool decode([[maybe_unused]] ed::message const & msg)\n"
+        "    {\n"
+        "${DECODE}"
+        "        return true;\n"
+        "    }\n"
+        "};\n"
+        "\n"
+        "\n")
+endforeach()
+
+string(APPEND CODE "
+} // namespace params
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
+")
+
+# only write the file if it changed to avoid useless recompilations
+#
+set(CHANGED TRUE)
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} PREVIOUS)
+    if(PREVIOUS STREQUAL CODE)
+        set(CHANGED FALSE)
+    endif()
+endif()
+if(CHANGED)
+    file(WRITE ${OUTPUT} "${CODE}")
+endif()
+
+# the stamp is always updated so the rule is not run again on each build
+#
+if(STAMP)
+    file(TOUCH ${STAMP})
+endif()
+
+# vim: ts=4 sw=4 et nocindent
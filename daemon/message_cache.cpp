@@ -0,0 +1,418 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Implementation of the LOCK message cache.
+ *
+ * Until the leaders are known, the cluck daemon cannot process LOCK
+ * messages. It keeps them in this cache and replays them once it is
+ * ready, earliest timeout first. When a cluster starts, many clients may send LOCK messages
+ * before the election completes so the cache can grow quickly.
+ *
+ * Instead of a copy of the whole message, the cache saves a compact
+ * request with the parameters of the LOCK. The strings are atoms so the
+ * server, service and object names are shared between all the requests.
+ * The message is rebuilt when it gets replayed or when it times out.
+ *
+ * A client which sends the same LOCK again (same server, process, object
+ * and tag) replaces its previous request instead of adding a new one.
+ * The total number of requests is limited; once the limit is reached,
+ * the oldest request is evicted.
+ *
+ * \warning
+ * The cache is not protected by a mutex. The cluck daemon only uses it
+ * from its main thread.
+ */
+
+// self
+//
+#include    "message_cache.h"
+
+
+// cluck
+//
+#include    <cluck/names.h>
+
+
+// C++
+//
+#include    <algorithm>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+/** \class message_cache
+ * \brief Cache of the LOCK requests received before the election.
+ *
+ * The requests are kept in the order they were received so the oldest
+ * one can be evicted when the cache is full. A separate index sorts them
+ * by timeout date so the cleanup does not have to go through the entire
+ * cache to find the requests that timed out and the replay can start
+ * with the requests which have the least time left.
+ */
+
+
+/** \struct message_cache::request
+ * \brief The parameters of one cached LOCK message.
+ *
+ * The f_unlock_duration is zero and the f_serial is -1 when the LOCK
+ * message did not include these parameters. The f_progress flag is true
+ * when the client asked for LOCK_PROGRESS messages. The f_relock flag is
+ * true when a leader sent the LOCK again after the loss of a leader. The
+ * f_forwarded flag is true when a leader forwarded the LOCK from another
+ * leader group.
+ */
+
+
+
+/** \brief Create a request from a LOCK message.
+ *
+ * The LOCK message is expected to have been verified by msg_lock().
+ * The \p timeout is the obtention timeout as computed from the message
+ * (the parameter is optional and a default applies when missing).
+ *
+ * \param[in] msg  The LOCK message.
+ * \param[in] timeout  The date when the LOCK times out.
+ *
+ * \return The request representing that LOCK message.
+ */
+message_cache::request message_cache::request::from_message(
+      ed::message const & msg
+    , cluck::timeout_t const & timeout)
+{
+    request r;
+    r.f_timeout = timeout;
+    r.f_duration = msg.get_timespec_parameter(cluck::g_name_cluck_param_duration);
+    if(msg.has_parameter(cluck::g_name_cluck_param_unlock_duration))
+    {
+        r.f_unlock_duration = msg.get_timespec_parameter(cluck::g_name_cluck_param_unlock_duration);
+    }
+    if(msg.has_parameter(cluck::g_name_cluck_param_serial))
+    {
+        r.f_serial = msg.get_integer_parameter(cluck::g_name_cluck_param_serial);
+    }
+    r.f_progress = msg.has_parameter(cluck::g_name_cluck_param_progress)
+                && msg.get_integer_parameter(cluck::g_name_cluck_param_progress) != 0;
+    r.f_relock = msg.has_parameter(cluck::g_name_cluck_param_relock);
+    r.f_forwarded = msg.has_parameter(cluck::g_name_cluck_param_forwarded);
+    r.f_object_name = atom(msg.get_parameter(cluck::g_name_cluck_param_object_name));
+    r.f_tag = msg.get_integer_parameter(cluck::g_name_cluck_param_tag);
+    r.f_pid = msg.get_integer_parameter(cluck::g_name_cluck_param_pid);
+    r.f_sent_from_server = atom(msg.get_sent_from_server());
+    r.f_sent_from_service = atom(msg.get_sent_from_service());
+    if(msg.has_parameter(cluck::g_name_cluck_param_lock_proxy_server_name))
+    {
+        r.f_proxy_server_name = atom(msg.get_parameter(cluck::g_name_cluck_param_lock_proxy_server_name));
+    }
+    if(msg.has_parameter(cluck::g_name_cluck_param_lock_proxy_service_name))
+    {
+        r.f_proxy_service_name = atom(msg.get_parameter(cluck::g_name_cluck_param_lock_proxy_service_name));
+    }
+    return r;
+}
+
+
+/** \brief Get the name of the server requesting the lock.
+ *
+ * When the LOCK was proxied, this is the name of the server where the
+ * client runs. Otherwise it is the server that sent the message.
+ *
+ * \return The name of the server requesting the lock.
+ */
+std::string message_cache::request::get_server_name() const
+{
+    if(!f_proxy_server_name.str().empty())
+    {
+        return f_proxy_server_name;
+    }
+    return f_sent_from_server;
+}
+
+
+/** \brief Get the name of the service requesting the lock.
+ *
+ * When the LOCK was proxied, this is the name of the client's service.
+ * Otherwise it is the service that sent the message.
+ *
+ * \return The name of the service requesting the lock.
+ */
+std::string message_cache::request::get_service_name() const
+{
+    if(!f_proxy_service_name.str().empty())
+    {
+        return f_proxy_service_name;
+    }
+    return f_sent_from_service;
+}
+
+
+/** \brief Rebuild the LOCK message.
+ *
+ * This function recreates the LOCK message as it was received. The
+ * timeout is always included since it was already computed when the
+ * message was first received.
+ *
+ * \return The LOCK message of this request.
+ */
+ed::message message_cache::request::to_message() const
+{
+    ed::message msg;
+    msg.set_command(cluck::g_name_cluck_cmd_lock);
+    msg.set_sent_from_server(f_sent_from_server);
+    msg.set_sent_from_service(f_sent_from_service);
+    msg.set_service(cluck::g_name_cluck_service_name);
+    msg.add_parameter(cluck::g_name_cluck_param_object_name, f_object_name.str());
+    msg.add_parameter(cluck::g_name_cluck_param_tag, f_tag);
+    msg.add_parameter(cluck::g_name_cluck_param_pid, f_pid);
+    msg.add_parameter(cluck::g_name_cluck_param_timeout, f_timeout);
+    msg.add_parameter(cluck::g_name_cluck_param_duration, f_duration);
+    if(f_unlock_duration != cluck::timeout_t())
+    {
+        msg.add_parameter(cluck::g_name_cluck_param_unlock_duration, f_unlock_duration);
+    }
+    if(f_serial != -1)
+    {
+        msg.add_parameter(cluck::g_name_cluck_param_serial, f_serial);
+    }
+    if(f_progress)
+    {
+        msg.add_parameter(cluck::g_name_cluck_param_progress, 1);
+    }
+    if(f_relock)
+    {
+        msg.add_parameter(cluck::g_name_cluck_param_relock, 1);
+    }
+    if(f_forwarded)
+    {
+        msg.add_parameter(cluck::g_name_cluck_param_forwarded, 1);
+    }
+    if(!f_proxy_server_name.str().empty())
+    {
+        msg.add_parameter(cluck::g_name_cluck_param_lock_proxy_server_name, f_proxy_server_name.str());
+    }
+    if(!f_proxy_service_name.str().empty())
+    {
+        msg.add_parameter(cluck::g_name_cluck_param_lock_proxy_service_name, f_proxy_service_name.str());
+    }
+    return msg;
+}
+
+
+/** \brief Change the maximum number of requests kept in the cache.
+ *
+ * The new limit applies to the following calls to add(). A limit of
+ * zero is changed to one.
+ *
+ * \param[in] limit  The maximum number of requests.
+ */
+void message_cache::set_limit(std::size_t limit)
+{
+    f_limit = std::max(limit, static_cast<std::size_t>(1));
+}
+
+
+/** \brief Get the maximum number of requests kept in the cache.
+ *
+ * \return The maximum number of requests.
+ */
+std::size_t message_cache::get_limit() const
+{
+    return f_limit;
+}
+
+
+/** \brief Check whether the cache is empty.
+ *
+ * \return true if no requests are cached.
+ */
+bool message_cache::empty() const
+{
+    return f_entries.empty();
+}
+
+
+/** \brief Get the number of requests in the cache.
+ *
+ * \return The number of requests.
+ */
+std::size_t message_cache::size() const
+{
+    return f_entries.size();
+}
+
+
+/** \brief Get the number of requests that replaced a previous one.
+ *
+ * Each time a client sends the same LOCK again, this counter gets
+ * incremented.
+ *
+ * \return The number of coalesced requests.
+ */
+std::size_t message_cache::get_coalesced() const
+{
+    return f_coalesced;
+}
+
+
+/** \brief Add a request to the cache.
+ *
+ * If the same client already has a request for the same object and tag,
+ * that request is removed and the new one is added at the end. The new
+ * request has the latest timeout and parameters.
+ *
+ * If the cache is full, the oldest request is removed and saved in
+ * \p evicted. The caller is expected to send a LOCK_FAILED for it.
+ *
+ * \param[in] r  The request to add.
+ * \param[out] evicted  The request that was removed to make room.
+ *
+ * \return true if \p evicted was set.
+ */
+bool message_cache::add(request const & r, request & evicted)
+{
+    client_t const client(client_of(r));
+    auto const existing(f_clients.find(client));
+    if(existing != f_clients.end())
+    {
+        ++f_coalesced;
+        erase(f_entries.find(existing->second));
+    }
+
+    bool result(false);
+    if(f_entries.size() >= f_limit)
+    {
+        auto const oldest(f_entries.begin());
+        evicted = oldest->second.f_request;
+        erase(oldest);
+        result = true;
+    }
+
+    sequence_t const sequence(f_sequence++);
+    entry & e(f_entries[sequence]);
+    e.f_request = r;
+    e.f_deadline = f_deadlines.emplace(r.f_timeout, sequence);
+    f_clients[client] = sequence;
+
+    return result;
+}
+
+
+/** \brief Get the earliest timeout of the cached requests.
+ *
+ * \return The earliest timeout or timespec_ex::max() if the cache is empty.
+ */
+cluck::timeout_t message_cache::get_next_timeout() const
+{
+    if(f_deadlines.empty())
+    {
+        return snapdev::timespec_ex::max();
+    }
+    return f_deadlines.begin()->first;
+}
+
+
+/** \brief Remove one request which timed out.
+ *
+ * Call this function in a loop until it returns false to remove all
+ * the requests which timed out.
+ *
+ * \param[in] now  The current date.
+ * \param[out] r  The request that timed out.
+ *
+ * \return true if \p r was set to a request that timed out.
+ */
+bool message_cache::pop_timed_out(cluck::timeout_t const & now, request & r)
+{
+    if(f_deadlines.empty()
+    || f_deadlines.begin()->first > now)
+    {
+        return false;
+    }
+
+    auto const it(f_entries.find(f_deadlines.begin()->second));
+    r = it->second.f_request;
+    erase(it);
+
+    return true;
+}
+
+
+/** \brief Remove the request with the earliest timeout.
+ *
+ * The cached requests are replayed in the order of their timeout so the
+ * requests which have the least time left are processed first. Requests
+ * with the same timeout are returned in the order they were received.
+ *
+ * \param[out] r  The request with the earliest timeout.
+ *
+ * \return true if \p r was set, false if the cache is empty.
+ */
+bool message_cache::pop_next(request & r)
+{
+    if(f_deadlines.empty())
+    {
+        return false;
+    }
+
+    auto const it(f_entries.find(f_deadlines.begin()->second));
+    r = it->second.f_request;
+    erase(it);
+
+    return true;
+}
+
+
+/** \brief Get the key identifying the client of a request.
+ *
+ * \param[in] r  The request.
+ *
+ * \return The key used to find a previous request from the same client.
+ */
+message_cache::client_t message_cache::client_of(request const & r)
+{
+    atom const & server_name(r.f_proxy_server_name.str().empty()
+                                ? r.f_sent_from_server
+                                : r.f_proxy_server_name);
+    return client_t(server_name.id(), r.f_pid, r.f_object_name.id(), r.f_tag);
+}
+
+
+/** \brief Remove one request from all the indexes.
+ *
+ * \param[in] it  The request to remove.
+ */
+void message_cache::erase(entry_map_t::iterator it)
+{
+    f_deadlines.erase(it->second.f_deadline);
+    f_clients.erase(client_of(it->second.f_request));
+    f_entries.erase(it);
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -17,6 +17,11 @@
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #pragma once
 
+// self
+//
+#include    "atom.h"
+
+
 // cluck
 //
 #include    <cluck/cluck.h>
@@ -24,21 +29,89 @@
 
 // eventdispatcher
 //
+#include    <eventdispatcher/dispatcher_match.h>
 #include    <eventdispatcher/message.h>
 
 
+// C++
+//
+#include    <map>
+#include    <tuple>
+
+
 
 namespace cluck_daemon
 {
 
 
 
-struct message_cache
+class message_cache
 {
-    typedef std::list<message_cache>  list_t;
+public:
+    static constexpr std::size_t DEFAULT_LIMIT = 100'000;
+
+    struct request
+    {
+        static request          from_message(ed::message const & msg, cluck::timeout_t const & timeout);
+
+        std::string             get_server_name() const;
+        std::string             get_service_name() const;
+        ed::message             to_message() const;
+
+        cluck::timeout_t        f_timeout = cluck::timeout_t();
+        cluck::timeout_t        f_duration = cluck::timeout_t();
+        cluck::timeout_t        f_unlock_duration = cluck::timeout_t();    // zero when not specified
+        std::int64_t            f_serial = -1;                              // -1 when not specified
+        bool                    f_progress = false;
+        bool                    f_relock = false;
+        bool                    f_forwarded = false;
+        atom                    f_object_name = atom();
+        ed::dispatcher_match::tag_t
+                                f_tag = ed::dispatcher_match::DISPATCHER_MATCH_NO_TAG;
+        pid_t                   f_pid = 0;
+        atom                    f_sent_from_server = atom();
+        atom                    f_sent_from_service = atom();
+        atom                    f_proxy_server_name = atom();
+        atom                    f_proxy_service_name = atom();
+    };
+
+    void                        set_limit(std::size_t limit);
+    std::size_t                 get_limit() const;
+    bool                        empty() const;
+    std::size_t                 size() const;
+    std::size_t                 get_coalesced() const;
+
+    bool                        add(request const & r, request & evicted);
+    cluck::timeout_t            get_next_timeout() const;
+    bool                        pop_timed_out(cluck::timeout_t const & now, request & r);
+    bool                        pop_next(request & r);
+
+private:
+    typedef std::uint64_t       sequence_t;
+    typedef std::tuple<atom::id_t, pid_t, atom::id_t, ed::dispatcher_match::tag_t>
+                                client_t;
+    typedef std::multimap<cluck::timeout_t, sequence_t>
+                                deadline_map_t;
+
+    struct entry
+    {
+        request                 f_request = request();
+        deadline_map_t::iterator
+                                f_deadline = deadline_map_t::iterator();
+    };
+
+    typedef std::map<sequence_t, entry>     entry_map_t;    // sorted by arrival
+    typedef std::map<client_t, sequence_t>  client_map_t;
+
+    static client_t             client_of(request const & r);
+    void                        erase(entry_map_t::iterator it);
 
-    cluck::timeout_t        f_timeout = cluck::timeout_t();
-    ed::message             f_message = ed::message();
+    std::size_t                 f_limit = DEFAULT_LIMIT;
+    sequence_t                  f_sequence = 0;
+    std::size_t                 f_coalesced = 0;
+    entry_map_t                 f_entries = entry_map_t();
+    deadline_map_t              f_deadlines = deadline_map_t();
+    client_map_t                f_clients = client_map_t();
 };
 
 
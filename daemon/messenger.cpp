@@ -22,6 +22,7 @@
 #include    "messenger.h"
 
 #include    "cluckd.h"
+#include    "command_table.h"
 
 
 // cluck
@@ -31,6 +32,7 @@
 
 // eventdispatcher
 //
+#include    <eventdispatcher/communicator.h>
 #include    <eventdispatcher/names.h>
 
 
@@ -39,6 +41,12 @@
 #include    <communicator/names.h>
 
 
+// snapdev
+//
+#include    <snapdev/not_used.h>
+#include    <snapdev/timespec_ex.h>
+
+
 // last include
 //
 #include    <snapdev/poison.h>
@@ -49,6 +57,80 @@ namespace cluck_daemon
 {
 
 
+namespace
+{
+
+
+
+typedef void (cluckd::*cluck_command_handler_t)(ed::message & msg);
+
+
+/** \brief The cluckd function handling each cluck command.
+ *
+ * This table is indexed by the cluck_command_t enumeration.
+ */
+constexpr cluck_command_handler_t const g_cluck_command_handlers[] =
+{
+    nullptr,                        // CLUCK_COMMAND_UNKNOWN
+    &cluckd::msg_activate_lock,
+    &cluckd::msg_add_ticket,
+    &cluckd::msg_batch,
+    &cluckd::msg_drop_ticket,
+    &cluckd::msg_get_max_ticket,
+    &cluckd::msg_info,
+    &cluckd::msg_list_tickets,
+    &cluckd::msg_lock,
+    &cluckd::msg_lock_activated,
+    &cluckd::msg_lock_entered,
+    &cluckd::msg_lock_entering,
+    &cluckd::msg_lock_exiting,
+    &cluckd::msg_lock_failed,
+    &cluckd::msg_lock_leaders,
+    &cluckd::msg_lock_progress,
+    &cluckd::msg_lock_started,
+    &cluckd::msg_lock_status,
+    &cluckd::msg_lock_tickets,
+    &cluckd::msg_locked,
+    &cluckd::msg_max_ticket,
+    &cluckd::msg_ticket_added,
+    &cluckd::msg_ticket_ready,
+    &cluckd::msg_unlock,
+    &cluckd::msg_unlocked,
+    &cluckd::msg_unlocking,
+};
+
+static_assert(std::size(g_cluck_command_handlers) == static_cast<std::size_t>(cluck_command_t::CLUCK_COMMAND_max)
+            , "each cluck command must have a handler in g_cluck_command_handlers");
+
+
+/** \brief Match any one of the cluck commands.
+ *
+ * This match function is used by the first match of the messenger
+ * dispatcher. It searches the command in the perfect hash table of the
+ * cluck commands instead of having the dispatcher compare the command
+ * against each one of its matches.
+ *
+ * \param[in] expr  The expression of the match, which is not used.
+ * \param[in] msg  The message being dispatched.
+ *
+ * \return MATCH_TRUE if the command is a cluck command.
+ */
+ed::dispatcher_match::match_t cluck_command_match(
+      std::string const & expr
+    , ed::message & msg)
+{
+    snapdev::NOT_USED(expr);
+
+    return find_cluck_command(msg.get_command()) == cluck_command_t::CLUCK_COMMAND_UNKNOWN
+                ? ed::dispatcher_match::match_t::MATCH_FALSE
+                : ed::dispatcher_match::match_t::MATCH_TRUE;
+}
+
+
+
+} // no name namespace
+
+
 /** \class messenger
  * \brief Handle messages from the communicatord.
  *
@@ -79,6 +161,15 @@ messenger::messenger(cluckd * c, advgetopt::getopt & opts)
 {
     set_name("cluck_messenger");
     get_dispatcher()->add_matches({
+        // the cluck commands are found with one lookup in our command
+        // table; the cluck command matches below are still necessary for
+        // the list of COMMANDS we understand
+        //
+        ed::define_match(
+              ed::Callback(std::bind(&messenger::dispatch_cluck_command, this, std::placeholders::_1))
+            , ed::MatchFunc(&cluck_command_match)
+        ),
+
         // eventdispatcher commands
         //
         ed::define_match(
@@ -125,6 +216,10 @@ messenger::messenger(cluckd * c, advgetopt::getopt & opts)
               ed::Expression(cluck::g_name_cluck_cmd_add_ticket)
             , ed::Callback(std::bind(&cluckd::msg_add_ticket, c, std::placeholders::_1))
         ),
+        ed::define_match(
+              ed::Expression(cluck::g_name_cluck_cmd_batch)
+            , ed::Callback(std::bind(&cluckd::msg_batch, c, std::placeholders::_1))
+        ),
         ed::define_match(
               ed::Expression(cluck::g_name_cluck_cmd_drop_ticket)
             , ed::Callback(std::bind(&cluckd::msg_drop_ticket, c, std::placeholders::_1))
@@ -169,6 +264,10 @@ messenger::messenger(cluckd * c, advgetopt::getopt & opts)
               ed::Expression(cluck::g_name_cluck_cmd_lock_leaders)
             , ed::Callback(std::bind(&cluckd::msg_lock_leaders, c, std::placeholders::_1))
         ),
+        ed::define_match(
+              ed::Expression(cluck::g_name_cluck_cmd_lock_progress)
+            , ed::Callback(std::bind(&cluckd::msg_lock_progress, c, std::placeholders::_1))
+        ),
         ed::define_match(
               ed::Expression(cluck::g_name_cluck_cmd_lock_started)
             , ed::Callback(std::bind(&cluckd::msg_lock_started, c, std::placeholders::_1))
@@ -181,6 +280,10 @@ messenger::messenger(cluckd * c, advgetopt::getopt & opts)
               ed::Expression(cluck::g_name_cluck_cmd_lock_tickets)
             , ed::Callback(std::bind(&cluckd::msg_lock_tickets, c, std::placeholders::_1))
         ),
+        ed::define_match(
+              ed::Expression(cluck::g_name_cluck_cmd_locked)
+            , ed::Callback(std::bind(&cluckd::msg_locked, c, std::placeholders::_1))
+        ),
         ed::define_match(
               ed::Expression(cluck::g_name_cluck_cmd_max_ticket)
             , ed::Callback(std::bind(&cluckd::msg_max_ticket, c, std::placeholders::_1))
@@ -197,6 +300,14 @@ messenger::messenger(cluckd * c, advgetopt::getopt & opts)
               ed::Expression(cluck::g_name_cluck_cmd_unlock)
             , ed::Callback(std::bind(&cluckd::msg_unlock, c, std::placeholders::_1))
         ),
+        ed::define_match(
+              ed::Expression(cluck::g_name_cluck_cmd_unlocked)
+            , ed::Callback(std::bind(&cluckd::msg_unlocked, c, std::placeholders::_1))
+        ),
+        ed::define_match(
+              ed::Expression(cluck::g_name_cluck_cmd_unlocking)
+            , ed::Callback(std::bind(&cluckd::msg_unlocking, c, std::placeholders::_1))
+        ),
     });
 }
 
@@ -206,6 +317,21 @@ messenger::~messenger()
 }
 
 
+/** \brief Execute a cluck command.
+ *
+ * This function is called by the dispatcher whenever the command of the
+ * message is one of the cluck commands (see cluck_command_match()). It
+ * calls the corresponding cluckd function directly.
+ *
+ * \param[in,out] msg  The message to process.
+ */
+void messenger::dispatch_cluck_command(ed::message & msg)
+{
+    cluck_command_t const command(find_cluck_command(msg.get_command()));
+    (f_cluckd->*g_cluck_command_handlers[static_cast<std::size_t>(command)])(msg);
+}
+
+
 /** \brief Finish handling command line options.
  *
  * This function makes sure the fluid settings and communicator daemon
@@ -263,6 +389,219 @@ void messenger::stop(bool quitting)
 }
 
 
+/** \brief Send a message.
+ *
+ * The messages addressed to a client connected directly to the cluck
+ * daemon through its Unix socket are sent to that client (see
+ * cluckd::send_local_message()). The inter-leader messages are sent
+ * directly to the other leader when the leader mesh is in use (see
+ * cluckd::send_leader_message()). All the other messages are sent to
+ * the communicator daemon as usual.
+ *
+ * \param[in,out] msg  The message to send.
+ * \param[in] cache  Whether the communicator daemon may cache the message.
+ *
+ * \return true if the message was sent or cached.
+ */
+bool messenger::send_message(ed::message & msg, bool cache)
+{
+    if(f_cluckd->send_local_message(msg))
+    {
+        return true;
+    }
+
+    advgetopt::string_list_t servers{ msg.get_server() };
+    if(batch_message(msg, servers) > 0)
+    {
+        return true;
+    }
+
+    return send_unbatched_message(msg, cache);
+}
+
+
+/** \brief Send a message without batching it.
+ *
+ * The message is sent directly to the other leader if possible, or to
+ * the communicator daemon otherwise.
+ *
+ * \param[in,out] msg  The message to send.
+ * \param[in] cache  Whether the communicator daemon may cache the message.
+ *
+ * \return true if the message was sent or cached.
+ */
+bool messenger::send_unbatched_message(ed::message & msg, bool cache)
+{
+    if(f_cluckd->send_leader_message(msg))
+    {
+        return true;
+    }
+
+    return fluid_settings_connection::send_message(msg, cache);
+}
+
+
+/** \brief Send the same message to several servers.
+ *
+ * This function sends \p msg to the cluck daemon of each one of the
+ * specified \p servers.
+ *
+ * The servers reachable through the leader mesh all receive the exact
+ * same message, so it gets serialized only once (see
+ * cluckd::multicast_leader_message()).
+ *
+ * \note
+ * The single serialization only applies to the leader mesh. The other
+ * servers are sent the message through the communicator daemon, one at
+ * a time, since the destination is part of the message header. Changing
+ * the server name invalidates the serialized form the message caches,
+ * so the message is serialized again for each of these servers. The
+ * communicator daemon connection only accepts ed::message objects, so
+ * the serialized form cannot be patched and reused there.
+ *
+ * \param[in,out] msg  The message to send.
+ * \param[in] servers  The name of the servers to send the message to.
+ *
+ * \return The number of servers the message was sent to.
+ */
+std::size_t messenger::multicast_message(
+      ed::message & msg
+    , advgetopt::string_list_t servers)
+{
+    std::size_t count(batch_message(msg, servers));
+    count += f_cluckd->multicast_leader_message(msg, servers);
+    for(auto const & s : servers)
+    {
+        msg.set_server(s);
+        if(fluid_settings_connection::send_message(msg))
+        {
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+
+/** \brief Add a message to the batches.
+ *
+ * When the `batch-delay` option is set to 0 or more, the messages of the
+ * inter-leader protocol are not sent immediately. Instead, they are
+ * added to the batch of their destination server. The batches are sent
+ * once the delay is over. A delay of 0 means the batches are sent at the
+ * end of the current iteration of the event loop.
+ *
+ * The messages added to a batch are removed from the \p servers list.
+ *
+ * \param[in] msg  The message to add to the batches.
+ * \param[in,out] servers  The names of the destination servers.
+ *
+ * \return The number of batches the message was added to.
+ */
+std::size_t messenger::batch_message(
+      ed::message & msg
+    , advgetopt::string_list_t & servers)
+{
+    std::int64_t const delay(f_cluckd->get_batch_delay());
+    if(delay < 0
+    || msg.get_service() != cluck::g_name_cluck_service_name
+    || msg.get_command() == cluck::g_name_cluck_cmd_batch
+    || !leader_client::get_commands().contains(msg.get_command()))
+    {
+        return 0;
+    }
+
+    std::size_t count(0);
+    for(auto s(servers.begin()); s != servers.end(); )
+    {
+        if(s->empty())
+        {
+            ++s;
+            continue;
+        }
+        msg.set_server(*s);
+        f_batches[*s].push_back(msg);
+        ++count;
+        s = servers.erase(s);
+    }
+
+    if(count > 0)
+    {
+        if(f_batch_timer == nullptr)
+        {
+            f_batch_timer = std::make_shared<batch_timer>(this);
+            ed::communicator::instance()->add_connection(f_batch_timer);
+        }
+        if(f_batch_timer->get_timeout_date() == -1)
+        {
+            f_batch_timer->set_timeout_date(snapdev::now() + snapdev::timespec_ex(0, delay * 1'000));
+        }
+    }
+
+    return count;
+}
+
+
+/** \brief Send the pending batches.
+ *
+ * Each batch with a single message is sent as is. The other batches are
+ * sent as one BATCH message which includes all the messages, one per
+ * line, in the order they were added. The receiving cluck daemon
+ * processes them in that order (see cluckd::msg_batch()).
+ */
+void messenger::flush_batches()
+{
+    if(f_batch_timer != nullptr)
+    {
+        f_batch_timer->set_timeout_date(-1);
+    }
+
+    batch_map_t batches;
+    batches.swap(f_batches);
+    for(auto & b : batches)
+    {
+        if(b.second.size() == 1)
+        {
+            send_unbatched_message(b.second[0]);
+            continue;
+        }
+
+        std::string messages;
+        for(auto & m : b.second)
+        {
+            // the destination is in the BATCH message itself
+            //
+            m.set_server(std::string());
+            messages += m.to_message();
+            messages += '\n';
+        }
+
+        ed::message batch;
+        batch.set_command(cluck::g_name_cluck_cmd_batch);
+        batch.set_server(b.first);
+        batch.set_service(cluck::g_name_cluck_service_name);
+        batch.add_parameter(cluck::g_name_cluck_param_messages, messages);
+        send_unbatched_message(batch);
+    }
+}
+
+
+/** \brief Send the pending batches and remove the batch timer.
+ *
+ * This function is called when the cluck daemon stops.
+ */
+void messenger::stop_batching()
+{
+    flush_batches();
+
+    if(f_batch_timer != nullptr)
+    {
+        ed::communicator::instance()->remove_connection(f_batch_timer);
+        f_batch_timer.reset();
+    }
+}
+
+
 /** \brief Send the CLUSTER_STATUS to communicatord once ready.
  *
  * This function builds a message and sends it to communicatord.
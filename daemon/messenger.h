@@ -17,11 +17,21 @@
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #pragma once
 
+// self
+//
+#include    "batch_timer.h"
+
+
 // fluid-settings
 //
 #include    <fluid-settings/fluid_settings_connection.h>
 
 
+// advgetopt
+//
+#include    <advgetopt/utils.h>
+
+
 
 namespace cluck_daemon
 {
@@ -48,6 +58,12 @@ public:
     // ed::connection_with_send_message implementation
     virtual void                ready(ed::message & msg);
     virtual void                stop(bool quitting);
+    virtual bool                send_message(ed::message & msg, bool cache = false) override;
+    std::size_t                 multicast_message(
+                                      ed::message & msg
+                                    , advgetopt::string_list_t servers);
+    void                        flush_batches();
+    void                        stop_batching();
 
     // fluid_settings::fluid_settings_connection() implementation
     virtual void                fluid_settings_changed(
@@ -56,7 +72,17 @@ public:
                                     , std::string const & value) override;
 
 private:
+    typedef std::map<std::string, std::vector<ed::message>>  batch_map_t;     // key is the destination server name
+
+    std::size_t                 batch_message(
+                                      ed::message & msg
+                                    , advgetopt::string_list_t & servers);
+    bool                        send_unbatched_message(ed::message & msg, bool cache = false);
+    void                        dispatch_cluck_command(ed::message & msg);
+
     cluckd *                    f_cluckd = nullptr;
+    batch_timer::pointer_t      f_batch_timer = batch_timer::pointer_t();
+    batch_map_t                 f_batches = batch_map_t();
 };
 
 
@@ -0,0 +1,390 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Implementation of the statistics of each object.
+ *
+ * Without statistics, the only way to know which locks are hot is to
+ * grep the logs. The cluck daemon keeps, for each object name (or for
+ * each prefix of the object names, see the `object-stats-prefix`
+ * option), the number of LOCK requests, acquisitions, and timeouts,
+ * the rate of acquisitions, the depth of its queue, and histograms of
+ * the time spent waiting for the lock (LOCK to LOCKED) and holding it
+ * (LOCKED to UNLOCK).
+ *
+ * The statistics are updated in O(1) by the tickets as they change
+ * state. The number of objects is bounded (see the `object-stats-limit`
+ * option); when the limit is reached, the least recently used object
+ * is forgotten.
+ *
+ * \warning
+ * The statistics are not protected by a mutex. The cluck daemon only uses
+ * them from its main thread.
+ */
+
+// self
+//
+#include    "object_stats.h"
+
+
+// C++
+//
+#include    <algorithm>
+#include    <cmath>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+namespace
+{
+
+
+
+/** \brief The time constant of the acquisition rate in seconds.
+ *
+ * The rate is an exponentially decaying average so an object which is
+ * not locked anymore goes cold within a minute or so.
+ */
+constexpr double            RATE_PERIOD = 10.0;
+
+
+
+} // no name namespace
+
+
+
+/** \class object_stats
+ * \brief Keep statistics about the locks of each object.
+ *
+ * The objects are kept in a list sorted from the most to the least
+ * recently used and an index to find them by name.
+ */
+
+
+/** \struct object_stats::stats
+ * \brief The statistics of one object.
+ *
+ * The f_queue_depth is the number of tickets of the object (entering or
+ * waiting for the lock) the last time a LOCK request was received.
+ */
+
+
+
+/** \brief Get the rate of acquisitions at a given time.
+ *
+ * \param[in] now  The current date.
+ *
+ * \return The number of acquisitions per second.
+ */
+double object_stats::stats::get_rate(cluck::timeout_t const & now) const
+{
+    double const elapsed(static_cast<double>((now - f_last_acquisition).to_usec()) / 1'000'000.0);
+    return f_rate * std::exp(-std::max(elapsed, 0.0) / RATE_PERIOD);
+}
+
+
+/** \brief Set the maximum number of objects.
+ *
+ * When the limit is lowered, the least recently used objects are
+ * forgotten immediately.
+ *
+ * \param[in] limit  The maximum number of objects, 0 to not keep any
+ * statistics.
+ */
+void object_stats::set_limit(std::size_t limit)
+{
+    f_limit = limit;
+    while(f_lru.size() > f_limit)
+    {
+        f_index.erase(f_lru.back().f_name);
+        f_lru.pop_back();
+    }
+}
+
+
+/** \brief Get the maximum number of objects.
+ *
+ * \return The maximum number of objects, 0 if the statistics are off.
+ */
+std::size_t object_stats::get_limit() const
+{
+    return f_limit;
+}
+
+
+/** \brief Group the objects by prefix.
+ *
+ * The object names often include an identifier, such as
+ * "website/page/123". Such objects are rarely hot individually. Keeping
+ * only the first components of their names groups them together, for
+ * example with 2 components, all the pages are counted as "website/page".
+ *
+ * The components are separated by slashes. This function should be
+ * called before any statistics are gathered.
+ *
+ * \param[in] components  The number of components to keep, 0 to keep
+ * the whole name.
+ */
+void object_stats::set_prefix(std::size_t components)
+{
+    f_prefix = components;
+}
+
+
+/** \brief Get the number of components used to group objects.
+ *
+ * \return The number of components or 0 if the whole name is used.
+ */
+std::size_t object_stats::get_prefix() const
+{
+    return f_prefix;
+}
+
+
+/** \brief Count a LOCK request.
+ *
+ * \param[in] object_name  The name of the object to lock.
+ * \param[in] depth  The number of tickets of that object, including the
+ * new one.
+ */
+void object_stats::queued(
+      std::string const & object_name
+    , std::size_t depth)
+{
+    stats * s(touch(object_name));
+    if(s != nullptr)
+    {
+        ++s->f_requests;
+        s->f_queue_depth = depth;
+        s->f_max_queue_depth = std::max(s->f_max_queue_depth, depth);
+    }
+}
+
+
+/** \brief Count the acquisition of a lock.
+ *
+ * \param[in] object_name  The name of the locked object.
+ * \param[in] wait  The time between the LOCK request and the lock.
+ * \param[in] now  The current date.
+ */
+void object_stats::locked(
+      std::string const & object_name
+    , cluck::timeout_t const & wait
+    , cluck::timeout_t const & now)
+{
+    stats * s(touch(object_name));
+    if(s != nullptr)
+    {
+        s->f_rate = s->get_rate(now) + 1.0 / RATE_PERIOD;
+        s->f_last_acquisition = now;
+        ++s->f_acquisitions;
+        s->f_wait.add(wait.to_usec());
+    }
+}
+
+
+/** \brief Count the release of a lock.
+ *
+ * \param[in] object_name  The name of the unlocked object.
+ * \param[in] hold  The time between the lock and its release.
+ */
+void object_stats::unlocked(
+      std::string const & object_name
+    , cluck::timeout_t const & hold)
+{
+    stats * s(touch(object_name));
+    if(s != nullptr)
+    {
+        s->f_hold.add(hold.to_usec());
+    }
+}
+
+
+/** \brief Count a lock which timed out.
+ *
+ * This is called when a LOCK request times out before the lock is
+ * obtained and when a lock times out before the UNLOCK is received.
+ *
+ * \param[in] object_name  The name of the object.
+ */
+void object_stats::timed_out(std::string const & object_name)
+{
+    stats * s(touch(object_name));
+    if(s != nullptr)
+    {
+        ++s->f_timeouts;
+    }
+}
+
+
+/** \brief Get the number of objects with statistics.
+ *
+ * \return The number of objects.
+ */
+std::size_t object_stats::size() const
+{
+    return f_lru.size();
+}
+
+
+/** \brief Search the statistics of an object.
+ *
+ * \param[in] object_name  The name of the object (or of one of the
+ * objects sharing the same prefix).
+ *
+ * \return The statistics or nullptr if the object is not known.
+ */
+object_stats::stats const * object_stats::find(std::string const & object_name) const
+{
+    auto const it(f_index.find(get_key(object_name)));
+    if(it == f_index.end())
+    {
+        return nullptr;
+    }
+    return &*it->second;
+}
+
+
+/** \brief Get the hottest objects.
+ *
+ * The objects are sorted by rate of acquisitions, then by queue depth,
+ * then by number of requests.
+ *
+ * \param[in] count  The maximum number of objects to return.
+ * \param[in] now  The current date.
+ *
+ * \return The statistics of the hottest objects, hottest first.
+ */
+std::vector<object_stats::stats const *> object_stats::get_hot(
+      std::size_t count
+    , cluck::timeout_t const & now) const
+{
+    typedef std::pair<double, stats const *>    rated_t;
+
+    std::vector<rated_t> rated;
+    rated.reserve(f_lru.size());
+    for(auto const & s : f_lru)
+    {
+        rated.emplace_back(s.get_rate(now), &s);
+    }
+
+    count = std::min(count, rated.size());
+    std::partial_sort(
+              rated.begin()
+            , rated.begin() + count
+            , rated.end()
+            , [](rated_t const & a, rated_t const & b)
+            {
+                if(a.first != b.first)
+                {
+                    return a.first > b.first;
+                }
+                if(a.second->f_queue_depth != b.second->f_queue_depth)
+                {
+                    return a.second->f_queue_depth > b.second->f_queue_depth;
+                }
+                return a.second->f_requests > b.second->f_requests;
+            });
+
+    std::vector<stats const *> result;
+    result.reserve(count);
+    for(std::size_t idx(0); idx < count; ++idx)
+    {
+        result.push_back(rated[idx].second);
+    }
+    return result;
+}
+
+
+/** \brief Compute the name under which an object is counted.
+ *
+ * \param[in] object_name  The name of the object.
+ *
+ * \return The object name or its prefix (see set_prefix()).
+ */
+std::string object_stats::get_key(std::string const & object_name) const
+{
+    if(f_prefix == 0)
+    {
+        return object_name;
+    }
+
+    std::string::size_type pos(0);
+    for(std::size_t component(0); component < f_prefix; ++component)
+    {
+        pos = object_name.find('/', pos);
+        if(pos == std::string::npos)
+        {
+            return object_name;
+        }
+        ++pos;
+    }
+    return object_name.substr(0, pos - 1);
+}
+
+
+/** \brief Get the statistics of an object and mark it as recently used.
+ *
+ * If the object is not yet known, it gets added. If that makes the
+ * number of objects go over the limit, the least recently used object
+ * is forgotten.
+ *
+ * \param[in] object_name  The name of the object.
+ *
+ * \return The statistics of the object or nullptr if statistics are off.
+ */
+object_stats::stats * object_stats::touch(std::string const & object_name)
+{
+    if(f_limit == 0)
+    {
+        return nullptr;
+    }
+
+    std::string key(get_key(object_name));
+    auto it(f_index.find(key));
+    if(it != f_index.end())
+    {
+        f_lru.splice(f_lru.begin(), f_lru, it->second);
+        return &f_lru.front();
+    }
+
+    if(f_lru.size() >= f_limit)
+    {
+        f_index.erase(f_lru.back().f_name);
+        f_lru.pop_back();
+    }
+
+    f_lru.emplace_front();
+    f_lru.front().f_name = key;
+    f_index.emplace(std::move(key), f_lru.begin());
+    return &f_lru.front();
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,105 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+// self
+//
+#include    "histogram.h"
+
+
+// cluck
+//
+#include    <cluck/cluck.h>
+
+
+// C++
+//
+#include    <list>
+#include    <string>
+#include    <unordered_map>
+#include    <vector>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+class object_stats
+{
+public:
+    static constexpr std::size_t    DEFAULT_LIMIT = 1'000;
+
+    struct stats
+    {
+        std::string             f_name = std::string();
+        std::uint64_t           f_requests = 0;
+        std::uint64_t           f_acquisitions = 0;
+        std::uint64_t           f_timeouts = 0;
+        std::size_t             f_queue_depth = 0;
+        std::size_t             f_max_queue_depth = 0;
+        double                  f_rate = 0.0;               // acquisitions per second
+        cluck::timeout_t        f_last_acquisition = cluck::timeout_t();
+        histogram               f_wait = histogram();       // in microseconds, LOCK to LOCKED
+        histogram               f_hold = histogram();       // in microseconds, LOCKED to UNLOCK
+
+        double                  get_rate(cluck::timeout_t const & now) const;
+    };
+
+    void                        set_limit(std::size_t limit);
+    std::size_t                 get_limit() const;
+    void                        set_prefix(std::size_t components);
+    std::size_t                 get_prefix() const;
+
+    void                        queued(
+                                      std::string const & object_name
+                                    , std::size_t depth);
+    void                        locked(
+                                      std::string const & object_name
+                                    , cluck::timeout_t const & wait
+                                    , cluck::timeout_t const & now);
+    void                        unlocked(
+                                      std::string const & object_name
+                                    , cluck::timeout_t const & hold);
+    void                        timed_out(std::string const & object_name);
+
+    std::size_t                 size() const;
+    stats const *               find(std::string const & object_name) const;
+    std::vector<stats const *>  get_hot(
+                                      std::size_t count
+                                    , cluck::timeout_t const & now) const;
+
+private:
+    typedef std::list<stats>    lru_t;
+    typedef std::unordered_map<std::string, lru_t::iterator>
+                                index_t;
+
+    std::string                 get_key(std::string const & object_name) const;
+    stats *                     touch(std::string const & object_name);
+
+    std::size_t                 f_limit = DEFAULT_LIMIT;
+    std::size_t                 f_prefix = 0;
+    lru_t                       f_lru = lru_t();            // most recently used first
+    index_t                     f_index = index_t();
+};
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
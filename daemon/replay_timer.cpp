@@ -0,0 +1,82 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// self
+//
+#include    "replay_timer.h"
+
+#include    "cluckd.h"
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+/** \class replay_timer
+ * \brief Replay the cached LOCK requests a few at a time.
+ *
+ * The LOCK requests received before the cluck daemon is ready are kept
+ * in a cache. Once the leaders are known, the requests are replayed in
+ * slices (see the `lock-replay-rate` option) so the new leaders do not
+ * have to start thousands of negotiations at once. This timer wakes
+ * the daemon up to replay the next slice.
+ */
+
+
+
+/** \brief The replay timer initialization.
+ *
+ * The timer is off until the daemon becomes ready with a non-empty
+ * cache of LOCK requests.
+ *
+ * \param[in] c  The cluck daemon which holds the cache.
+ */
+replay_timer::replay_timer(cluckd * c)
+    : ed::timer(-1)
+    , f_cluckd(c)
+{
+    set_name("replay_timer");
+}
+
+
+replay_timer::~replay_timer()
+{
+}
+
+
+/** \brief Replay the next slice of cached LOCK requests.
+ *
+ * The delay between two slices is over, replay the next one.
+ */
+void replay_timer::process_timeout()
+{
+    f_cluckd->replay_cached_locks();
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -47,6 +47,11 @@
 #include    <snaplogger/message.h>
 
 
+// C++
+//
+#include    <limits>
+
+
 // last include
 //
 #include    <snapdev/poison.h>
@@ -358,7 +363,7 @@ ticket::ticket(
             , messenger::pointer_t messenger
             , std::string const & object_name
             , ed::dispatcher_match::tag_t tag
-            , std::string const & entering_key
+            , ticket_key const & entering_key
             , cluck::timeout_t obtention_timeout
             , cluck::timeout_t lock_duration
             , std::string const & server_name
@@ -378,6 +383,7 @@ ticket::ticket(
     , f_entering_key(entering_key)
 {
     set_unlock_duration(f_lock_duration);
+    f_trace.mark(lock_trace::TRANSITION_CREATED, snapdev::now());
 
     // TODO: see how to not say "attempting a lock" when we are deserializing
     //       an existing lock.
@@ -410,6 +416,16 @@ ticket::ticket(
  * computer. In those cases, special care has to be taken to get things
  * to work as expected.
  *
+ * When the cluster uses multiple leader groups, the other two leaders are
+ * the members of the group handling this ticket's object. A leader only
+ * creates tickets for objects of its own group, so these are the leaders
+ * of our own group (see cluckd::get_leader_group()).
+ *
+ * The message is sent with messenger::multicast_message(). When both
+ * leaders are reachable through the leader mesh, the message gets
+ * serialized only once. Otherwise it is serialized once per leader,
+ * as before.
+ *
  * \param[in] msg  The message to send to the other two leaders.
  *
  * \return true if the message was forwarded at least once, false otherwise.
@@ -427,29 +443,20 @@ bool ticket::send_message_to_leaders(ed::message & msg)
     {
         // there are at least two leaders
         //
-        int count(0);
-        msg.set_server(leader->get_name());
-        if(f_messenger->send_message(msg))
-        {
-            ++count;
-        }
+        advgetopt::string_list_t servers{ leader->get_name() };
 
         // check for a third leader
         //
         leader = f_cluckd->get_leader_b();
         if(leader != nullptr)
         {
-            msg.set_server(leader->get_name());
-            if(f_messenger->send_message(msg))
-            {
-                ++count;
-            }
+            servers.push_back(leader->get_name());
         }
 
         // we have to wait for at least one reply if we were able to send
         // at least one message
         //
-        return count > 0;
+        return f_messenger->multicast_message(msg, servers) > 0;
     }
 
     // there is only one leader (ourselves)
@@ -479,16 +486,18 @@ void ticket::entering()
     //    return;
     //}
 
+    f_trace.mark(lock_trace::TRANSITION_ENTERING, snapdev::now());
+
     ed::message entering_message;
     entering_message.set_command(cluck::g_name_cluck_cmd_lock_entering);
-    entering_message.add_parameter(cluck::g_name_cluck_param_key, f_entering_key);
+    entering_message.add_parameter(cluck::g_name_cluck_param_key, f_entering_key.to_string());
     entering_message.add_parameter(cluck::g_name_cluck_param_timeout, f_obtention_timeout);
     entering_message.add_parameter(cluck::g_name_cluck_param_duration, f_lock_duration);
     if(f_lock_duration != f_unlock_duration)
     {
         entering_message.add_parameter(cluck::g_name_cluck_param_unlock_duration, f_unlock_duration);
     }
-    entering_message.add_parameter(cluck::g_name_cluck_param_source, f_server_name + "/" + f_service_name);
+    entering_message.add_parameter(cluck::g_name_cluck_param_source, f_server_name.str() + "/" + f_service_name.str());
     entering_message.add_parameter(cluck::g_name_cluck_param_serial, f_serial);
     if(send_message_to_leaders(entering_message))
     {
@@ -528,6 +537,7 @@ void ticket::entered()
         // single acknowledgement
         //
         f_get_max_ticket = true;
+        f_trace.mark(lock_trace::TRANSITION_ENTERED, snapdev::now());
 
         // calculate this instance max. ticket number
         //
@@ -535,7 +545,7 @@ void ticket::entered()
 
         ed::message get_max_ticket_message;
         get_max_ticket_message.set_command(cluck::g_name_cluck_cmd_get_max_ticket);
-        get_max_ticket_message.add_parameter(cluck::g_name_cluck_param_key, f_entering_key);
+        get_max_ticket_message.add_parameter(cluck::g_name_cluck_param_key, f_entering_key.to_string());
         if(send_message_to_leaders(get_max_ticket_message))
         {
             if(one_leader())
@@ -567,22 +577,19 @@ void ticket::max_ticket(ticket_id_t new_max_ticket)
 {
     if(!f_added_ticket)
     {
+        f_trace.mark(lock_trace::TRANSITION_MAX_TICKET, snapdev::now());
+
         if(new_max_ticket > f_our_ticket)
         {
             f_our_ticket = new_max_ticket;
         }
 
+        // f_our_ticket is a 64 bit number; to wrap around, the list of
+        // tickets with that "object name" would have to never go back to
+        // being empty for over 18 quintillion locks, which at a million
+        // locks per second represents over half a million years
+        //
         ++f_our_ticket;
-        if(f_our_ticket == NO_TICKET)
-        {
-            // f_out_ticket is a 32 bit number, this can happen only if you
-            // created over 4 billion locks back to back--i.e. created a new
-            // one before the previous one was released; or put in a different
-            // way: the list of tickets with that "object name" never went
-            // back to being empty for that long...
-            //
-            throw cluck::out_of_range("ticket::max_ticket() tried to generate the next ticket and got a wrapping around number.");
-        }
 
         add_ticket();
     }
@@ -607,6 +614,7 @@ void ticket::add_ticket()
         throw cluck::logic_error("ticket::add_ticket() called more than once."); // LCOV_EXCL_LINE
     }
     f_added_ticket = true;
+    f_trace.mark(lock_trace::TRANSITION_ADD_TICKET, snapdev::now());
 
     //
     // WARNING: the ticket key MUST be properly sorted by:
@@ -618,18 +626,16 @@ void ticket::add_ticket()
     // The client PID does not need to be sorted numerically, just be sorted
     // so one client is before the other.
     //
-    // However, the ticket number MUST be numerically sorted. For this reason,
-    // since the key is a string, we must add introducing zeroes.
+    // However, the ticket number MUST be numerically sorted. The ticket_key
+    // comparison operator takes care of that.
     //
-    f_ticket_key = snapdev::int_to_hex(f_our_ticket, false, 8)
-                 + '/'
-                 + f_entering_key;
+    f_ticket_key = ticket_key(f_our_ticket, f_entering_key);
 
     f_cluckd->set_ticket(f_object_name, f_ticket_key, shared_from_this());
 
     ed::message add_ticket_message;
     add_ticket_message.set_command(cluck::g_name_cluck_cmd_add_ticket);
-    add_ticket_message.add_parameter(cluck::g_name_cluck_param_key, f_ticket_key);
+    add_ticket_message.add_parameter(cluck::g_name_cluck_param_key, f_ticket_key.to_string());
     add_ticket_message.add_parameter(cluck::g_name_cluck_param_timeout, f_obtention_timeout);
     if(send_message_to_leaders(add_ticket_message))
     {
@@ -662,6 +668,7 @@ void ticket::ticket_added(key_map_t const & still_entering)
         // single acknowledgement
         //
         f_added_ticket_quorum = true;
+        f_trace.mark(lock_trace::TRANSITION_TICKET_ADDED, snapdev::now());
 
         f_still_entering = still_entering;
 
@@ -671,7 +678,7 @@ void ticket::ticket_added(key_map_t const & still_entering)
         //
         ed::message exiting_message;
         exiting_message.set_command(cluck::g_name_cluck_cmd_lock_exiting);
-        exiting_message.add_parameter(cluck::g_name_cluck_param_key, f_entering_key);
+        exiting_message.add_parameter(cluck::g_name_cluck_param_key, f_entering_key.to_string());
         snapdev::NOT_USED(send_message_to_leaders(exiting_message));
 
         f_cluckd->lock_exiting(exiting_message);
@@ -691,7 +698,7 @@ void ticket::ticket_added(key_map_t const & still_entering)
  *
  * \param[in] key  The key of the ticket that was entered.
  */
-void ticket::remove_entering(std::string const & key)
+void ticket::remove_entering(ticket_key const & key)
 {
     if(f_added_ticket_quorum
     && !f_ticket_ready)
@@ -721,13 +728,13 @@ void ticket::remove_entering(std::string const & key)
             //
             if(f_still_entering.empty())
             {
-                f_ticket_ready = true;
+                set_ready();
 
                 // let the other two leaders know that the ticket is ready
                 //
                 ed::message ticket_ready_message;
                 ticket_ready_message.set_command(cluck::g_name_cluck_cmd_ticket_ready);
-                ticket_ready_message.add_parameter(cluck::g_name_cluck_param_key, f_ticket_key);
+                ticket_ready_message.add_parameter(cluck::g_name_cluck_param_key, f_ticket_key.to_string());
                 snapdev::NOT_USED(send_message_to_leaders(ticket_ready_message));
             }
         }
@@ -746,8 +753,12 @@ void ticket::remove_entering(std::string const & key)
  *
  * On a system with only one computer, it will also send the LOCKED
  * message immediately.
+ *
+ * \return true if the ticket was ready and the ACTIVATE_LOCK message
+ * was sent; false otherwise, in which case the activation has to be
+ * attempted again later.
  */
-void ticket::activate_lock()
+bool ticket::activate_lock()
 {
     if(f_ticket_ready
     && !f_locked
@@ -755,15 +766,17 @@ void ticket::activate_lock()
     {
         ed::message activate_lock_message;
         activate_lock_message.set_command(cluck::g_name_cluck_cmd_activate_lock);
-        activate_lock_message.add_parameter(cluck::g_name_cluck_param_key, f_ticket_key);
-        if(send_message_to_leaders(activate_lock_message))
+        activate_lock_message.add_parameter(cluck::g_name_cluck_param_key, f_ticket_key.to_string());
+        bool const sent(send_message_to_leaders(activate_lock_message));
+        if(sent
+        && one_leader())
         {
-            if(one_leader())
-            {
-                lock_activated();
-            }
+            lock_activated();
         }
+        return sent;
     }
+
+    return false;
 }
 
 
@@ -782,12 +795,34 @@ void ticket::lock_activated()
     && !f_locked
     && f_lock_failed == lock_failure_t::LOCK_FAILURE_NONE)
     {
+        cluck::timeout_t const now(snapdev::now());
         f_locked = true;
-        f_lock_timeout_date = snapdev::now() + f_lock_duration;
+        f_lock_timeout_date = now + f_lock_duration;
         f_unlocked_timeout_date = f_lock_timeout_date + f_unlock_duration;
 
+        // the ticket now times out at a different date
+        //
+        f_cluckd->push_deadline(get_current_timeout_date());
+
         if(f_owner == f_cluckd->get_server_name())
         {
+            f_cluckd->get_object_stats().locked(
+                      f_object_name
+                    , now - f_trace.get_date(lock_trace::TRANSITION_CREATED)
+                    , now);
+
+            f_trace.mark(lock_trace::TRANSITION_LOCKED, now);
+            f_cluckd->get_lock_phases().add(f_trace);
+            SNAP_LOG_DEBUG
+                << "Lock on \""
+                << f_object_name
+                << "\" ("
+                << f_tag
+                << ") obtained; "
+                << f_trace.to_string()
+                << '.'
+                << SNAP_LOG_SEND;
+
             ed::message locked_message;
             locked_message.set_command(cluck::g_name_cluck_cmd_locked);
             locked_message.set_server(f_server_name);
@@ -796,12 +831,81 @@ void ticket::lock_activated()
             locked_message.add_parameter(cluck::g_name_cluck_param_timeout_date, f_lock_timeout_date);
             locked_message.add_parameter(cluck::g_name_cluck_param_unlocked_date, f_unlocked_timeout_date);
             locked_message.add_parameter(cluck::g_name_cluck_param_tag, f_tag);
+            locked_message.add_parameter(cluck::g_name_cluck_param_pid, f_entering_key.get_pid());
             f_messenger->send_message(locked_message);
         }
     }
 }
 
 
+/** \brief Let the client know where its ticket stands in the queue.
+ *
+ * When the client asked for it (see set_progress()), the leader which
+ * owns the ticket sends LOCK_PROGRESS messages while the ticket waits
+ * for its lock. The message includes the number of tickets ahead of
+ * this one (\p position), how many of those currently hold the lock,
+ * and the estimated wait when known.
+ *
+ * A message is sent only when the position or the number of holders
+ * changed since the last message and at most once per \p interval.
+ * When a change has to wait for the interval to elapse, the function
+ * returns the date at which it can be sent and the caller is expected
+ * to call this function again at that time.
+ *
+ * \param[in] position  The number of tickets ahead of this one.
+ * \param[in] holders  The number of tickets ahead holding the lock.
+ * \param[in] estimated_wait  The estimated wait, negative if unknown.
+ * \param[in] now  The current date.
+ * \param[in] interval  The minimum time between two messages.
+ *
+ * \return The date when a postponed message can be sent or
+ * timespec_ex::max() if nothing is pending.
+ */
+cluck::timeout_t ticket::progress(
+      std::size_t position
+    , std::size_t holders
+    , cluck::timeout_t const & estimated_wait
+    , cluck::timeout_t const & now
+    , cluck::timeout_t const & interval)
+{
+    if(!f_progress
+    || f_locked
+    || f_lock_failed != lock_failure_t::LOCK_FAILURE_NONE
+    || f_owner != f_cluckd->get_server_name()
+    || (position == f_progress_position && holders == f_progress_holders))
+    {
+        return snapdev::timespec_ex::max();
+    }
+
+    cluck::timeout_t const next_date(f_progress_date + interval);
+    if(now < next_date)
+    {
+        return next_date;
+    }
+
+    f_progress_position = position;
+    f_progress_holders = holders;
+    f_progress_date = now;
+
+    ed::message progress_message;
+    progress_message.set_command(cluck::g_name_cluck_cmd_lock_progress);
+    progress_message.set_server(f_server_name);
+    progress_message.set_service(f_service_name);
+    progress_message.add_parameter(cluck::g_name_cluck_param_object_name, f_object_name);
+    progress_message.add_parameter(cluck::g_name_cluck_param_tag, f_tag);
+    progress_message.add_parameter(cluck::g_name_cluck_param_pid, f_entering_key.get_pid());
+    progress_message.add_parameter(cluck::g_name_cluck_param_position, position);
+    progress_message.add_parameter(cluck::g_name_cluck_param_holders, holders);
+    if(estimated_wait >= cluck::timeout_t())
+    {
+        progress_message.add_parameter(cluck::g_name_cluck_param_estimated_wait, estimated_wait);
+    }
+    f_messenger->send_message(progress_message);
+
+    return snapdev::timespec_ex::max();
+}
+
+
 /** \brief We are done with the ticket.
  *
  * This function sends the DROP_TICKET message to get rid of a ticket
@@ -826,13 +930,20 @@ void ticket::drop_ticket()
     drop_ticket_message.set_command(cluck::g_name_cluck_cmd_drop_ticket);
     drop_ticket_message.add_parameter(
               cluck::g_name_cluck_param_key
-            , f_ticket_key.empty() ? f_entering_key : f_ticket_key);
+            , (f_ticket_key.empty() ? f_entering_key : f_ticket_key).to_string());
     send_message_to_leaders(drop_ticket_message);
 
     if(f_lock_failed == lock_failure_t::LOCK_FAILURE_NONE)
     {
         f_lock_failed = lock_failure_t::LOCK_FAILURE_UNLOCKING;
 
+        if(f_locked)
+        {
+            f_cluckd->get_object_stats().unlocked(
+                      f_object_name
+                    , snapdev::now() - (f_lock_timeout_date - f_lock_duration));
+        }
+
         //if(f_owner == f_cluckd->get_server_name()) -- this can happen with any leader so we have to send the UNLOCKED
         //                                              the other leaders won't call this function they receive DROP_TICKET
         //                                              instead and as mentioned in the TODO below, we should get a QUORUM
@@ -857,6 +968,7 @@ void ticket::drop_ticket()
             unlocked_message.add_parameter(cluck::g_name_cluck_param_object_name, f_object_name);
             unlocked_message.add_parameter(cluck::g_name_cluck_param_unlocked_date, snapdev::now());
             unlocked_message.add_parameter(cluck::g_name_cluck_param_tag, f_tag);
+            unlocked_message.add_parameter(cluck::g_name_cluck_param_pid, f_entering_key.get_pid());
             f_messenger->send_message(unlocked_message);
         }
     }
@@ -961,6 +1073,12 @@ void ticket::lock_failed(std::string const & reason)
         return;
     }
 
+    if(send == SEND_MSG_UNLOCKING
+    || send == SEND_MSG_FAILED)
+    {
+        f_cluckd->get_object_stats().timed_out(f_object_name);
+    }
+
     switch(send)
     {
     case SEND_MSG_NONE:
@@ -989,6 +1107,7 @@ void ticket::lock_failed(std::string const & reason)
             lock_failed_message.set_service(f_service_name);
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_object_name, f_object_name);
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_tag, f_tag);
+            lock_failed_message.add_parameter(cluck::g_name_cluck_param_pid, f_entering_key.get_pid());
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_error, cluck::g_name_cluck_value_timedout);
             f_messenger->send_message(lock_failed_message);
         }
@@ -1022,6 +1141,7 @@ void ticket::lock_failed(std::string const & reason)
             lock_failed_message.set_service(f_service_name);
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_object_name, f_object_name);
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_tag, f_tag);
+            lock_failed_message.add_parameter(cluck::g_name_cluck_param_pid, f_entering_key.get_pid());
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_error, cluck::g_name_cluck_value_timedout);
             f_messenger->send_message(lock_failed_message);
         }
@@ -1045,7 +1165,7 @@ void ticket::lock_failed(std::string const & reason)
             lock_failed_message.set_service(f_service_name);
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_object_name, f_object_name);
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_tag, f_tag);
-            lock_failed_message.add_parameter(cluck::g_name_cluck_param_key, f_entering_key);
+            lock_failed_message.add_parameter(cluck::g_name_cluck_param_key, f_entering_key.to_string());
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_error, cluck::g_name_cluck_value_failed);
             lock_failed_message.add_parameter(cluck::g_name_cluck_param_description,
                     "ticket failed before or after the lock was obtained ("
@@ -1093,7 +1213,7 @@ void ticket::set_owner(std::string const & owner)
  *
  * \return  The name of this ticket owner.
  */
-std::string const & ticket::get_owner() const
+atom const & ticket::get_owner() const
 {
     return f_owner;
 }
@@ -1113,17 +1233,14 @@ std::string const & ticket::get_owner() const
  */
 pid_t ticket::get_client_pid() const
 {
-    std::vector<std::string> segments;
-    if(snapdev::tokenize_string(segments, f_entering_key, "/") != 2)
+    if(!f_entering_key.is_valid())
     {
         throw cluck::invalid_parameter(
                   "ticket::get_client_pid() split f_entering_key \""
-                + f_entering_key
+                + f_entering_key.to_string()
                 + "\" and did not get exactly two segments.");
     }
-    std::int64_t value;
-    advgetopt::validator_integer::convert_string(segments[1], value);
-    return static_cast<pid_t>(value);
+    return f_entering_key.get_pid();
 }
 
 
@@ -1138,7 +1255,8 @@ pid_t ticket::get_client_pid() const
  * twice.
  *
  * The cluck daemon uses the leader number as part of the serial
- * number (bits 24 and 25) so it is unique among all the instances,
+ * number (bits 56 and 57, see SERIAL_LEADER_SHIFT; older versions
+ * used bits 24 and 25) so it is unique among all the instances,
  * at least until a cluck deamon dies and its unique numbers get
  * mingled (and the old leaders may change their own number too...)
  *
@@ -1216,6 +1334,46 @@ cluck::timeout_t ticket::get_unlock_duration() const
 }
 
 
+/** \brief Attach the quota reservation of the client to this ticket.
+ *
+ * The leader which receives the LOCK counts the ticket against the quota
+ * of the client which requested it. The reservation is released when the
+ * ticket is destroyed.
+ *
+ * \param[in] r  The reservation of this ticket.
+ */
+void ticket::set_quota_reservation(client_quota::reservation && r)
+{
+    f_quota_reservation = std::move(r);
+}
+
+
+/** \brief Mark whether the client wants LOCK_PROGRESS messages.
+ *
+ * The client adds the "progress" parameter to its LOCK message when it
+ * wants to be told about the position of its ticket in the queue.
+ * Only the leader which owns the ticket knows about this flag.
+ *
+ * \param[in] progress  true if LOCK_PROGRESS messages are to be sent.
+ *
+ * \sa progress()
+ */
+void ticket::set_progress(bool progress)
+{
+    f_progress = progress;
+}
+
+
+/** \brief Check whether the client wants LOCK_PROGRESS messages.
+ *
+ * \return true if LOCK_PROGRESS messages are sent for this ticket.
+ */
+bool ticket::get_progress() const
+{
+    return f_progress;
+}
+
+
 /** \brief Mark the ticket as being ready.
  *
  * This ticket is marked as being ready.
@@ -1227,6 +1385,7 @@ cluck::timeout_t ticket::get_unlock_duration() const
 void ticket::set_ready()
 {
     f_ticket_ready = true;
+    f_trace.mark(lock_trace::TRANSITION_READY, snapdev::now());
 }
 
 
@@ -1257,9 +1416,36 @@ void ticket::set_ticket_number(ticket_id_t const number)
     f_added_ticket = true;
 
     f_our_ticket = number;
-    f_ticket_key = snapdev::int_to_hex(f_our_ticket, false, 8)
-                 + '/'
-                 + f_entering_key;
+    f_ticket_key = ticket_key(f_our_ticket, f_entering_key);
+}
+
+
+/** \brief Generate a ticket key.
+ *
+ * The ticket key is composed of the ticket number in hexadecimal, the
+ * name of the server, and the PID of the client. The last two parts
+ * are the entering key.
+ *
+ * To remain compatible with older versions of cluckd, which use 32 bit
+ * ticket numbers, the ticket number is written with 8 digits as long
+ * as it fits in 32 bits. Larger numbers are written with 16 digits.
+ *
+ * \note
+ * Inside the daemon, the keys are kept in a ticket_key structure. This
+ * function only formats the string representation used on the wire.
+ *
+ * \param[in] number  The ticket number.
+ * \param[in] entering_key  The entering key (server name and PID).
+ *
+ * \return The ticket key.
+ */
+std::string ticket::make_ticket_key(
+      ticket_id_t number
+    , std::string const & entering_key)
+{
+    return ticket_key::ticket_number_to_string(number)
+         + '/'
+         + entering_key;
 }
 
 
@@ -1475,7 +1661,7 @@ bool ticket::timed_out() const
  */
 std::string const & ticket::get_object_name() const
 {
-    return f_object_name;
+    return f_object_name.str();
 }
 
 
@@ -1505,7 +1691,7 @@ ed::dispatcher_match::tag_t ticket::get_tag() const
  */
 std::string const & ticket::get_server_name() const
 {
-    return f_server_name;
+    return f_server_name.str();
 }
 
 
@@ -1522,7 +1708,7 @@ std::string const & ticket::get_server_name() const
  */
 std::string const & ticket::get_service_name() const
 {
-    return f_service_name;
+    return f_service_name.str();
 }
 
 
@@ -1537,7 +1723,7 @@ std::string const & ticket::get_service_name() const
  *
  * \return The entering key of this ticket.
  */
-std::string const & ticket::get_entering_key() const
+ticket_key const & ticket::get_entering_key() const
 {
     return f_entering_key;
 }
@@ -1554,11 +1740,11 @@ std::string const & ticket::get_entering_key() const
  * \li Process Identifier (PID) of the service daemon asking for the lock.
  *
  * \note
- * This function returns an empty string until the ticket key is available.
+ * This function returns an empty key until the ticket key is available.
  *
  * \return The ticket key.
  */
-std::string const & ticket::get_ticket_key() const
+ticket_key const & ticket::get_ticket_key() const
 {
     return f_ticket_key;
 }
@@ -1584,24 +1770,24 @@ std::string ticket::serialize() const
 {
     std::map<std::string, std::string> data;
 
-    data["object_name"]         = f_object_name;
+    data["object_name"]         = f_object_name.str();
     data["tag"]                 = std::to_string(static_cast<int>(f_tag));
     data["obtention_timeout"]   = f_obtention_timeout.to_timestamp(true);
     //data["alive_timeout"]       = f_alive_timeout.to_timestamp(true); -- we do not want to transfer this one
     data["lock_duration"]       = f_lock_duration.to_timestamp(true);
     data["unlock_duration"]     = f_unlock_duration.to_timestamp(true);
-    data["server_name"]         = f_server_name;
-    data["service_name"]        = f_service_name;
-    data["owner"]               = f_owner;
+    data["server_name"]         = f_server_name.str();
+    data["service_name"]        = f_service_name.str();
+    data["owner"]               = f_owner.str();
     if(f_serial != NO_SERIAL)
     {
         data["serial"]          = std::to_string(f_serial);
     }
-    data["entering_key"]        = f_entering_key;
+    data["entering_key"]        = f_entering_key.to_string();
     data["get_max_ticket"]      = f_get_max_ticket ? "true" : "false";
     data["our_ticket"]          = std::to_string(f_our_ticket);
     data["added_ticket"]        = f_added_ticket ? "true" : "false";
-    data["ticket_key"]          = f_ticket_key;
+    data["ticket_key"]          = f_ticket_key.to_string();
     data["added_ticket_quorum"] = f_added_ticket_quorum ? "true" : "false";
 
     // this is a map
@@ -1693,7 +1879,7 @@ void ticket::unserialize(std::string const & data)
                                 "ticket::unserialize() not unserializing entering key \""
                                 + value
                                 + "\" over itself \""
-                                + f_entering_key
+                                + f_entering_key.to_string()
                                 + "\" (entering key mismatch).");
                     // LCOV_EXCL_STOP
                 }
@@ -1755,7 +1941,7 @@ void ticket::unserialize(std::string const & data)
                                 "ticket::unserialize() not unserializing object name \""
                                 + value
                                 + "\" over itself \""
-                                + f_object_name
+                                + f_object_name.str()
                                 + "\" (object name mismatch).");
                     // LCOV_EXCL_STOP
                 }
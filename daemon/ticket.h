@@ -19,7 +19,12 @@
 
 // self
 //
+#include    "atom.h"
+#include    "client_quota.h"
+#include    "lock_trace.h"
 #include    "messenger.h"
+#include    "ticket_key.h"
+#include    "ticket_store.h"
 
 
 // cluck
@@ -44,20 +49,27 @@ class ticket
 public:
     typedef std::shared_ptr<ticket>             pointer_t;
     typedef std::vector<pointer_t>              vector_t;
-    typedef std::map<std::string, pointer_t>    key_map_t;      // sorted by key
-    typedef std::map<std::string, key_map_t>    object_map_t;   // sorted by object_name
-    typedef std::int32_t                        serial_t;
-    typedef std::uint32_t                       ticket_id_t;
+    typedef ticket_map                          key_map_t;      // sorted by key
+    typedef ticket_store                        object_map_t;   // hashed by object_name
+    typedef std::int64_t                        serial_t;
+    typedef ticket_key::ticket_id_t             ticket_id_t;
 
     static serial_t const                       NO_SERIAL = -1;
-    static ticket_id_t const                    NO_TICKET = 0;
+    static ticket_id_t const                    NO_TICKET = ticket_key::NO_TICKET;
+    static int const                            SERIAL_LEADER_SHIFT = 56;
+    static serial_t const                       SERIAL_COUNTER_MASK = (1LL << SERIAL_LEADER_SHIFT) - 1;
+    static std::size_t const                    NO_POSITION = static_cast<std::size_t>(-1);
+
+    static std::string          make_ticket_key(
+                                          ticket_id_t number
+                                        , std::string const & entering_key);
 
                                 ticket(
                                           cluckd * c
                                         , messenger::pointer_t messenger
                                         , std::string const & lock_name
                                         , ed::dispatcher_match::tag_t tag
-                                        , std::string const & entering_key
+                                        , ticket_key const & entering_key
                                         , cluck::timeout_t obtention_timeout
                                         , cluck::timeout_t lock_duration
                                         , std::string const & server_name
@@ -73,9 +85,15 @@ public:
     void                        max_ticket(ticket_id_t new_max_ticket);
     void                        add_ticket();
     void                        ticket_added(key_map_t const & entering);
-    void                        remove_entering(std::string const & key);
-    void                        activate_lock();
+    void                        remove_entering(ticket_key const & key);
+    bool                        activate_lock();
     void                        lock_activated();
+    cluck::timeout_t            progress(
+                                          std::size_t position
+                                        , std::size_t holders
+                                        , cluck::timeout_t const & estimated_wait
+                                        , cluck::timeout_t const & now
+                                        , cluck::timeout_t const & interval);
     void                        drop_ticket(); // this is called when we receive the UNLOCK event
     void                        lock_failed(std::string const & reason);
     void                        lock_tickets();
@@ -83,11 +101,14 @@ public:
     // object handling
     //
     void                        set_owner(std::string const & owner);
-    std::string const &         get_owner() const;
+    atom const &                get_owner() const;
     pid_t                       get_client_pid() const;
     void                        set_serial(serial_t owner);
     serial_t                    get_serial() const;
     void                        set_unlock_duration(cluck::timeout_t duration);
+    void                        set_quota_reservation(client_quota::reservation && r);
+    void                        set_progress(bool progress);
+    bool                        get_progress() const;
     cluck::timeout_t            get_unlock_duration() const;
     void                        set_ready();
     void                        set_ticket_number(ticket_id_t number);
@@ -104,8 +125,8 @@ public:
     ed::dispatcher_match::tag_t get_tag() const;
     std::string const &         get_server_name() const;
     std::string const &         get_service_name() const;
-    std::string const &         get_entering_key() const;
-    std::string const &         get_ticket_key() const;
+    ticket_key const &          get_entering_key() const;
+    ticket_key const &          get_ticket_key() const;
     std::string                 serialize() const;
     void                        unserialize(std::string const & data);
 
@@ -125,27 +146,30 @@ private:
     // initialization
     //
     messenger::pointer_t            f_messenger = messenger::pointer_t();
-    std::string                     f_object_name = std::string();
+    atom                            f_object_name = atom();
     ed::dispatcher_match::tag_t     f_tag = ed::dispatcher_match::DISPATCHER_MATCH_NO_TAG;
     cluck::timeout_t                f_obtention_timeout = cluck::timeout_t();
     cluck::timeout_t                f_alive_timeout = cluck::timeout_t();
     cluck::timeout_t                f_lock_duration = cluck::timeout_t();
     cluck::timeout_t                f_unlock_duration = cluck::timeout_t();
-    std::string                     f_server_name = std::string();
-    std::string                     f_service_name = std::string();
-    std::string                     f_owner = std::string();
+    atom                            f_server_name = atom();
+    atom                            f_service_name = atom();
+    atom                            f_owner = atom();
     serial_t                        f_serial = NO_SERIAL;
+    client_quota::reservation       f_quota_reservation = client_quota::reservation();
+    bool                            f_progress = false;
 
     // initialized, entering
     //
-    std::string                     f_entering_key = std::string();
+    lock_trace                      f_trace = lock_trace();
+    ticket_key                      f_entering_key = ticket_key();
     bool                            f_get_max_ticket = false;
 
     // entered, adding ticket
     //
     ticket_id_t                     f_our_ticket = NO_TICKET;
     bool                            f_added_ticket = false;
-    std::string                     f_ticket_key = std::string();
+    ticket_key                      f_ticket_key = ticket_key();
 
     // ticket added, exiting
     //
@@ -156,6 +180,12 @@ private:
     //
     bool                            f_ticket_ready = false;
 
+    // waiting, progress sent to the client
+    //
+    std::size_t                     f_progress_position = NO_POSITION;
+    std::size_t                     f_progress_holders = 0;
+    cluck::timeout_t                f_progress_date = cluck::timeout_t();
+
     // locked
     //
     bool                            f_locked = false;
@@ -0,0 +1,464 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// self
+//
+#include    "ticket_key.h"
+
+
+// snapdev
+//
+#include    <snapdev/hexadecimal_string.h>
+
+
+// C++
+//
+#include    <charconv>
+#include    <limits>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+/** \class ticket_key
+ * \brief The key of an entering ticket or a ticket.
+ *
+ * On the wire, an entering key is a string formatted as
+ * "<server name>/<pid>" and a ticket key prepends the ticket number
+ * written in hexadecimal: "<ticket number>/<server name>/<pid>".
+ *
+ * Inside the daemon, the keys are kept in this structure instead. The
+ * server name is an atom and the ticket number and pid are integers.
+ * This way searching the maps of tickets does not require creating
+ * and comparing strings. The strings are only generated to send the
+ * keys in a message or to print them in the logs.
+ *
+ * A key which cannot be parsed is kept as is (in the server name field,
+ * with a pid of 0) so it can still be searched and sent back in an
+ * error message. Such keys are not valid (see is_valid()).
+ *
+ * The keys sort by ticket number first, numerically, whatever the number
+ * of digits used on the wire. Keys with the same number (which includes
+ * all the entering keys) then sort as the "<server>/<pid>" string would.
+ * This is a strict weak ordering even when server names look like
+ * ticket numbers. All the leaders must agree on the order of the tickets.
+ */
+
+
+
+namespace
+{
+
+
+
+/** \brief Convert a pid to a string without allocation.
+ *
+ * \param[in] pid  The pid to convert.
+ * \param[in] buf  The output buffer.
+ *
+ * \return A view on the digits written in \p buf, an empty view if
+ * \p pid is 0 (i.e. the key is not valid).
+ */
+std::string_view pid_to_chars(pid_t pid, char (&buf)[16])
+{
+    if(pid == 0)
+    {
+        return std::string_view();
+    }
+    std::to_chars_result const r(std::to_chars(buf, buf + sizeof(buf), pid));
+    return std::string_view(buf, r.ptr - buf);
+}
+
+
+
+} // no name namespace
+
+
+
+/** \brief Initialize an empty key.
+ *
+ * An empty key is not valid.
+ */
+ticket_key::ticket_key()
+{
+}
+
+
+/** \brief Initialize an entering key.
+ *
+ * \param[in] server_name  The name of the server requesting the lock.
+ * \param[in] pid  The pid of the process requesting the lock.
+ */
+ticket_key::ticket_key(atom const & server_name, pid_t pid)
+    : f_server_name(server_name)
+    , f_pid(pid)
+{
+}
+
+
+/** \brief Initialize a ticket key.
+ *
+ * A ticket key is the entering key of the ticket with its ticket
+ * number.
+ *
+ * \param[in] number  The ticket number.
+ * \param[in] entering_key  The entering key of the ticket.
+ */
+ticket_key::ticket_key(ticket_id_t number, ticket_key const & entering_key)
+    : f_number(number)
+    , f_server_name(entering_key.f_server_name)
+    , f_pid(entering_key.f_pid)
+{
+}
+
+
+/** \brief Parse a key received in a message.
+ *
+ * The key is expected to be an entering key ("<server>/<pid>") or a
+ * ticket key ("<ticket number>/<server>/<pid>"). Anything else is kept
+ * as is in an invalid key.
+ *
+ * \param[in] key  The key to parse.
+ */
+ticket_key::ticket_key(std::string_view key)
+{
+    std::string_view::size_type const pid_pos(key.rfind('/'));
+    if(pid_pos != std::string_view::npos
+    && pid_pos != 0)
+    {
+        std::string_view server_name(key.substr(0, pid_pos));
+        ticket_id_t number(NO_TICKET);
+        bool valid(true);
+        std::string_view::size_type const number_pos(server_name.find('/'));
+        if(number_pos != std::string_view::npos)
+        {
+            valid = parse_ticket_number(server_name.substr(0, number_pos), number)
+                 && number != NO_TICKET;
+            server_name = server_name.substr(number_pos + 1);
+            valid = valid
+                 && !server_name.empty()
+                 && server_name.find('/') == std::string_view::npos;
+        }
+
+        std::string_view const pid(key.substr(pid_pos + 1));
+        std::int64_t value(0);
+        std::from_chars_result const r(std::from_chars(pid.data(), pid.data() + pid.length(), value));
+        if(valid
+        && !pid.empty()
+        && r.ec == std::errc()
+        && r.ptr == pid.data() + pid.length()
+        && value > 0
+        && value <= std::numeric_limits<pid_t>::max())
+        {
+            f_number = number;
+            f_server_name = atom(server_name);
+            f_pid = static_cast<pid_t>(value);
+            return;
+        }
+    }
+
+    f_server_name = atom(key);
+}
+
+
+/** \brief Parse a key received in a message.
+ *
+ * \param[in] key  The key to parse.
+ */
+ticket_key::ticket_key(std::string const & key)
+    : ticket_key(std::string_view(key))
+{
+}
+
+
+/** \brief Parse a key received in a message.
+ *
+ * \param[in] key  The key to parse.
+ */
+ticket_key::ticket_key(char const * key)
+    : ticket_key(std::string_view(key == nullptr ? "" : key))
+{
+}
+
+
+/** \brief Parse the ticket number segment of a ticket key.
+ *
+ * Older versions of cluckd use 8 digits, newer versions use 16 digits
+ * when the number does not fit in 32 bits.
+ *
+ * \param[in] number  The hexadecimal number to parse.
+ * \param[out] result  The resulting ticket number.
+ *
+ * \return true if \p number was a valid ticket number.
+ */
+bool ticket_key::parse_ticket_number(std::string_view number, ticket_id_t & result)
+{
+    if(number.length() != 8
+    && number.length() != 16)
+    {
+        return false;
+    }
+
+    std::from_chars_result const r(std::from_chars(number.data(), number.data() + number.length(), result, 16));
+    return r.ec == std::errc()
+        && r.ptr == number.data() + number.length();
+}
+
+
+/** \brief Convert a ticket number to its string representation.
+ *
+ * Up to 0xFFFFFFFF the number uses 8 digits (the original 32 bit format)
+ * so keys generated with smaller numbers are unchanged. Above that limit
+ * the number uses 16 digits.
+ *
+ * \param[in] number  The ticket number to convert.
+ *
+ * \return The ticket number in hexadecimal.
+ */
+std::string ticket_key::ticket_number_to_string(ticket_id_t number)
+{
+    return snapdev::int_to_hex(
+                  number
+                , false
+                , number > std::numeric_limits<std::uint32_t>::max() ? 16 : 8);
+}
+
+
+/** \brief Check whether the key was defined.
+ *
+ * \return true if this key was not set.
+ */
+bool ticket_key::empty() const
+{
+    return f_pid == 0
+        && f_server_name.empty();
+}
+
+
+/** \brief Check whether the key was parsed successfully.
+ *
+ * \return true if the key has a server name and a pid.
+ */
+bool ticket_key::is_valid() const
+{
+    return f_pid != 0;
+}
+
+
+/** \brief Check whether this is an entering key.
+ *
+ * \return true if the key does not include a ticket number.
+ */
+bool ticket_key::is_entering_key() const
+{
+    return f_number == NO_TICKET;
+}
+
+
+/** \brief Get the ticket number.
+ *
+ * \return The ticket number or NO_TICKET for an entering key.
+ */
+ticket_key::ticket_id_t ticket_key::get_ticket_number() const
+{
+    return f_number;
+}
+
+
+/** \brief Get the name of the server which requested the lock.
+ *
+ * \return The server name atom.
+ */
+atom const & ticket_key::get_server_name() const
+{
+    return f_server_name;
+}
+
+
+/** \brief Get the pid of the process which requested the lock.
+ *
+ * \return The pid or 0 if the key is not valid.
+ */
+pid_t ticket_key::get_pid() const
+{
+    return f_pid;
+}
+
+
+/** \brief Get the entering key of a ticket key.
+ *
+ * \return This key without the ticket number.
+ */
+ticket_key ticket_key::get_entering_key() const
+{
+    return ticket_key(f_server_name, f_pid);
+}
+
+
+/** \brief Format the key as sent in messages.
+ *
+ * \return The key as a string.
+ */
+std::string ticket_key::to_string() const
+{
+    if(f_pid == 0)
+    {
+        return f_server_name.str();
+    }
+
+    std::string result;
+    if(f_number != NO_TICKET)
+    {
+        result = ticket_number_to_string(f_number);
+        result += '/';
+    }
+    result += f_server_name.str();
+    result += '/';
+    result += std::to_string(f_pid);
+    return result;
+}
+
+
+/** \brief Compare two keys.
+ *
+ * \param[in] rhs  The other key.
+ *
+ * \return true if both keys are equal.
+ */
+bool ticket_key::operator == (ticket_key const & rhs) const
+{
+    return f_number == rhs.f_number
+        && f_pid == rhs.f_pid
+        && f_server_name == rhs.f_server_name;
+}
+
+
+/** \brief Sort two keys.
+ *
+ * The ticket number is compared first. Then the entering keys are
+ * compared as if they were strings.
+ *
+ * \param[in] rhs  The other key.
+ *
+ * \return true if this key sorts before \p rhs.
+ */
+bool ticket_key::operator < (ticket_key const & rhs) const
+{
+    if(f_number != rhs.f_number)
+    {
+        return f_number < rhs.f_number;
+    }
+    return compare_entering_keys(rhs) < 0;
+}
+
+
+/** \brief Compare the "<server>/<pid>" part of two keys.
+ *
+ * This function gives the same result as comparing the keys as strings
+ * without actually building the strings.
+ *
+ * \param[in] rhs  The other key.
+ *
+ * \return -1, 0, or 1 like std::string::compare().
+ */
+int ticket_key::compare_entering_keys(ticket_key const & rhs) const
+{
+    char lbuf[16];
+    char rbuf[16];
+    std::string_view const lpid(pid_to_chars(f_pid, lbuf));
+    std::string_view const rpid(pid_to_chars(rhs.f_pid, rbuf));
+
+    if(f_server_name == rhs.f_server_name)
+    {
+        // an invalid key has no "/<pid>" so it sorts first
+        //
+        if(lpid.empty() || rpid.empty())
+        {
+            return static_cast<int>(!lpid.empty()) - static_cast<int>(!rpid.empty());
+        }
+        int const r(lpid.compare(rpid));
+        return r < 0 ? -1 : (r > 0 ? 1 : 0);
+    }
+
+    std::string const & lname(f_server_name.str());
+    std::string const & rname(rhs.f_server_name.str());
+    std::string::size_type const size(std::min(lname.length(), rname.length()));
+    int const r(lname.compare(0, size, rname, 0, size));
+    if(r != 0)
+    {
+        return r < 0 ? -1 : 1;
+    }
+
+    // one name is a prefix of the other, the shorter one is followed
+    // by a '/' in the key string (or nothing if the key is invalid)
+    //
+    if(lname.length() < rname.length())
+    {
+        if(lpid.empty())
+        {
+            return -1;
+        }
+        unsigned char const c(rname[size]);
+        if(c != '/')
+        {
+            return '/' < c ? -1 : 1;
+        }
+    }
+    else
+    {
+        if(rpid.empty())
+        {
+            return 1;
+        }
+        unsigned char const c(lname[size]);
+        if(c != '/')
+        {
+            return c < '/' ? -1 : 1;
+        }
+    }
+
+    // this only happens with invalid keys which include a '/'
+    //
+    int const s(get_entering_key().to_string().compare(rhs.get_entering_key().to_string()));
+    return s < 0 ? -1 : (s > 0 ? 1 : 0);
+}
+
+
+/** \brief Print a key.
+ *
+ * \param[in] out  The output stream.
+ * \param[in] key  The key to print.
+ *
+ * \return A reference to \p out.
+ */
+std::ostream & operator << (std::ostream & out, ticket_key const & key)
+{
+    return out << key.to_string();
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
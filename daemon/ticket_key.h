@@ -0,0 +1,86 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+// self
+//
+#include    "atom.h"
+
+
+// C++
+//
+#include    <cstdint>
+#include    <string>
+#include    <string_view>
+
+
+// C
+//
+#include    <sys/types.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+class ticket_key
+{
+public:
+    typedef std::uint64_t       ticket_id_t;
+
+    static ticket_id_t const    NO_TICKET = 0;
+
+                                ticket_key();
+                                ticket_key(atom const & server_name, pid_t pid);
+                                ticket_key(ticket_id_t number, ticket_key const & entering_key);
+                                ticket_key(std::string_view key);
+                                ticket_key(std::string const & key);
+                                ticket_key(char const * key);
+
+    static bool                 parse_ticket_number(std::string_view number, ticket_id_t & result);
+    static std::string          ticket_number_to_string(ticket_id_t number);
+
+    bool                        empty() const;
+    bool                        is_valid() const;
+    bool                        is_entering_key() const;
+    ticket_id_t                 get_ticket_number() const;
+    atom const &                get_server_name() const;
+    pid_t                       get_pid() const;
+    ticket_key                  get_entering_key() const;
+    std::string                 to_string() const;
+
+    bool                        operator == (ticket_key const & rhs) const;
+    bool                        operator < (ticket_key const & rhs) const;
+
+private:
+    int                         compare_entering_keys(ticket_key const & rhs) const;
+
+    ticket_id_t                 f_number = NO_TICKET;
+    atom                        f_server_name = atom();
+    pid_t                       f_pid = 0;
+};
+
+
+std::ostream & operator << (std::ostream & out, ticket_key const & key);
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,268 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Implementation of the ticket pool.
+ *
+ * Each LOCK creates a ticket on each leader and that ticket is released
+ * as soon as the lock is dropped. With short-lived locks at a high rate,
+ * this means many allocations and deallocations of the exact same size.
+ *
+ * The ticket pool allocates slabs of blocks of that size and keeps the
+ * released blocks in a free list. Once the pool grew to the number of
+ * tickets alive at the busiest moment, creating and dropping a ticket
+ * does not call the general-purpose allocator anymore.
+ *
+ * The strings of a ticket are atoms and its keys are ticket_key objects,
+ * so the ticket body itself does not allocate anything else.
+ *
+ * \warning
+ * The pool is not protected by a mutex. The cluck daemon only creates
+ * and releases tickets from its main thread.
+ */
+
+// self
+//
+#include    "ticket_pool.h"
+
+
+// C++
+//
+#include    <algorithm>
+#include    <cstddef>
+#include    <new>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+namespace
+{
+
+
+
+/** \brief Round a size up to the size of a block.
+ *
+ * \param[in] size  The size to round up.
+ *
+ * \return The size of the block used to hold \p size bytes.
+ */
+std::size_t block_size(std::size_t size)
+{
+    std::size_t const align(alignof(std::max_align_t));
+    size = std::max(size, sizeof(void *));
+    return (size + align - 1) & ~(align - 1);
+}
+
+
+
+} // no name namespace
+
+
+
+/** \class ticket_pool
+ * \brief A slab allocator for tickets.
+ *
+ * The pool serves blocks of one size. That size is defined by the first
+ * allocation, which is the size std::allocate_shared() needs for a
+ * ticket along its reference counters. Any other request (i.e. a
+ * different size or a stricter alignment) is forwarded to the
+ * general-purpose allocator.
+ *
+ * The slabs are kept until the pool is destroyed. The pool does not
+ * shrink once the peak of tickets passed.
+ */
+
+
+
+/** \brief Initialize an empty pool.
+ *
+ * The pool does not allocate anything until the first ticket gets
+ * created.
+ */
+ticket_pool::ticket_pool()
+{
+}
+
+
+/** \brief Release the slabs.
+ *
+ * The allocator holds a pointer to the pool so the pool cannot be
+ * destroyed while tickets still use its blocks.
+ */
+ticket_pool::~ticket_pool()
+{
+    for(auto s : f_slabs)
+    {
+        ::operator delete(s);
+    }
+}
+
+
+/** \brief Allocate a block.
+ *
+ * This function returns a block from the free list. If the list is
+ * empty, a new slab gets allocated first.
+ *
+ * The very first call defines the size of the blocks.
+ *
+ * \param[in] size  The number of bytes required.
+ * \param[in] alignment  The alignment required.
+ *
+ * \return A pointer to the allocated memory.
+ */
+void * ticket_pool::allocate(std::size_t size, std::size_t alignment)
+{
+    if(f_block_size == 0
+    && alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    {
+        f_block_size = block_size(size);
+    }
+
+    if(block_size(size) != f_block_size
+    || alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    {
+        ++f_upstream_allocations;
+        return ::operator new(size);
+    }
+
+    if(f_free == nullptr)
+    {
+        add_slab();
+    }
+
+    free_block * b(f_free);
+    f_free = b->f_next;
+    --f_free_blocks;
+    ++f_used_blocks;
+
+    return b;
+}
+
+
+/** \brief Return a block to the pool.
+ *
+ * The block is added to the free list and reused by the next
+ * allocation. The size must be the one used with allocate().
+ *
+ * \param[in] ptr  The pointer returned by allocate().
+ * \param[in] size  The size passed to allocate().
+ * \param[in] alignment  The alignment passed to allocate().
+ */
+void ticket_pool::deallocate(void * ptr, std::size_t size, std::size_t alignment) noexcept
+{
+    if(block_size(size) != f_block_size
+    || alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    free_block * b(static_cast<free_block *>(ptr));
+    b->f_next = f_free;
+    f_free = b;
+    ++f_free_blocks;
+    --f_used_blocks;
+}
+
+
+/** \brief Allocate one more slab.
+ *
+ * The new slab is cut in BLOCKS_PER_SLAB blocks which are all added
+ * to the free list.
+ */
+void ticket_pool::add_slab()
+{
+    char * slab(static_cast<char *>(::operator new(f_block_size * BLOCKS_PER_SLAB)));
+    ++f_upstream_allocations;
+    f_slabs.push_back(slab);
+
+    for(std::size_t idx(BLOCKS_PER_SLAB); idx > 0; --idx)
+    {
+        free_block * b(reinterpret_cast<free_block *>(slab + (idx - 1) * f_block_size));
+        b->f_next = f_free;
+        f_free = b;
+    }
+    f_free_blocks += BLOCKS_PER_SLAB;
+}
+
+
+/** \brief Get the size of the blocks of this pool.
+ *
+ * \return The block size or 0 if nothing was allocated yet.
+ */
+std::size_t ticket_pool::get_block_size() const
+{
+    return f_block_size;
+}
+
+
+/** \brief Get the number of slabs allocated so far.
+ *
+ * \return The number of slabs.
+ */
+std::size_t ticket_pool::get_slab_count() const
+{
+    return f_slabs.size();
+}
+
+
+/** \brief Get the number of blocks currently in use.
+ *
+ * \return The number of tickets currently allocated in this pool.
+ */
+std::size_t ticket_pool::get_used_blocks() const
+{
+    return f_used_blocks;
+}
+
+
+/** \brief Get the number of blocks ready for reuse.
+ *
+ * \return The number of blocks in the free list.
+ */
+std::size_t ticket_pool::get_free_blocks() const
+{
+    return f_free_blocks;
+}
+
+
+/** \brief Get the number of calls to the general-purpose allocator.
+ *
+ * This counter includes the slabs and the requests the pool could not
+ * serve. Once the pool reached its steady state, it does not change
+ * anymore.
+ *
+ * \return The number of upstream allocations.
+ */
+std::size_t ticket_pool::get_upstream_allocations() const
+{
+    return f_upstream_allocations;
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
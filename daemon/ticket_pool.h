@@ -0,0 +1,132 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+// C++
+//
+#include    <cstdint>
+#include    <memory>
+#include    <vector>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+class ticket_pool
+{
+public:
+    typedef std::shared_ptr<ticket_pool>    pointer_t;
+
+    static std::size_t const    BLOCKS_PER_SLAB = 64;
+
+                                ticket_pool();
+                                ticket_pool(ticket_pool const &) = delete;
+                                ~ticket_pool();
+
+    ticket_pool &               operator = (ticket_pool const &) = delete;
+
+    void *                      allocate(std::size_t size, std::size_t alignment);
+    void                        deallocate(void * ptr, std::size_t size, std::size_t alignment) noexcept;
+
+    std::size_t                 get_block_size() const;
+    std::size_t                 get_slab_count() const;
+    std::size_t                 get_used_blocks() const;
+    std::size_t                 get_free_blocks() const;
+    std::size_t                 get_upstream_allocations() const;
+
+private:
+    struct free_block
+    {
+        free_block *            f_next = nullptr;
+    };
+
+    void                        add_slab();
+
+    std::size_t                 f_block_size = 0;
+    std::vector<void *>         f_slabs = std::vector<void *>();
+    free_block *                f_free = nullptr;
+    std::size_t                 f_used_blocks = 0;
+    std::size_t                 f_free_blocks = 0;
+    std::size_t                 f_upstream_allocations = 0;
+};
+
+
+/** \brief Allocator giving tickets memory from a ticket_pool.
+ *
+ * This allocator is used with std::allocate_shared() so the ticket and
+ * its reference counters are allocated in one block of the pool.
+ *
+ * The allocator holds a shared pointer to its pool. Since a copy of the
+ * allocator is saved in the control block of each ticket, the pool
+ * remains valid until the last ticket is gone.
+ */
+template<typename T>
+class ticket_allocator
+{
+public:
+    typedef T                   value_type;
+
+                                ticket_allocator(ticket_pool::pointer_t pool) noexcept
+                                    : f_pool(pool)
+                                {
+                                }
+
+                                template<typename U>
+                                ticket_allocator(ticket_allocator<U> const & rhs) noexcept
+                                    : f_pool(rhs.get_pool())
+                                {
+                                }
+
+    T *                         allocate(std::size_t n)
+                                {
+                                    return static_cast<T *>(f_pool->allocate(n * sizeof(T), alignof(T)));
+                                }
+
+    void                        deallocate(T * ptr, std::size_t n) noexcept
+                                {
+                                    f_pool->deallocate(ptr, n * sizeof(T), alignof(T));
+                                }
+
+    ticket_pool::pointer_t      get_pool() const
+                                {
+                                    return f_pool;
+                                }
+
+    template<typename U>
+    bool                        operator == (ticket_allocator<U> const & rhs) const
+                                {
+                                    return f_pool == rhs.get_pool();
+                                }
+
+    template<typename U>
+    bool                        operator != (ticket_allocator<U> const & rhs) const
+                                {
+                                    return f_pool != rhs.get_pool();
+                                }
+
+private:
+    ticket_pool::pointer_t      f_pool = ticket_pool::pointer_t();
+};
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
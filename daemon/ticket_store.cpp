@@ -0,0 +1,484 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Implementation of the ticket store.
+ *
+ * The cluck daemon keeps its tickets per object. It used to be a map of
+ * maps, so each search went through two trees of nodes allocated all
+ * over the heap before reaching the ticket.
+ *
+ * The ticket_store is an open-addressing hash of the object names,
+ * which are atoms, so the hash is computed from the atom identifier and
+ * comparing two names is a pointer comparison. The objects are saved
+ * in one contiguous vector.
+ *
+ * Each object has a ticket_map, which holds two parallel sorted vectors:
+ * one of keys and one of tickets. The keys include the ticket number,
+ * the server name and the pid, so searching a ticket or its number
+ * scans a contiguous array without touching the tickets themselves.
+ */
+
+// self
+//
+#include    "ticket_store.h"
+
+
+// C++
+//
+#include    <algorithm>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+/** \class ticket_map
+ * \brief A flat map of tickets sorted by key.
+ *
+ * This map is a replacement of the std::map<ticket_key, pointer_t>.
+ * The keys and the tickets are saved in two vectors at the same index.
+ * The iterators return a pair of references named `first` and `second`
+ * so the map can be used like a std::map.
+ *
+ * Inserting or erasing a ticket invalidates the iterators which point
+ * after that ticket (erase() returns a valid iterator to the next
+ * ticket). Moving or growing the ticket_store does not invalidate them.
+ *
+ * The first ticket is the head of the queue of that object. The map
+ * remembers whether that head was already activated. The flag is
+ * cleared each time the head changes so the daemon knows when an
+ * ACTIVATE_LOCK message is necessary.
+ */
+
+
+ticket_map::iterator ticket_map::begin()
+{
+    return iterator(f_keys.data(), f_tickets.data());
+}
+
+
+ticket_map::iterator ticket_map::end()
+{
+    return iterator(f_keys.data() + f_keys.size(), f_tickets.data() + f_tickets.size());
+}
+
+
+ticket_map::const_iterator ticket_map::begin() const
+{
+    return const_iterator(f_keys.data(), f_tickets.data());
+}
+
+
+ticket_map::const_iterator ticket_map::end() const
+{
+    return const_iterator(f_keys.data() + f_keys.size(), f_tickets.data() + f_tickets.size());
+}
+
+
+bool ticket_map::empty() const
+{
+    return f_keys.empty();
+}
+
+
+std::size_t ticket_map::size() const
+{
+    return f_keys.size();
+}
+
+
+void ticket_map::clear()
+{
+    f_keys.clear();
+    f_tickets.clear();
+    f_head_activated = false;
+}
+
+
+/** \brief Search the position of a key.
+ *
+ * \param[in] key  The key to search.
+ *
+ * \return The index of the first key which is not less than \p key.
+ */
+std::size_t ticket_map::lower_bound(ticket_key const & key) const
+{
+    return std::lower_bound(f_keys.begin(), f_keys.end(), key) - f_keys.begin();
+}
+
+
+/** \brief Search a ticket.
+ *
+ * \param[in] key  The key of the ticket to search.
+ *
+ * \return An iterator to the ticket or end().
+ */
+ticket_map::iterator ticket_map::find(ticket_key const & key)
+{
+    std::size_t const idx(lower_bound(key));
+    if(idx >= f_keys.size()
+    || !(f_keys[idx] == key))
+    {
+        return end();
+    }
+    return iterator(f_keys.data() + idx, f_tickets.data() + idx);
+}
+
+
+/** \brief Search a ticket.
+ *
+ * \param[in] key  The key of the ticket to search.
+ *
+ * \return An iterator to the ticket or end().
+ */
+ticket_map::const_iterator ticket_map::find(ticket_key const & key) const
+{
+    std::size_t const idx(lower_bound(key));
+    if(idx >= f_keys.size()
+    || !(f_keys[idx] == key))
+    {
+        return end();
+    }
+    return const_iterator(f_keys.data() + idx, f_tickets.data() + idx);
+}
+
+
+/** \brief Get a reference to a ticket, adding it if necessary.
+ *
+ * If \p key is not yet in the map, it gets inserted with a null ticket
+ * at its sorted position.
+ *
+ * The caller may replace the ticket, so getting a reference to the head
+ * of the queue clears the head activated flag.
+ *
+ * \param[in] key  The key of the ticket.
+ *
+ * \return A reference to the ticket pointer.
+ */
+ticket_map::pointer_t & ticket_map::operator [] (ticket_key const & key)
+{
+    std::size_t const idx(lower_bound(key));
+    if(idx >= f_keys.size()
+    || !(f_keys[idx] == key))
+    {
+        f_keys.insert(f_keys.begin() + idx, key);
+        f_tickets.insert(f_tickets.begin() + idx, pointer_t());
+    }
+    if(idx == 0)
+    {
+        f_head_activated = false;
+    }
+    return f_tickets[idx];
+}
+
+
+/** \brief Remove a ticket.
+ *
+ * \param[in] it  An iterator to the ticket to remove.
+ *
+ * \return An iterator to the ticket which followed the removed ticket.
+ */
+ticket_map::iterator ticket_map::erase(iterator it)
+{
+    std::size_t const idx(it.get_key() - f_keys.data());
+    f_keys.erase(f_keys.begin() + idx);
+    f_tickets.erase(f_tickets.begin() + idx);
+    if(idx == 0)
+    {
+        f_head_activated = false;
+    }
+    return iterator(f_keys.data() + idx, f_tickets.data() + idx);
+}
+
+
+/** \brief Get the largest ticket number.
+ *
+ * The keys are sorted by ticket number first, so the last key has the
+ * largest number.
+ *
+ * \return The largest ticket number or NO_TICKET if the map is empty.
+ */
+ticket_key::ticket_id_t ticket_map::get_last_ticket_number() const
+{
+    if(f_keys.empty())
+    {
+        return ticket_key::NO_TICKET;
+    }
+    return f_keys.back().get_ticket_number();
+}
+
+
+/** \brief Check whether the head of the queue was activated.
+ *
+ * \return true if set_head_activated(true) was called since the head
+ * last changed.
+ */
+bool ticket_map::is_head_activated() const
+{
+    return f_head_activated;
+}
+
+
+/** \brief Mark the head of the queue as activated or not.
+ *
+ * The daemon sets this flag once it sent the ACTIVATE_LOCK message of
+ * the first ticket. It clears it when that activation needs to be
+ * attempted again.
+ *
+ * \param[in] activated  Whether the head was activated.
+ */
+void ticket_map::set_head_activated(bool activated)
+{
+    f_head_activated = activated;
+}
+
+
+
+
+/** \class ticket_store
+ * \brief The tickets of all the objects.
+ *
+ * The objects are saved in a vector. The hash table only holds the index
+ * of each object in that vector. The table uses linear probing and is
+ * kept at most half full.
+ *
+ * The order of the objects is not defined. Erasing an object moves the
+ * last object to its place, so the erase() function returns an iterator
+ * which can be used to continue a loop as with a std::map.
+ *
+ * Adding an object may move the other objects, which invalidates the
+ * iterators to the objects and the references to their ticket_map. The
+ * iterators of the ticket_map themselves remain valid.
+ */
+
+
+namespace
+{
+
+
+
+std::size_t hash_atom(atom const & object_name, std::size_t mask)
+{
+    std::uint64_t const h(static_cast<std::uint64_t>(object_name.id()) * 0x9E3779B97F4A7C15ULL);
+    return static_cast<std::size_t>(h >> 32) & mask;
+}
+
+
+
+} // no name namespace
+
+
+
+ticket_store::iterator ticket_store::begin()
+{
+    return f_objects.begin();
+}
+
+
+ticket_store::iterator ticket_store::end()
+{
+    return f_objects.end();
+}
+
+
+ticket_store::const_iterator ticket_store::begin() const
+{
+    return f_objects.begin();
+}
+
+
+ticket_store::const_iterator ticket_store::end() const
+{
+    return f_objects.end();
+}
+
+
+bool ticket_store::empty() const
+{
+    return f_objects.empty();
+}
+
+
+std::size_t ticket_store::size() const
+{
+    return f_objects.size();
+}
+
+
+void ticket_store::clear()
+{
+    f_objects.clear();
+    f_index.clear();
+}
+
+
+/** \brief Search the slot of an object.
+ *
+ * \param[in] object_name  The name of the object to search.
+ *
+ * \return The slot of that object or of the empty slot where it would
+ * be added.
+ */
+std::size_t ticket_store::find_slot(atom const & object_name) const
+{
+    std::size_t const mask(f_index.size() - 1);
+    std::size_t slot(hash_atom(object_name, mask));
+    while(f_index[slot] != NO_INDEX
+       && f_objects[f_index[slot]].first != object_name)
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+
+/** \brief Double the size of the hash table.
+ *
+ * The indexes of all the objects get inserted again.
+ */
+void ticket_store::grow()
+{
+    f_index.assign(std::max(f_index.size() * 2, static_cast<std::size_t>(16)), NO_INDEX);
+    for(std::size_t idx(0); idx < f_objects.size(); ++idx)
+    {
+        f_index[find_slot(f_objects[idx].first)] = static_cast<std::uint32_t>(idx);
+    }
+}
+
+
+ticket_store::iterator ticket_store::find(atom const & object_name)
+{
+    if(f_objects.empty())
+    {
+        return f_objects.end();
+    }
+    std::uint32_t const idx(f_index[find_slot(object_name)]);
+    return idx == NO_INDEX ? f_objects.end() : f_objects.begin() + idx;
+}
+
+
+/** \brief Search an object by name.
+ *
+ * The name is not interned by this function. If it is not an interned
+ * string, no object can have that name.
+ *
+ * \param[in] object_name  The name of the object to search.
+ *
+ * \return An iterator to the object or end().
+ */
+ticket_store::iterator ticket_store::find(std::string const & object_name)
+{
+    atom const name(atom::find(object_name));
+    if(name.empty() && !object_name.empty())
+    {
+        return f_objects.end();
+    }
+    return find(name);
+}
+
+
+ticket_store::const_iterator ticket_store::find(atom const & object_name) const
+{
+    return const_cast<ticket_store *>(this)->find(object_name);
+}
+
+
+ticket_store::const_iterator ticket_store::find(std::string const & object_name) const
+{
+    return const_cast<ticket_store *>(this)->find(object_name);
+}
+
+
+/** \brief Get the tickets of an object, adding it if necessary.
+ *
+ * \param[in] object_name  The name of the object.
+ *
+ * \return A reference to the tickets of that object.
+ */
+ticket_map & ticket_store::operator [] (atom const & object_name)
+{
+    if((f_objects.size() + 1) * 2 > f_index.size())
+    {
+        grow();
+    }
+
+    std::size_t const slot(find_slot(object_name));
+    if(f_index[slot] == NO_INDEX)
+    {
+        f_index[slot] = static_cast<std::uint32_t>(f_objects.size());
+        f_objects.emplace_back(object_name, ticket_map());
+    }
+    return f_objects[f_index[slot]].second;
+}
+
+
+/** \brief Remove an object and all its tickets.
+ *
+ * The last object is moved in place of the removed object and the
+ * slot removed from the hash table is filled back by shifting the
+ * following slots (there are no tombstones).
+ *
+ * \param[in] it  An iterator to the object to remove.
+ *
+ * \return An iterator to the object now at the same position or end().
+ */
+ticket_store::iterator ticket_store::erase(iterator it)
+{
+    std::size_t const mask(f_index.size() - 1);
+    std::size_t const idx(it - f_objects.begin());
+
+    // remove the slot and shift the next slots back as required
+    //
+    std::size_t hole(find_slot(it->first));
+    f_index[hole] = NO_INDEX;
+    for(std::size_t slot((hole + 1) & mask); f_index[slot] != NO_INDEX; slot = (slot + 1) & mask)
+    {
+        std::size_t const home(hash_atom(f_objects[f_index[slot]].first, mask));
+        if(((slot - home) & mask) >= ((slot - hole) & mask))
+        {
+            f_index[hole] = f_index[slot];
+            f_index[slot] = NO_INDEX;
+            hole = slot;
+        }
+    }
+
+    // move the last object in place of the removed object
+    //
+    std::size_t const last(f_objects.size() - 1);
+    if(idx != last)
+    {
+        f_index[find_slot(f_objects[last].first)] = static_cast<std::uint32_t>(idx);
+        f_objects[idx] = std::move(f_objects[last]);
+    }
+    f_objects.pop_back();
+
+    return f_objects.begin() + idx;
+}
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
@@ -0,0 +1,166 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+// self
+//
+#include    "atom.h"
+#include    "ticket_key.h"
+
+
+// C++
+//
+#include    <cstdint>
+#include    <iterator>
+#include    <memory>
+#include    <string>
+#include    <type_traits>
+#include    <vector>
+
+
+
+namespace cluck_daemon
+{
+
+
+
+class ticket;
+
+
+class ticket_map
+{
+public:
+    typedef std::shared_ptr<ticket>     pointer_t;
+
+    template<bool is_const>
+    class basic_iterator
+    {
+    public:
+        typedef std::conditional_t<is_const, pointer_t const, pointer_t>
+                                        ticket_t;
+
+        struct reference
+        {
+            ticket_key const &          first;
+            ticket_t &                  second;
+
+            reference const *           operator -> () const { return this; }
+        };
+
+        typedef std::input_iterator_tag iterator_category;
+        typedef reference               value_type;
+        typedef std::ptrdiff_t          difference_type;
+        typedef reference               pointer;
+
+                                        basic_iterator() = default;
+                                        basic_iterator(ticket_key const * key, ticket_t * t)
+                                            : f_key(key)
+                                            , f_ticket(t)
+                                        {
+                                        }
+
+                                        template<bool c = is_const, typename = std::enable_if_t<c>>
+                                        basic_iterator(basic_iterator<false> const & rhs)
+                                            : f_key(rhs.get_key())
+                                            , f_ticket(rhs.get_ticket())
+                                        {
+                                        }
+
+        reference                       operator * () const { return reference{ *f_key, *f_ticket }; }
+        reference                       operator -> () const { return reference{ *f_key, *f_ticket }; }
+        basic_iterator &                operator ++ () { ++f_key; ++f_ticket; return *this; }
+        basic_iterator                  operator ++ (int) { basic_iterator r(*this); ++*this; return r; }
+        bool                            operator == (basic_iterator const & rhs) const { return f_key == rhs.f_key; }
+        bool                            operator != (basic_iterator const & rhs) const { return f_key != rhs.f_key; }
+
+        ticket_key const *              get_key() const { return f_key; }
+        ticket_t *                      get_ticket() const { return f_ticket; }
+
+    private:
+        ticket_key const *              f_key = nullptr;
+        ticket_t *                      f_ticket = nullptr;
+    };
+
+    typedef basic_iterator<false>       iterator;
+    typedef basic_iterator<true>        const_iterator;
+
+    iterator                    begin();
+    iterator                    end();
+    const_iterator              begin() const;
+    const_iterator              end() const;
+
+    bool                        empty() const;
+    std::size_t                 size() const;
+    void                        clear();
+
+    iterator                    find(ticket_key const & key);
+    const_iterator              find(ticket_key const & key) const;
+    pointer_t &                 operator [] (ticket_key const & key);
+    iterator                    erase(iterator it);
+
+    ticket_key::ticket_id_t     get_last_ticket_number() const;
+    bool                        is_head_activated() const;
+    void                        set_head_activated(bool activated);
+
+private:
+    std::size_t                 lower_bound(ticket_key const & key) const;
+
+    std::vector<ticket_key>     f_keys = std::vector<ticket_key>();
+    std::vector<pointer_t>      f_tickets = std::vector<pointer_t>();
+    bool                        f_head_activated = false;
+};
+
+
+class ticket_store
+{
+public:
+    typedef std::pair<atom, ticket_map>             value_type;
+    typedef std::vector<value_type>::iterator       iterator;
+    typedef std::vector<value_type>::const_iterator const_iterator;
+
+    iterator                    begin();
+    iterator                    end();
+    const_iterator              begin() const;
+    const_iterator              end() const;
+
+    bool                        empty() const;
+    std::size_t                 size() const;
+    void                        clear();
+
+    iterator                    find(atom const & object_name);
+    iterator                    find(std::string const & object_name);
+    const_iterator              find(atom const & object_name) const;
+    const_iterator              find(std::string const & object_name) const;
+    ticket_map &                operator [] (atom const & object_name);
+    iterator                    erase(iterator it);
+
+private:
+    static constexpr std::uint32_t const
+                                NO_INDEX = static_cast<std::uint32_t>(-1);
+
+    std::size_t                 find_slot(atom const & object_name) const;
+    void                        grow();
+
+    std::vector<value_type>     f_objects = std::vector<value_type>();
+    std::vector<std::uint32_t>  f_index = std::vector<std::uint32_t>();
+};
+
+
+
+} // namespace cluck_daemon
+// vim: ts=4 sw=4 et
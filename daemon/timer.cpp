@@ -44,6 +44,10 @@ namespace cluck_daemon
  * called. Any lock which timed out is removed and the user on the other
  * end is told about the problem with an UNLOCKING, UNLOCKED or LOCK_FAILED
  * message as the case may be.
+ *
+ * The message handlers do not run the cleanup each time they change
+ * the tickets. Instead, they push their deadline and the timer wakes
+ * us up when the earliest one is reached (see cluckd::push_deadline()).
  */
 
 
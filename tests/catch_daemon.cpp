@@ -830,6 +830,247 @@ CATCH_TEST_CASE("cluck_daemon_specialized_tests", "[cluckd][daemon]")
     }
     CATCH_END_SECTION()
 
+    CATCH_START_SECTION("cluck_daemon_specialized_tests: verify local combining (off)")
+    {
+        addr::addr a(get_address());
+
+        std::vector<std::string> const args = {
+            "cluckd", // name of command
+            "--communicator-listen",
+            "cd://" + a.to_ipv4or6_string(addr::STRING_IP_ADDRESS_PORT),
+            "--candidate-priority",
+            "off",
+            "--local-combining",
+            "2",
+            "--path-to-message-definitions",
+
+            // WARNING: the order matters, we want to test with our source
+            //          (i.e. original) files first
+            //
+            SNAP_CATCH2_NAMESPACE::g_source_dir() + "/daemon/message-definitions:"
+                + SNAP_CATCH2_NAMESPACE::g_dist_dir() + "/share/eventdispatcher/messages",
+        };
+
+        // convert arguments
+        //
+        std::vector<char const *> args_strings;
+        args_strings.reserve(args.size() + 1);
+        for(auto const & arg : args)
+        {
+            args_strings.push_back(arg.c_str());
+        }
+        args_strings.push_back(nullptr); // NULL terminated
+
+        cluck_daemon::cluckd::pointer_t lock(std::make_shared<cluck_daemon::cluckd>(args.size(), const_cast<char **>(args_strings.data())));
+        lock->add_connections();
+
+        // no elections happened, 'lock' is not a leader
+        //
+        CATCH_REQUIRE(lock->is_leader() == nullptr);
+        CATCH_REQUIRE_THROWS_MATCHES(
+              lock->get_leader_a()
+            , cluck::logic_error
+            , Catch::Matchers::ExceptionMessage("logic_error: cluckd::get_leader_a(): only a leader can call this function."));
+        CATCH_REQUIRE_THROWS_MATCHES(
+              lock->get_leader_b()
+            , cluck::logic_error
+            , Catch::Matchers::ExceptionMessage("logic_error: cluckd::get_leader_b(): only a leader can call this function."));
+
+        // messenger is not yet connected, it's not ready
+        //
+        CATCH_REQUIRE_FALSE(lock->is_daemon_ready());
+
+        std::string const source_dir(SNAP_CATCH2_NAMESPACE::g_source_dir());
+        std::string const filename(source_dir + "/tests/rprtr/cluck_daemon_test_local_combining.rprtr");
+        SNAP_CATCH2_NAMESPACE::reporter::lexer::pointer_t l(SNAP_CATCH2_NAMESPACE::reporter::create_lexer(filename));
+        CATCH_REQUIRE(l != nullptr);
+        SNAP_CATCH2_NAMESPACE::reporter::state::pointer_t s(std::make_shared<SNAP_CATCH2_NAMESPACE::reporter::state>());
+        SNAP_CATCH2_NAMESPACE::reporter::parser::pointer_t p(std::make_shared<SNAP_CATCH2_NAMESPACE::reporter::parser>(l, s));
+        p->parse_program();
+
+        SNAP_CATCH2_NAMESPACE::reporter::executor::pointer_t e(std::make_shared<SNAP_CATCH2_NAMESPACE::reporter::executor>(s));
+        e->start();
+
+        e->set_thread_done_callback([lock]()
+            {
+                lock->stop(true);
+            });
+
+        try
+        {
+            lock->run();
+        }
+        catch(std::exception const & ex)
+        {
+            SNAP_LOG_FATAL
+                << "an exception occurred while running cluckd (3 cluckd): "
+                << ex
+                << SNAP_LOG_SEND;
+
+            libexcept::exception_base_t const * b(dynamic_cast<libexcept::exception_base_t const *>(&ex));
+            if(b != nullptr) for(auto const & line : b->get_stack_trace())
+            {
+                SNAP_LOG_FATAL
+                    << "    "
+                    << line
+                    << SNAP_LOG_SEND;
+            }
+
+            throw;
+        }
+
+        CATCH_REQUIRE(s->get_exit_code() == 0);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("cluck_daemon_specialized_tests: verify LOCK_PROGRESS")
+    {
+        addr::addr a(get_address());
+
+        std::vector<std::string> const args = {
+            "cluckd", // name of command
+            "--communicator-listen",
+            "cd://" + a.to_ipv4or6_string(addr::STRING_IP_ADDRESS_PORT),
+            "--path-to-message-definitions",
+
+            // WARNING: the order matters, we want to test with our source
+            //          (i.e. original) files first
+            //
+            SNAP_CATCH2_NAMESPACE::g_source_dir() + "/daemon/message-definitions:"
+                + SNAP_CATCH2_NAMESPACE::g_dist_dir() + "/share/eventdispatcher/messages",
+        };
+
+        // convert arguments
+        //
+        std::vector<char const *> args_strings;
+        args_strings.reserve(args.size() + 1);
+        for(auto const & arg : args)
+        {
+            args_strings.push_back(arg.c_str());
+        }
+        args_strings.push_back(nullptr); // NULL terminated
+
+        cluck_daemon::cluckd::pointer_t lock(std::make_shared<cluck_daemon::cluckd>(args.size(), const_cast<char **>(args_strings.data())));
+        lock->add_connections();
+
+        std::string const source_dir(SNAP_CATCH2_NAMESPACE::g_source_dir());
+        std::string const filename(source_dir + "/tests/rprtr/cluck_daemon_test_lock_progress.rprtr");
+        SNAP_CATCH2_NAMESPACE::reporter::lexer::pointer_t l(SNAP_CATCH2_NAMESPACE::reporter::create_lexer(filename));
+        CATCH_REQUIRE(l != nullptr);
+        SNAP_CATCH2_NAMESPACE::reporter::state::pointer_t s(std::make_shared<SNAP_CATCH2_NAMESPACE::reporter::state>());
+        SNAP_CATCH2_NAMESPACE::reporter::parser::pointer_t p(std::make_shared<SNAP_CATCH2_NAMESPACE::reporter::parser>(l, s));
+        p->parse_program();
+
+        SNAP_CATCH2_NAMESPACE::reporter::executor::pointer_t e(std::make_shared<SNAP_CATCH2_NAMESPACE::reporter::executor>(s));
+        e->start();
+
+        e->set_thread_done_callback([lock]()
+            {
+                lock->stop(true);
+            });
+
+        try
+        {
+            lock->run();
+        }
+        catch(std::exception const & ex)
+        {
+            SNAP_LOG_FATAL
+                << "an exception occurred while running cluckd (lock progress): "
+                << ex
+                << SNAP_LOG_SEND;
+
+            libexcept::exception_base_t const * b(dynamic_cast<libexcept::exception_base_t const *>(&ex));
+            if(b != nullptr) for(auto const & line : b->get_stack_trace())
+            {
+                SNAP_LOG_FATAL
+                    << "    "
+                    << line
+                    << SNAP_LOG_SEND;
+            }
+
+            throw;
+        }
+
+        CATCH_REQUIRE(s->get_exit_code() == 0);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("cluck_daemon_specialized_tests: replay the cached LOCK requests in slices")
+    {
+        addr::addr a(get_address());
+
+        std::vector<std::string> const args = {
+            "cluckd", // name of command
+            "--communicator-listen",
+            "cd://" + a.to_ipv4or6_string(addr::STRING_IP_ADDRESS_PORT),
+            "--lock-replay-rate",
+            "100",
+            "--path-to-message-definitions",
+
+            // WARNING: the order matters, we want to test with our source
+            //          (i.e. original) files first
+            //
+            SNAP_CATCH2_NAMESPACE::g_source_dir() + "/daemon/message-definitions:"
+                + SNAP_CATCH2_NAMESPACE::g_dist_dir() + "/share/eventdispatcher/messages",
+        };
+
+        // convert arguments
+        //
+        std::vector<char const *> args_strings;
+        args_strings.reserve(args.size() + 1);
+        for(auto const & arg : args)
+        {
+            args_strings.push_back(arg.c_str());
+        }
+        args_strings.push_back(nullptr); // NULL terminated
+
+        cluck_daemon::cluckd::pointer_t lock(std::make_shared<cluck_daemon::cluckd>(args.size(), const_cast<char **>(args_strings.data())));
+        lock->add_connections();
+
+        std::string const source_dir(SNAP_CATCH2_NAMESPACE::g_source_dir());
+        std::string const filename(source_dir + "/tests/rprtr/cluck_daemon_test_replay.rprtr");
+        SNAP_CATCH2_NAMESPACE::reporter::lexer::pointer_t l(SNAP_CATCH2_NAMESPACE::reporter::create_lexer(filename));
+        CATCH_REQUIRE(l != nullptr);
+        SNAP_CATCH2_NAMESPACE::reporter::state::pointer_t s(std::make_shared<SNAP_CATCH2_NAMESPACE::reporter::state>());
+        SNAP_CATCH2_NAMESPACE::reporter::parser::pointer_t p(std::make_shared<SNAP_CATCH2_NAMESPACE::reporter::parser>(l, s));
+        p->parse_program();
+
+        SNAP_CATCH2_NAMESPACE::reporter::executor::pointer_t e(std::make_shared<SNAP_CATCH2_NAMESPACE::reporter::executor>(s));
+        e->start();
+
+        e->set_thread_done_callback([lock]()
+            {
+                lock->stop(true);
+            });
+
+        try
+        {
+            lock->run();
+        }
+        catch(std::exception const & ex)
+        {
+            SNAP_LOG_FATAL
+                << "an exception occurred while running cluckd (replay): "
+                << ex
+                << SNAP_LOG_SEND;
+
+            libexcept::exception_base_t const * b(dynamic_cast<libexcept::exception_base_t const *>(&ex));
+            if(b != nullptr) for(auto const & line : b->get_stack_trace())
+            {
+                SNAP_LOG_FATAL
+                    << "    "
+                    << line
+                    << SNAP_LOG_SEND;
+            }
+
+            throw;
+        }
+
+        CATCH_REQUIRE(s->get_exit_code() == 0);
+    }
+    CATCH_END_SECTION()
+
     CATCH_START_SECTION("cluck_daemon_specialized_tests: try an interrupt to stop the cluck daemon")
     {
         addr::addr a(get_address());
@@ -1154,6 +1395,81 @@ CATCH_TEST_CASE("cluck_daemon_failures", "[cluckd][daemon][fail]")
     }
     CATCH_END_SECTION()
 
+    CATCH_START_SECTION("cluck_daemon_failures: client over its quota")
+    {
+        addr::addr a(get_address());
+
+        std::vector<std::string> const args = {
+            "cluckd", // name of command
+            "--communicator-listen",
+            "cd://" + a.to_ipv4or6_string(addr::STRING_IP_ADDRESS_PORT),
+            "--client-max-tickets",
+            "1",
+            "--path-to-message-definitions",
+
+            // WARNING: the order matters, we want to test with our source
+            //          (i.e. original) files first
+            //
+            SNAP_CATCH2_NAMESPACE::g_source_dir() + "/daemon/message-definitions:"
+                + SNAP_CATCH2_NAMESPACE::g_dist_dir() + "/share/eventdispatcher/messages",
+        };
+
+        // convert arguments
+        //
+        std::vector<char const *> args_strings;
+        args_strings.reserve(args.size() + 1);
+        for(auto const & arg : args)
+        {
+            args_strings.push_back(arg.c_str());
+        }
+        args_strings.push_back(nullptr); // NULL terminated
+
+        cluck_daemon::cluckd::pointer_t lock(std::make_shared<cluck_daemon::cluckd>(args.size(), const_cast<char **>(args_strings.data())));
+        lock->add_connections();
+
+        std::string const source_dir(SNAP_CATCH2_NAMESPACE::g_source_dir());
+        std::string const filename(source_dir + "/tests/rprtr/failed_with_quota.rprtr");
+        SNAP_CATCH2_NAMESPACE::reporter::lexer::pointer_t l(SNAP_CATCH2_NAMESPACE::reporter::create_lexer(filename));
+        CATCH_REQUIRE(l != nullptr);
+        SNAP_CATCH2_NAMESPACE::reporter::state::pointer_t s(std::make_shared<SNAP_CATCH2_NAMESPACE::reporter::state>());
+        SNAP_CATCH2_NAMESPACE::reporter::parser::pointer_t p(std::make_shared<SNAP_CATCH2_NAMESPACE::reporter::parser>(l, s));
+        p->parse_program();
+
+        SNAP_CATCH2_NAMESPACE::reporter::executor::pointer_t e(std::make_shared<SNAP_CATCH2_NAMESPACE::reporter::executor>(s));
+        e->start();
+
+        e->set_thread_done_callback([lock]()
+            {
+                lock->stop(true);
+            });
+
+        try
+        {
+            lock->run();
+        }
+        catch(std::exception const & ex)
+        {
+            SNAP_LOG_FATAL
+                << "an exception occurred while running cluckd (client over its quota): "
+                << ex
+                << SNAP_LOG_SEND;
+
+            libexcept::exception_base_t const * b(dynamic_cast<libexcept::exception_base_t const *>(&ex));
+            if(b != nullptr) for(auto const & line : b->get_stack_trace())
+            {
+                SNAP_LOG_FATAL
+                    << "    "
+                    << line
+                    << SNAP_LOG_SEND;
+            }
+
+            throw;
+        }
+
+        CATCH_REQUIRE(s->get_exit_code() == 0);
+    }
+    CATCH_END_SECTION()
+
     CATCH_START_SECTION("cluck_daemon_failures: send a DROP_TICKET to cancel an entering LOCK")
     {
         addr::addr a(get_address());
@@ -1287,7 +1603,7 @@ CATCH_TEST_CASE("cluck_daemon_errors", "[cluckd][daemon][error]")
     }
     CATCH_END_SECTION()
 
-    CATCH_START_SECTION("cluck_daemon_errors: get max ticket overflow")
+    CATCH_START_SECTION("cluck_daemon_errors: get max ticket above 32 bits")
     {
         addr::addr a(get_address());
 
@@ -1320,7 +1636,7 @@ CATCH_TEST_CASE("cluck_daemon_errors", "[cluckd][daemon][error]")
         lock->add_connections();
 
         std::string const source_dir(SNAP_CATCH2_NAMESPACE::g_source_dir());
-        std::string const filename(source_dir + "/tests/rprtr/failed_with_max_ticket_too_large.rprtr");
+        std::string const filename(source_dir + "/tests/rprtr/max_ticket_above_32_bits.rprtr");
         SNAP_CATCH2_NAMESPACE::reporter::lexer::pointer_t l(SNAP_CATCH2_NAMESPACE::reporter::create_lexer(filename));
         CATCH_REQUIRE(l != nullptr);
         SNAP_CATCH2_NAMESPACE::reporter::state::pointer_t s(std::make_shared<SNAP_CATCH2_NAMESPACE::reporter::state>());
@@ -1339,29 +1655,10 @@ CATCH_TEST_CASE("cluck_daemon_errors", "[cluckd][daemon][error]")
         {
             lock->run();
         }
-        catch(cluck::out_of_range const & ex)
-        {
-            SNAP_LOG_INFO
-                << "got the expected exception: "
-                << ex
-                << SNAP_LOG_SEND;
-
-            std::string const expected("out_of_range: ticket::max_ticket() tried to generate the next ticket and got a wrapping around number.");
-            CATCH_REQUIRE(ex.what() == expected);
-
-            // the communicator daemon may still have connections because of
-            // the exception
-            //
-            ed::connection::vector_t connections(ed::communicator::instance()->get_connections());
-            for(auto c : connections)
-            {
-                ed::communicator::instance()->remove_connection(c);
-            }
-        }
         catch(std::exception const & ex)
         {
             SNAP_LOG_FATAL
-                << "an exception occurred while running cluckd (get max ticket overflow): "
+                << "an exception occurred while running cluckd (get max ticket above 32 bits): "
                 << ex
                 << SNAP_LOG_SEND;
 
@@ -0,0 +1,177 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// self
+//
+#include    "catch_main.h"
+
+
+
+// daemon
+//
+#include    <daemon/admission_control.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace
+{
+
+
+
+cluck_daemon::message_cache::request make_request(
+      std::string const & object_name
+    , pid_t pid
+    , std::int64_t timeout)
+{
+    cluck_daemon::message_cache::request r;
+    r.f_timeout = cluck::timeout_t(timeout, 0);
+    r.f_duration = cluck::timeout_t(10, 0);
+    r.f_object_name = cluck_daemon::atom(object_name);
+    r.f_pid = pid;
+    r.f_sent_from_server = cluck_daemon::atom("alpha");
+    r.f_sent_from_service = cluck_daemon::atom("website");
+    return r;
+}
+
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("daemon_admission_control", "[cluckd][admission][daemon]")
+{
+    CATCH_START_SECTION("daemon_admission_control: fixed limit")
+    {
+        cluck_daemon::admission_control admission;
+        CATCH_REQUIRE(admission.get_limit() == cluck::CLUCK_MAXIMUM_ENTERING_LOCKS);
+        CATCH_REQUIRE(admission.get_backlog_limit() == 0);
+        CATCH_REQUIRE(admission.get_object_limit("obj") == cluck::CLUCK_MAXIMUM_ENTERING_LOCKS);
+
+        admission.set_limit(25);
+        CATCH_REQUIRE(admission.get_limit() == 25);
+        CATCH_REQUIRE(admission.get_object_limit("obj") == 25);
+
+        // without a drain rate, the hint is the default of 1 second
+        //
+        CATCH_REQUIRE(admission.get_retry_after("obj", 25) == cluck::timeout_t(1, 0));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_admission_control: adaptive limit follows the drain rate")
+    {
+        cluck_daemon::admission_control admission;
+        admission.set_limit(cluck_daemon::admission_control::ADAPTIVE_LIMIT);
+        CATCH_REQUIRE(admission.get_object_limit("fast") == cluck::CLUCK_MAXIMUM_ENTERING_LOCKS);
+
+        // 500 tickets admitted and drained per second
+        //
+        std::size_t entering(0);
+        for(std::int64_t ms(0); ms <= 2'000; ms += 10)
+        {
+            admission.observe("fast", entering, cluck::timeout_t(100 + ms / 1'000, ms % 1'000 * 1'000'000));
+            for(int idx(0); idx < 5; ++idx)
+            {
+                admission.admitted("fast");
+            }
+            entering = 5;
+        }
+        CATCH_REQUIRE(admission.get_drain_rate("fast") > 450.0);
+        CATCH_REQUIRE(admission.get_drain_rate("fast") < 550.0);
+        CATCH_REQUIRE(admission.get_object_limit("fast") >= 450);
+        CATCH_REQUIRE(admission.get_object_limit("fast") <= 550);
+
+        // 1 ticket drained per second gives the minimum
+        //
+        for(std::int64_t s(0); s <= 5; ++s)
+        {
+            admission.observe("slow", 3, cluck::timeout_t(100 + s, 0));
+            admission.admitted("slow");
+        }
+        CATCH_REQUIRE(admission.get_drain_rate("slow") > 0.9);
+        CATCH_REQUIRE(admission.get_object_limit("slow") == cluck_daemon::admission_control::MINIMUM_ADAPTIVE_LIMIT);
+
+        // 20 tickets over the limit at 1 per second is 10 seconds
+        //
+        CATCH_REQUIRE(admission.get_retry_after("slow", 29) == cluck::timeout_t(10, 0));
+        CATCH_REQUIRE(admission.get_retry_after("slow", 10) == cluck::timeout_t(1, 0));
+        CATCH_REQUIRE(admission.get_retry_after("fast", 2'000) > cluck::timeout_t(2, 0));
+        CATCH_REQUIRE(admission.get_retry_after("fast", 2'000) < cluck::timeout_t(4, 0));
+        CATCH_REQUIRE(admission.get_retry_after("fast", 0) == cluck::timeout_t(0, 10'000'000));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_admission_control: backlog")
+    {
+        cluck_daemon::admission_control admission;
+        CATCH_REQUIRE_FALSE(admission.add_to_backlog(make_request("obj", 1, 100)));
+        CATCH_REQUIRE_FALSE(admission.has_backlog("obj"));
+        CATCH_REQUIRE(admission.get_next_timeout() == snapdev::timespec_ex::max());
+
+        admission.set_backlog_limit(2);
+        CATCH_REQUIRE(admission.get_backlog_limit() == 2);
+        CATCH_REQUIRE(admission.add_to_backlog(make_request("obj", 1, 300)));
+        CATCH_REQUIRE(admission.add_to_backlog(make_request("obj", 2, 200)));
+        CATCH_REQUIRE_FALSE(admission.add_to_backlog(make_request("obj", 3, 100)));
+        CATCH_REQUIRE(admission.add_to_backlog(make_request("other", 4, 150)));
+        CATCH_REQUIRE(admission.has_backlog("obj"));
+        CATCH_REQUIRE(admission.get_next_timeout() == cluck::timeout_t(150, 0));
+        CATCH_REQUIRE(admission.get_backlogged_objects().size() == 2);
+
+        cluck_daemon::message_cache::request r;
+        CATCH_REQUIRE_FALSE(admission.pop_timed_out("obj", cluck::timeout_t(199, 0), r));
+        CATCH_REQUIRE(admission.pop_timed_out("other", cluck::timeout_t(199, 0), r));
+        CATCH_REQUIRE(r.f_pid == 4);
+        CATCH_REQUIRE_FALSE(admission.has_backlog("other"));
+
+        CATCH_REQUIRE(admission.pop_backlog("obj", r));
+        CATCH_REQUIRE(r.f_pid == 2);
+        CATCH_REQUIRE(admission.pop_backlog("obj", r));
+        CATCH_REQUIRE(r.f_pid == 1);
+        CATCH_REQUIRE_FALSE(admission.pop_backlog("obj", r));
+        CATCH_REQUIRE_FALSE(admission.pop_backlog("unknown", r));
+        CATCH_REQUIRE(admission.get_backlogged_objects().empty());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_admission_control: idle objects are pruned")
+    {
+        cluck_daemon::admission_control admission;
+        admission.set_limit(cluck_daemon::admission_control::ADAPTIVE_LIMIT);
+        admission.observe("obj", 0, cluck::timeout_t(100, 0));
+        admission.admitted("obj");
+        admission.observe("obj", 0, cluck::timeout_t(101, 0));
+        CATCH_REQUIRE(admission.get_drain_rate("obj") == 1.0);
+
+        admission.prune(cluck::timeout_t(150, 0));
+        CATCH_REQUIRE(admission.get_drain_rate("obj") == 1.0);
+
+        admission.prune(cluck::timeout_t(161, 0));
+        CATCH_REQUIRE(admission.get_drain_rate("obj") == 0.0);
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
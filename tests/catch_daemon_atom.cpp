@@ -0,0 +1,127 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// self
+//
+#include    "catch_main.h"
+
+
+
+// daemon
+//
+#include    <daemon/atom.h>
+
+
+// C++
+//
+#include    <map>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+CATCH_TEST_CASE("daemon_atom", "[cluckd][atom][daemon]")
+{
+    CATCH_START_SECTION("daemon_atom: empty atom")
+    {
+        std::size_t const count(cluck_daemon::atom::interned_count());
+
+        cluck_daemon::atom a;
+        CATCH_REQUIRE(a.empty());
+        CATCH_REQUIRE(a.id() == 0);
+        CATCH_REQUIRE(a.str() == std::string());
+
+        cluck_daemon::atom b(std::string{});
+        CATCH_REQUIRE(b.empty());
+        CATCH_REQUIRE(a == b);
+
+        CATCH_REQUIRE(cluck_daemon::atom::interned_count() == count);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_atom: strings are shared")
+    {
+        std::size_t const count(cluck_daemon::atom::interned_count());
+
+        {
+            cluck_daemon::atom a("lock_object");
+            cluck_daemon::atom b(std::string("lock_object"));
+            cluck_daemon::atom c("other_object");
+
+            CATCH_REQUIRE_FALSE(a.empty());
+            CATCH_REQUIRE(a == b);
+            CATCH_REQUIRE(a.id() == b.id());
+            CATCH_REQUIRE(&a.str() == &b.str());
+            CATCH_REQUIRE_FALSE(a == c);
+            CATCH_REQUIRE(a == std::string("lock_object"));
+            CATCH_REQUIRE(a == "lock_object");
+            CATCH_REQUIRE(cluck_daemon::atom::interned_count() == count + 2);
+
+            cluck_daemon::atom d(a);
+            CATCH_REQUIRE(d == a);
+            cluck_daemon::atom e(std::move(d));
+            CATCH_REQUIRE(e == a);
+            CATCH_REQUIRE(d.empty());
+
+            b = c;
+            CATCH_REQUIRE(b == c);
+            CATCH_REQUIRE(cluck_daemon::atom::interned_count() == count + 2);
+
+            // once the last reference is gone, the string is released
+            //
+            a = cluck_daemon::atom();
+            e = cluck_daemon::atom();
+            CATCH_REQUIRE(cluck_daemon::atom::interned_count() == count + 1);
+        }
+
+        CATCH_REQUIRE(cluck_daemon::atom::interned_count() == count);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_atom: sorted map keyed by atoms")
+    {
+        std::map<cluck_daemon::atom, int, cluck_daemon::atom_less> objects;
+        objects[std::string("zebra")] = 3;
+        objects[std::string("apple")] = 1;
+        objects[std::string("mango")] = 2;
+
+        // atoms sort like their strings
+        //
+        int expected(1);
+        for(auto const & o : objects)
+        {
+            CATCH_REQUIRE(o.second == expected);
+            ++expected;
+        }
+
+        // a plain string can be used to search the map
+        //
+        auto const it(objects.find(std::string("mango")));
+        CATCH_REQUIRE(it != objects.end());
+        CATCH_REQUIRE(it->second == 2);
+        CATCH_REQUIRE(objects.find(std::string("pear")) == objects.end());
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
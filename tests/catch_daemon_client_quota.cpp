@@ -0,0 +1,167 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// self
+//
+#include    "catch_main.h"
+
+
+
+// daemon
+//
+#include    <daemon/client_quota.h>
+
+
+// C++
+//
+#include    <vector>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+CATCH_TEST_CASE("daemon_client_quota", "[cluckd][quota][daemon]")
+{
+    CATCH_START_SECTION("daemon_client_quota: no limits by default")
+    {
+        cluck_daemon::client_quota quota;
+        CATCH_REQUIRE(quota.get_max_tickets() == 0);
+        CATCH_REQUIRE(quota.get_rate() == 0);
+
+        std::vector<cluck_daemon::client_quota::reservation> reservations;
+        cluck::timeout_t retry_after;
+        for(int idx(0); idx < 1'000; ++idx)
+        {
+            CATCH_REQUIRE(quota.check("alpha", "website", cluck::timeout_t(100, 0), true, retry_after)
+                                == cluck_daemon::client_quota::result_t::QUOTA_ACCEPTED);
+            reservations.push_back(quota.reserve("alpha", "website"));
+        }
+        CATCH_REQUIRE(retry_after == cluck::timeout_t());
+
+        std::vector<cluck_daemon::client_quota::usage> const usage(quota.get_usage());
+        CATCH_REQUIRE(usage.size() == 1);
+        CATCH_REQUIRE(usage[0].f_server_name == "alpha");
+        CATCH_REQUIRE(usage[0].f_service_name == "website");
+        CATCH_REQUIRE(usage[0].f_tickets == 1'000);
+        CATCH_REQUIRE(usage[0].f_requests == 1'000);
+        CATCH_REQUIRE(usage[0].f_rejected == 0);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_client_quota: tickets are limited per client")
+    {
+        cluck_daemon::client_quota quota;
+        quota.set_max_tickets(2);
+        CATCH_REQUIRE(quota.get_max_tickets() == 2);
+
+        cluck::timeout_t retry_after;
+        cluck::timeout_t const now(100, 0);
+        cluck_daemon::client_quota::reservation r1(quota.reserve("alpha", "website"));
+        cluck_daemon::client_quota::reservation r2(quota.reserve("alpha", "website"));
+        CATCH_REQUIRE(quota.check("alpha", "website", now, true, retry_after)
+                            == cluck_daemon::client_quota::result_t::QUOTA_TICKETS);
+
+        // other clients are not affected
+        //
+        CATCH_REQUIRE(quota.check("alpha", "backend", now, true, retry_after)
+                            == cluck_daemon::client_quota::result_t::QUOTA_ACCEPTED);
+        CATCH_REQUIRE(quota.check("beta", "website", now, true, retry_after)
+                            == cluck_daemon::client_quota::result_t::QUOTA_ACCEPTED);
+
+        // moving a reservation does not release it, destroying it does
+        //
+        cluck_daemon::client_quota::reservation moved(std::move(r1));
+        CATCH_REQUIRE(quota.check("alpha", "website", now, true, retry_after)
+                            == cluck_daemon::client_quota::result_t::QUOTA_TICKETS);
+        moved = cluck_daemon::client_quota::reservation();
+        CATCH_REQUIRE(quota.check("alpha", "website", now, true, retry_after)
+                            == cluck_daemon::client_quota::result_t::QUOTA_ACCEPTED);
+
+        for(auto const & u : quota.get_usage())
+        {
+            if(u.f_server_name == "alpha"
+            && u.f_service_name == "website")
+            {
+                CATCH_REQUIRE(u.f_tickets == 1);
+                CATCH_REQUIRE(u.f_requests == 3);
+                CATCH_REQUIRE(u.f_rejected == 2);
+            }
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_client_quota: LOCK rate uses a token bucket")
+    {
+        cluck_daemon::client_quota quota;
+        quota.set_rate(10);
+        CATCH_REQUIRE(quota.get_rate() == 10);
+
+        // a burst of one second worth of requests is accepted
+        //
+        cluck::timeout_t retry_after;
+        for(int idx(0); idx < 10; ++idx)
+        {
+            CATCH_REQUIRE(quota.check("alpha", "website", cluck::timeout_t(100, 0), true, retry_after)
+                                == cluck_daemon::client_quota::result_t::QUOTA_ACCEPTED);
+        }
+        CATCH_REQUIRE(quota.check("alpha", "website", cluck::timeout_t(100, 0), true, retry_after)
+                            == cluck_daemon::client_quota::result_t::QUOTA_RATE);
+        CATCH_REQUIRE(retry_after > cluck::timeout_t(0, 99'000'000));
+        CATCH_REQUIRE(retry_after < cluck::timeout_t(0, 101'000'000));
+
+        // requests which were already counted are not refused
+        //
+        CATCH_REQUIRE(quota.check("alpha", "website", cluck::timeout_t(100, 0), false, retry_after)
+                            == cluck_daemon::client_quota::result_t::QUOTA_ACCEPTED);
+
+        // after 0.1 second, one more token is available
+        //
+        CATCH_REQUIRE(quota.check("alpha", "website", cluck::timeout_t(100, 100'000'000), true, retry_after)
+                            == cluck_daemon::client_quota::result_t::QUOTA_ACCEPTED);
+        CATCH_REQUIRE(quota.check("alpha", "website", cluck::timeout_t(100, 100'000'000), true, retry_after)
+                            == cluck_daemon::client_quota::result_t::QUOTA_RATE);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_client_quota: idle clients are pruned")
+    {
+        cluck_daemon::client_quota quota;
+        cluck::timeout_t retry_after;
+        quota.check("alpha", "website", cluck::timeout_t(100, 0), true, retry_after);
+        quota.check("beta", "website", cluck::timeout_t(100, 0), true, retry_after);
+        cluck_daemon::client_quota::reservation r(quota.reserve("beta", "website"));
+        CATCH_REQUIRE(quota.get_usage().size() == 2);
+
+        quota.prune(cluck::timeout_t(130, 0));
+        CATCH_REQUIRE(quota.get_usage().size() == 2);
+
+        // only the client without tickets is removed
+        //
+        quota.prune(cluck::timeout_t(200, 0));
+        CATCH_REQUIRE(quota.get_usage().size() == 1);
+        CATCH_REQUIRE(quota.get_usage()[0].f_server_name == "beta");
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -0,0 +1,217 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// self
+//
+#include    "catch_main.h"
+
+
+
+// daemon
+//
+#include    <daemon/command_table.h>
+
+
+// cluck
+//
+#include    <cluck/names.h>
+
+
+// snaplogger
+//
+#include    <snaplogger/message.h>
+
+
+// C++
+//
+#include    <chrono>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace
+{
+
+
+
+// the commands as the dispatcher sees them: one match per command,
+// compared one after the other
+//
+std::vector<std::string> const g_dispatcher_commands =
+{
+    cluck::g_name_cluck_cmd_activate_lock,
+    cluck::g_name_cluck_cmd_add_ticket,
+    cluck::g_name_cluck_cmd_batch,
+    cluck::g_name_cluck_cmd_drop_ticket,
+    cluck::g_name_cluck_cmd_get_max_ticket,
+    cluck::g_name_cluck_cmd_info,
+    cluck::g_name_cluck_cmd_list_tickets,
+    cluck::g_name_cluck_cmd_lock,
+    cluck::g_name_cluck_cmd_lock_activated,
+    cluck::g_name_cluck_cmd_lock_entered,
+    cluck::g_name_cluck_cmd_lock_entering,
+    cluck::g_name_cluck_cmd_lock_exiting,
+    cluck::g_name_cluck_cmd_lock_failed,
+    cluck::g_name_cluck_cmd_lock_leaders,
+    cluck::g_name_cluck_cmd_lock_progress,
+    cluck::g_name_cluck_cmd_lock_started,
+    cluck::g_name_cluck_cmd_lock_status,
+    cluck::g_name_cluck_cmd_lock_tickets,
+    cluck::g_name_cluck_cmd_locked,
+    cluck::g_name_cluck_cmd_max_ticket,
+    cluck::g_name_cluck_cmd_ticket_added,
+    cluck::g_name_cluck_cmd_ticket_ready,
+    cluck::g_name_cluck_cmd_unlock,
+    cluck::g_name_cluck_cmd_unlocked,
+    cluck::g_name_cluck_cmd_unlocking,
+};
+
+
+std::size_t linear_search(std::string const & command)
+{
+    for(std::size_t idx(0); idx < g_dispatcher_commands.size(); ++idx)
+    {
+        if(g_dispatcher_commands[idx] == command)
+        {
+            return idx + 1;
+        }
+    }
+    return 0;
+}
+
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("daemon_command_table", "[cluckd][command][daemon]")
+{
+    CATCH_START_SECTION("daemon_command_table: each cluck command is found")
+    {
+        // the table is sorted like the enumeration so the position in
+        // the list of names must match the command
+        //
+        for(std::size_t idx(0); idx < g_dispatcher_commands.size(); ++idx)
+        {
+            CATCH_REQUIRE(static_cast<std::size_t>(cluck_daemon::find_cluck_command(g_dispatcher_commands[idx])) == idx + 1);
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_command_table: other commands are not found")
+    {
+        char const * other_commands[] = {
+            "",
+            "ABSOLUTELY",
+            "CLOCK_STABLE",
+            "CLUSTER_UP",
+            "HANGUP",
+            "LOCK_",
+            "LOCKS",
+            "READY",
+            "STATUS",
+            "STOP",
+            "UNLOCKED_",
+            "lock",
+        };
+        for(auto const & c : other_commands)
+        {
+            CATCH_REQUIRE(cluck_daemon::find_cluck_command(c) == cluck_daemon::cluck_command_t::CLUCK_COMMAND_UNKNOWN);
+        }
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("daemon_command_table_benchmark", "[cluckd][command][daemon][benchmark][.]")
+{
+    CATCH_START_SECTION("daemon_command_table_benchmark: linear search against perfect hash")
+    {
+        // a mix of the inter-leader messages (the most common) and
+        // a few commands which are not cluck commands
+        //
+        std::vector<std::string> const commands = {
+            cluck::g_name_cluck_cmd_lock_entering,
+            cluck::g_name_cluck_cmd_lock_entered,
+            cluck::g_name_cluck_cmd_get_max_ticket,
+            cluck::g_name_cluck_cmd_max_ticket,
+            cluck::g_name_cluck_cmd_add_ticket,
+            cluck::g_name_cluck_cmd_ticket_added,
+            cluck::g_name_cluck_cmd_lock_exiting,
+            cluck::g_name_cluck_cmd_ticket_ready,
+            cluck::g_name_cluck_cmd_activate_lock,
+            cluck::g_name_cluck_cmd_lock_activated,
+            cluck::g_name_cluck_cmd_unlock,
+            cluck::g_name_cluck_cmd_unlocked,
+            cluck::g_name_cluck_cmd_drop_ticket,
+            "STATUS",
+            "READY",
+        };
+
+        constexpr std::size_t const REPEAT = 200'000;
+
+        std::size_t linear_found(0);
+        auto const linear_start(std::chrono::steady_clock::now());
+        for(std::size_t r(0); r < REPEAT; ++r)
+        {
+            for(auto const & c : commands)
+            {
+                linear_found += linear_search(c);
+            }
+        }
+        auto const linear_duration(std::chrono::steady_clock::now() - linear_start);
+
+        std::size_t hash_found(0);
+        auto const hash_start(std::chrono::steady_clock::now());
+        for(std::size_t r(0); r < REPEAT; ++r)
+        {
+            for(auto const & c : commands)
+            {
+                hash_found += static_cast<std::size_t>(cluck_daemon::find_cluck_command(c));
+            }
+        }
+        auto const hash_duration(std::chrono::steady_clock::now() - hash_start);
+
+        // both searches must find the same commands
+        //
+        CATCH_REQUIRE(linear_found == hash_found);
+
+        double const count(static_cast<double>(REPEAT * commands.size()));
+        double const linear_ns(std::chrono::duration<double, std::nano>(linear_duration).count() / count);
+        double const hash_ns(std::chrono::duration<double, std::nano>(hash_duration).count() / count);
+        SNAP_LOG_INFO
+            << "dispatch micro-benchmark: linear search "
+            << linear_ns
+            << "ns/command, perfect hash "
+            << hash_ns
+            << "ns/command ("
+            << (hash_ns > 0.0 ? linear_ns / hash_ns : 0.0)
+            << "x)"
+            << SNAP_LOG_SEND;
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -109,6 +109,8 @@ CATCH_TEST_CASE("daemon_computer", "[cluckd][computer][daemon]")
         CATCH_REQUIRE(c.get_start_time() == snapdev::timespec_ex());
         CATCH_REQUIRE(c.get_name() == std::string());
         CATCH_REQUIRE(c.get_ip_address() == addr::addr());
+        CATCH_REQUIRE(c.get_leader_index() == 0);
+        CATCH_REQUIRE(c.get_leader_group() == 0);
 
         // without a priority, this one fails
         //
@@ -198,6 +200,77 @@ CATCH_TEST_CASE("daemon_computer", "[cluckd][computer][daemon]")
         }
     }
     CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_computer: leader index and group")
+    {
+        cluck_daemon::computer c;
+
+        for(std::size_t idx(0); idx < 30; ++idx)
+        {
+            c.set_leader_index(idx);
+            CATCH_REQUIRE(c.get_leader_index() == idx);
+            CATCH_REQUIRE(c.get_leader_group() == idx / 3);
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_computer: round trip time")
+    {
+        cluck_daemon::computer c;
+
+        snapdev::timespec_ex now(1000, 0);
+        CATCH_REQUIRE(c.get_rtt(now) == cluck_daemon::computer::RTT_UNKNOWN);
+
+        // a reply without a ping is ignored
+        //
+        c.rtt_pong(c.get_rtt_sequence(), now);
+        CATCH_REQUIRE(c.get_rtt(now) == cluck_daemon::computer::RTT_UNKNOWN);
+
+        // first sample is used as is
+        //
+        CATCH_REQUIRE(c.rtt_ping(now));
+        CATCH_REQUIRE_FALSE(c.rtt_ping(now));
+        c.rtt_pong(c.get_rtt_sequence(), now + snapdev::timespec_ex(0, 800'000));
+        CATCH_REQUIRE(c.get_rtt(now) == 800);
+        CATCH_REQUIRE(c.get_smoothed_rtt() == 800);
+
+        // too soon for another ping
+        //
+        CATCH_REQUIRE_FALSE(c.rtt_ping(now + snapdev::timespec_ex(4, 0)));
+
+        // next samples are averaged
+        //
+        now += snapdev::timespec_ex(5, 0);
+        CATCH_REQUIRE(c.rtt_ping(now));
+        c.rtt_pong(c.get_rtt_sequence(), now + snapdev::timespec_ex(0, 1'600'000));
+        CATCH_REQUIRE(c.get_rtt(now) == 800 + (1'600 - 800) / 8);
+
+        // a pending ping which takes too long is reported as is
+        //
+        now += snapdev::timespec_ex(5, 0);
+        CATCH_REQUIRE(c.rtt_ping(now));
+        CATCH_REQUIRE(c.get_rtt(now) == 900);
+        CATCH_REQUIRE(c.get_rtt(now + snapdev::timespec_ex(2, 0)) == 2'000'000);
+        CATCH_REQUIRE(c.get_smoothed_rtt() == 900);
+
+        // that ping never gets a reply; the next ping is measured from
+        // its own date and a late reply to the lost ping is ignored
+        //
+        std::uint32_t const lost(c.get_rtt_sequence());
+        now += snapdev::timespec_ex(5, 0);
+        CATCH_REQUIRE(c.rtt_ping(now));
+        CATCH_REQUIRE(c.get_rtt_sequence() != lost);
+        c.rtt_pong(lost, now + snapdev::timespec_ex(0, 100'000));
+        CATCH_REQUIRE(c.get_smoothed_rtt() == 900);
+        c.rtt_pong(c.get_rtt_sequence(), now + snapdev::timespec_ex(0, 1'700'000));
+        CATCH_REQUIRE(c.get_smoothed_rtt() == 900 + (1'700 - 900) / 8);
+
+        // a duplicate reply is ignored
+        //
+        c.rtt_pong(c.get_rtt_sequence(), now + snapdev::timespec_ex(0, 9'000'000));
+        CATCH_REQUIRE(c.get_smoothed_rtt() == 1'000);
+    }
+    CATCH_END_SECTION()
 }
 
 
@@ -0,0 +1,183 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// self
+//
+#include    "catch_main.h"
+
+
+
+// daemon
+//
+#include    <daemon/leader_groups.h>
+
+
+// C++
+//
+#include    <algorithm>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace
+{
+
+
+
+cluck_daemon::computer::vector_t create_leaders(std::size_t count)
+{
+    cluck_daemon::computer::vector_t leaders;
+    for(std::size_t idx(0); idx < count; ++idx)
+    {
+        cluck_daemon::computer::pointer_t c(std::make_shared<cluck_daemon::computer>());
+        c->set_leader_index(idx);
+        leaders.push_back(c);
+    }
+    return leaders;
+}
+
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("daemon_leader_groups", "[cluckd][leader][daemon]")
+{
+    CATCH_START_SECTION("daemon_leader_groups: FNV-1a reference values")
+    {
+        CATCH_REQUIRE(cluck_daemon::hash_object_name("") == 0xcbf29ce484222325ULL);
+        CATCH_REQUIRE(cluck_daemon::hash_object_name("a") == 0xaf63dc4c8601ec8cULL);
+        CATCH_REQUIRE(cluck_daemon::hash_object_name("foobar") == 0x85944171f73967e8ULL);
+
+        // chaining strings is the same as hashing the concatenation
+        //
+        CATCH_REQUIRE(cluck_daemon::hash_object_name("bar", cluck_daemon::hash_object_name("foo"))
+                            == cluck_daemon::hash_object_name("foobar"));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_leader_groups: jump consistent hash reference values")
+    {
+        CATCH_REQUIRE(cluck_daemon::jump_consistent_hash(1, 1) == 0);
+        CATCH_REQUIRE(cluck_daemon::jump_consistent_hash(42, 57) == 43);
+        CATCH_REQUIRE(cluck_daemon::jump_consistent_hash(0xDEAD10CC, 1) == 0);
+        CATCH_REQUIRE(cluck_daemon::jump_consistent_hash(0xDEAD10CC, 666) == 361);
+        CATCH_REQUIRE(cluck_daemon::jump_consistent_hash(256, 1024) == 520);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_leader_groups: object to group mapping is stable")
+    {
+        // all the cluck daemons must compute the same groups, whatever
+        // the version, so these values must never change
+        //
+        CATCH_REQUIRE(cluck_daemon::get_object_group("lock1", 1) == 0);
+        CATCH_REQUIRE(cluck_daemon::get_object_group("lock1", 3) == 1);
+        CATCH_REQUIRE(cluck_daemon::get_object_group("early_lock", 5) == 4);
+        CATCH_REQUIRE(cluck_daemon::get_object_group("big_lock", 2) == 1);
+
+        // adding a group only moves objects to that new group and about
+        // 1 / (groups + 1) of them
+        //
+        for(std::size_t groups(1); groups < 10; ++groups)
+        {
+            std::size_t moved(0);
+            for(std::size_t idx(0); idx < 10'000; ++idx)
+            {
+                std::string const object_name("object_" + std::to_string(idx));
+                std::size_t const before(cluck_daemon::get_object_group(object_name, groups));
+                std::size_t const after(cluck_daemon::get_object_group(object_name, groups + 1));
+                CATCH_REQUIRE(before < groups);
+                CATCH_REQUIRE(after < groups + 1);
+                if(before != after)
+                {
+                    CATCH_REQUIRE(after == groups);
+                    ++moved;
+                }
+            }
+            std::size_t const expected(10'000 / (groups + 1));
+            CATCH_REQUIRE(moved > expected * 8 / 10);
+            CATCH_REQUIRE(moved < expected * 12 / 10);
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_leader_groups: leader<n> belongs to group n / 3")
+    {
+        cluck_daemon::computer::vector_t const leaders(create_leaders(9));
+
+        // with one group, all the leaders are members
+        //
+        CATCH_REQUIRE(cluck_daemon::get_group_members(leaders, 1, 0) == leaders);
+
+        for(std::size_t group(0); group < 3; ++group)
+        {
+            cluck_daemon::computer::vector_t const members(cluck_daemon::get_group_members(leaders, 3, group));
+            CATCH_REQUIRE(members.size() == 3);
+            for(std::size_t idx(0); idx < 3; ++idx)
+            {
+                CATCH_REQUIRE(members[idx] == leaders[group * 3 + idx]);
+            }
+        }
+        CATCH_REQUIRE(cluck_daemon::get_group_members(leaders, 3, 3).empty());
+
+        // a lost leader leaves a hole in its group only
+        //
+        cluck_daemon::computer::vector_t lost(leaders);
+        lost.erase(lost.begin() + 4);
+        cluck_daemon::computer::vector_t const group1(cluck_daemon::get_group_members(lost, 3, 1));
+        CATCH_REQUIRE(group1.size() == 2);
+        CATCH_REQUIRE(group1[0] == leaders[3]);
+        CATCH_REQUIRE(group1[1] == leaders[5]);
+        CATCH_REQUIRE(cluck_daemon::get_group_members(lost, 3, 0).size() == 3);
+        CATCH_REQUIRE(cluck_daemon::get_group_members(lost, 3, 2).size() == 3);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_leader_groups: each object has exactly one group of leaders")
+    {
+        cluck_daemon::computer::vector_t const leaders(create_leaders(9));
+
+        for(std::size_t idx(0); idx < 100; ++idx)
+        {
+            std::string const object_name("object_" + std::to_string(idx));
+            std::size_t const group(cluck_daemon::get_object_group(object_name, 3));
+            cluck_daemon::computer::vector_t const members(cluck_daemon::get_group_members(leaders, 3, group));
+            CATCH_REQUIRE(members.size() == 3);
+
+            // a leader handles the object (see cluckd::is_object_leader())
+            // only if it is a member of that group
+            //
+            for(auto const & l : leaders)
+            {
+                bool const is_member(std::find(members.begin(), members.end(), l) != members.end());
+                CATCH_REQUIRE(is_member == (l->get_leader_group() == group));
+            }
+        }
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -0,0 +1,154 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// self
+//
+#include    "catch_main.h"
+
+
+
+// daemon
+//
+#include    <daemon/leader_connection.h>
+#include    <daemon/leader_groups.h>
+
+
+// libaddr
+//
+#include    <libaddr/addr_parser.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace
+{
+
+
+
+cluck_daemon::computer::pointer_t create_leader(
+      std::string const & name
+    , std::string const & ip)
+{
+    cluck_daemon::computer::pointer_t c(std::make_shared<cluck_daemon::computer>());
+    CATCH_REQUIRE(c->set_id("01|123|" + ip + "|55|" + name));
+    return c;
+}
+
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("daemon_leader_mesh", "[cluckd][leader][daemon]")
+{
+    CATCH_START_SECTION("daemon_leader_mesh: find the leader of a peer address")
+    {
+        cluck_daemon::computer::priority_t const priority(cluck_daemon::computer::PRIORITY_USER_MIN);
+        cluck_daemon::computer::vector_t leaders{
+            std::make_shared<cluck_daemon::computer>(
+                      "node1"
+                    , priority
+                    , addr::string_to_addr("10.0.0.1"))
+            , create_leader("node2", "10.0.0.2")
+            , create_leader("node3", "10.0.0.3")
+        };
+        CATCH_REQUIRE(leaders[0]->is_self());
+
+        // the port of the peer is ephemeral so it is ignored
+        //
+        CATCH_REQUIRE(cluck_daemon::find_leader_by_address(leaders, addr::string_to_addr("10.0.0.2:40001")) == leaders[1]);
+        CATCH_REQUIRE(cluck_daemon::find_leader_by_address(leaders, addr::string_to_addr("10.0.0.3:40002")) == leaders[2]);
+        CATCH_REQUIRE(cluck_daemon::find_leader_by_address(leaders, addr::string_to_addr("10.0.0.3")) == leaders[2]);
+
+        // we do not connect to ourselves
+        //
+        CATCH_REQUIRE(cluck_daemon::find_leader_by_address(leaders, addr::string_to_addr("10.0.0.1:40003")) == nullptr);
+
+        // not a leader
+        //
+        CATCH_REQUIRE(cluck_daemon::find_leader_by_address(leaders, addr::string_to_addr("10.0.0.4:40004")) == nullptr);
+        CATCH_REQUIRE(cluck_daemon::find_leader_by_address(cluck_daemon::computer::vector_t(), addr::string_to_addr("10.0.0.2:40001")) == nullptr);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_leader_mesh: a demoted leader is not found anymore")
+    {
+        cluck_daemon::computer::vector_t const before{
+            create_leader("node2", "10.0.0.2")
+            , create_leader("node3", "10.0.0.3")
+        };
+        addr::addr const peer(addr::string_to_addr("10.0.0.3:40002"));
+        CATCH_REQUIRE(cluck_daemon::find_leader_by_address(before, peer) == before[1]);
+
+        // after the election, node3 is replaced by node4
+        //
+        cluck_daemon::computer::vector_t const after{
+            before[0]
+            , create_leader("node4", "10.0.0.4")
+        };
+        CATCH_REQUIRE(cluck_daemon::find_leader_by_address(after, peer) == nullptr);
+        CATCH_REQUIRE(cluck_daemon::find_leader_by_address(after, addr::string_to_addr("10.0.0.4:40005")) == after[1]);
+
+        // node3 becomes a leader of another group
+        //
+        cluck_daemon::computer::vector_t leaders{
+            create_leader("node5", "10.0.0.5")
+            , create_leader("node6", "10.0.0.6")
+            , create_leader("node7", "10.0.0.7")
+            , before[1]
+        };
+        for(std::size_t idx(0); idx < leaders.size(); ++idx)
+        {
+            leaders[idx]->set_leader_index(idx);
+        }
+        CATCH_REQUIRE(cluck_daemon::find_leader_by_address(cluck_daemon::get_group_members(leaders, 2, 0), peer) == nullptr);
+        CATCH_REQUIRE(cluck_daemon::find_leader_by_address(cluck_daemon::get_group_members(leaders, 2, 1), peer) == before[1]);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_leader_mesh: a new connection is used after a delay")
+    {
+        snapdev::timespec_ex const connected(1'700'000'000, 0);
+
+        // never connected
+        //
+        CATCH_REQUIRE_FALSE(cluck_daemon::leader_connection::is_switch_delay_over(snapdev::timespec_ex(), connected));
+
+        // the messages sent through the communicator daemons may still be
+        // on their way for one second
+        //
+        CATCH_REQUIRE_FALSE(cluck_daemon::leader_connection::is_switch_delay_over(connected, connected));
+        CATCH_REQUIRE_FALSE(cluck_daemon::leader_connection::is_switch_delay_over(connected, connected + snapdev::timespec_ex(0, 999'999'999)));
+        CATCH_REQUIRE(cluck_daemon::leader_connection::is_switch_delay_over(connected, connected + snapdev::timespec_ex(1, 0)));
+        CATCH_REQUIRE(cluck_daemon::leader_connection::is_switch_delay_over(connected, connected + snapdev::timespec_ex(60, 0)));
+
+        // the clock went back
+        //
+        CATCH_REQUIRE_FALSE(cluck_daemon::leader_connection::is_switch_delay_over(connected, connected - snapdev::timespec_ex(5, 0)));
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -0,0 +1,149 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// self
+//
+#include    "catch_main.h"
+
+
+
+// daemon
+//
+#include    <daemon/local_forwards.h>
+
+
+// cluck
+//
+#include    <cluck/names.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+CATCH_TEST_CASE("daemon_local_forwards", "[cluckd][local][daemon]")
+{
+    CATCH_START_SECTION("daemon_local_forwards: clients using the same tag on the same object")
+    {
+        cluck_daemon::local_forwards forwards;
+        forwards.add("local_1", 1234, "lock_name", 55);
+        forwards.add("local_2", 5678, "lock_name", 55);
+        forwards.add("local_2", 5678, "other_lock", 55);
+        CATCH_REQUIRE(forwards.size() == 3);
+
+        CATCH_REQUIRE(forwards.find(1234, "lock_name", 55) == "local_1");
+        CATCH_REQUIRE(forwards.find(5678, "lock_name", 55) == "local_2");
+        CATCH_REQUIRE(forwards.find(5678, "other_lock", 55) == "local_2");
+        CATCH_REQUIRE(forwards.find(1234, "other_lock", 55).empty());
+        CATCH_REQUIRE(forwards.find(1234, "lock_name", 56).empty());
+        CATCH_REQUIRE(forwards.find(0, "lock_name", 55).empty());
+
+        CATCH_REQUIRE(forwards.remove(1234, "lock_name", 55));
+        CATCH_REQUIRE_FALSE(forwards.remove(1234, "lock_name", 55));
+        CATCH_REQUIRE(forwards.find(1234, "lock_name", 55).empty());
+        CATCH_REQUIRE(forwards.find(5678, "lock_name", 55) == "local_2");
+        CATCH_REQUIRE(forwards.size() == 2);
+
+        forwards.clear();
+        CATCH_REQUIRE(forwards.size() == 0);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_local_forwards: a disconnected client loses all its requests")
+    {
+        cluck_daemon::local_forwards forwards;
+        forwards.add("local_1", 1234, "lock_name", 55);
+        forwards.add("local_1", 1235, "lock_name", 56);
+        forwards.add("local_2", 5678, "lock_name", 55);
+
+        forwards.remove_service("local_1");
+        CATCH_REQUIRE(forwards.size() == 1);
+        CATCH_REQUIRE(forwards.find(1234, "lock_name", 55).empty());
+        CATCH_REQUIRE(forwards.find(1235, "lock_name", 56).empty());
+        CATCH_REQUIRE(forwards.find(5678, "lock_name", 55) == "local_2");
+
+        forwards.remove_service("unknown");
+        CATCH_REQUIRE(forwards.size() == 1);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_local_forwards: the client is found from the parameters of the replies")
+    {
+        cluck_daemon::local_forwards forwards;
+        forwards.add("local_1", 1234, "lock_name", 55);
+        forwards.add("local_2", 5678, "lock_name", 55);
+
+        // LOCKED, LOCK_PROGRESS, UNLOCKING, UNLOCKED include the "pid"
+        //
+        ed::message locked;
+        locked.set_command(cluck::g_name_cluck_cmd_locked);
+        locked.add_parameter(cluck::g_name_cluck_param_object_name, "lock_name");
+        locked.add_parameter(cluck::g_name_cluck_param_tag, 55);
+        locked.add_parameter(cluck::g_name_cluck_param_pid, 5678);
+        CATCH_REQUIRE(cluck_daemon::local_forwards::get_reply_pid(locked) == 5678);
+        CATCH_REQUIRE(forwards.find(
+                  cluck_daemon::local_forwards::get_reply_pid(locked)
+                , locked.get_parameter(cluck::g_name_cluck_param_object_name)
+                , locked.get_integer_parameter(cluck::g_name_cluck_param_tag)) == "local_2");
+
+        // LOCK_FAILED includes an entering key
+        //
+        ed::message entering_failed;
+        entering_failed.set_command(cluck::g_name_cluck_cmd_lock_failed);
+        entering_failed.add_parameter(cluck::g_name_cluck_param_object_name, "lock_name");
+        entering_failed.add_parameter(cluck::g_name_cluck_param_tag, 55);
+        entering_failed.add_parameter(cluck::g_name_cluck_param_key, "rc/1234");
+        CATCH_REQUIRE(cluck_daemon::local_forwards::get_reply_pid(entering_failed) == 1234);
+        CATCH_REQUIRE(forwards.find(
+                  cluck_daemon::local_forwards::get_reply_pid(entering_failed)
+                , entering_failed.get_parameter(cluck::g_name_cluck_param_object_name)
+                , entering_failed.get_integer_parameter(cluck::g_name_cluck_param_tag)) == "local_1");
+
+        // or a ticket key
+        //
+        ed::message ticket_failed;
+        ticket_failed.set_command(cluck::g_name_cluck_cmd_lock_failed);
+        ticket_failed.add_parameter(cluck::g_name_cluck_param_key, "00000003/rc/5678");
+        CATCH_REQUIRE(cluck_daemon::local_forwards::get_reply_pid(ticket_failed) == 5678);
+
+        // the "pid" has priority over the "key"
+        //
+        ticket_failed.add_parameter(cluck::g_name_cluck_param_pid, 1234);
+        CATCH_REQUIRE(cluck_daemon::local_forwards::get_reply_pid(ticket_failed) == 1234);
+
+        // no identifier
+        //
+        ed::message unknown;
+        unknown.set_command(cluck::g_name_cluck_cmd_unlocked);
+        unknown.add_parameter(cluck::g_name_cluck_param_object_name, "lock_name");
+        unknown.add_parameter(cluck::g_name_cluck_param_tag, 55);
+        CATCH_REQUIRE(cluck_daemon::local_forwards::get_reply_pid(unknown) == 0);
+
+        ed::message bad_key;
+        bad_key.set_command(cluck::g_name_cluck_cmd_lock_failed);
+        bad_key.add_parameter(cluck::g_name_cluck_param_key, "not a key");
+        CATCH_REQUIRE(cluck_daemon::local_forwards::get_reply_pid(bad_key) == 0);
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
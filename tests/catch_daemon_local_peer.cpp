@@ -0,0 +1,147 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// self
+//
+#include    "catch_main.h"
+
+
+
+// daemon
+//
+#include    <daemon/local_peer.h>
+
+
+// C++
+//
+#include    <future>
+#include    <limits>
+#include    <thread>
+
+
+// C
+//
+#include    <signal.h>
+#include    <sys/socket.h>
+#include    <sys/wait.h>
+#include    <unistd.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+CATCH_TEST_CASE("daemon_local_peer", "[cluckd][local][daemon]")
+{
+    CATCH_START_SECTION("daemon_local_peer: SO_PEERCRED gives us our own process")
+    {
+        int fds[2];
+        CATCH_REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+        cluck_daemon::local_peer peer(fds[0]);
+        CATCH_REQUIRE(peer.get_pid() == getpid());
+        CATCH_REQUIRE(peer.get_error() == 0);
+
+        CATCH_REQUIRE(peer.is_peer_thread(getpid()));
+        CATCH_REQUIRE(peer.get_thread_count() == 0);
+
+        close(fds[0]);
+        close(fds[1]);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_local_peer: the threads of the peer are accepted and remembered")
+    {
+        int fds[2];
+        CATCH_REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+        cluck_daemon::local_peer peer(fds[0]);
+
+        std::promise<pid_t> tid;
+        std::promise<void> done;
+        std::thread t([&tid, &done]()
+            {
+                tid.set_value(gettid());
+                done.get_future().wait();
+            });
+        pid_t const thread_id(tid.get_future().get());
+        CATCH_REQUIRE(thread_id != getpid());
+
+        CATCH_REQUIRE(peer.is_peer_thread(thread_id));
+        CATCH_REQUIRE(peer.get_thread_count() == 1);
+        CATCH_REQUIRE(peer.is_peer_thread(thread_id));
+        CATCH_REQUIRE(peer.get_thread_count() == 1);
+
+        done.set_value();
+        t.join();
+
+        // the thread is gone but it was remembered
+        //
+        CATCH_REQUIRE(peer.is_peer_thread(thread_id));
+
+        close(fds[0]);
+        close(fds[1]);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_local_peer: identifiers of other processes are refused")
+    {
+        int fds[2];
+        CATCH_REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+        cluck_daemon::local_peer peer(fds[0]);
+
+        // a child process is not one of our threads
+        //
+        pid_t const child(fork());
+        CATCH_REQUIRE(child >= 0);
+        if(child == 0)
+        {
+            pause();
+            _exit(0);
+        }
+        CATCH_REQUIRE_FALSE(peer.is_peer_thread(child));
+        kill(child, SIGKILL);
+        CATCH_REQUIRE(waitpid(child, nullptr, 0) == child);
+
+        CATCH_REQUIRE_FALSE(peer.is_peer_thread(std::numeric_limits<pid_t>::max()));
+        CATCH_REQUIRE_FALSE(peer.is_peer_thread(0));
+        CATCH_REQUIRE_FALSE(peer.is_peer_thread(-1));
+        CATCH_REQUIRE(peer.get_thread_count() == 0);
+
+        close(fds[0]);
+        close(fds[1]);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_local_peer: no credentials without a socket")
+    {
+        cluck_daemon::local_peer peer(-1);
+        CATCH_REQUIRE(peer.get_pid() == -1);
+        CATCH_REQUIRE(peer.get_error() == EBADF);
+
+        CATCH_REQUIRE_FALSE(peer.is_peer_thread(getpid()));
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
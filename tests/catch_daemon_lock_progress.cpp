@@ -0,0 +1,213 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// self
+//
+#include    "catch_main.h"
+
+
+
+// daemon
+//
+#include    <daemon/lock_progress.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+CATCH_TEST_CASE("daemon_lock_progress", "[cluckd][progress][daemon]")
+{
+    CATCH_START_SECTION("daemon_lock_progress: interval")
+    {
+        cluck_daemon::lock_progress progress;
+        CATCH_REQUIRE(progress.get_interval() == cluck::timeout_t(1, 0));
+
+        progress.set_interval(cluck::timeout_t(0, 250'000'000));
+        CATCH_REQUIRE(progress.get_interval() == cluck::timeout_t(0, 250'000'000));
+
+        progress.set_interval(cluck::timeout_t());
+        CATCH_REQUIRE(progress.get_interval() == cluck::timeout_t());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_lock_progress: no estimate without history")
+    {
+        cluck_daemon::lock_progress progress;
+        cluck::timeout_t wait(-1, 0);
+        CATCH_REQUIRE_FALSE(progress.estimate_wait("unknown", 3, cluck::timeout_t(), wait));
+        CATCH_REQUIRE(wait == cluck::timeout_t(-1, 0));
+        CATCH_REQUIRE(progress.get_average_hold("unknown") == cluck::timeout_t());
+        CATCH_REQUIRE(progress.size() == 0);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_lock_progress: average hold time")
+    {
+        cluck_daemon::lock_progress progress;
+
+        // the first sample is the average
+        //
+        progress.record_hold("orders", cluck::timeout_t(2, 0), cluck::timeout_t(100, 0));
+        CATCH_REQUIRE(progress.get_average_hold("orders") == cluck::timeout_t(2, 0));
+
+        // further samples move the average by 1/8th of the difference
+        //
+        progress.record_hold("orders", cluck::timeout_t(10, 0), cluck::timeout_t(101, 0));
+        CATCH_REQUIRE(progress.get_average_hold("orders") == cluck::timeout_t(3, 0));
+
+        // negative hold times (clock adjustments) count as zero
+        //
+        progress.record_hold("orders", cluck::timeout_t(-5, 0), cluck::timeout_t(102, 0));
+        CATCH_REQUIRE(progress.get_average_hold("orders") == cluck::timeout_t(2, 625'000'000));
+
+        // objects are independent
+        //
+        progress.record_hold("invoices", cluck::timeout_t(0, 100'000'000), cluck::timeout_t(102, 0));
+        CATCH_REQUIRE(progress.get_average_hold("invoices") == cluck::timeout_t(0, 100'000'000));
+        CATCH_REQUIRE(progress.get_average_hold("orders") == cluck::timeout_t(2, 625'000'000));
+        CATCH_REQUIRE(progress.size() == 2);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_lock_progress: estimated wait")
+    {
+        cluck_daemon::lock_progress progress;
+        progress.record_hold("orders", cluck::timeout_t(2, 0), cluck::timeout_t(100, 0));
+
+        cluck::timeout_t wait;
+
+        // next in line with nobody holding the lock
+        //
+        CATCH_REQUIRE(progress.estimate_wait("orders", 0, cluck::timeout_t(), wait));
+        CATCH_REQUIRE(wait == cluck::timeout_t());
+
+        // three tickets ahead, none holding the lock yet
+        //
+        CATCH_REQUIRE(progress.estimate_wait("orders", 3, cluck::timeout_t(), wait));
+        CATCH_REQUIRE(wait == cluck::timeout_t(6, 0));
+
+        // the first ticket ahead held the lock for 1.5 seconds already
+        //
+        CATCH_REQUIRE(progress.estimate_wait("orders", 3, cluck::timeout_t(1, 500'000'000), wait));
+        CATCH_REQUIRE(wait == cluck::timeout_t(4, 500'000'000));
+
+        // a holder past the average is expected to release any time now
+        //
+        CATCH_REQUIRE(progress.estimate_wait("orders", 3, cluck::timeout_t(30, 0), wait));
+        CATCH_REQUIRE(wait == cluck::timeout_t(4, 0));
+        CATCH_REQUIRE(progress.estimate_wait("orders", 1, cluck::timeout_t(30, 0), wait));
+        CATCH_REQUIRE(wait == cluck::timeout_t());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_lock_progress: idle objects get pruned")
+    {
+        cluck_daemon::lock_progress progress;
+        progress.record_hold("orders", cluck::timeout_t(1, 0), cluck::timeout_t(1'000, 0));
+        progress.record_hold("invoices", cluck::timeout_t(1, 0), cluck::timeout_t(1'600, 0));
+
+        // the first prune happens right away and nothing is idle yet
+        //
+        progress.prune(cluck::timeout_t(1'550, 0));
+        CATCH_REQUIRE(progress.size() == 2);
+
+        // not pruned again until 10 minutes later
+        //
+        progress.prune(cluck::timeout_t(1'700, 0));
+        CATCH_REQUIRE(progress.size() == 2);
+
+        progress.prune(cluck::timeout_t(2'150, 0));
+        CATCH_REQUIRE(progress.size() == 1);
+        CATCH_REQUIRE(progress.get_average_hold("orders") == cluck::timeout_t());
+        CATCH_REQUIRE(progress.get_average_hold("invoices") == cluck::timeout_t(1, 0));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_lock_progress: clients fail fast with an estimate")
+    {
+        // 50 clients queue on the same object, each holds the lock for
+        // about 1 second and gives up after 10 seconds; without progress
+        // the clients which cannot make it wait out their whole timeout,
+        // with progress they give up as soon as the first estimate
+        // exceeds their timeout
+        //
+        constexpr int CLIENTS = 50;
+        constexpr std::int64_t OBTENTION = 10'000'000;
+        auto hold = [](int idx) { return 1'000'000 + (idx % 5 - 2) * 50'000; };
+
+        cluck_daemon::lock_progress progress;
+        for(int idx(0); idx < 20; ++idx)
+        {
+            progress.record_hold(
+                      "orders"
+                    , cluck::timeout_t(0, hold(idx) * 1'000)
+                    , cluck::timeout_t(100 + idx, 0));
+        }
+
+        auto simulate = [&](bool use_progress, int & obtained, std::int64_t & wasted)
+        {
+            obtained = 0;
+            wasted = 0;
+            std::int64_t now(0);
+            for(int position(0); position < CLIENTS; ++position)
+            {
+                if(use_progress)
+                {
+                    cluck::timeout_t wait;
+                    CATCH_REQUIRE(progress.estimate_wait("orders", position, cluck::timeout_t(), wait));
+                    if(wait.to_usec() > OBTENTION)
+                    {
+                        // give up right away, no time wasted
+                        //
+                        continue;
+                    }
+                }
+                if(now < OBTENTION)
+                {
+                    ++obtained;
+                    now += hold(position);
+                }
+                else
+                {
+                    wasted += OBTENTION;
+                }
+            }
+        };
+
+        int obtained_without(0);
+        std::int64_t wasted_without(0);
+        simulate(false, obtained_without, wasted_without);
+
+        int obtained_with(0);
+        std::int64_t wasted_with(0);
+        simulate(true, obtained_with, wasted_with);
+
+        // the estimate does not make clients give up a lock they could get
+        //
+        CATCH_REQUIRE(obtained_with == obtained_without);
+        CATCH_REQUIRE(wasted_with < wasted_without);
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -0,0 +1,107 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+// self
+//
+#include    "catch_main.h"
+
+
+
+// daemon
+//
+#include    <daemon/lock_trace.h>
+
+
+// C++
+//
+#include    <string>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+CATCH_TEST_CASE("daemon_lock_trace", "[cluckd][trace][daemon]")
+{
+    CATCH_START_SECTION("daemon_lock_trace: phase names")
+    {
+        CATCH_REQUIRE(std::string(cluck_daemon::lock_trace::phase_name(0)) == "admission");
+        CATCH_REQUIRE(std::string(cluck_daemon::lock_trace::phase_name(cluck_daemon::lock_trace::PHASE_COUNT - 1)) == "activation");
+        CATCH_REQUIRE(std::string(cluck_daemon::lock_trace::phase_name(cluck_daemon::lock_trace::PHASE_COUNT)) == "unknown");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_lock_trace: incomplete trace")
+    {
+        cluck_daemon::lock_trace trace;
+        CATCH_REQUIRE_FALSE(trace.is_complete());
+
+        trace.mark(cluck_daemon::lock_trace::TRANSITION_CREATED, cluck::timeout_t(100, 0));
+        trace.mark(cluck_daemon::lock_trace::TRANSITION_ENTERING, cluck::timeout_t(100, 5'000));
+        CATCH_REQUIRE_FALSE(trace.is_complete());
+        CATCH_REQUIRE(trace.get_phase(0) == cluck::timeout_t(0, 5'000));
+        CATCH_REQUIRE(trace.get_phase(1) == cluck::timeout_t(-1, 0));
+        CATCH_REQUIRE(trace.to_string() == "admission: 5us, entering: ?, max_ticket: ?, add_ticket: ?, ticket_added: ?, still_entering: ?, activation: ?, total: ?");
+
+        cluck_daemon::lock_phases phases;
+        phases.add(trace);
+        CATCH_REQUIRE(phases.get_histogram(0).get_count() == 0);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_lock_trace: complete trace")
+    {
+        cluck_daemon::lock_trace trace;
+
+        // each phase lasts 1ms more than the previous one
+        //
+        std::int64_t usec(0);
+        for(std::size_t t(0); t < cluck_daemon::lock_trace::TRANSITION_COUNT; ++t)
+        {
+            usec += static_cast<std::int64_t>(t) * 1'000;
+            trace.mark(static_cast<cluck_daemon::lock_trace::transition_t>(t), cluck::timeout_t(200, usec * 1'000));
+        }
+        CATCH_REQUIRE(trace.is_complete());
+
+        // only the first mark counts (the MAX_TICKET is received from
+        // each leader)
+        //
+        trace.mark(cluck_daemon::lock_trace::TRANSITION_MAX_TICKET, cluck::timeout_t(300, 0));
+        CATCH_REQUIRE(trace.get_date(cluck_daemon::lock_trace::TRANSITION_MAX_TICKET) == cluck::timeout_t(200, 6'000'000));
+
+        for(std::size_t phase(0); phase < cluck_daemon::lock_trace::PHASE_COUNT; ++phase)
+        {
+            CATCH_REQUIRE(trace.get_phase(phase).to_usec() == static_cast<std::int64_t>((phase + 1) * 1'000));
+        }
+        CATCH_REQUIRE(trace.to_string() == "admission: 1000us, entering: 2000us, max_ticket: 3000us, add_ticket: 4000us, ticket_added: 5000us, still_entering: 6000us, activation: 7000us, total: 28000us");
+
+        cluck_daemon::lock_phases phases;
+        phases.add(trace);
+        phases.add(trace);
+        for(std::size_t phase(0); phase < cluck_daemon::lock_trace::PHASE_COUNT; ++phase)
+        {
+            CATCH_REQUIRE(phases.get_histogram(phase).get_count() == 2);
+            CATCH_REQUIRE(phases.get_histogram(phase).get_max() == static_cast<std::int64_t>((phase + 1) * 1'000));
+        }
+    }
+    CATCH_END_SECTION()
+}
+
+
+// vim: ts=4 sw=4 et
@@ -0,0 +1,206 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// self
+//
+#include    "catch_main.h"
+
+
+
+// daemon
+//
+#include    <daemon/message_cache.h>
+
+
+// C++
+//
+#include    <vector>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace
+{
+
+
+
+cluck_daemon::message_cache::request make_request(
+      std::string const & server
+    , pid_t pid
+    , std::string const & object_name
+    , ed::dispatcher_match::tag_t tag
+    , std::int64_t timeout)
+{
+    cluck_daemon::message_cache::request r;
+    r.f_timeout = cluck::timeout_t(timeout, 0);
+    r.f_duration = cluck::timeout_t(10, 0);
+    r.f_object_name = cluck_daemon::atom(object_name);
+    r.f_tag = tag;
+    r.f_pid = pid;
+    r.f_sent_from_server = cluck_daemon::atom(server);
+    r.f_sent_from_service = cluck_daemon::atom("website");
+    return r;
+}
+
+
+std::vector<pid_t> drain(cluck_daemon::message_cache & cache)
+{
+    std::vector<pid_t> result;
+    cluck_daemon::message_cache::request r;
+    while(cache.pop_next(r))
+    {
+        result.push_back(r.f_pid);
+    }
+    return result;
+}
+
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("daemon_message_cache", "[cluckd][cache][daemon]")
+{
+    CATCH_START_SECTION("daemon_message_cache: requests are replayed earliest timeout first")
+    {
+        cluck_daemon::message_cache cache;
+        CATCH_REQUIRE(cache.empty());
+        CATCH_REQUIRE(cache.get_limit() == cluck_daemon::message_cache::DEFAULT_LIMIT);
+        CATCH_REQUIRE(cache.get_next_timeout() == snapdev::timespec_ex::max());
+
+        cluck_daemon::message_cache::request evicted;
+        CATCH_REQUIRE_FALSE(cache.add(make_request("alpha", 100, "obj1", 1, 300), evicted));
+        CATCH_REQUIRE_FALSE(cache.add(make_request("beta", 200, "obj2", 2, 100), evicted));
+        CATCH_REQUIRE_FALSE(cache.add(make_request("alpha", 101, "obj1", 3, 200), evicted));
+        CATCH_REQUIRE_FALSE(cache.add(make_request("alpha", 102, "obj1", 4, 100), evicted));
+        CATCH_REQUIRE(cache.size() == 4);
+        CATCH_REQUIRE(cache.get_next_timeout() == cluck::timeout_t(100, 0));
+
+        cluck_daemon::message_cache::request r;
+        CATCH_REQUIRE(cache.pop_next(r));
+        CATCH_REQUIRE(r.f_pid == 200);
+        CATCH_REQUIRE(r.f_object_name == "obj2");
+        CATCH_REQUIRE(r.get_server_name() == "beta");
+        CATCH_REQUIRE(r.get_service_name() == "website");
+
+        // same timeout, arrival order
+        //
+        CATCH_REQUIRE(drain(cache) == std::vector<pid_t>({ 102, 101, 100 }));
+        CATCH_REQUIRE(cache.empty());
+        CATCH_REQUIRE_FALSE(cache.pop_next(r));
+        CATCH_REQUIRE(cache.get_next_timeout() == snapdev::timespec_ex::max());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_message_cache: a repeated LOCK replaces the previous one")
+    {
+        cluck_daemon::message_cache cache;
+        cluck_daemon::message_cache::request evicted;
+        CATCH_REQUIRE_FALSE(cache.add(make_request("alpha", 100, "obj1", 1, 100), evicted));
+        CATCH_REQUIRE_FALSE(cache.add(make_request("alpha", 200, "obj1", 1, 150), evicted));
+        CATCH_REQUIRE_FALSE(cache.add(make_request("alpha", 100, "obj1", 1, 500), evicted));
+        CATCH_REQUIRE(cache.size() == 2);
+        CATCH_REQUIRE(cache.get_coalesced() == 1);
+
+        // the old deadline is gone with the replaced request
+        //
+        CATCH_REQUIRE(cache.get_next_timeout() == cluck::timeout_t(150, 0));
+
+        // a proxied LOCK is identified by the proxy server name
+        //
+        cluck_daemon::message_cache::request proxied(make_request("gamma", 100, "obj1", 1, 600));
+        proxied.f_proxy_server_name = cluck_daemon::atom("alpha");
+        proxied.f_proxy_service_name = cluck_daemon::atom("backend");
+        CATCH_REQUIRE(proxied.get_server_name() == "alpha");
+        CATCH_REQUIRE(proxied.get_service_name() == "backend");
+        CATCH_REQUIRE_FALSE(cache.add(proxied, evicted));
+        CATCH_REQUIRE(cache.size() == 2);
+        CATCH_REQUIRE(cache.get_coalesced() == 2);
+
+        cluck_daemon::message_cache::request r;
+        CATCH_REQUIRE(cache.pop_next(r));
+        CATCH_REQUIRE(r.f_pid == 200);
+        CATCH_REQUIRE(cache.pop_next(r));
+        CATCH_REQUIRE(r.f_pid == 100);
+        CATCH_REQUIRE(r.f_timeout == cluck::timeout_t(600, 0));
+        CATCH_REQUIRE(r.get_service_name() == "backend");
+        CATCH_REQUIRE(cache.empty());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_message_cache: the oldest request is evicted when full")
+    {
+        cluck_daemon::message_cache cache;
+        cache.set_limit(0);
+        CATCH_REQUIRE(cache.get_limit() == 1);
+        cache.set_limit(3);
+
+        cluck_daemon::message_cache::request evicted;
+        for(pid_t pid(1); pid <= 3; ++pid)
+        {
+            CATCH_REQUIRE_FALSE(cache.add(make_request("alpha", pid, "obj", 0, 100 + pid), evicted));
+        }
+        CATCH_REQUIRE(cache.add(make_request("alpha", 4, "obj", 0, 50), evicted));
+        CATCH_REQUIRE(evicted.f_pid == 1);
+        CATCH_REQUIRE(cache.size() == 3);
+        CATCH_REQUIRE(cache.get_next_timeout() == cluck::timeout_t(50, 0));
+
+        // replacing a request does not evict another one
+        //
+        CATCH_REQUIRE_FALSE(cache.add(make_request("alpha", 2, "obj", 0, 200), evicted));
+        CATCH_REQUIRE(cache.size() == 3);
+
+        CATCH_REQUIRE(drain(cache) == std::vector<pid_t>({ 4, 3, 2 }));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_message_cache: timed out requests are removed by deadline")
+    {
+        cluck_daemon::message_cache cache;
+        cluck_daemon::message_cache::request evicted;
+        CATCH_REQUIRE_FALSE(cache.add(make_request("alpha", 1, "obj", 0, 300), evicted));
+        CATCH_REQUIRE_FALSE(cache.add(make_request("alpha", 2, "obj", 0, 100), evicted));
+        CATCH_REQUIRE_FALSE(cache.add(make_request("alpha", 3, "obj", 0, 200), evicted));
+
+        cluck_daemon::message_cache::request r;
+        CATCH_REQUIRE_FALSE(cache.pop_timed_out(cluck::timeout_t(99, 0), r));
+        CATCH_REQUIRE(cache.pop_timed_out(cluck::timeout_t(200, 0), r));
+        CATCH_REQUIRE(r.f_pid == 2);
+        CATCH_REQUIRE(cache.pop_timed_out(cluck::timeout_t(200, 0), r));
+        CATCH_REQUIRE(r.f_pid == 3);
+        CATCH_REQUIRE_FALSE(cache.pop_timed_out(cluck::timeout_t(200, 0), r));
+        CATCH_REQUIRE(cache.size() == 1);
+        CATCH_REQUIRE(cache.get_next_timeout() == cluck::timeout_t(300, 0));
+
+        // the same client can add a new request once the old one is gone
+        //
+        CATCH_REQUIRE_FALSE(cache.add(make_request("alpha", 2, "obj", 0, 400), evicted));
+        CATCH_REQUIRE(cache.size() == 2);
+        CATCH_REQUIRE(cache.get_coalesced() == 0);
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -0,0 +1,211 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+// self
+//
+#include    "catch_main.h"
+
+
+
+// daemon
+//
+#include    <daemon/object_stats.h>
+
+
+// C++
+//
+#include    <limits>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+CATCH_TEST_CASE("daemon_histogram", "[cluckd][stats][daemon]")
+{
+    CATCH_START_SECTION("daemon_histogram: buckets")
+    {
+        CATCH_REQUIRE(cluck_daemon::histogram::bucket_of(-5) == 0);
+        CATCH_REQUIRE(cluck_daemon::histogram::bucket_of(0) == 0);
+        CATCH_REQUIRE(cluck_daemon::histogram::bucket_of(1) == 1);
+        CATCH_REQUIRE(cluck_daemon::histogram::bucket_of(2) == 2);
+        CATCH_REQUIRE(cluck_daemon::histogram::bucket_of(3) == 2);
+        CATCH_REQUIRE(cluck_daemon::histogram::bucket_of(4) == 3);
+        CATCH_REQUIRE(cluck_daemon::histogram::bucket_of(1'000'000) == 20);
+        CATCH_REQUIRE(cluck_daemon::histogram::bucket_of(std::numeric_limits<std::int64_t>::max())
+                                        == cluck_daemon::histogram::BUCKETS - 1);
+
+        for(std::size_t idx(0); idx < cluck_daemon::histogram::BUCKETS - 1; ++idx)
+        {
+            std::int64_t const limit(cluck_daemon::histogram::bucket_limit(idx));
+            CATCH_REQUIRE(cluck_daemon::histogram::bucket_of(limit) == idx);
+            CATCH_REQUIRE(cluck_daemon::histogram::bucket_of(limit + 1) == idx + 1);
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_histogram: percentiles")
+    {
+        cluck_daemon::histogram h;
+        CATCH_REQUIRE(h.get_count() == 0);
+        CATCH_REQUIRE(h.get_average() == 0);
+        CATCH_REQUIRE(h.get_percentile(50) == 0);
+
+        for(std::int64_t value(1); value <= 100; ++value)
+        {
+            h.add(value * 1'000);
+        }
+        CATCH_REQUIRE(h.get_count() == 100);
+        CATCH_REQUIRE(h.get_average() == 50'500);
+        CATCH_REQUIRE(h.get_max() == 100'000);
+
+        // percentiles are the upper limit of a bucket so they are within
+        // a factor of 2 of the exact value
+        //
+        std::int64_t const p50(h.get_percentile(50));
+        CATCH_REQUIRE(p50 >= 50'000);
+        CATCH_REQUIRE(p50 < 100'000);
+        CATCH_REQUIRE(h.get_percentile(99) == 100'000);
+        CATCH_REQUIRE(h.get_percentile(100) == 100'000);
+
+        h.clear();
+        CATCH_REQUIRE(h.get_count() == 0);
+        CATCH_REQUIRE(h.get_max() == 0);
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("daemon_object_stats", "[cluckd][stats][daemon]")
+{
+    CATCH_START_SECTION("daemon_object_stats: count transitions")
+    {
+        cluck_daemon::object_stats stats;
+        CATCH_REQUIRE(stats.get_limit() == cluck_daemon::object_stats::DEFAULT_LIMIT);
+        CATCH_REQUIRE(stats.find("orders") == nullptr);
+
+        stats.queued("orders", 1);
+        stats.queued("orders", 3);
+        stats.queued("orders", 2);
+        stats.locked("orders", cluck::timeout_t(0, 5'000'000), cluck::timeout_t(100, 0));
+        stats.unlocked("orders", cluck::timeout_t(0, 20'000'000));
+        stats.timed_out("orders");
+
+        cluck_daemon::object_stats::stats const * s(stats.find("orders"));
+        CATCH_REQUIRE(s != nullptr);
+        CATCH_REQUIRE(s->f_name == "orders");
+        CATCH_REQUIRE(s->f_requests == 3);
+        CATCH_REQUIRE(s->f_acquisitions == 1);
+        CATCH_REQUIRE(s->f_timeouts == 1);
+        CATCH_REQUIRE(s->f_queue_depth == 2);
+        CATCH_REQUIRE(s->f_max_queue_depth == 3);
+        CATCH_REQUIRE(s->f_wait.get_count() == 1);
+        CATCH_REQUIRE(s->f_wait.get_max() == 5'000);
+        CATCH_REQUIRE(s->f_hold.get_count() == 1);
+        CATCH_REQUIRE(s->f_hold.get_max() == 20'000);
+        CATCH_REQUIRE(stats.size() == 1);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_object_stats: prefix")
+    {
+        cluck_daemon::object_stats stats;
+        stats.set_prefix(2);
+        CATCH_REQUIRE(stats.get_prefix() == 2);
+
+        stats.queued("website/page/123", 1);
+        stats.queued("website/page/456", 1);
+        stats.queued("website/user/7", 1);
+        stats.queued("website", 1);
+
+        CATCH_REQUIRE(stats.size() == 3);
+        CATCH_REQUIRE(stats.find("website/page")->f_requests == 2);
+        CATCH_REQUIRE(stats.find("website/page/789")->f_requests == 2);
+        CATCH_REQUIRE(stats.find("website/user")->f_requests == 1);
+        CATCH_REQUIRE(stats.find("website")->f_requests == 1);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_object_stats: least recently used objects get evicted")
+    {
+        cluck_daemon::object_stats stats;
+        stats.set_limit(3);
+
+        stats.queued("a", 1);
+        stats.queued("b", 1);
+        stats.queued("c", 1);
+        stats.queued("a", 1);       // "b" is now the least recently used
+        stats.queued("d", 1);
+
+        CATCH_REQUIRE(stats.size() == 3);
+        CATCH_REQUIRE(stats.find("a") != nullptr);
+        CATCH_REQUIRE(stats.find("b") == nullptr);
+        CATCH_REQUIRE(stats.find("c") != nullptr);
+        CATCH_REQUIRE(stats.find("d") != nullptr);
+
+        stats.set_limit(1);
+        CATCH_REQUIRE(stats.size() == 1);
+        CATCH_REQUIRE(stats.find("d") != nullptr);
+
+        stats.set_limit(0);
+        stats.queued("e", 1);
+        CATCH_REQUIRE(stats.size() == 0);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_object_stats: hot objects")
+    {
+        cluck_daemon::object_stats stats;
+
+        // "hot" is locked 10 times per second for 30 seconds, "warm" once
+        // per second and "cold" was busy but a long time ago
+        //
+        for(int idx(0); idx < 300; ++idx)
+        {
+            stats.locked("cold", cluck::timeout_t(), cluck::timeout_t(idx / 10.0));
+        }
+        for(int idx(0); idx < 300; ++idx)
+        {
+            cluck::timeout_t const now(1'000.0 + idx / 10.0);
+            stats.locked("hot", cluck::timeout_t(), now);
+            if(idx % 10 == 0)
+            {
+                stats.locked("warm", cluck::timeout_t(), now);
+            }
+        }
+
+        cluck::timeout_t const now(1'030.0);
+        CATCH_REQUIRE(stats.find("hot")->get_rate(now) > 9.0);
+        CATCH_REQUIRE(stats.find("hot")->get_rate(now) < 10.0);
+        CATCH_REQUIRE(stats.find("warm")->get_rate(now) > 0.9);
+        CATCH_REQUIRE(stats.find("warm")->get_rate(now) < 1.0);
+        CATCH_REQUIRE(stats.find("cold")->get_rate(now) < 0.001);
+
+        std::vector<cluck_daemon::object_stats::stats const *> const hot(stats.get_hot(2, now));
+        CATCH_REQUIRE(hot.size() == 2);
+        CATCH_REQUIRE(hot[0]->f_name == "hot");
+        CATCH_REQUIRE(hot[1]->f_name == "warm");
+
+        CATCH_REQUIRE(stats.get_hot(10, now).size() == 3);
+    }
+    CATCH_END_SECTION()
+}
+
+
+// vim: ts=4 sw=4 et
@@ -29,6 +29,7 @@
 #undef private
 
 #include    <daemon/cluckd.h>
+#include    <daemon/ticket_pool.h>
 
 
 // cluck
@@ -48,6 +49,14 @@
 #include    <snapdev/stringize.h>
 
 
+// C++
+//
+#include    <atomic>
+#include    <chrono>
+#include    <cstdlib>
+#include    <new>
+
+
 // last include
 //
 #include    <snapdev/poison.h>
@@ -59,6 +68,11 @@ namespace
 
 
 
+// number of calls to the global operator new (see below)
+//
+std::atomic<std::size_t> g_new_calls = 0;
+
+
 char const * g_argv[2] = {
     "catch_daemon_ticket",
     nullptr
@@ -141,11 +155,73 @@ void messenger_mock::add_expected_message(ed::message & msg)
 }
 
 
+// a lock cycle as seen by the daemon: a ticket gets created, receives
+// its number (ADD_TICKET), is inserted in the tickets of its object,
+// and the oldest ticket gets dropped so about WINDOW tickets are alive
+// at any one time
+//
+// the function returns the number of calls to the global operator new
+// made by these cycles
+//
+constexpr std::size_t const WINDOW = 100;
+
+template<typename C>
+std::size_t lock_cycles(
+      cluck_daemon::ticket::object_map_t & tickets
+    , std::size_t first
+    , std::size_t count
+    , C create)
+{
+    cluck_daemon::atom const object_name("ticket_test");
+    std::size_t const start(g_new_calls);
+    for(std::size_t idx(first); idx < first + count; ++idx)
+    {
+        cluck_daemon::ticket::pointer_t t(create());
+        t->set_ticket_number(idx + 1);
+        cluck_daemon::ticket::key_map_t & object_tickets(tickets[object_name]);
+        object_tickets[t->get_ticket_key()] = t;
+        if(object_tickets.size() > WINDOW)
+        {
+            object_tickets.erase(object_tickets.begin());
+        }
+    }
+    return g_new_calls - start;
+}
+
+
 
 } // no name namespace
 
 
 
+// count the allocations of the whole test binary so we can verify the
+// number of allocations of a lock cycle
+//
+void * operator new(std::size_t size)
+{
+    ++g_new_calls;
+    void * ptr(std::malloc(size == 0 ? 1 : size));
+    if(ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+
+void operator delete(void * ptr) noexcept
+{
+    std::free(ptr);
+}
+
+
+void operator delete(void * ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+
+
 CATCH_TEST_CASE("daemon_ticket", "[cluckd][ticket][daemon]")
 {
     CATCH_START_SECTION("daemon_ticket: verify defaults")
@@ -303,6 +379,177 @@ CATCH_TEST_CASE("daemon_ticket", "[cluckd][ticket][daemon]")
         CATCH_REQUIRE(t.get_current_timeout_date() == obtention_timeout);
     }
     CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_ticket: ticket number larger than 32 bits")
+    {
+        cluck::timeout_t obtention_timeout(snapdev::now());
+        obtention_timeout += cluck::timeout_t(5, 0);
+        cluckd_mock d;
+        cluck_daemon::ticket t(
+              &d
+            , nullptr
+            , "ticket_test"
+            , 123
+            , "rc/5003"
+            , obtention_timeout
+            , cluck::timeout_t(10, 0)
+            , "rc"
+            , "website");
+
+        t.set_ticket_number(0x100000000);
+        CATCH_REQUIRE(t.get_ticket_number() == 0x100000000);
+        CATCH_REQUIRE(t.get_ticket_key() == "0000000100000000/rc/5003");
+
+        // 32 bit numbers keep the old 8 digit format
+        //
+        CATCH_REQUIRE(cluck_daemon::ticket::make_ticket_key(0xffffffff, "rc/5003") == "ffffffff/rc/5003");
+
+        // the keys sort numerically even when the width differs
+        //
+        cluck_daemon::ticket::key_map_t keys;
+        keys["0000000100000000/rc/5003"] = nullptr;
+        keys["ffffffff/rc/5003"] = nullptr;
+        keys["00000001/rc/5003"] = nullptr;
+        auto it(keys.begin());
+        CATCH_REQUIRE(it->first == "00000001/rc/5003");
+        ++it;
+        CATCH_REQUIRE(it->first == "ffffffff/rc/5003");
+        ++it;
+        CATCH_REQUIRE(it->first == "0000000100000000/rc/5003");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_ticket: the ticket pool saves one allocation per lock cycle")
+    {
+        cluck::timeout_t obtention_timeout(snapdev::now());
+        obtention_timeout += cluck::timeout_t(5, 0);
+        cluckd_mock d;
+
+        constexpr std::size_t const CYCLES = 1'000;
+
+        cluck_daemon::ticket_pool::pointer_t pool(std::make_shared<cluck_daemon::ticket_pool>());
+        auto create_pooled = [&]()
+        {
+            return std::allocate_shared<cluck_daemon::ticket>(
+                      cluck_daemon::ticket_allocator<cluck_daemon::ticket>(pool)
+                    , &d
+                    , nullptr
+                    , "ticket_test"
+                    , 123
+                    , "rc/5003"
+                    , obtention_timeout
+                    , cluck::timeout_t(10, 0)
+                    , "rc"
+                    , "website");
+        };
+        auto create_shared = [&]()
+        {
+            return std::make_shared<cluck_daemon::ticket>(
+                      &d
+                    , nullptr
+                    , "ticket_test"
+                    , 123
+                    , "rc/5003"
+                    , obtention_timeout
+                    , cluck::timeout_t(10, 0)
+                    , "rc"
+                    , "website");
+        };
+
+        // warm up the pool and the ticket store
+        //
+        cluck_daemon::ticket::object_map_t tickets;
+        lock_cycles(tickets, 0, CYCLES, create_pooled);
+        std::size_t const upstream(pool->get_upstream_allocations());
+        CATCH_REQUIRE(upstream <= WINDOW / cluck_daemon::ticket_pool::BLOCKS_PER_SLAB + 2);
+
+        // once warm, the pool does not allocate anything more and each
+        // ticket created with make_shared() costs one more call to the
+        // global operator new
+        //
+        std::size_t const pooled_news(lock_cycles(tickets, CYCLES, CYCLES, create_pooled));
+        CATCH_REQUIRE(pool->get_upstream_allocations() == upstream);
+        std::size_t const shared_news(lock_cycles(tickets, CYCLES * 2, CYCLES, create_shared));
+        CATCH_REQUIRE(shared_news >= pooled_news + CYCLES);
+
+        tickets.clear();
+        CATCH_REQUIRE(pool->get_used_blocks() == 0);
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("daemon_ticket_benchmark", "[cluckd][ticket][daemon][benchmark][.]")
+{
+    CATCH_START_SECTION("daemon_ticket_benchmark: ticket pool against make_shared()")
+    {
+        cluck::timeout_t obtention_timeout(snapdev::now());
+        obtention_timeout += cluck::timeout_t(5, 0);
+        cluckd_mock d;
+
+        constexpr std::size_t const CYCLES = 100'000;
+
+        cluck_daemon::ticket_pool::pointer_t pool(std::make_shared<cluck_daemon::ticket_pool>());
+        auto create_pooled = [&]()
+        {
+            return std::allocate_shared<cluck_daemon::ticket>(
+                      cluck_daemon::ticket_allocator<cluck_daemon::ticket>(pool)
+                    , &d
+                    , nullptr
+                    , "ticket_test"
+                    , 123
+                    , "rc/5003"
+                    , obtention_timeout
+                    , cluck::timeout_t(10, 0)
+                    , "rc"
+                    , "website");
+        };
+        auto create_shared = [&]()
+        {
+            return std::make_shared<cluck_daemon::ticket>(
+                      &d
+                    , nullptr
+                    , "ticket_test"
+                    , 123
+                    , "rc/5003"
+                    , obtention_timeout
+                    , cluck::timeout_t(10, 0)
+                    , "rc"
+                    , "website");
+        };
+
+        // warm up the pool and the ticket store
+        //
+        cluck_daemon::ticket::object_map_t tickets;
+        lock_cycles(tickets, 0, CYCLES, create_pooled);
+
+        auto const pooled_start(std::chrono::steady_clock::now());
+        std::size_t const pooled_news(lock_cycles(tickets, CYCLES, CYCLES, create_pooled));
+        auto const pooled_duration(std::chrono::steady_clock::now() - pooled_start);
+
+        auto const shared_start(std::chrono::steady_clock::now());
+        std::size_t const shared_news(lock_cycles(tickets, CYCLES * 2, CYCLES, create_shared));
+        auto const shared_duration(std::chrono::steady_clock::now() - shared_start);
+
+        double const pooled_ns(std::chrono::duration<double, std::nano>(pooled_duration).count() / CYCLES);
+        double const shared_ns(std::chrono::duration<double, std::nano>(shared_duration).count() / CYCLES);
+        SNAP_LOG_INFO
+            << "ticket pool benchmark: operator new calls per lock cycle: make_shared() "
+            << static_cast<double>(shared_news) / CYCLES
+            << ", pool "
+            << static_cast<double>(pooled_news) / CYCLES
+            << " ("
+            << pool->get_slab_count()
+            << " slabs of "
+            << pool->get_block_size()
+            << " bytes blocks); make_shared() "
+            << shared_ns
+            << "ns/cycle, pool "
+            << pooled_ns
+            << "ns/cycle"
+            << SNAP_LOG_SEND;
+    }
+    CATCH_END_SECTION()
 }
 
 
@@ -356,30 +603,6 @@ CATCH_TEST_CASE("daemon_ticket_errors", "[cluckd][ticket][daemon][error]")
     }
     CATCH_END_SECTION()
 
-    CATCH_START_SECTION("daemon_ticket_errors: ticket number wrap around in max_ticket()")
-    {
-        cluck::timeout_t obtention_timeout(snapdev::now());
-        obtention_timeout += cluck::timeout_t(5, 0);
-        cluckd_mock d;
-        cluck_daemon::ticket t(
-              &d
-            , nullptr
-            , "ticket_test"
-            , 123
-            , "rc/5003"
-            , obtention_timeout
-            , cluck::timeout_t(10, 0)
-            , "rc"
-            , "website");
-
-        CATCH_REQUIRE_THROWS_MATCHES(
-              t.max_ticket(std::numeric_limits<cluck_daemon::ticket::ticket_id_t>::max())
-            , cluck::out_of_range
-            , Catch::Matchers::ExceptionMessage(
-                  "out_of_range: ticket::max_ticket() tried to generate the next ticket and got a wrapping around number."));
-    }
-    CATCH_END_SECTION()
-
     CATCH_START_SECTION("daemon_ticket_errors: ticket with bad entering key")
     {
         cluck::timeout_t obtention_timeout(snapdev::now());
@@ -0,0 +1,212 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// self
+//
+#include    "catch_main.h"
+
+
+
+
+// daemon
+//
+#include    <daemon/ticket_key.h>
+
+
+// C++
+//
+#include    <algorithm>
+#include    <vector>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+CATCH_TEST_CASE("daemon_ticket_key", "[cluckd][ticket][daemon]")
+{
+    CATCH_START_SECTION("daemon_ticket_key: empty key")
+    {
+        cluck_daemon::ticket_key k;
+        CATCH_REQUIRE(k.empty());
+        CATCH_REQUIRE_FALSE(k.is_valid());
+        CATCH_REQUIRE(k.get_ticket_number() == cluck_daemon::ticket_key::NO_TICKET);
+        CATCH_REQUIRE(k.get_pid() == 0);
+        CATCH_REQUIRE(k.to_string() == std::string());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_ticket_key: entering key")
+    {
+        cluck_daemon::ticket_key const k("rc/5003");
+        CATCH_REQUIRE_FALSE(k.empty());
+        CATCH_REQUIRE(k.is_valid());
+        CATCH_REQUIRE(k.is_entering_key());
+        CATCH_REQUIRE(k.get_ticket_number() == cluck_daemon::ticket_key::NO_TICKET);
+        CATCH_REQUIRE(k.get_server_name() == "rc");
+        CATCH_REQUIRE(k.get_pid() == 5003);
+        CATCH_REQUIRE(k.to_string() == "rc/5003");
+        CATCH_REQUIRE(k == cluck_daemon::ticket_key(cluck_daemon::atom("rc"), 5003));
+        CATCH_REQUIRE(k.get_entering_key() == k);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_ticket_key: ticket key")
+    {
+        cluck_daemon::ticket_key const k("0000002a/rc/5003");
+        CATCH_REQUIRE(k.is_valid());
+        CATCH_REQUIRE_FALSE(k.is_entering_key());
+        CATCH_REQUIRE(k.get_ticket_number() == 42);
+        CATCH_REQUIRE(k.get_server_name() == "rc");
+        CATCH_REQUIRE(k.get_pid() == 5003);
+        CATCH_REQUIRE(k.to_string() == "0000002a/rc/5003");
+        CATCH_REQUIRE(k.get_entering_key() == cluck_daemon::ticket_key("rc/5003"));
+        CATCH_REQUIRE(k == cluck_daemon::ticket_key(42, cluck_daemon::ticket_key("rc/5003")));
+
+        cluck_daemon::ticket_key const large("0000000100000000/rc/5003");
+        CATCH_REQUIRE(large.get_ticket_number() == 0x100000000ULL);
+        CATCH_REQUIRE(large.to_string() == "0000000100000000/rc/5003");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_ticket_key: invalid keys are kept as is")
+    {
+        char const * invalid_keys[] =
+        {
+            "bad/key",
+            "badhexnb/rc/32005",
+            "rc/not-a-pid",
+            "no-slash",
+        };
+        for(auto const & s : invalid_keys)
+        {
+            cluck_daemon::ticket_key const k(s);
+            CATCH_REQUIRE_FALSE(k.is_valid());
+            CATCH_REQUIRE(k.to_string() == s);
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_ticket_key: order matches the string order")
+    {
+        std::vector<std::string> keys =
+        {
+            "00000001/rc/5003",
+            "00000002/rc/5003",
+            "00000001/rc/6",
+            "00000001/rc2/5003",
+            "00000001/r/5003",
+            "0000000a/rc/5003",
+            "000000ff/rc/1",
+            "000000ff/rc-2/1",
+        };
+        std::vector<cluck_daemon::ticket_key> parsed;
+        for(auto const & s : keys)
+        {
+            parsed.emplace_back(s);
+        }
+        std::sort(keys.begin(), keys.end());
+        std::sort(parsed.begin(), parsed.end());
+        CATCH_REQUIRE(keys.size() == parsed.size());
+        for(std::size_t idx(0); idx < keys.size(); ++idx)
+        {
+            CATCH_REQUIRE(parsed[idx].to_string() == keys[idx]);
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_ticket_key: strict weak ordering")
+    {
+        // server names of 8 and 16 characters look like ticket numbers;
+        // they must not change the way the entering keys compare
+        //
+        std::vector<std::string> entering_keys =
+        {
+            "zzzzzzzz/1",
+            "aaaaaaaaaaaaaaaa/1",
+            "mmmmmmmmmm/1",
+            "ffffffff/2",
+            "0000000100000000/3",
+            "b/4",
+        };
+        std::vector<cluck_daemon::ticket_key> keys;
+        for(auto const & s : entering_keys)
+        {
+            keys.emplace_back(s);
+            CATCH_REQUIRE(keys.back().is_entering_key());
+        }
+
+        // the ticket numbers compare as numbers whatever their width
+        //
+        cluck_daemon::ticket_key const entering("rc/5003");
+        keys.emplace_back(0xffffffffULL, entering);
+        keys.emplace_back(0x100000000ULL, entering);
+        keys.emplace_back(0x2ULL, entering);
+
+        for(auto const & a : keys)
+        {
+            CATCH_REQUIRE_FALSE(a < a);
+            for(auto const & b : keys)
+            {
+                if(a < b)
+                {
+                    CATCH_REQUIRE_FALSE(b < a);
+                }
+                for(auto const & c : keys)
+                {
+                    if(a < b && b < c)
+                    {
+                        CATCH_REQUIRE(a < c);
+                    }
+                }
+            }
+        }
+
+        // entering keys use the plain string order
+        //
+        std::vector<cluck_daemon::ticket_key> parsed(keys.begin(), keys.begin() + entering_keys.size());
+        std::sort(entering_keys.begin(), entering_keys.end());
+        std::sort(parsed.begin(), parsed.end());
+        for(std::size_t idx(0); idx < entering_keys.size(); ++idx)
+        {
+            CATCH_REQUIRE(parsed[idx].to_string() == entering_keys[idx]);
+        }
+
+        CATCH_REQUIRE(cluck_daemon::ticket_key(0xffffffffULL, entering) < cluck_daemon::ticket_key(0x100000000ULL, entering));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_ticket_key: parse ticket numbers")
+    {
+        cluck_daemon::ticket_key::ticket_id_t number(0);
+        CATCH_REQUIRE(cluck_daemon::ticket_key::parse_ticket_number("0000ffff", number));
+        CATCH_REQUIRE(number == 0xffff);
+        CATCH_REQUIRE_FALSE(cluck_daemon::ticket_key::parse_ticket_number("ffff", number));
+        CATCH_REQUIRE_FALSE(cluck_daemon::ticket_key::parse_ticket_number("badhexnb", number));
+        CATCH_REQUIRE_FALSE(cluck_daemon::ticket_key::parse_ticket_number("100000000", number));
+        CATCH_REQUIRE(cluck_daemon::ticket_key::ticket_number_to_string(0xffff) == "0000ffff");
+        CATCH_REQUIRE(cluck_daemon::ticket_key::ticket_number_to_string(0x100000000ULL) == "0000000100000000");
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -0,0 +1,147 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// self
+//
+#include    "catch_main.h"
+
+
+
+
+// daemon
+//
+#include    <daemon/ticket_pool.h>
+
+
+// C++
+//
+#include    <cstddef>
+#include    <string>
+#include    <vector>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace
+{
+
+
+
+struct pooled_object
+{
+                pooled_object(int value) : f_value(value) {}
+
+    int         f_value = 0;
+    std::string f_name = std::string("pooled object");
+    char        f_data[100] = {};
+};
+
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("daemon_ticket_pool", "[cluckd][ticket][daemon]")
+{
+    CATCH_START_SECTION("daemon_ticket_pool: empty pool")
+    {
+        cluck_daemon::ticket_pool pool;
+        CATCH_REQUIRE(pool.get_block_size() == 0);
+        CATCH_REQUIRE(pool.get_slab_count() == 0);
+        CATCH_REQUIRE(pool.get_used_blocks() == 0);
+        CATCH_REQUIRE(pool.get_free_blocks() == 0);
+        CATCH_REQUIRE(pool.get_upstream_allocations() == 0);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_ticket_pool: blocks are reused")
+    {
+        cluck_daemon::ticket_pool::pointer_t pool(std::make_shared<cluck_daemon::ticket_pool>());
+        cluck_daemon::ticket_allocator<pooled_object> allocator(pool);
+
+        std::vector<std::shared_ptr<pooled_object>> objects;
+        for(int idx(0); idx < 100; ++idx)
+        {
+            objects.push_back(std::allocate_shared<pooled_object>(allocator, idx));
+        }
+        CATCH_REQUIRE(pool->get_block_size() >= sizeof(pooled_object));
+        CATCH_REQUIRE(pool->get_slab_count() == 2);
+        CATCH_REQUIRE(pool->get_used_blocks() == 100);
+        CATCH_REQUIRE(pool->get_free_blocks() == cluck_daemon::ticket_pool::BLOCKS_PER_SLAB * 2 - 100);
+        CATCH_REQUIRE(pool->get_upstream_allocations() == 2);
+        for(int idx(0); idx < 100; ++idx)
+        {
+            CATCH_REQUIRE(objects[idx]->f_value == idx);
+        }
+
+        objects.clear();
+        CATCH_REQUIRE(pool->get_used_blocks() == 0);
+        CATCH_REQUIRE(pool->get_free_blocks() == cluck_daemon::ticket_pool::BLOCKS_PER_SLAB * 2);
+
+        for(int idx(0); idx < 10'000; ++idx)
+        {
+            std::shared_ptr<pooled_object> o(std::allocate_shared<pooled_object>(allocator, idx));
+            CATCH_REQUIRE(o->f_value == idx);
+        }
+        CATCH_REQUIRE(pool->get_slab_count() == 2);
+        CATCH_REQUIRE(pool->get_upstream_allocations() == 2);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_ticket_pool: other sizes are forwarded")
+    {
+        cluck_daemon::ticket_pool pool;
+        void * a(pool.allocate(200, alignof(std::max_align_t)));
+        CATCH_REQUIRE(pool.get_slab_count() == 1);
+        CATCH_REQUIRE(pool.get_used_blocks() == 1);
+
+        void * b(pool.allocate(1000, alignof(std::max_align_t)));
+        CATCH_REQUIRE(pool.get_slab_count() == 1);
+        CATCH_REQUIRE(pool.get_used_blocks() == 1);
+        CATCH_REQUIRE(pool.get_upstream_allocations() == 2);
+
+        pool.deallocate(b, 1000, alignof(std::max_align_t));
+        pool.deallocate(a, 200, alignof(std::max_align_t));
+        CATCH_REQUIRE(pool.get_used_blocks() == 0);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_ticket_pool: the pool survives its owner")
+    {
+        cluck_daemon::ticket_pool::pointer_t pool(std::make_shared<cluck_daemon::ticket_pool>());
+        std::shared_ptr<pooled_object> o(std::allocate_shared<pooled_object>(
+                      cluck_daemon::ticket_allocator<pooled_object>(pool)
+                    , 33));
+        std::weak_ptr<cluck_daemon::ticket_pool> weak(pool);
+        pool.reset();
+        CATCH_REQUIRE_FALSE(weak.expired());
+        CATCH_REQUIRE(o->f_value == 33);
+        o.reset();
+        CATCH_REQUIRE(weak.expired());
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -0,0 +1,304 @@
+// Copyright (c) 2016-2025  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/cluck
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// self
+//
+#include    "catch_main.h"
+
+
+
+
+// daemon
+//
+#include    <daemon/ticket_store.h>
+
+
+// snaplogger
+//
+#include    <snaplogger/message.h>
+
+
+// C++
+//
+#include    <chrono>
+#include    <map>
+#include    <vector>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace
+{
+
+
+
+// the tickets are not dereferenced by the store so the tests use
+// null tickets; the key is what matters
+//
+typedef std::map<cluck_daemon::ticket_key, cluck_daemon::ticket_map::pointer_t>
+                                        nested_key_map_t;
+typedef std::map<cluck_daemon::atom, nested_key_map_t, cluck_daemon::atom_less>
+                                        nested_object_map_t;
+
+
+cluck_daemon::ticket_key make_key(std::size_t idx)
+{
+    return cluck_daemon::ticket_key(
+              idx + 1
+            , cluck_daemon::ticket_key(
+                      cluck_daemon::atom("host" + std::to_string(idx % 7))
+                    , static_cast<pid_t>(1000 + idx)));
+}
+
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("daemon_ticket_store", "[cluckd][ticket][daemon]")
+{
+    CATCH_START_SECTION("daemon_ticket_store: ticket map is sorted by key")
+    {
+        cluck_daemon::ticket_map m;
+        CATCH_REQUIRE(m.empty());
+        CATCH_REQUIRE(m.begin() == m.end());
+        CATCH_REQUIRE(m.get_last_ticket_number() == cluck_daemon::ticket_key::NO_TICKET);
+
+        m["00000003/rc/5003"] = nullptr;
+        m["00000001/rc/5003"] = nullptr;
+        m["00000002/rc/5003"] = nullptr;
+        m["00000002/rc/5003"] = nullptr;
+        CATCH_REQUIRE(m.size() == 3);
+        CATCH_REQUIRE(m.get_last_ticket_number() == 3);
+
+        cluck_daemon::ticket_key::ticket_id_t expected(1);
+        for(auto const & key_ticket : m)
+        {
+            CATCH_REQUIRE(key_ticket.first.get_ticket_number() == expected);
+            CATCH_REQUIRE(key_ticket.second == nullptr);
+            ++expected;
+        }
+
+        auto it(m.find("00000002/rc/5003"));
+        CATCH_REQUIRE(it != m.end());
+        CATCH_REQUIRE(it->first == "00000002/rc/5003");
+        it = m.erase(it);
+        CATCH_REQUIRE(it->first == "00000003/rc/5003");
+        CATCH_REQUIRE(m.find("00000002/rc/5003") == m.end());
+        CATCH_REQUIRE(m.size() == 2);
+
+        cluck_daemon::ticket_map const copy(m);
+        CATCH_REQUIRE(copy.find("00000001/rc/5003") != copy.end());
+        CATCH_REQUIRE(copy.find("00000004/rc/5003") == copy.end());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_ticket_store: head activation flag follows the head")
+    {
+        cluck_daemon::ticket_map m;
+        CATCH_REQUIRE_FALSE(m.is_head_activated());
+
+        m["00000002/rc/5003"] = nullptr;
+        m.set_head_activated(true);
+        CATCH_REQUIRE(m.is_head_activated());
+
+        // a ticket added after the head does not change the head
+        //
+        m["00000003/rc/5003"] = nullptr;
+        CATCH_REQUIRE(m.is_head_activated());
+
+        // erasing a ticket which is not the head keeps the flag
+        //
+        m.erase(m.find("00000003/rc/5003"));
+        CATCH_REQUIRE(m.is_head_activated());
+
+        // a new head clears the flag
+        //
+        m["00000001/rc/5003"] = nullptr;
+        CATCH_REQUIRE_FALSE(m.is_head_activated());
+
+        // erasing the head clears the flag
+        //
+        m.set_head_activated(true);
+        m.erase(m.begin());
+        CATCH_REQUIRE_FALSE(m.is_head_activated());
+        CATCH_REQUIRE(m.begin()->first == "00000002/rc/5003");
+
+        m.set_head_activated(true);
+        m.clear();
+        CATCH_REQUIRE_FALSE(m.is_head_activated());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("daemon_ticket_store: objects are found by name")
+    {
+        cluck_daemon::ticket_store store;
+        CATCH_REQUIRE(store.empty());
+        CATCH_REQUIRE(store.find(std::string("not-an-object")) == store.end());
+
+        for(std::size_t idx(0); idx < 100; ++idx)
+        {
+            store[cluck_daemon::atom("object-" + std::to_string(idx))][make_key(idx)] = nullptr;
+        }
+        CATCH_REQUIRE(store.size() == 100);
+
+        for(std::size_t idx(0); idx < 100; ++idx)
+        {
+            auto it(store.find("object-" + std::to_string(idx)));
+            CATCH_REQUIRE(it != store.end());
+            CATCH_REQUIRE(it->first == "object-" + std::to_string(idx));
+            CATCH_REQUIRE(it->second.size() == 1);
+            CATCH_REQUIRE(it->second.find(make_key(idx)) != it->second.end());
+        }
+
+        // erase every other object while looping like the daemon does
+        //
+        for(auto it(store.begin()); it != store.end(); )
+        {
+            std::string const & name(it->first.str());
+            if((std::stoi(name.substr(7)) & 1) == 0)
+            {
+                it = store.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        CATCH_REQUIRE(store.size() == 50);
+        for(std::size_t idx(0); idx < 100; ++idx)
+        {
+            auto it(store.find("object-" + std::to_string(idx)));
+            CATCH_REQUIRE((it == store.end()) == ((idx & 1) == 0));
+        }
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("daemon_ticket_store_benchmark", "[cluckd][ticket][daemon][benchmark][.]")
+{
+    CATCH_START_SECTION("daemon_ticket_store_benchmark: flat store against nested maps")
+    {
+        constexpr std::size_t const OBJECTS = 100;
+        constexpr std::size_t const LOOKUPS = 200'000;
+
+        for(std::size_t const count : { 1'000, 10'000, 100'000 })
+        {
+            std::vector<cluck_daemon::atom> names;
+            for(std::size_t idx(0); idx < OBJECTS; ++idx)
+            {
+                names.emplace_back("bench-object-" + std::to_string(idx));
+            }
+            std::vector<cluck_daemon::ticket_key> keys;
+            for(std::size_t idx(0); idx < count; ++idx)
+            {
+                keys.push_back(make_key(idx));
+            }
+
+            nested_object_map_t nested;
+            cluck_daemon::ticket_store store;
+            for(std::size_t idx(0); idx < count; ++idx)
+            {
+                nested[names[idx % OBJECTS]][keys[idx]] = nullptr;
+                store[names[idx % OBJECTS]][keys[idx]] = nullptr;
+            }
+
+            // search tickets by object name and key
+            //
+            std::size_t nested_found(0);
+            auto const nested_start(std::chrono::steady_clock::now());
+            for(std::size_t idx(0); idx < LOOKUPS; ++idx)
+            {
+                std::size_t const pos((idx * 7919) % count);
+                auto obj(nested.find(names[pos % OBJECTS]));
+                if(obj != nested.end()
+                && obj->second.find(keys[pos]) != obj->second.end())
+                {
+                    ++nested_found;
+                }
+            }
+            auto const nested_duration(std::chrono::steady_clock::now() - nested_start);
+
+            std::size_t store_found(0);
+            auto const store_start(std::chrono::steady_clock::now());
+            for(std::size_t idx(0); idx < LOOKUPS; ++idx)
+            {
+                std::size_t const pos((idx * 7919) % count);
+                auto obj(store.find(names[pos % OBJECTS]));
+                if(obj != store.end()
+                && obj->second.find(keys[pos]) != obj->second.end())
+                {
+                    ++store_found;
+                }
+            }
+            auto const store_duration(std::chrono::steady_clock::now() - store_start);
+            CATCH_REQUIRE(nested_found == LOOKUPS);
+            CATCH_REQUIRE(store_found == LOOKUPS);
+
+            // scan all the tickets (as cleanup() does)
+            //
+            std::size_t nested_sum(0);
+            auto const nested_scan_start(std::chrono::steady_clock::now());
+            for(auto const & obj : nested)
+            {
+                for(auto const & key_ticket : obj.second)
+                {
+                    nested_sum += key_ticket.first.get_ticket_number();
+                }
+            }
+            auto const nested_scan_duration(std::chrono::steady_clock::now() - nested_scan_start);
+
+            std::size_t store_sum(0);
+            auto const store_scan_start(std::chrono::steady_clock::now());
+            for(auto const & obj : store)
+            {
+                for(auto const & key_ticket : obj.second)
+                {
+                    store_sum += key_ticket.first.get_ticket_number();
+                }
+            }
+            auto const store_scan_duration(std::chrono::steady_clock::now() - store_scan_start);
+            CATCH_REQUIRE(nested_sum == store_sum);
+
+            SNAP_LOG_INFO
+                << "ticket store benchmark with "
+                << count
+                << " tickets: lookup nested maps "
+                << std::chrono::duration<double, std::nano>(nested_duration).count() / LOOKUPS
+                << "ns, flat store "
+                << std::chrono::duration<double, std::nano>(store_duration).count() / LOOKUPS
+                << "ns; scan nested maps "
+                << std::chrono::duration<double, std::micro>(nested_scan_duration).count()
+                << "us, flat store "
+                << std::chrono::duration<double, std::micro>(store_scan_duration).count()
+                << "us"
+                << SNAP_LOG_SEND;
+        }
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
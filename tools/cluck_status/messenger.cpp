@@ -61,7 +61,7 @@ namespace lock_status
  * This class is a messenger used to send a message to the cluckd service
  * and print out the response.
  *
- * At the moment, we have a single such command: LIST_TICKETS.
+ * At the moment, we support the INFO and LIST_TICKETS commands.
  */
 
 
@@ -82,6 +82,10 @@ messenger::messenger(server * s, advgetopt::getopt & opts)
 {
     set_name("lock_status");
     get_dispatcher()->add_matches({
+        ed::define_match(
+              ed::Expression(cluck::g_name_cluck_cmd_cluckd_status)
+            , ed::Callback(std::bind(&messenger::msg_cluckd_status, this, std::placeholders::_1))
+        ),
         ed::define_match(
               ed::Expression(cluck::g_name_cluck_cmd_lock_ready)
             , ed::Callback(std::bind(&messenger::msg_lock_ready, this, std::placeholders::_1))
@@ -100,7 +104,16 @@ messenger::messenger(server * s, advgetopt::getopt & opts)
         ),
     });
 
-    if(opts.is_defined("list-ticket"))
+    if(opts.is_defined("hot"))
+    {
+        f_command = cluck::g_name_cluck_cmd_info;
+        f_mode = cluck::g_name_cluck_value_hot;
+    }
+    else if(opts.is_defined("info"))
+    {
+        f_command = cluck::g_name_cluck_cmd_info;
+    }
+    else if(opts.is_defined("list-ticket"))
     {
         f_command = cluck::g_name_cluck_cmd_list_tickets;
     }
@@ -141,12 +154,50 @@ void messenger::fluid_settings_changed(
         list_message.set_service(cluck::g_name_cluck_service_name);
         list_message.set_server(f_server_name);
         list_message.add_parameter("cache", "no");
+        if(!f_mode.empty())
+        {
+            list_message.add_parameter(cluck::g_name_cluck_param_mode, f_mode);
+        }
         ::communicator::request_failure(list_message);
         send_message(list_message);
     }
 }
 
 
+/** \brief Print out the status of the cluckd service.
+ *
+ * This function gets called when we receive the reply to our INFO
+ * message. The status is a JSON object which includes the list of
+ * computers, their leader status, and the round trip time (in
+ * microseconds) from this cluckd service to each one of them, when
+ * known.
+ *
+ * On a leader, it also includes the "clients" array with the current
+ * usage of each client service: its number of tickets, the number of
+ * LOCK requests it sent, and how many of those were refused because
+ * the client was over its quotas.
+ *
+ * The "phases" object shows how long the locks obtained on that
+ * cluckd service spent in each phase of the bakery algorithm
+ * (in microseconds).
+ *
+ * With the `--hot` command, it also includes the "hot" array with the
+ * statistics of the most locked objects: their rate of acquisitions,
+ * queue depth, timeouts, and their wait and hold times (in microseconds).
+ *
+ * \param[in] msg  The CLUCKD_STATUS message.
+ */
+void messenger::msg_cluckd_status(ed::message & msg)
+{
+    std::cout
+        << std::endl
+        << msg.get_parameter(::communicator::g_name_communicator_param_status)
+        << std::endl;
+
+    stop(false);
+}
+
+
 void messenger::msg_lock_ready(ed::message & msg)
 {
     snapdev::NOT_USED(msg);
@@ -50,6 +50,7 @@ public:
                                     , std::string const & value) override;
 
 private:
+    void                        msg_cluckd_status(ed::message & msg);
     void                        msg_lock_ready(ed::message & msg);
     void                        msg_no_lock(ed::message & msg);
     void                        msg_ticket_list(ed::message & msg);
@@ -59,6 +60,7 @@ private:
     bool                        f_quiet = false;
     std::string                 f_server_name = std::string();
     std::string                 f_command = std::string();
+    std::string                 f_mode = std::string();
 };
 
 
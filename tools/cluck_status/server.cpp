@@ -62,6 +62,20 @@ namespace
 
 advgetopt::option const g_options[] =
 {
+    advgetopt::define_option(
+          advgetopt::Name("hot")
+        , advgetopt::ShortName('H')
+        , advgetopt::Flags(advgetopt::standalone_command_flags<
+                      advgetopt::GETOPT_FLAG_GROUP_OPTIONS>())
+        , advgetopt::Help("Print the statistics of the most locked objects: rate, queue depth, timeouts, wait and hold times.")
+    ),
+    advgetopt::define_option(
+          advgetopt::Name("info")
+        , advgetopt::ShortName('i')
+        , advgetopt::Flags(advgetopt::standalone_command_flags<
+                      advgetopt::GETOPT_FLAG_GROUP_OPTIONS>())
+        , advgetopt::Help("Print the cluckd status including the round trip time to the other cluck daemons and the quota usage of the clients.")
+    ),
     advgetopt::define_option(
           advgetopt::Name("list-ticket")
         , advgetopt::ShortName('l')